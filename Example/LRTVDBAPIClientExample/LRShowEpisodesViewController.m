@@ -23,6 +23,7 @@
 #import "LRShowEpisodesViewController.h"
 #import "LRTVDBShow.h"
 #import "LRTVDBEpisode.h"
+#import "LRTVDBPersistenceManager.h"
 #import "LRTVDBEpisodeCell.h"
 #import "LREpisodeDetailsViewController.h"
 #import "UIImageView+LRNetworking.h"
@@ -51,7 +52,7 @@ static void *kObservingLastEpisodeContext;
     
     [self.show addObserver:self
                 forKeyPath:LRTVDBShowAttributes.episodes
-                   options:0
+                   options:NSKeyValueObservingOptionNew
                    context:&kObservingEpisodesContext];
     
     [self.show addObserver:self
@@ -93,7 +94,18 @@ static void *kObservingLastEpisodeContext;
                         change:(NSDictionary *)change
                        context:(void *)context
 {
-    if (context == &kObservingEpisodesContext || context == &kObservingLastEpisodeContext)
+    if (context == &kObservingEpisodesContext &&
+        [change[NSKeyValueChangeKindKey] unsignedIntegerValue] == NSKeyValueChangeReplacement)
+    {
+        // Only some episodes have changed, no need to reload everything.
+        // The indexes are only meaningful now, so the episodes themselves are captured.
+        NSArray *updatedEpisodes = change[NSKeyValueChangeNewKey];
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self reloadEpisodes:updatedEpisodes];
+        });
+    }
+    else if (context == &kObservingEpisodesContext || context == &kObservingLastEpisodeContext)
     {
         dispatch_async(dispatch_get_main_queue(), ^{
             
@@ -116,9 +128,32 @@ static void *kObservingLastEpisodeContext;
     }
 }
 
+- (void)reloadEpisodes:(NSArray *)episodes
+{
+    NSMutableArray *indexPaths = [NSMutableArray arrayWithCapacity:[episodes count]];
+    
+    for (LRTVDBEpisode *episode in episodes)
+    {
+        NSInteger section = episode.seasonNumber.integerValue;
+        NSUInteger row = [[self.show episodesForSeason:episode.seasonNumber] indexOfObjectIdenticalTo:episode];
+        
+        // The episodes have changed in the meantime and the table doesn't know yet, rows can't be mapped.
+        if (row == NSNotFound || section >= [self.tableView numberOfSections] ||
+            row >= [self.tableView numberOfRowsInSection:section])
+        {
+            [self.tableView reloadData];
+            return;
+        }
+        
+        [indexPaths addObject:[NSIndexPath indexPathForRow:row inSection:section]];
+    }
+    
+    [self.tableView reloadRowsAtIndexPaths:indexPaths withRowAnimation:UITableViewRowAnimationNone];
+}
+
 - (void)scrollToCorrectEpisode
 {
-    LRTVDBEpisode *correctEpisode = self.show.lastEpisodeSeen ?: self.show.lastEpisode;
+    LRTVDBEpisode *correctEpisode = self.show.activeEpisode ?: self.show.lastEpisode;
     
     if (correctEpisode == nil) return;
     
@@ -191,23 +226,19 @@ static void *kObservingLastEpisodeContext;
 
 - (void)episodeSeenButtonTappedOnCell:(LRTVDBEpisodeCell *)cell
 {
-    LRTVDBEpisode *validEpisode = nil;
-
-    if (cell.episode == self.show.lastEpisodeSeen)
-    {
-        NSUInteger index = [self.show.episodes indexOfObjectIdenticalTo:cell.episode];
-        
-        if (index != NSNotFound && index > 0)
-        {
-            validEpisode = self.show.episodes[index - 1];
-        }
-    }
-    else
-    {
-        validEpisode = cell.episode;
-    }
+    NSArray *episodes = self.show.episodes;
+    NSUInteger index = [episodes indexOfObjectIdenticalTo:cell.episode];
+    
+    if (index == NSNotFound) return;
+    
+    // Seeing an episode means seeing the previous ones too, and the other way around.
+    BOOL seen = ![cell.episode hasBeenSeen];
+    NSRange range = seen ? NSMakeRange(0, index + 1) : NSMakeRange(index, [episodes count] - index);
+    
+    [self.show setSeen:seen forEpisodesInRange:range];
     
-    self.show.lastEpisodeSeen = validEpisode;
+    // Persisted right away, without saving the whole show.
+    [[LRTVDBPersistenceManager manager] journalSeenStatusOfEpisodes:[episodes subarrayWithRange:range]];
     
     [self.tableView reloadData];
 }
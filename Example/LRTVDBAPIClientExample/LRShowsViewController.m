@@ -158,8 +158,8 @@
 {
     self.lastEpisodesRefresh = [NSDate date];
     
-    [self.shows makeObjectsPerformSelector:@selector(refreshEpisodesInfomation)];
-    
+    // Shows refresh their episodes information by themselves when the day
+    // rolls over, they just need to be sorted again.
     [[LRTVDBShowStorage sharedStorage] reloadShows];
     
     self.shows = nil;
@@ -205,18 +205,7 @@
 {
     if (self.lastEpisodesRefresh == nil) return YES;
     
-    static NSCalendar *calendar = nil;
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        calendar = [NSCalendar currentCalendar];
-    });
-    
-    NSDateComponents *components = [calendar components:NSDayCalendarUnit
-                                               fromDate:[self.lastEpisodesRefresh dateByIgnoringTime]
-                                                 toDate:[[NSDate date] dateByIgnoringTime]
-                                                options:0];
-    
-    return components.day > 0;
+    return [self.lastEpisodesRefresh lr_dayNumber] != LRTVDBTodayDayNumber();
 }
 
 - (BOOL)shouldUpdateShows
@@ -0,0 +1,49 @@
+// NSData+LRTVDBAdditions.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@interface NSData (LRTVDBAdditions)
+
+/**
+ Compresses the receiver with zlib, primed with a preset dictionary of the
+ strings the persisted shows repeat the most (keys, image paths, common
+ words...), so even small segments shrink.
+ @discussion The compressed data starts with a small header (magic number,
+ dictionary version and uncompressed length) so it can be told apart from
+ uncompressed data.
+ @return The compressed data, nil if it couldn't be compressed.
+ */
+- (NSData *)lr_compressedData;
+
+/**
+ @return The uncompressed data of data generated by lr_compressedData, nil
+ if the receiver is not compressed or is corrupt.
+ */
+- (NSData *)lr_decompressedData;
+
+/**
+ @return YES if the receiver was generated by lr_compressedData.
+ */
+- (BOOL)lr_isCompressedData;
+
+@end
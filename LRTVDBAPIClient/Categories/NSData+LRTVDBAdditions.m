@@ -0,0 +1,179 @@
+// NSData+LRTVDBAdditions.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "NSData+LRTVDBAdditions.h"
+#import <libkern/OSByteOrder.h>
+#import <zlib.h>
+
+static const uint8_t kLRTVDBCompressedDataMagic[4] = { 'L', 'R', 'T', 'Z' };
+
+/** Must be increased whenever the dictionary changes, old data can't be inflated without its dictionary. */
+static const uint8_t kLRTVDBCompressionDictionaryVersion = 1;
+
+/** Magic number, dictionary version and little endian uncompressed length. */
+static const NSUInteger kLRTVDBCompressedDataHeaderLength = sizeof(kLRTVDBCompressedDataMagic) + sizeof(uint8_t) + sizeof(uint32_t);
+
+/** Deflate never shrinks data further than this, larger lengths can only come from corrupt headers. */
+static const uint64_t kLRTVDBMaximumCompressionRatio = 1032;
+
+/**
+ Strings repeated across the persisted shows. zlib matches against the end
+ of the dictionary more cheaply, so the most common strings are last.
+ */
+static NSData *LRTVDBCompressionDictionary(void)
+{
+    static NSData *dictionary = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSArray *strings = @[
+            // Words of overviews and names
+            @"Monday", @"Tuesday", @"Wednesday", @"Thursday", @"Friday", @"Saturday", @"Sunday",
+            @"Continuing", @"Ended", @"Drama", @"Comedy", @"Action", @"Adventure", @"Science-Fiction",
+            @"Crime", @"Mystery", @"Thriller", @"Fantasy", @"Animation", @"Reality", @"Documentary",
+            @"TV-14", @"TV-PG", @"TV-MA", @"season", @"episode", @"series", @"family", @"friends",
+            @" when ", @" after ", @" their ", @" while ", @" with ", @" from ", @" that ", @" for ",
+            @" his ", @" her ", @" is ", @" in ", @" a ", @" to ", @" of ", @" and ", @" the ", @". ",
+            
+            // Image paths, relative to the banners base URL
+            @".jpg", @"text/", @"graphical/", @"blank/", @"fanart/original/", @"posters/",
+            @"seasons/", @"seasonswide/", @"actors/", @"episodes/",
+            
+            // Keys of the serialized models
+            @"kShowAirDayKey", @"kShowAirTimeKey", @"kShowAvailableLanguagesKey", @"kShowBasicStatusKey",
+            @"kShowContentRatingKey", @"kShowGenresKey", @"kShowImdbIDKey", @"kShowLanguageKey",
+            @"kShowNetworkKey", @"kShowPremiereDateKey", @"kShowRuntimeKey", @"kShowLastEpisodeSeenKey",
+            @"kShowFanartURLKey", @"kShowBannerURLKey", @"kShowPosterURLKey", @"kShowOverviewKey",
+            @"kShowRatingCountKey", @"kShowRatingKey", @"kShowNameKey", @"kShowIDKey",
+            @"kShowInfoFingerprintKey", @"kShowImagesFingerprintKey", @"kShowActorsFingerprintKey",
+            @"kShowActorsNamesKey", @"kShowEpisodesKey", @"kShowImagesKey", @"kShowActorsKey",
+            @"kActorIDKey", @"kActorImageURLKey", @"kActorNameKey", @"kActorRoleKey", @"kActorSortOrderKey",
+            @"kImageRatingCountKey", @"kImageRatingKey", @"kImageSeasonNumberKey",
+            @"kImageThumbnailURLKey", @"kImageTypeKey", @"kImageURLKey",
+            @"kEpisodeDirectorsKey", @"kEpisodeGuestStarsKey", @"kEpisodeWritersKey",
+            @"kEpisodeImdbIDKey", @"kEpisodeLanguageKey", @"kEpisodeImageURLKey",
+            @"kEpisodeRatingCountKey", @"kEpisodeRatingKey", @"kEpisodeAiredDateKey",
+            @"kEpisodeSeasonNumberKey", @"kEpisodeNumberKey", @"kEpisodeSeenKey",
+            @"kEpisodeShowIDKey", @"kEpisodeIDKey", @"kEpisodeTitleKey", @"kEpisodeOverviewKey",
+            @"bplist00",
+        ];
+        
+        dictionary = [[strings componentsJoinedByString:@""] dataUsingEncoding:NSUTF8StringEncoding];
+    });
+    
+    return dictionary;
+}
+
+@implementation NSData (LRTVDBAdditions)
+
+- (NSData *)lr_compressedData
+{
+    if ([self length] > UINT32_MAX) return nil;
+    
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    
+    if (deflateInit(&stream, Z_BEST_COMPRESSION) != Z_OK) return nil;
+    
+    NSData *dictionary = LRTVDBCompressionDictionary();
+    
+    if (deflateSetDictionary(&stream, [dictionary bytes], (uInt)[dictionary length]) != Z_OK)
+    {
+        deflateEnd(&stream);
+        return nil;
+    }
+    
+    uLong bound = deflateBound(&stream, (uLong)[self length]);
+    NSMutableData *compressedData = [NSMutableData dataWithLength:kLRTVDBCompressedDataHeaderLength + bound];
+    uint8_t *bytes = [compressedData mutableBytes];
+    
+    memcpy(bytes, kLRTVDBCompressedDataMagic, sizeof(kLRTVDBCompressedDataMagic));
+    bytes[4] = kLRTVDBCompressionDictionaryVersion;
+    OSWriteLittleInt32(bytes, 5, (uint32_t)[self length]);
+    
+    stream.next_in = (Bytef *)[self bytes];
+    stream.avail_in = (uInt)[self length];
+    stream.next_out = bytes + kLRTVDBCompressedDataHeaderLength;
+    stream.avail_out = (uInt)bound;
+    
+    int status = deflate(&stream, Z_FINISH);
+    
+    [compressedData setLength:kLRTVDBCompressedDataHeaderLength + stream.total_out];
+    
+    deflateEnd(&stream);
+    
+    return status == Z_STREAM_END ? compressedData : nil;
+}
+
+- (NSData *)lr_decompressedData
+{
+    if (![self lr_isCompressedData]) return nil;
+    
+    const uint8_t *bytes = [self bytes];
+    
+    if (bytes[4] != kLRTVDBCompressionDictionaryVersion) return nil;
+    
+    uint32_t length = OSReadLittleInt32(bytes, 5);
+    
+    // The length is read before anything is inflated, so it's checked
+    // before allocating the buffer for it.
+    if ((uint64_t)length > ([self length] - kLRTVDBCompressedDataHeaderLength) * kLRTVDBMaximumCompressionRatio) return nil;
+    
+    NSMutableData *decompressedData = [NSMutableData dataWithLength:length];
+    
+    if (!decompressedData) return nil;
+    
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    
+    if (inflateInit(&stream) != Z_OK) return nil;
+    
+    stream.next_in = (Bytef *)bytes + kLRTVDBCompressedDataHeaderLength;
+    stream.avail_in = (uInt)([self length] - kLRTVDBCompressedDataHeaderLength);
+    stream.next_out = [decompressedData mutableBytes];
+    stream.avail_out = length;
+    
+    int status = inflate(&stream, Z_FINISH);
+    
+    if (status == Z_NEED_DICT)
+    {
+        NSData *dictionary = LRTVDBCompressionDictionary();
+        
+        if (inflateSetDictionary(&stream, [dictionary bytes], (uInt)[dictionary length]) == Z_OK)
+        {
+            status = inflate(&stream, Z_FINISH);
+        }
+    }
+    
+    BOOL success = (status == Z_STREAM_END && stream.total_out == length);
+    
+    inflateEnd(&stream);
+    
+    return success ? decompressedData : nil;
+}
+
+- (BOOL)lr_isCompressedData
+{
+    return [self length] > kLRTVDBCompressedDataHeaderLength &&
+           memcmp([self bytes], kLRTVDBCompressedDataMagic, sizeof(kLRTVDBCompressedDataMagic)) == 0;
+}
+
+@end
@@ -22,8 +22,50 @@
 
 #import <Foundation/Foundation.h>
 
+/**
+ Number of days elapsed since 1970-01-01 in the proleptic Gregorian calendar.
+ @discussion Day numbers identify a calendar day independently of the time
+ zone, so comparing two of them is just an integer subtraction.
+ */
+typedef NSInteger LRTVDBDayNumber;
+
+/**
+ Day number used for unknown or invalid dates. It sorts after every real day.
+ */
+extern const LRTVDBDayNumber LRTVDBUnknownDayNumber;
+
+/**
+ Parses a fixed-format date string (yyyy-MM-dd) as the ones theTVDB uses.
+ @param cString NULL terminated string. Surrounding whitespace is ignored.
+ @return The day number of the date or LRTVDBUnknownDayNumber if the string
+ is not a valid date.
+ @remarks This function neither allocates nor depends on the current locale,
+ so it can be safely called concurrently from any thread.
+ */
+LRTVDBDayNumber LRTVDBDayNumberFromISODateCString(const char *cString);
+
+/**
+ @return The day number of the current day in the default time zone.
+ @discussion The value is cached until the day rolls over (or the system
+ clock or time zone changes), so calling this function is cheap enough to
+ check whether any day dependent value has gone stale.
+ */
+LRTVDBDayNumber LRTVDBTodayDayNumber(void);
+
 @interface NSDate (LRTVDBAdditions)
 
+/**
+ @return The date at the start of the provided day in the default time zone
+ or nil if the day number is LRTVDBUnknownDayNumber.
+ @remarks Dates are cached, as plenty of episodes share the same aired day.
+ */
++ (NSDate *)lr_dateWithDayNumber:(LRTVDBDayNumber)dayNumber;
+
+/**
+ @return The day number of the receiver in the default time zone.
+ */
+- (LRTVDBDayNumber)lr_dayNumber;
+
 /**
  Removes time information from the NSDate object receiver.
  @return A new NSDate object removing the time information from the receiver.
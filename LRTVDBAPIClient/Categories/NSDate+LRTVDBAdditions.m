@@ -21,9 +21,212 @@
 // THE SOFTWARE.
 
 #import "NSDate+LRTVDBAdditions.h"
+#import <libkern/OSAtomic.h>
+
+const LRTVDBDayNumber LRTVDBUnknownDayNumber = NSIntegerMax;
+
+static const NSTimeInterval kLRTVDBSecondsPerDay = 86400;
+
+NS_INLINE BOOL LRTVDBIsWhitespace(char character)
+{
+    return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+}
+
+NS_INLINE BOOL LRTVDBIsLeapYear(NSInteger year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+/**
+ Howard Hinnant's days_from_civil algorithm.
+ @see http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+ */
+NS_INLINE LRTVDBDayNumber LRTVDBDayNumberFromCivilDate(NSInteger year, NSInteger month, NSInteger day)
+{
+    year -= month <= 2;
+    
+    NSInteger era = (year >= 0 ? year : year - 399) / 400;
+    NSInteger yearOfEra = year - era * 400;
+    NSInteger dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    NSInteger dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    
+    return era * 146097 + dayOfEra - 719468;
+}
+
+LRTVDBDayNumber LRTVDBDayNumberFromISODateCString(const char *cString)
+{
+    if (cString == NULL) return LRTVDBUnknownDayNumber;
+    
+    while (LRTVDBIsWhitespace(*cString)) cString++;
+    
+    // yyyy-MM-dd
+    static const size_t kDateLength = 10;
+    
+    NSInteger values[3] = {0, 0, 0};
+    NSUInteger component = 0;
+    
+    for (size_t i = 0; i < kDateLength; i++)
+    {
+        char character = cString[i];
+        
+        if (i == 4 || i == 7)
+        {
+            if (character != '-') return LRTVDBUnknownDayNumber;
+            component++;
+        }
+        else if (character >= '0' && character <= '9')
+        {
+            values[component] = values[component] * 10 + (character - '0');
+        }
+        else
+        {
+            // Also catches the NULL terminator of short strings.
+            return LRTVDBUnknownDayNumber;
+        }
+    }
+    
+    for (const char *trailing = cString + kDateLength; *trailing != '\0'; trailing++)
+    {
+        if (!LRTVDBIsWhitespace(*trailing)) return LRTVDBUnknownDayNumber;
+    }
+    
+    NSInteger year = values[0], month = values[1], day = values[2];
+    
+    static const NSInteger kDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    
+    if (year < 1 || month < 1 || month > 12 || day < 1) return LRTVDBUnknownDayNumber;
+    
+    NSInteger daysInMonth = kDaysInMonth[month - 1] + (month == 2 && LRTVDBIsLeapYear(year));
+    
+    if (day > daysInMonth) return LRTVDBUnknownDayNumber;
+    
+    return LRTVDBDayNumberFromCivilDate(year, month, day);
+}
+
+// Today's day number is cached along with the interval of time it spans, so
+// asking for it is just a comparison until the day rolls over.
+static OSSpinLock sTodayLock = OS_SPINLOCK_INIT;
+static LRTVDBDayNumber sTodayDayNumber = LRTVDBUnknownDayNumber;
+static NSTimeInterval sTodayStartTimeInterval = 0;
+static NSTimeInterval sTodayEndTimeInterval = 0;
+
+static void LRTVDBInvalidateTodayDayNumber(void)
+{
+    OSSpinLockLock(&sTodayLock);
+    sTodayDayNumber = LRTVDBUnknownDayNumber;
+    OSSpinLockUnlock(&sTodayLock);
+}
+
+LRTVDBDayNumber LRTVDBTodayDayNumber(void)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        
+        // Going back in time is caught by the interval check, but a time zone
+        // change doesn't move the clock at all.
+        for (NSString *notificationName in @[NSSystemTimeZoneDidChangeNotification, NSSystemClockDidChangeNotification])
+        {
+            [[NSNotificationCenter defaultCenter] addObserverForName:notificationName
+                                                              object:nil
+                                                               queue:nil
+                                                          usingBlock:^(NSNotification *note) {
+                                                              LRTVDBInvalidateTodayDayNumber();
+                                                          }];
+        }
+    });
+    
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+    
+    OSSpinLockLock(&sTodayLock);
+    
+    LRTVDBDayNumber todayDayNumber = sTodayDayNumber;
+    BOOL isCachedDayValid = todayDayNumber != LRTVDBUnknownDayNumber &&
+                            now >= sTodayStartTimeInterval && now < sTodayEndTimeInterval;
+    
+    OSSpinLockUnlock(&sTodayLock);
+    
+    if (!isCachedDayValid)
+    {
+        todayDayNumber = [[NSDate dateWithTimeIntervalSinceReferenceDate:now] lr_dayNumber];
+        
+        NSTimeInterval startTimeInterval = [[NSDate lr_dateWithDayNumber:todayDayNumber] timeIntervalSinceReferenceDate];
+        NSTimeInterval endTimeInterval = [[NSDate lr_dateWithDayNumber:todayDayNumber + 1] timeIntervalSinceReferenceDate];
+        
+        OSSpinLockLock(&sTodayLock);
+        
+        sTodayDayNumber = todayDayNumber;
+        sTodayStartTimeInterval = startTimeInterval;
+        sTodayEndTimeInterval = endTimeInterval;
+        
+        OSSpinLockUnlock(&sTodayLock);
+    }
+    
+    return todayDayNumber;
+}
 
 @implementation NSDate (LRTVDBAdditions)
 
++ (NSCache *)lr_dayNumberDatesCache
+{
+    static NSCache *cache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[NSCache alloc] init];
+        
+        // Cached dates are local midnights, they're no longer valid if the time zone changes.
+        [[NSNotificationCenter defaultCenter] addObserverForName:NSSystemTimeZoneDidChangeNotification
+                                                          object:nil
+                                                           queue:nil
+                                                      usingBlock:^(NSNotification *note) {
+                                                          [cache removeAllObjects];
+                                                      }];
+    });
+    
+    return cache;
+}
+
++ (NSDate *)lr_dateWithDayNumber:(LRTVDBDayNumber)dayNumber
+{
+    if (dayNumber == LRTVDBUnknownDayNumber) return nil;
+    
+    NSCache *cache = [self lr_dayNumberDatesCache];
+    NSNumber *key = @(dayNumber);
+    
+    NSDate *date = [cache objectForKey:key];
+    
+    if (date == nil)
+    {
+        NSTimeZone *timeZone = [NSTimeZone defaultTimeZone];
+        NSTimeInterval utcMidnight = dayNumber * kLRTVDBSecondsPerDay;
+        
+        // The offset at the UTC midnight is just a first guess, it can be
+        // different at the local midnight because of daylight saving time.
+        NSTimeInterval localMidnight = utcMidnight - [timeZone secondsFromGMTForDate:
+                                                      [NSDate dateWithTimeIntervalSince1970:utcMidnight]];
+        date = [NSDate dateWithTimeIntervalSince1970:utcMidnight - [timeZone secondsFromGMTForDate:
+                                                                    [NSDate dateWithTimeIntervalSince1970:localMidnight]]];
+        
+        // Some time zones skip midnight when changing to daylight saving
+        // time. The day then starts one hour later.
+        if ([date lr_dayNumber] < dayNumber)
+        {
+            date = [date dateByAddingTimeInterval:3600];
+        }
+        
+        [cache setObject:date forKey:key];
+    }
+    
+    return date;
+}
+
+- (LRTVDBDayNumber)lr_dayNumber
+{
+    NSTimeInterval localTimeInterval = [self timeIntervalSince1970] +
+                                       [[NSTimeZone defaultTimeZone] secondsFromGMTForDate:self];
+    
+    return (LRTVDBDayNumber)floor(localTimeInterval / kLRTVDBSecondsPerDay);
+}
+
 - (instancetype)dateByIgnoringTime
 {
     static NSCalendar *calendar = nil;
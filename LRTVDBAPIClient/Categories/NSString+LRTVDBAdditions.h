@@ -21,14 +21,21 @@
 // THE SOFTWARE.
 
 #import <Foundation/Foundation.h>
+#import "NSDate+LRTVDBAdditions.h"
 
 @interface NSString (LRTVDBAdditions)
 
 /**
- @return NSDate equivalent of the receiver string.
+ @return NSDate equivalent of the receiver string (yyyy-MM-dd).
  */
 - (NSDate *)dateValue;
 
+/**
+ @return Day number of the receiver string (yyyy-MM-dd) or
+ LRTVDBUnknownDayNumber if it's not a valid date.
+ */
+- (LRTVDBDayNumber)dayNumberValue;
+
 /**
  Basic HTML unescaping.
  @return A new NSString after unescaping the HTML entities.
@@ -26,14 +26,20 @@
 
 - (NSDate *)dateValue
 {
-    static NSDateFormatter *dateFormatter = nil;
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        dateFormatter = [[NSDateFormatter alloc] init];
-        [dateFormatter setDateFormat:@"yyyy-MM-dd"];
-    });
+    return [NSDate lr_dateWithDayNumber:[self dayNumberValue]];
+}
+
+- (LRTVDBDayNumber)dayNumberValue
+{
+    // Enough room for the date and some surrounding whitespace.
+    char buffer[32];
     
-    return [dateFormatter dateFromString:self];
+    if (![self getCString:buffer maxLength:sizeof(buffer) encoding:NSASCIIStringEncoding])
+    {
+        return LRTVDBUnknownDayNumber;
+    }
+    
+    return LRTVDBDayNumberFromISODateCString(buffer);
 }
 
 - (instancetype)unescapeHTMLEntities
@@ -53,6 +59,12 @@
     
     NSString *ampersand = @"&";
     
+    // Most strings have no entities at all.
+    if ([self rangeOfString:ampersand options:NSLiteralSearch].location == NSNotFound)
+    {
+        return [self copy];
+    }
+    
     NSMutableString *targetString = [self mutableCopy];
     NSMutableString *unescapedString = [NSMutableString string];
 	NSCharacterSet *htmlCharacterSet = [NSCharacterSet characterSetWithCharactersInString:ampersand];
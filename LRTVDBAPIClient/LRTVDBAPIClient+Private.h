@@ -20,6 +20,11 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#import <malloc/malloc.h>
+
+@class LRTVDBParseContext;
+@class LRTVDBShow;
+
 /** TVDB image base URL */
 static NSString *const kLRTVDBAPIImageBaseURLString = @"http://www.thetvdb.com/banners/";
 
@@ -33,11 +38,49 @@ NS_INLINE NSURL *LRTVDBImageURLForPath(NSString *path)
 {
     if (!path) return nil;
     
+    // Absolute URLs, as persisted by previous versions, are kept as they are.
+    if ([path rangeOfString:@"://"].location != NSNotFound) return [NSURL URLWithString:path];
+    
     NSString *urlString = [kLRTVDBAPIImageBaseURLString stringByAppendingString:path];
     
     return [NSURL URLWithString:urlString];
 }
 
+/**
+ Inverse of LRTVDBImageURLForPath. Persisted image URLs only keep their path,
+ as the base URL is shared by every one of them.
+ @return The path of the image relative to the TVDB image base URL, or the
+ whole URL string if it's not under it.
+ */
+NS_INLINE NSString *LRTVDBImagePathForURLString(NSString *urlString)
+{
+    if ([urlString hasPrefix:kLRTVDBAPIImageBaseURLString])
+    {
+        return [urlString substringFromIndex:[kLRTVDBAPIImageBaseURLString length]];
+    }
+    
+    return urlString;
+}
+
+NS_INLINE NSString *LRTVDBImagePathForURL(NSURL *url)
+{
+    return LRTVDBImagePathForURLString([url absoluteString]);
+}
+
+/** First binary schema version of the models encoding image paths instead of whole URLs. */
+static const NSUInteger kLRTVDBImagePathsSchemaVersion = 2;
+
+/**
+ @return The URL of an image string decoded from a binary record encoded with
+ the given schema version (see LRTVDBBinaryDecoder recordSchemaVersion).
+ */
+NS_INLINE NSURL *LRTVDBImageURLForDecodedString(NSString *string, NSUInteger recordSchemaVersion)
+{
+    if (!string) return nil;
+    
+    return recordSchemaVersion < kLRTVDBImagePathsSchemaVersion ? [NSURL URLWithString:string] : LRTVDBImageURLForPath(string);
+}
+
 /**
  @return The default TVDB API language: English
  */
@@ -45,3 +88,63 @@ NS_INLINE NSString *LRTVDBDefaultLanguage(void)
 {
     return @"en";
 }
+
+/**
+ Fingerprint of the downloaded data of a show section.
+ @discussion Besides the CRC32 of the data, it includes the options which change
+ what is parsed out of it, or what an update takes from it (the artwork of the
+ show info), so changing them never skips a section.
+ */
+FOUNDATION_EXPORT NSNumber *LRTVDBFingerprint(uint32_t crc, LRTVDBParseContext *context, BOOL includeEpisodes, BOOL replaceArtwork);
+
+/**
+ @return An empty show, only identified by its ID, used in place of the
+ show info which hasn't changed since the last update.
+ */
+FOUNDATION_EXPORT LRTVDBShow *LRTVDBUnchangedShow(LRTVDBShow *currentShow);
+
+/**
+ @return The value of a rating as a double.
+ @discussion Ratings are parsed as doubles, but previous versions parsed and
+ persisted them as floats. Those are widened through their shortest decimal
+ representation, so that 7.6f is read back as 7.6 rather than 7.599999904.
+ */
+NS_INLINE double LRTVDBRatingValue(NSNumber *rating)
+{
+    if (rating == nil) return NAN;
+    
+    return strcmp([rating objCType], @encode(float)) == 0 ? [[rating stringValue] doubleValue] : [rating doubleValue];
+}
+
+/**
+ Memory accounting helpers (see LRTVDBShow memoryUsage).
+ @return The heap bytes allocated for the object itself, as reported by
+ malloc. Zero for nil, constant objects and tagged pointers.
+ */
+NS_INLINE size_t LRTVDBMallocSize(id object)
+{
+    return object ? malloc_size((__bridge const void *)object) : 0;
+}
+
+/**
+ @return The heap bytes of the array and of the objects in it.
+ */
+NS_INLINE size_t LRTVDBMallocSizeOfArray(NSArray *array)
+{
+    size_t size = LRTVDBMallocSize(array);
+    
+    for (id object in array)
+    {
+        size += LRTVDBMallocSize(object);
+    }
+    
+    return size;
+}
+
+/**
+ @return The heap bytes of the URL and of its string.
+ */
+NS_INLINE size_t LRTVDBMallocSizeOfURL(NSURL *url)
+{
+    return url ? LRTVDBMallocSize(url) + LRTVDBMallocSize([url relativeString]) : 0;
+}
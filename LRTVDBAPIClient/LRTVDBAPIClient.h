@@ -58,6 +58,14 @@
  */
 @property (nonatomic) BOOL forceEnglishMetadata;
 
+/**
+ Use this property to defer the decoding of the heavy episode text fields
+ (overview, directors, writers and guest stars) until they are first accessed.
+ @discussion This reduces parse time and memory usage when only basic episode
+ information (title, number, aired date...) is needed.
+ */
+@property (nonatomic) BOOL lazyEpisodeTextFields;
+
 /**
  Shared API client object.
  @return The singleton API client instance.
@@ -194,6 +202,20 @@
  */
 - (void)episodesIDsToUpdateWithCompletionBlock:(void (^)(NSArray *episodesIDs, NSError *error))completionBlock;
 
+/**
+ Number of show sections (show info along with its episodes, images and actors)
+ skipped by updateShows:checkIfNeeded:updateEpisodes:updateImages:updateActors:replaceArtwork:completionBlock:
+ because their downloaded data hadn't changed since the last update. Skipped
+ sections are neither parsed nor merged.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfSkippedShowSections;
+
+/**
+ Number of show sections which were actually parsed and merged by
+ updateShows:checkIfNeeded:updateEpisodes:updateImages:updateActors:replaceArtwork:completionBlock:.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfUpdatedShowSections;
+
 /**
  Refreshes the last update timestamp.
  @remarks A normal use case for this method would be using it after
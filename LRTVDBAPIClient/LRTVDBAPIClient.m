@@ -25,13 +25,15 @@
 #import "NSArray+LRTVDBAdditions.h"
 #import "LRTVDBShow+Private.h"
 #import "LRTVDBEpisode+Private.h"
-#import "ZZArchive.h"
-#import "ZZArchiveEntry.h"
 #import "LRTVDBShowParser.h"
 #import "LRTVDBAPIClient+Private.h"
 #import "LRTVDBActorParser.h"
+#import "LRTVDBArchiveParser.h"
 #import "LRTVDBImageParser.h"
 #import "LRTVDBEpisodeParser.h"
+#import "LRTVDBParseContext.h"
+#import <libkern/OSAtomic.h>
+#import <zlib.h>
 
 #if !__has_feature(objc_arc)
 #error "LRTVDBAPIClient requires ARC support."
@@ -52,16 +54,27 @@
 /** TVDB Base URL */
 static NSString *const kLRTVDBAPIBaseURLString = @"http://www.thetvdb.com/api/";
 
+#if OS_OBJECT_USE_OBJC
+#define LRDispatchQueuePropertyModifier strong
+#else
+#define LRDispatchQueuePropertyModifier assign
+#endif
+
 /** Updates User Defaults Key */
 static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
 
 @interface LRTVDBAPIClient()
 {
     __strong NSString *_language;
+    volatile int32_t _numberOfSkippedShowSections;
+    volatile int32_t _numberOfUpdatedShowSections;
 }
 
 @property (nonatomic) NSTimeInterval lastUpdated;
 
+/** Concurrent queue where responses are parsed. */
+@property (nonatomic, LRDispatchQueuePropertyModifier) dispatch_queue_t parsingQueue;
+
 @end
 
 @implementation LRTVDBAPIClient
@@ -91,6 +104,8 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
         [self registerHTTPOperationClass:[AFHTTPRequestOperation class]];
         [self setDefaultHeader:@"Accept" value:@"application/xml"];
         
+        _parsingQueue = dispatch_queue_create("com.LRTVDBAPIClient.LRTVDBAPIClientConcurrentQueue", DISPATCH_QUEUE_CONCURRENT);
+        
         _lastUpdated = [[NSUserDefaults standardUserDefaults] doubleForKey:kLastUpdatedDefaultsKey];
         
         if (_lastUpdated == 0)
@@ -102,6 +117,17 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     return self;
 }
 
+- (void)dealloc
+{
+#if !OS_OBJECT_USE_OBJC
+    if (_parsingQueue != NULL)
+    {
+        dispatch_release(_parsingQueue);
+    }
+#endif
+    _parsingQueue = NULL;
+}
+
 #pragma mark - Shows
 
 - (void)showsWithName:(NSString *)showName
@@ -117,15 +143,18 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     
     LRTVDBAPIClientLog(@"Retrieving data from URL: %@", [kLRTVDBAPIBaseURLString stringByAppendingPathComponent:relativePath]);
     
+    // Captured now, so that parsing doesn't depend on later changes in the client.
+    LRTVDBParseContext *parseContext = [self parseContext];
+    
     void (^successBlock)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
                 
         if ([operation isCancelled]) return;
         
-        dispatch_async([[self class] lr_sharedConcurrentQueue], ^{
+        dispatch_async(self.parsingQueue, ^{
             
             LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding]);
             
-            completionBlock([[LRTVDBShowParser parser] parseBasicShowInfoFromData:responseObject], nil);
+            completionBlock([[LRTVDBShowParser parserWithContext:parseContext] parseBasicShowInfoFromData:responseObject], nil);
         });
     };
     
@@ -195,6 +224,8 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
          includeEpisodes:includeEpisodes
            includeImages:includeImages
            includeActors:includeActors
+          replaceArtwork:YES
+             currentShow:nil
          completionBlock:^(LRTVDBShow *show, NSError *error) {
              finishShowBlock(showID, show, error);
          }];
@@ -268,14 +299,16 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     
     LRTVDBAPIClientLog(@"Retrieving data from URL: %@", [kLRTVDBAPIBaseURLString stringByAppendingPathComponent:relativePath]);
     
+    LRTVDBParseContext *parseContext = [self parseContext];
+    
     void (^successBlock)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
         
-        dispatch_async([[self class] lr_sharedConcurrentQueue], ^{
+        dispatch_async(self.parsingQueue, ^{
             
             LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding]);
             
             // We know there's only on episode in the array.
-            completionBlock([[[LRTVDBEpisodeParser parser] episodesFromData:responseObject] lr_firstObject], nil);
+            completionBlock([[[LRTVDBEpisodeParser parserWithContext:parseContext] episodesFromData:responseObject] lr_firstObject], nil);
         });
     };
     
@@ -300,13 +333,15 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     
     LRTVDBAPIClientLog(@"Retrieving data from URL: %@", [kLRTVDBAPIBaseURLString stringByAppendingPathComponent:relativePath]);
     
+    LRTVDBParseContext *parseContext = [self parseContext];
+    
     void (^successBlock)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
         
-        dispatch_async([[self class] lr_sharedConcurrentQueue], ^{
+        dispatch_async(self.parsingQueue, ^{
 
             LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding]);
             
-            completionBlock([[LRTVDBImageParser parser] imagesFromData:responseObject], nil);            
+            completionBlock([[LRTVDBImageParser parserWithContext:parseContext] imagesFromData:responseObject], nil);            
         });
     };
     
@@ -331,13 +366,15 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     
     LRTVDBAPIClientLog(@"Retrieving data from URL: %@", [kLRTVDBAPIBaseURLString stringByAppendingPathComponent:relativePath]);
     
+    LRTVDBParseContext *parseContext = [self parseContext];
+    
     void (^successBlock)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
         
-        dispatch_async([[self class] lr_sharedConcurrentQueue], ^{
+        dispatch_async(self.parsingQueue, ^{
             
             LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding]);
                         
-            completionBlock([[LRTVDBActorParser parser] actorsFromData:responseObject], nil);
+            completionBlock([[LRTVDBActorParser parserWithContext:parseContext] actorsFromData:responseObject], nil);
         });
     };
     
@@ -378,13 +415,22 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
         __block BOOL updateFinishedOk = YES;
         __block int numerOfUpdatedShows = 0;
         
+        // Show info and episodes, images and actors.
+        int32_t numberOfSections = 1 + (updateImages ? 1 : 0) + (updateActors ? 1 : 0);
+        
         void (^updateShowBlock)(LRTVDBShow *, LRTVDBShow *, NSError *) = ^(LRTVDBShow *showToUpdate, LRTVDBShow *updatedShow, NSError *error) {
             
-            [showToUpdate updateWithShow:updatedShow
-                          updateEpisodes:updateEpisodes
-                            updateImages:updateImages
-                            updateActors:updateActors
-                          replaceArtwork:replaceArtwork];
+            int32_t numberOfSkippedSections = (int32_t)[showToUpdate updateWithShow:updatedShow
+                                                                     updateEpisodes:updateEpisodes
+                                                                       updateImages:updateImages
+                                                                       updateActors:updateActors
+                                                                     replaceArtwork:replaceArtwork];
+            
+            if (updatedShow)
+            {
+                OSAtomicAdd32Barrier(numberOfSkippedSections, &_numberOfSkippedShowSections);
+                OSAtomicAdd32Barrier(numberOfSections - numberOfSkippedSections, &_numberOfUpdatedShowSections);
+            }
             
             if (updateFinishedOk)
             {
@@ -422,6 +468,8 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
              includeEpisodes:updateEpisodes
                includeImages:updateImages
                includeActors:updateActors
+              replaceArtwork:replaceArtwork
+                 currentShow:show
              completionBlock:^(LRTVDBShow *updatedShow, NSError *error) {
                  updateShowBlock(show, updatedShow, error);
              }];
@@ -469,7 +517,10 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
         
         void (^updateEpisodeBlock)(LRTVDBEpisode *, LRTVDBEpisode *, NSError *) = ^(LRTVDBEpisode *episodeToUpdate, LRTVDBEpisode *updatedEpisode, NSError *error) {
             
-            [episodeToUpdate updateWithEpisode:updatedEpisode];
+            if ([episodeToUpdate updateWithEpisode:updatedEpisode])
+            {
+                [episodeToUpdate.show markSectionsAsDirty:LRTVDBShowSectionEpisodes];
+            }
             
             if (updateFinishedOk)
             {
@@ -516,13 +567,15 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     
     LRTVDBAPIClientLog(@"Retrieving data from URL: %@", [kLRTVDBAPIBaseURLString stringByAppendingPathComponent:relativePath]);
     
+    LRTVDBParseContext *parseContext = [self parseContext];
+    
     void (^successBlock)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
         
-        dispatch_async([[self class] lr_sharedConcurrentQueue], ^{
+        dispatch_async(self.parsingQueue, ^{
             
             LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding]);
             
-            NSArray *showsIDs = [[LRTVDBShowParser parser] showsIDsFromData:responseObject];
+            NSArray *showsIDs = [[LRTVDBShowParser parserWithContext:parseContext] showsIDsFromData:responseObject];
             completionBlock(showsIDs, nil);
         });
     };
@@ -543,13 +596,15 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     
     LRTVDBAPIClientLog(@"Retrieving data from URL: %@", [kLRTVDBAPIBaseURLString stringByAppendingPathComponent:relativePath]);
     
+    LRTVDBParseContext *parseContext = [self parseContext];
+    
     void (^successBlock)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
         
-        dispatch_async([[self class] lr_sharedConcurrentQueue], ^{
+        dispatch_async(self.parsingQueue, ^{
             
             LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding]);
             
-            completionBlock([[LRTVDBEpisodeParser parser] episodesIDsFromData:responseObject], nil);
+            completionBlock([[LRTVDBEpisodeParser parserWithContext:parseContext] episodesIDsFromData:responseObject], nil);
         });
     };
     
@@ -563,6 +618,16 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     [self getPath:relativePath parameters:nil success:successBlock failure:failureBlock];
 }
 
+- (NSUInteger)numberOfSkippedShowSections
+{
+    return (NSUInteger)_numberOfSkippedShowSections;
+}
+
+- (NSUInteger)numberOfUpdatedShowSections
+{
+    return (NSUInteger)_numberOfUpdatedShowSections;
+}
+
 - (void)refreshLastUpdateTimestamp
 {
     _lastUpdated = [[NSDate date] timeIntervalSince1970];
@@ -633,15 +698,36 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
 
 #pragma mark - Private
 
+NSNumber *LRTVDBFingerprint(uint32_t crc, LRTVDBParseContext *context, BOOL includeEpisodes, BOOL replaceArtwork)
+{
+    uint64_t options = (context.includeSpecials ? 1 : 0) | (includeEpisodes ? 2 : 0) | (replaceArtwork ? 4 : 0);
+    
+    return @((options << 32) | crc);
+}
+
+LRTVDBShow *LRTVDBUnchangedShow(LRTVDBShow *currentShow)
+{
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    show.showID = currentShow.showID;
+    
+    return show;
+}
+
 /**
  Creates a LRTVDBShow by downloading the zip or xml file containing the
  series, images and actors data.
+ @param replaceArtwork Whether the artwork of the current show is replaced
+ by the downloaded one. New shows always take it.
+ @param currentShow The show being updated, if any. Sections whose fingerprint
+ matches the current show one are not parsed.
  */
 - (void)showWithID:(NSString *)showID
           language:(NSString *)language
    includeEpisodes:(BOOL)includeEpisodes
      includeImages:(BOOL)includeImages
      includeActors:(BOOL)includeActors
+    replaceArtwork:(BOOL)replaceArtwork
+       currentShow:(LRTVDBShow *)currentShow
    completionBlock:(void (^)(LRTVDBShow *show, NSError *error))completionBlock
 {
     NSParameterAssert(showID);
@@ -657,6 +743,8 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
                      includeEpisodes:includeEpisodes
                        includeImages:includeImages
                        includeActors:includeActors
+                      replaceArtwork:replaceArtwork
+                         currentShow:currentShow
                      completionBlock:completionBlock];
     }
     else
@@ -664,6 +752,8 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
         [self xmlVersionOfShowWithID:showID
                             language:language
                      includeEpisodes:includeEpisodes
+                      replaceArtwork:replaceArtwork
+                         currentShow:currentShow
                      completionBlock:completionBlock];
     }
 }
@@ -677,6 +767,8 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
                includeEpisodes:(BOOL)includeEpisodes
                  includeImages:(BOOL)includeImages
                  includeActors:(BOOL)includeActors
+                replaceArtwork:(BOOL)replaceArtwork
+                   currentShow:(LRTVDBShow *)currentShow
                completionBlock:(void (^)(LRTVDBShow *show, NSError *error))completionBlock
 {
     NSParameterAssert(showID);
@@ -689,46 +781,20 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     
     LRTVDBAPIClientLog(@"Retrieving data from URL: %@", [kLRTVDBAPIBaseURLString stringByAppendingPathComponent:relativePath]);
     
+    LRTVDBParseContext *parseContext = [self parseContext];
+    
     void (^successBlock)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
         
-        dispatch_async([[self class] lr_sharedConcurrentQueue], ^{
+        dispatch_async(self.parsingQueue, ^{
             
-            LRTVDBShow *show = nil;
+            LRTVDBAPIClientLog(@"Data received from URL: %@", operation.request.URL);
             
-            if (responseObject)
-            {
-                ZZArchive *oldArchive = [ZZArchive archiveWithData:responseObject];
-                
-                // series XML info
-                ZZArchiveEntry *firstArchiveEntry = [oldArchive.entries count] > 0 ?
-                oldArchive.entries[0] : nil;
-                // images XML info
-                ZZArchiveEntry *secondArchiveEntry = [oldArchive.entries count] > 1 ?
-                oldArchive.entries[1] : nil;
-                // actors XML info
-                ZZArchiveEntry *thirdArchiveEntry = [oldArchive.entries count] > 2 ?
-                oldArchive.entries[2] : nil;
-                
-                LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:firstArchiveEntry.data encoding:NSUTF8StringEncoding]);
-                
-                // We know there's only one
-                show = [[[LRTVDBShowParser parser] parseShowInfoFromData:firstArchiveEntry.data] lr_firstObject];
-                
-                if (includeEpisodes)
-                {
-                    [show addEpisodes:[[LRTVDBEpisodeParser parser] episodesFromData:firstArchiveEntry.data]];
-                }
-                
-                if (includeImages)
-                {
-                    [show addImages:[[LRTVDBImageParser parser] imagesFromData:secondArchiveEntry.data]];
-                }
-                
-                if (includeActors)
-                {
-                    [show addActors:[[LRTVDBActorParser parser] actorsFromData:thirdArchiveEntry.data]];
-                }
-            }
+            LRTVDBShow *show = [[LRTVDBArchiveParser parserWithContext:parseContext] showFromData:responseObject
+                                                                                 includeEpisodes:includeEpisodes
+                                                                                   includeImages:includeImages
+                                                                                   includeActors:includeActors
+                                                                                  replaceArtwork:replaceArtwork
+                                                                                     currentShow:currentShow];
             
             completionBlock(show, nil);
         });
@@ -751,6 +817,8 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
 - (void)xmlVersionOfShowWithID:(NSString *)showID
                       language:(NSString *)language
                includeEpisodes:(BOOL)includeEpisodes
+                replaceArtwork:(BOOL)replaceArtwork
+                   currentShow:(LRTVDBShow *)currentShow
                completionBlock:(void (^)(LRTVDBShow *show, NSError *error))completionBlock
 {
     NSParameterAssert(showID);
@@ -763,20 +831,40 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     
     LRTVDBAPIClientLog(@"Retrieving data from URL: %@", [kLRTVDBAPIBaseURLString stringByAppendingPathComponent:relativePath]);
     
+    LRTVDBParseContext *parseContext = [self parseContext];
+    
     void (^successBlock)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
         
-        dispatch_async([[self class] lr_sharedConcurrentQueue], ^{
+        dispatch_async(self.parsingQueue, ^{
             
-            LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding]);
+            NSNumber *infoFingerprint = responseObject ? LRTVDBFingerprint((uint32_t)crc32(0, [responseObject bytes], (uInt)[responseObject length]), parseContext, includeEpisodes, replaceArtwork) : nil;
             
-            // We know there's only one
-            LRTVDBShow *show = [[[LRTVDBShowParser parser] parseShowInfoFromData:responseObject] lr_firstObject];
+            LRTVDBShow *show = nil;
             
-            if (includeEpisodes)
-            {                                
-                [show addEpisodes:[[LRTVDBEpisodeParser parser] episodesFromData:responseObject]];
+            if (currentShow && [infoFingerprint isEqual:currentShow.infoFingerprint])
+            {
+                show = LRTVDBUnchangedShow(currentShow);
+            }
+            else
+            {
+                LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding]);
+                
+                // We know there's only one
+                show = [[[LRTVDBShowParser parserWithContext:parseContext] parseShowInfoFromData:responseObject] lr_firstObject];
+                
+                if (includeEpisodes)
+                {
+                    [show addEpisodes:[[LRTVDBEpisodeParser parserWithContext:parseContext] episodesFromData:responseObject]];
+                }
             }
             
+            show.infoFingerprint = infoFingerprint;
+            
+            // Images and actors aren't downloaded, so they keep the
+            // fingerprints of the data they were last updated from.
+            show.imagesFingerprint = currentShow.imagesFingerprint;
+            show.actorsFingerprint = currentShow.actorsFingerprint;
+            
             completionBlock(show, nil);
         });
     };
@@ -818,14 +906,16 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     
     LRTVDBAPIClientLog(@"Retrieving data from URL: %@", [kLRTVDBAPIBaseURLString stringByAppendingPathComponent:relativePath]);
     
+    LRTVDBParseContext *parseContext = [self parseContext];
+    
     void (^successBlock)(AFHTTPRequestOperation *, id) = ^(AFHTTPRequestOperation *operation, id responseObject) {
         
-        dispatch_async([[self class] lr_sharedConcurrentQueue], ^{
+        dispatch_async(self.parsingQueue, ^{
             
             LRTVDBAPIClientLog(@"Data received from URL: %@\n%@", operation.request.URL, [[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding]);
             
             // We know there's only on episode in the array.
-            completionBlock([[[LRTVDBEpisodeParser parser] episodesFromData:responseObject] lr_firstObject], nil);
+            completionBlock([[[LRTVDBEpisodeParser parserWithContext:parseContext] episodesFromData:responseObject] lr_firstObject], nil);
         });
     };
     
@@ -839,6 +929,15 @@ static NSString *const kLastUpdatedDefaultsKey = @"kLastUpdatedDefaultsKey";
     [self getPath:relativePath parameters:nil success:successBlock failure:failureBlock];
 }
 
+#pragma mark - Parse context
+
+- (LRTVDBParseContext *)parseContext
+{
+    return [[LRTVDBParseContext alloc] initWithLanguage:self.language
+                                        includeSpecials:self.includeSpecials
+                                  lazyEpisodeTextFields:self.lazyEpisodeTextFields];
+}
+
 #pragma mark - TVDB Language
 
 - (void)setForceEnglishMetadata:(BOOL)forceEnglishMetadata
@@ -1018,18 +1117,4 @@ static NSString *const kLRTVDBDefaultAPIKey = @"0629B785CE550C8D";
     return _apiKey;
 }
 
-#pragma mark - Shared Concurrent Queue
-
-+ (dispatch_queue_t)lr_sharedConcurrentQueue
-{
-    static dispatch_queue_t sConcurrentQueue = NULL;
-    
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        sConcurrentQueue = dispatch_queue_create("com.LRTVDBAPIClient.LRTVDBAPIClientConcurrentQueue", DISPATCH_QUEUE_CONCURRENT);
-    });
-    
-    return sConcurrentQueue;
-}
-
 @end
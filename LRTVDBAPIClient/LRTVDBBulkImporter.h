@@ -0,0 +1,131 @@
+// LRTVDBBulkImporter.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class LRTVDBParseContext;
+@class LRTVDBPersistenceManager;
+
+static NSString *const kBulkImportErrorDomain = @"kBulkImportErrorDomain";
+
+typedef NS_ENUM (NSUInteger, BulkImportError)
+{
+    kBulkImportUnreadableSourceError,
+    kBulkImportCancelledError,
+};
+
+/**
+ Snapshot of the progress of a bulk import.
+ */
+@interface LRTVDBBulkImportProgress : NSObject
+
+/** Number of show zips found in the source. */
+@property (nonatomic, readonly) NSUInteger totalNumberOfArchives;
+
+/** Shows written to the persistence storage so far. */
+@property (nonatomic, readonly) NSUInteger numberOfImportedShows;
+
+/** Zips which couldn't be read or didn't contain a show. They are skipped. */
+@property (nonatomic, readonly) NSUInteger numberOfFailedArchives;
+
+/** Size of the zips processed so far, as read from the source. */
+@property (nonatomic, readonly) unsigned long long numberOfReadBytes;
+
+@property (nonatomic, readonly) NSTimeInterval elapsedTime;
+@property (nonatomic, readonly) double showsPerSecond;
+@property (nonatomic, readonly) double bytesPerSecond;
+
+/** From 0 to 1. */
+@property (nonatomic, readonly) double fractionCompleted;
+
+@end
+
+/**
+ Imports shows into the persistence storage from a local TVDB dump, without
+ using the network at all.
+ 
+ @discussion The dump is either a directory of show zips or a zip archive
+ containing show zips, in the same format as the zips downloaded by
+ LRTVDBAPIClient. A single show zip is imported too.
+ 
+ Zips are imported in batches. The zips of every batch are read, inflated
+ and parsed concurrently, across every core, while the previous batch is
+ being written, and each batch is recorded in the journal of the
+ persistence manager in a single pass and synced before being reported as
+ imported. Imported shows are not kept in memory: once the import finishes,
+ they are retrieved from the persistence storage like any other show. Saving
+ the shows retrieved before the import doesn't remove them, they're kept
+ after the saved ones until they're retrieved (see
+ saveShowsInPersistenceStorage:error:).
+ 
+ Shows already in the persistence storage are replaced by the imported
+ ones, seen status included.
+ @remarks Only one import at a time per importer.
+ */
+@interface LRTVDBBulkImporter : NSObject
+
+- (id)initWithPersistenceManager:(LRTVDBPersistenceManager *)persistenceManager;
+
+@property (nonatomic, strong, readonly) LRTVDBPersistenceManager *persistenceManager;
+
+/** Context the zips are parsed with. The default context if nil. */
+@property (nonatomic, copy) LRTVDBParseContext *parseContext;
+
+/** YES by default. */
+@property (nonatomic) BOOL includeEpisodes;
+@property (nonatomic) BOOL includeImages;
+@property (nonatomic) BOOL includeActors;
+
+/**
+ Zips parsed concurrently and written together. Two batches of shows are in
+ memory at most. 64 by default.
+ */
+@property (nonatomic) NSUInteger batchSize;
+
+/**
+ Imports every show zip at the provided file URL, synchronously.
+ @param progressBlock Called after every batch is written, in order, from a
+ background queue. It can be nil.
+ @return The final progress of the import, nil (and the error) if the
+ source can't be read, a batch can't be written or the import is cancelled.
+ Batches written before the error remain in the persistence storage.
+ */
+- (LRTVDBBulkImportProgress *)importShowsAtURL:(NSURL *)url
+                                 progressBlock:(void (^)(LRTVDBBulkImportProgress *progress))progressBlock
+                                         error:(__autoreleasing NSError **)error;
+
+/**
+ Imports every show zip at the provided file URL asynchronously.
+ @discussion Both blocks are called on the main queue, the progress block
+ always before the completion block.
+ @see importShowsAtURL:progressBlock:error:
+ */
+- (void)importShowsAtURL:(NSURL *)url
+           progressBlock:(void (^)(LRTVDBBulkImportProgress *progress))progressBlock
+         completionBlock:(void (^)(LRTVDBBulkImportProgress *progress, NSError *error))completionBlock;
+
+/**
+ Stops the current import once the batch being written is done.
+ */
+- (void)cancel;
+
+@end
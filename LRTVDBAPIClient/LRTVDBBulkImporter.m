@@ -0,0 +1,353 @@
+// LRTVDBBulkImporter.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBArchiveParser.h"
+#import "LRTVDBBulkImporter.h"
+#import "LRTVDBParseContext.h"
+#import "LRTVDBPersistenceManager.h"
+#import "LRTVDBShow.h"
+#import "ZZArchive.h"
+#import "ZZArchiveEntry.h"
+#import <libkern/OSAtomic.h>
+
+static const NSUInteger kLRTVDBDefaultImportBatchSize = 64;
+
+static NSString *const kLRTVDBArchivePathExtension = @"zip";
+
+static BOOL LRTVDBIsArchiveFileName(NSString *fileName)
+{
+    return [[fileName pathExtension] caseInsensitiveCompare:kLRTVDBArchivePathExtension] == NSOrderedSame;
+}
+
+/**
+ @param source The file URL of a show zip or the entry of a show zip inside
+ another zip.
+ @return The data of the show zip. Files are memory mapped.
+ */
+static NSData *LRTVDBArchiveSourceData(id source)
+{
+    if ([source isKindOfClass:[NSURL class]])
+    {
+        return [NSData dataWithContentsOfURL:source options:NSDataReadingMappedIfSafe error:NULL];
+    }
+    
+    return [(ZZArchiveEntry *)source data];
+}
+
+@interface LRTVDBBulkImportProgress ()
+
+@property (nonatomic) NSUInteger totalNumberOfArchives;
+@property (nonatomic) NSUInteger numberOfImportedShows;
+@property (nonatomic) NSUInteger numberOfFailedArchives;
+@property (nonatomic) unsigned long long numberOfReadBytes;
+@property (nonatomic) NSTimeInterval elapsedTime;
+
+@end
+
+@implementation LRTVDBBulkImportProgress
+
+- (double)showsPerSecond
+{
+    return self.elapsedTime > 0 ? self.numberOfImportedShows / self.elapsedTime : 0;
+}
+
+- (double)bytesPerSecond
+{
+    return self.elapsedTime > 0 ? self.numberOfReadBytes / self.elapsedTime : 0;
+}
+
+- (double)fractionCompleted
+{
+    if (self.totalNumberOfArchives == 0) return 1;
+    
+    return (double)(self.numberOfImportedShows + self.numberOfFailedArchives) / self.totalNumberOfArchives;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p> %lu/%lu shows (%lu failed), %llu bytes in %.2fs: %.1f shows/s, %.1f KB/s",
+            NSStringFromClass([self class]), self,
+            (unsigned long)self.numberOfImportedShows,
+            (unsigned long)self.totalNumberOfArchives,
+            (unsigned long)self.numberOfFailedArchives,
+            self.numberOfReadBytes,
+            self.elapsedTime,
+            self.showsPerSecond,
+            self.bytesPerSecond / 1024];
+}
+
+@end
+
+@interface LRTVDBBulkImporter ()
+{
+    volatile int32_t _cancelled;
+}
+
+@property (nonatomic, strong) LRTVDBPersistenceManager *persistenceManager;
+
+@end
+
+@implementation LRTVDBBulkImporter
+
+- (id)initWithPersistenceManager:(LRTVDBPersistenceManager *)persistenceManager
+{
+    NSParameterAssert(persistenceManager);
+    
+    if (self = [super init])
+    {
+        _persistenceManager = persistenceManager;
+        _includeEpisodes = YES;
+        _includeImages = YES;
+        _includeActors = YES;
+        _batchSize = kLRTVDBDefaultImportBatchSize;
+    }
+    return self;
+}
+
+#pragma mark - Import
+
+- (LRTVDBBulkImportProgress *)importShowsAtURL:(NSURL *)url
+                                 progressBlock:(void (^)(LRTVDBBulkImportProgress *progress))progressBlock
+                                         error:(__autoreleasing NSError **)error
+{
+    NSParameterAssert(url);
+    
+    OSAtomicAnd32Barrier(0, (volatile uint32_t *)&_cancelled);
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSArray *sources = [self archiveSourcesAtURL:url error:error];
+    
+    if (!sources) return nil;
+    
+    // Parsers are immutable, so a single one is shared by every thread.
+    LRTVDBArchiveParser *parser = [LRTVDBArchiveParser parserWithContext:self.parseContext ? : [LRTVDBParseContext defaultContext]];
+    LRTVDBPersistenceManager *persistenceManager = self.persistenceManager;
+    BOOL includeEpisodes = self.includeEpisodes;
+    BOOL includeImages = self.includeImages;
+    BOOL includeActors = self.includeActors;
+    NSUInteger batchSize = MAX(self.batchSize, (NSUInteger)1);
+    NSUInteger numberOfSources = [sources count];
+    
+    LRTVDBBulkImportProgress *progress = [[LRTVDBBulkImportProgress alloc] init];
+    progress.totalNumberOfArchives = numberOfSources;
+    
+    // Batches are written in order while the next one is being parsed. The
+    // semaphore makes parsing wait for the write before the previous one.
+    dispatch_queue_t writeQueue = dispatch_queue_create("com.LRTVDBAPIClient.LRTVDBBulkImporterWriteQueue", DISPATCH_QUEUE_SERIAL);
+    dispatch_semaphore_t pendingWrite = dispatch_semaphore_create(1);
+    
+    __block NSError *importError = nil;
+    
+    for (NSUInteger location = 0; location < numberOfSources; location += batchSize)
+    {
+        @autoreleasepool
+        {
+            NSRange range = NSMakeRange(location, MIN(batchSize, numberOfSources - location));
+            
+            __strong LRTVDBShow **shows = (__strong LRTVDBShow **)calloc(range.length, sizeof(LRTVDBShow *));
+            __block volatile int64_t numberOfReadBytes = 0;
+            
+            dispatch_apply(range.length, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+                @autoreleasepool
+                {
+                    NSData *data = LRTVDBArchiveSourceData(sources[range.location + i]);
+                    
+                    OSAtomicAdd64Barrier((int64_t)[data length], &numberOfReadBytes);
+                    
+                    LRTVDBShow *show = [parser showFromData:data
+                                            includeEpisodes:includeEpisodes
+                                              includeImages:includeImages
+                                              includeActors:includeActors
+                                             replaceArtwork:YES
+                                                currentShow:nil];
+                    
+                    shows[i] = show.showID ? show : nil;
+                }
+            });
+            
+            NSMutableArray *batch = [NSMutableArray arrayWithCapacity:range.length];
+            
+            for (NSUInteger i = 0; i < range.length; i++)
+            {
+                if (shows[i]) [batch addObject:shows[i]];
+                
+                shows[i] = nil;
+            }
+            
+            free(shows);
+            
+            NSUInteger numberOfFailedArchives = range.length - [batch count];
+            unsigned long long batchBytes = (unsigned long long)numberOfReadBytes;
+            
+            dispatch_semaphore_wait(pendingWrite, DISPATCH_TIME_FOREVER);
+            
+            // The semaphore orders this read after the previous write.
+            if (importError || _cancelled)
+            {
+                dispatch_semaphore_signal(pendingWrite);
+                break;
+            }
+            
+            dispatch_async(writeQueue, ^{
+                @autoreleasepool
+                {
+                    NSError *writeError = nil;
+                    
+                    if ([persistenceManager journalAddedShows:batch error:&writeError])
+                    {
+                        [persistenceManager synchronizeJournal];
+                        
+                        progress.numberOfImportedShows += [batch count];
+                        progress.numberOfFailedArchives += numberOfFailedArchives;
+                        progress.numberOfReadBytes += batchBytes;
+                        progress.elapsedTime = CFAbsoluteTimeGetCurrent() - startTime;
+                        
+                        if (progressBlock) progressBlock([self snapshotOfProgress:progress]);
+                    }
+                    else
+                    {
+                        importError = writeError;
+                    }
+                }
+                
+                dispatch_semaphore_signal(pendingWrite);
+            });
+        }
+    }
+    
+    dispatch_sync(writeQueue, ^{});
+    
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(writeQueue);
+    dispatch_release(pendingWrite);
+#endif
+    
+    if (!importError && _cancelled)
+    {
+        importError = [NSError errorWithDomain:kBulkImportErrorDomain code:kBulkImportCancelledError userInfo:nil];
+    }
+    
+    if (importError)
+    {
+        if (error) *error = importError;
+        
+        return nil;
+    }
+    
+    progress.elapsedTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    return progress;
+}
+
+- (void)importShowsAtURL:(NSURL *)url
+           progressBlock:(void (^)(LRTVDBBulkImportProgress *progress))progressBlock
+         completionBlock:(void (^)(LRTVDBBulkImportProgress *progress, NSError *error))completionBlock
+{
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        
+        NSError *error = nil;
+        
+        // The main queue is serial, so progress is delivered in order.
+        LRTVDBBulkImportProgress *progress = [self importShowsAtURL:url progressBlock:progressBlock ? ^(LRTVDBBulkImportProgress *batchProgress) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                progressBlock(batchProgress);
+            });
+        } : nil error:&error];
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (completionBlock) completionBlock(progress, error);
+        });
+    });
+}
+
+- (void)cancel
+{
+    OSAtomicOr32Barrier(1, (volatile uint32_t *)&_cancelled);
+}
+
+#pragma mark - Private
+
+/**
+ @return The file URLs of the show zips in a directory, the entries of the
+ show zips inside a zip, or the file URL itself if it's a show zip. nil if
+ there's nothing to import at the URL.
+ */
+- (NSArray *)archiveSourcesAtURL:(NSURL *)url error:(__autoreleasing NSError **)error
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSArray *sources = nil;
+    BOOL isDirectory = NO;
+    
+    if ([fileManager fileExistsAtPath:[url path] isDirectory:&isDirectory] && isDirectory)
+    {
+        NSArray *fileURLs = [fileManager contentsOfDirectoryAtURL:url
+                                       includingPropertiesForKeys:nil
+                                                          options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                            error:error];
+        
+        if (!fileURLs) return nil;
+        
+        sources = [[fileURLs filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSURL *fileURL, NSDictionary *bindings) {
+            return LRTVDBIsArchiveFileName([fileURL lastPathComponent]);
+        }]] sortedArrayUsingComparator:^NSComparisonResult(NSURL *firstURL, NSURL *secondURL) {
+            return [[firstURL lastPathComponent] compare:[secondURL lastPathComponent] options:NSNumericSearch];
+        }];
+    }
+    else
+    {
+        ZZArchive *archive = [ZZArchive archiveWithContentsOfURL:url];
+        
+        if ([archive.entries count] > 0)
+        {
+            sources = [archive.entries filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(ZZArchiveEntry *entry, NSDictionary *bindings) {
+                return LRTVDBIsArchiveFileName(entry.fileName);
+            }]];
+            
+            // Not a dump, but a single show zip.
+            if ([sources count] == 0) sources = @[url];
+        }
+    }
+    
+    if (!sources)
+    {
+        if (error) *error = [NSError errorWithDomain:kBulkImportErrorDomain
+                                                code:kBulkImportUnreadableSourceError
+                                            userInfo:@{ NSURLErrorKey: url }];
+    }
+    
+    return sources;
+}
+
+- (LRTVDBBulkImportProgress *)snapshotOfProgress:(LRTVDBBulkImportProgress *)progress
+{
+    LRTVDBBulkImportProgress *snapshot = [[LRTVDBBulkImportProgress alloc] init];
+    snapshot.totalNumberOfArchives = progress.totalNumberOfArchives;
+    snapshot.numberOfImportedShows = progress.numberOfImportedShows;
+    snapshot.numberOfFailedArchives = progress.numberOfFailedArchives;
+    snapshot.numberOfReadBytes = progress.numberOfReadBytes;
+    snapshot.elapsedTime = progress.elapsedTime;
+    
+    return snapshot;
+}
+
+@end
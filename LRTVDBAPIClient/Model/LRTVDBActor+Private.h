@@ -32,7 +32,13 @@
 
 /**
  Updates an actor.
+ @return YES if any of its values has changed.
  */
-- (void)updateWithActor:(LRTVDBActor *)updatedActor;
+- (BOOL)updateWithActor:(LRTVDBActor *)updatedActor;
+
+/**
+ @return Estimated heap bytes used by the actor (see LRTVDBShow memoryUsage).
+ */
+- (size_t)memorySize;
 
 @end
@@ -21,6 +21,8 @@
 // THE SOFTWARE.
 
 #import "LRTVDBActor.h"
+#import "LRTVDBBinaryCodec.h"
+#import "LRTVDBAPIClient+Private.h"
 
 // Persistence keys
 static NSString *const kActorIDKey = @"kActorIDKey";
@@ -29,6 +31,14 @@ static NSString *const kActorRoleKey = @"kActorRoleKey";
 static NSString *const kActorImageURLKey = @"kActorImageURLKey";
 static NSString *const kActorSortOrderKey = @"kActorSortOrderKey";
 
+// Binary codec tags
+static const NSUInteger kActorBinarySchemaVersion = 2;
+static const LRTVDBBinaryTag kActorIDTag = 1;
+static const LRTVDBBinaryTag kActorNameTag = 2;
+static const LRTVDBBinaryTag kActorRoleTag = 3;
+static const LRTVDBBinaryTag kActorImageURLTag = 4;
+static const LRTVDBBinaryTag kActorSortOrderTag = 5;
+
 NSComparator LRTVDBActorComparator = ^NSComparisonResult(LRTVDBActor *firstActor, LRTVDBActor *secondActor)
 {
     NSNumber *firstActorSortOrder = firstActor.sortOrder ? : @(NSIntegerMax);
@@ -51,17 +61,35 @@ NSComparator LRTVDBActorComparator = ^NSComparisonResult(LRTVDBActor *firstActor
 
 #pragma mark - Update actor
 
-- (void)updateWithActor:(LRTVDBActor *)updatedActor;
+- (BOOL)updateWithActor:(LRTVDBActor *)updatedActor;
 {
-    if (updatedActor == nil) return;
+    if (updatedActor == nil) return NO;
     
     NSAssert([self isEqual:updatedActor], @"Trying to update actor with one with different ID?");
     
-    self.actorID = updatedActor.actorID;
-    self.name = updatedActor.name;
-    self.role = updatedActor.role;
-    self.imageURL = updatedActor.imageURL;
-    self.sortOrder = updatedActor.sortOrder;
+    BOOL hasChanged = (LRTVDBValuesDiffer(self.name, updatedActor.name) ||
+                       LRTVDBValuesDiffer(self.role, updatedActor.role) ||
+                       LRTVDBValuesDiffer(self.imageURL, updatedActor.imageURL) ||
+                       LRTVDBValuesDiffer(self.sortOrder, updatedActor.sortOrder));
+    
+    if (hasChanged)
+    {
+        self.actorID = updatedActor.actorID;
+        self.name = updatedActor.name;
+        self.role = updatedActor.role;
+        self.imageURL = updatedActor.imageURL;
+        self.sortOrder = updatedActor.sortOrder;
+    }
+    
+    return hasChanged;
+}
+
+#pragma mark - Memory size
+
+- (size_t)memorySize
+{
+    return (LRTVDBMallocSize(self) + LRTVDBMallocSize(self.actorID) + LRTVDBMallocSize(self.name) +
+            LRTVDBMallocSize(self.role) + LRTVDBMallocSizeOfURL(self.imageURL) + LRTVDBMallocSize(self.sortOrder));
 }
 
 #pragma mark - LRTVDBSerializableModelProtocol
@@ -85,7 +113,7 @@ NSComparator LRTVDBActorComparator = ^NSComparisonResult(LRTVDBActor *firstActor
     
     id imageURL = LREmptyStringToNil(dictionary[kActorImageURLKey]);
     CHECK_TYPE(imageURL, [NSString class], @"imageURL", *error);
-    actor.imageURL = [NSURL URLWithString:imageURL];
+    actor.imageURL = LRTVDBImageURLForPath(imageURL);
 
     id sortOrder = LREmptyStringToNil(dictionary[kActorSortOrderKey]);
     CHECK_TYPE(sortOrder, [NSNumber class], @"sortOrder", *error);
@@ -99,11 +127,63 @@ NSComparator LRTVDBActorComparator = ^NSComparisonResult(LRTVDBActor *firstActor
     return @{ kActorIDKey : LRNilToEmptyString(self.actorID),
               kActorNameKey : LRNilToEmptyString(self.name),
               kActorRoleKey : LRNilToEmptyString(self.role),
-              kActorImageURLKey : LRNilToEmptyString([self.imageURL absoluteString]),
+              kActorImageURLKey : LRNilToEmptyString(LRTVDBImagePathForURL(self.imageURL)),
               kActorSortOrderKey : LRNilToEmptyString(self.sortOrder)
             };
 }
 
++ (NSUInteger)binarySchemaVersion
+{
+    return kActorBinarySchemaVersion;
+}
+
++ (LRTVDBActor *)decodeWithDecoder:(LRTVDBBinaryDecoder *)decoder
+{
+    LRTVDBActor *actor = [[LRTVDBActor alloc] init];
+    
+    LRTVDBBinaryTag tag;
+    
+    while ([decoder decodeNextFieldTag:&tag])
+    {
+        switch (tag)
+        {
+            case kActorIDTag:
+                actor.actorID = [decoder decodeString];
+                break;
+            case kActorNameTag:
+                actor.name = [decoder decodeString];
+                break;
+            case kActorRoleTag:
+                actor.role = [decoder decodeString];
+                break;
+            case kActorImageURLTag:
+                actor.imageURL = LRTVDBImageURLForDecodedString([decoder decodeString], decoder.recordSchemaVersion);
+                break;
+            case kActorSortOrderTag:
+                actor.sortOrder = @([decoder decodeInteger]);
+                break;
+            default:
+                [decoder skipField];
+                break;
+        }
+    }
+    
+    return actor.actorID ? actor : nil;
+}
+
+- (void)encodeWithEncoder:(LRTVDBBinaryEncoder *)encoder
+{
+    [encoder encodeString:self.actorID forTag:kActorIDTag];
+    [encoder encodeString:self.name forTag:kActorNameTag];
+    [encoder encodeString:self.role forTag:kActorRoleTag];
+    [encoder encodeString:LRTVDBImagePathForURL(self.imageURL) forTag:kActorImageURLTag];
+    
+    if (self.sortOrder)
+    {
+        [encoder encodeInteger:[self.sortOrder longLongValue] forTag:kActorSortOrderTag];
+    }
+}
+
 #pragma mark - Equality methods
 
 - (BOOL)isEqual:(id)object
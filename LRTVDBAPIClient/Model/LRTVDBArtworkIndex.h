@@ -0,0 +1,77 @@
+// LRTVDBArtworkIndex.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "LRTVDBImage.h"
+
+/**
+ Immutable index over the sorted images of a show.
+ @discussion Images sorted by LRTVDBImageComparator have every type in a
+ contiguous range, already sorted by rating and rating count, so the best
+ images of a type are just the first ones of its range. Season images are
+ grouped by season the first time they're asked for.
+ @remarks Thread safe.
+ */
+@interface LRTVDBArtworkIndex : NSObject
+
+/**
+ Creates the index from scratch.
+ @param images Array of LRTVDBImage instances sorted by LRTVDBImageComparator.
+ */
+- (id)initWithImages:(NSArray *)images;
+
+/**
+ Creates a new index after a merge which has only inserted and removed images.
+ @param images The merged images.
+ @param insertedIndexes Indexes of the new images in the merged images.
+ @param removedImages Images of the receiver no longer in the merged images.
+ @remarks O(m), being m the number of inserted and removed images.
+ */
+- (LRTVDBArtworkIndex *)indexWithImages:(NSArray *)images
+                        insertedIndexes:(NSIndexSet *)insertedIndexes
+                          removedImages:(NSArray *)removedImages;
+
+/** Indexed images. */
+@property (nonatomic, copy, readonly) NSArray *images;
+
+/**
+ @return Every image of the type, best ones first.
+ */
+- (NSArray *)imagesOfType:(LRTVDBImageType)type;
+
+/**
+ @return The best images of the type, at most count of them. O(count).
+ */
+- (NSArray *)bestImagesOfType:(LRTVDBImageType)type count:(NSUInteger)count;
+
+/**
+ @return The best image of the type, nil if none. O(1).
+ */
+- (LRTVDBImage *)bestImageOfType:(LRTVDBImageType)type;
+
+/**
+ @return The season images of the season, best ones first. O(1) once every
+ season image has been grouped.
+ */
+- (NSArray *)imagesForSeason:(NSNumber *)seasonNumber;
+
+@end
@@ -0,0 +1,196 @@
+// LRTVDBArtworkIndex.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBArtworkIndex.h"
+#import <libkern/OSAtomic.h>
+
+// Image types in LRTVDBImageComparator order, unknown image types at the end.
+static const LRTVDBImageType kLRTVDBSortedImageTypes[] = {
+    LRTVDBImageTypeFanart,
+    LRTVDBImageTypePoster,
+    LRTVDBImageTypeSeason,
+    LRTVDBImageTypeBanner,
+    LRTVDBImageTypeUnknown,
+};
+
+#define kLRTVDBNumberOfImageTypes (sizeof(kLRTVDBSortedImageTypes) / sizeof(LRTVDBImageType))
+
+NS_INLINE NSUInteger LRTVDBImageTypeSlot(LRTVDBImageType type)
+{
+    // Types coming from old persisted images may be out of range.
+    return (type > LRTVDBImageTypeUnknown && type <= LRTVDBImageTypeBanner) ? (NSUInteger)type : LRTVDBImageTypeUnknown;
+}
+
+@interface LRTVDBArtworkIndex ()
+{
+    // Number of images and range of every type, indexed by LRTVDBImageTypeSlot.
+    NSUInteger _counts[kLRTVDBNumberOfImageTypes];
+    NSRange _ranges[kLRTVDBNumberOfImageTypes];
+    
+    NSArray *_imagesOfTypeCache[kLRTVDBNumberOfImageTypes];
+    NSDictionary *_seasonImages;
+    OSSpinLock _cacheLock;
+}
+
+@property (nonatomic, copy) NSArray *images;
+
+@end
+
+@implementation LRTVDBArtworkIndex
+
+- (id)initWithImages:(NSArray *)images
+{
+    NSUInteger counts[kLRTVDBNumberOfImageTypes] = {0};
+    
+    for (LRTVDBImage *image in images)
+    {
+        counts[LRTVDBImageTypeSlot(image.type)]++;
+    }
+    
+    return [self initWithImages:images counts:counts];
+}
+
+/**
+ Designated initializer.
+ @param counts Number of images of every type, indexed by LRTVDBImageTypeSlot.
+ */
+- (id)initWithImages:(NSArray *)images counts:(const NSUInteger *)counts
+{
+    if (self = [super init])
+    {
+        _images = [images copy];
+        _cacheLock = OS_SPINLOCK_INIT;
+        
+        NSUInteger location = 0;
+        
+        for (NSUInteger i = 0; i < kLRTVDBNumberOfImageTypes; i++)
+        {
+            NSUInteger slot = LRTVDBImageTypeSlot(kLRTVDBSortedImageTypes[i]);
+            
+            _counts[slot] = counts[slot];
+            _ranges[slot] = NSMakeRange(location, counts[slot]);
+            location += counts[slot];
+        }
+        
+        NSAssert(location == [_images count], @"Image counts don't match the images");
+    }
+    return self;
+}
+
+#pragma mark - Incremental update
+
+- (LRTVDBArtworkIndex *)indexWithImages:(NSArray *)images
+                        insertedIndexes:(NSIndexSet *)insertedIndexes
+                          removedImages:(NSArray *)removedImages
+{
+    NSUInteger counts[kLRTVDBNumberOfImageTypes];
+    memcpy(counts, _counts, sizeof(counts));
+    
+    for (LRTVDBImage *image in removedImages)
+    {
+        counts[LRTVDBImageTypeSlot(image.type)]--;
+    }
+    
+    for (NSUInteger index = [insertedIndexes firstIndex]; index != NSNotFound; index = [insertedIndexes indexGreaterThanIndex:index])
+    {
+        counts[LRTVDBImageTypeSlot([(LRTVDBImage *)images[index] type])]++;
+    }
+    
+    return [[LRTVDBArtworkIndex alloc] initWithImages:images counts:counts];
+}
+
+#pragma mark - Queries
+
+- (NSArray *)imagesOfType:(LRTVDBImageType)type
+{
+    NSUInteger slot = LRTVDBImageTypeSlot(type);
+    
+    OSSpinLockLock(&_cacheLock);
+    NSArray *imagesOfType = _imagesOfTypeCache[slot];
+    OSSpinLockUnlock(&_cacheLock);
+    
+    if (imagesOfType) return imagesOfType;
+    
+    imagesOfType = [_images subarrayWithRange:_ranges[slot]];
+    
+    OSSpinLockLock(&_cacheLock);
+    _imagesOfTypeCache[slot] = imagesOfType;
+    OSSpinLockUnlock(&_cacheLock);
+    
+    return imagesOfType;
+}
+
+- (NSArray *)bestImagesOfType:(LRTVDBImageType)type count:(NSUInteger)count
+{
+    NSRange range = _ranges[LRTVDBImageTypeSlot(type)];
+    
+    if (count >= range.length) return [self imagesOfType:type];
+    
+    return [_images subarrayWithRange:NSMakeRange(range.location, count)];
+}
+
+- (LRTVDBImage *)bestImageOfType:(LRTVDBImageType)type
+{
+    NSRange range = _ranges[LRTVDBImageTypeSlot(type)];
+    
+    return range.length > 0 ? _images[range.location] : nil;
+}
+
+- (NSArray *)imagesForSeason:(NSNumber *)seasonNumber
+{
+    if (seasonNumber == nil) return nil;
+    
+    OSSpinLockLock(&_cacheLock);
+    NSDictionary *seasonImages = _seasonImages;
+    OSSpinLockUnlock(&_cacheLock);
+    
+    if (seasonImages == nil)
+    {
+        NSMutableDictionary *mutableSeasonImages = [NSMutableDictionary dictionary];
+        
+        // Season images are already sorted, so every season keeps the order.
+        for (LRTVDBImage *image in [self imagesOfType:LRTVDBImageTypeSeason])
+        {
+            if (image.seasonNumber == nil) continue;
+            
+            NSMutableArray *images = mutableSeasonImages[image.seasonNumber];
+            
+            if (images == nil)
+            {
+                images = [NSMutableArray array];
+                mutableSeasonImages[image.seasonNumber] = images;
+            }
+            
+            [images addObject:image];
+        }
+        
+        seasonImages = [mutableSeasonImages copy];
+        
+        OSSpinLockLock(&_cacheLock);
+        _seasonImages = seasonImages;
+        OSSpinLockUnlock(&_cacheLock);
+    }
+    
+    return seasonImages[seasonNumber];
+}
+
+@end
@@ -21,6 +21,29 @@
 // THE SOFTWARE.
 
 #import "LRTVDBEpisode.h"
+#import "NSDate+LRTVDBAdditions.h"
+
+/**
+ Location of the heavy text fields of an episode inside a text buffer.
+ @remarks Fields that are not present have a NSNotFound location.
+ */
+typedef struct
+{
+    NSRange overview;
+    NSRange directors;
+    NSRange writers;
+    NSRange guestStars;
+} LRTVDBEpisodeTextRanges;
+
+/**
+ @return Text ranges with every field not present.
+ */
+NS_INLINE LRTVDBEpisodeTextRanges LRTVDBEpisodeEmptyTextRanges(void)
+{
+    NSRange notFoundRange = NSMakeRange(NSNotFound, 0);
+    
+    return (LRTVDBEpisodeTextRanges){notFoundRange, notFoundRange, notFoundRange, notFoundRange};
+}
 
 @interface LRTVDBEpisode (Private)
 
@@ -40,15 +63,59 @@
 @property (nonatomic, strong) NSURL *imageURL;
 @property (nonatomic, strong) NSDate *airedDate;
 
+/**
+ Scalar values backing episodeNumber, seasonNumber and rating.
+ @remarks NSIntegerMax (or NAN for the rating) if the value is unknown.
+ */
+@property (nonatomic) NSInteger episodeNumberValue;
+@property (nonatomic) NSInteger seasonNumberValue;
+@property (nonatomic) double ratingValue;
+
+/**
+ Day in which the episode was aired. airedDate is derived from it.
+ @remarks LRTVDBUnknownDayNumber if the episode has no aired date.
+ */
+@property (nonatomic) LRTVDBDayNumber airedDayNumber;
+
+/**
+ Position of the episode in the episodes of its show.
+ */
+@property (nonatomic) NSUInteger indexInShow;
+
 /**
  Some episodes coming from theTVDB are not correct. They have no name, season
  number or episode number and it's really not worth showing them.
  */
 @property (nonatomic, readonly, getter = isCorrect) BOOL correct;
 
+/**
+ Defers the decoding of overview, directors, writers and guest stars.
+ @param buffer Immutable buffer with the raw (still HTML escaped) UTF-8 text
+ of the fields, usually shared by every episode of the same response.
+ @param ranges Location of each field inside the buffer.
+ @discussion The fields are decoded on first access of any of them and the
+ reference to the buffer is dropped afterwards. Decoding is thread safe.
+ */
+- (void)setTextFieldsBuffer:(NSData *)buffer ranges:(LRTVDBEpisodeTextRanges)ranges;
+
 /**
  Updates an episode.
+ @return YES if any of its values has changed.
+ */
+- (BOOL)updateWithEpisode:(LRTVDBEpisode *)updatedEpisode;
+
+/**
+ Deserializes an episode of a known show.
+ @param showID ID of the show owning the episode. Episodes persisted without
+ one (e.g. episodes added to a show by hand) take it instead of being dropped.
+ @see deserialize:error:
+ */
++ (LRTVDBEpisode *)deserialize:(NSDictionary *)dictionary showID:(NSString *)showID error:(NSError **)error;
+
+/**
+ @return Estimated heap bytes used by the episode (see LRTVDBShow memoryUsage).
+ Heavy text fields not decoded yet count as their length in the buffer.
  */
-- (void)updateWithEpisode:(LRTVDBEpisode *)updatedEpisode;
+- (size_t)memorySize;
 
 @end
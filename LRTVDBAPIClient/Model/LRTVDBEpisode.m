@@ -20,9 +20,15 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
-#import "LRTVDBEpisode.h"
+#import "LRTVDBEpisode+Private.h"
 #import "LRTVDBShow+Private.h"
 #import "NSDate+LRTVDBAdditions.h"
+#import "LRTVDBStringInterner.h"
+#import "NSArray+LRTVDBAdditions.h"
+#import "NSString+LRTVDBAdditions.h"
+#import "LRTVDBBinaryCodec.h"
+#import "LRTVDBAPIClient+Private.h"
+#import <libkern/OSAtomic.h>
 
 // Persistence keys
 static NSString *const kEpisodeIDKey = @"kEpisodeIDKey";
@@ -42,6 +48,25 @@ static NSString *const kEpisodeLanguageKey = @"kEpisodeLanguageKey";
 static NSString *const kEpisodeShowIDKey = @"kEpisodeShowIDKey";
 static NSString *const kEpisodeSeenKey = @"kEpisodeSeenKey";
 
+// Binary codec tags
+static const NSUInteger kEpisodeBinarySchemaVersion = 2;
+static const LRTVDBBinaryTag kEpisodeIDTag = 1;
+static const LRTVDBBinaryTag kEpisodeTitleTag = 2;
+static const LRTVDBBinaryTag kEpisodeOverviewTag = 3;
+static const LRTVDBBinaryTag kEpisodeImageURLTag = 4;
+static const LRTVDBBinaryTag kEpisodeAiredDayNumberTag = 5;
+static const LRTVDBBinaryTag kEpisodeImdbIDTag = 6;
+static const LRTVDBBinaryTag kEpisodeDirectorsTag = 7;
+static const LRTVDBBinaryTag kEpisodeWritersTag = 8;
+static const LRTVDBBinaryTag kEpisodeGuestStarsTag = 9;
+static const LRTVDBBinaryTag kEpisodeSeasonNumberTag = 10;
+static const LRTVDBBinaryTag kEpisodeNumberTag = 11;
+static const LRTVDBBinaryTag kEpisodeRatingTag = 12;
+static const LRTVDBBinaryTag kEpisodeRatingCountTag = 13;
+static const LRTVDBBinaryTag kEpisodeLanguageTag = 14;
+static const LRTVDBBinaryTag kEpisodeShowIDTag = 15;
+static const LRTVDBBinaryTag kEpisodeSeenTag = 16;
+
 const struct LRTVDBEpisodeAttributes LRTVDBEpisodeAttributes = {
     .seen = @"seen",
 };
@@ -52,23 +77,38 @@ NSComparator LRTVDBEpisodeComparator = ^NSComparisonResult(LRTVDBEpisode *firstE
     // episodes that are yet to be aired are more likely to have season and
     // episode numbers rather than aired date...
     
-    NSNumber *firstEpisodeSeasonNumber = firstEpisode.seasonNumber ? : @(NSIntegerMax);
-    NSNumber *secondEpisodeSeasonNumber = secondEpisode.seasonNumber ? : @(NSIntegerMax);
+    // Missing season and episode numbers are NSIntegerMax, so they go last.
+    NSInteger firstEpisodeSeasonNumber = firstEpisode.seasonNumberValue;
+    NSInteger secondEpisodeSeasonNumber = secondEpisode.seasonNumberValue;
+    
+    if (firstEpisodeSeasonNumber != secondEpisodeSeasonNumber)
+    {
+        return firstEpisodeSeasonNumber < secondEpisodeSeasonNumber ? NSOrderedAscending : NSOrderedDescending;
+    }
     
-    NSComparisonResult comparisonResult = [firstEpisodeSeasonNumber compare:secondEpisodeSeasonNumber];
+    NSInteger firstEpisodeEpisodeNumber = firstEpisode.episodeNumberValue;
+    NSInteger secondEpisodeEpisodeNumber = secondEpisode.episodeNumberValue;
     
-    if (comparisonResult == NSOrderedSame)
+    if (firstEpisodeEpisodeNumber != secondEpisodeEpisodeNumber)
     {
-        NSNumber *firstEpisodeEpisodeNumber = firstEpisode.episodeNumber ? : @(NSIntegerMax);
-        NSNumber *secondEpisodeEpisodeNumber = secondEpisode.episodeNumber ? : @(NSIntegerMax);
-        
-        comparisonResult = [firstEpisodeEpisodeNumber compare:secondEpisodeEpisodeNumber];
+        return firstEpisodeEpisodeNumber < secondEpisodeEpisodeNumber ? NSOrderedAscending : NSOrderedDescending;
     }
     
-    return comparisonResult;
+    return NSOrderedSame;
 };
 
 @interface LRTVDBEpisode ()
+{
+    // Heavy text fields pending to be decoded.
+    volatile BOOL _hasPendingTextFields;
+    NSData *_textFieldsBuffer;
+    LRTVDBEpisodeTextRanges _textFieldsRanges;
+    
+    NSString *_overview;
+    NSArray *_writers;
+    NSArray *_directors;
+    NSArray *_guestStars;
+}
 
 @property (nonatomic, copy) NSString *title;
 @property (nonatomic, copy) NSString *overview;
@@ -83,14 +123,30 @@ NSComparator LRTVDBEpisodeComparator = ^NSComparisonResult(LRTVDBEpisode *firstE
 @property (nonatomic, strong) NSNumber *seasonNumber;
 @property (nonatomic, strong) NSNumber *rating;
 @property (nonatomic, strong) NSNumber *ratingCount;
+@property (nonatomic) NSInteger episodeNumberValue;
+@property (nonatomic) NSInteger seasonNumberValue;
+@property (nonatomic) double ratingValue;
 @property (nonatomic, strong) NSURL *imageURL;
 @property (nonatomic, strong) NSDate *airedDate;
-@property (nonatomic, strong) NSNumber *numberOfDaysToAir;
+@property (nonatomic) LRTVDBDayNumber airedDayNumber;
+@property (nonatomic) NSUInteger indexInShow;
 
 @end
 
 @implementation LRTVDBEpisode
 
+- (id)init
+{
+    if (self = [super init])
+    {
+        _airedDayNumber = LRTVDBUnknownDayNumber;
+        _episodeNumberValue = NSIntegerMax;
+        _seasonNumberValue = NSIntegerMax;
+        _ratingValue = NAN;
+    }
+    return self;
+}
+
 - (void)setSeen:(BOOL)seen
 {
     if (_seen != seen)
@@ -101,49 +157,308 @@ NSComparator LRTVDBEpisodeComparator = ^NSComparisonResult(LRTVDBEpisode *firstE
     }
 }
 
+#pragma mark - Numeric values
+
+// Season number, episode number and rating are stored as scalars, so that
+// sorting and indexing episodes doesn't need to unbox anything. They're
+// only boxed when asked for.
+
+- (NSNumber *)episodeNumber
+{
+    return _episodeNumberValue != NSIntegerMax ? @(_episodeNumberValue) : nil;
+}
+
+- (void)setEpisodeNumber:(NSNumber *)episodeNumber
+{
+    _episodeNumberValue = episodeNumber ? [episodeNumber integerValue] : NSIntegerMax;
+}
+
+- (NSNumber *)seasonNumber
+{
+    return _seasonNumberValue != NSIntegerMax ? @(_seasonNumberValue) : nil;
+}
+
+- (void)setSeasonNumber:(NSNumber *)seasonNumber
+{
+    _seasonNumberValue = seasonNumber ? [seasonNumber integerValue] : NSIntegerMax;
+}
+
+- (NSNumber *)rating
+{
+    return !isnan(_ratingValue) ? @(_ratingValue) : nil;
+}
+
+- (void)setRating:(NSNumber *)rating
+{
+    _ratingValue = LRTVDBRatingValue(rating);
+}
+
++ (NSSet *)keyPathsForValuesAffectingEpisodeNumber
+{
+    return [NSSet setWithObject:@"episodeNumberValue"];
+}
+
++ (NSSet *)keyPathsForValuesAffectingSeasonNumber
+{
+    return [NSSet setWithObject:@"seasonNumberValue"];
+}
+
++ (NSSet *)keyPathsForValuesAffectingRating
+{
+    return [NSSet setWithObject:@"ratingValue"];
+}
+
+#pragma mark - Aired date
+
+// The aired day number is what is actually stored. Dates are only built
+// when asked for and they come from a cache shared by every episode.
+
+- (NSDate *)airedDate
+{
+    return [NSDate lr_dateWithDayNumber:_airedDayNumber];
+}
+
 - (void)setAiredDate:(NSDate *)airedDate
 {
-    if (_airedDate != airedDate)
+    self.airedDayNumber = airedDate ? [airedDate lr_dayNumber] : LRTVDBUnknownDayNumber;
+}
+
++ (NSSet *)keyPathsForValuesAffectingAiredDate
+{
+    return [NSSet setWithObject:@"airedDayNumber"];
+}
+
+// Days to air are not stored, they'd go stale as soon as the day rolls over.
+// Computing them is just a subtraction against today's day number.
+
+- (NSInteger)numberOfDaysToAir
+{
+    if (_airedDayNumber == LRTVDBUnknownDayNumber) return NSIntegerMax;
+    
+    return _airedDayNumber - LRTVDBTodayDayNumber();
+}
+
+#pragma mark - Heavy text fields
+
+static NSString *LRTVDBStringFromBuffer(NSData *buffer, NSRange range)
+{
+    if (range.location == NSNotFound || range.length == 0) return nil;
+    
+    return [[NSString alloc] initWithBytes:(const char *)[buffer bytes] + range.location
+                                    length:range.length
+                                  encoding:NSUTF8StringEncoding];
+}
+
+static NSArray *LRTVDBPipedArrayFromBuffer(NSData *buffer, NSRange range)
+{
+    NSArray *array = [[LRTVDBStringFromBuffer(buffer, range) pipedStringToArray] lr_arrayByRemovingDuplicates];
+    
+    return [[LRTVDBStringInterner sharedInterner] internStringsInArray:array];
+}
+
+- (void)setTextFieldsBuffer:(NSData *)buffer ranges:(LRTVDBEpisodeTextRanges)ranges
+{
+    @synchronized(self)
     {
-        _airedDate = airedDate;
+        _textFieldsBuffer = buffer;
+        _textFieldsRanges = ranges;
         
-        self.numberOfDaysToAir = [self daysToEpisode];
+        _overview = nil;
+        _directors = nil;
+        _writers = nil;
+        _guestStars = nil;
+        
+        OSMemoryBarrier();
+        _hasPendingTextFields = buffer != nil;
     }
 }
 
-- (NSNumber *)daysToEpisode
+- (void)decodeTextFieldsIfNeeded
+{
+    if (!_hasPendingTextFields)
+    {
+        // Pairs with the barrier in the writer, so that decoded fields are visible.
+        OSMemoryBarrier();
+        return;
+    }
+    
+    @synchronized(self)
+    {
+        if (!_hasPendingTextFields) return;
+        
+        // Same transformations as the ones in LRTVDBEpisodeParser.
+        _overview = [LRTVDBStringFromBuffer(_textFieldsBuffer, _textFieldsRanges.overview) unescapeHTMLEntities];
+        _directors = LRTVDBPipedArrayFromBuffer(_textFieldsBuffer, _textFieldsRanges.directors);
+        _writers = LRTVDBPipedArrayFromBuffer(_textFieldsBuffer, _textFieldsRanges.writers);
+        _guestStars = LRTVDBPipedArrayFromBuffer(_textFieldsBuffer, _textFieldsRanges.guestStars);
+        
+        _textFieldsBuffer = nil;
+        
+        OSMemoryBarrier();
+        _hasPendingTextFields = NO;
+    }
+}
+
+- (NSString *)overview
+{
+    [self decodeTextFieldsIfNeeded];
+    return _overview;
+}
+
+- (NSArray *)directors
+{
+    [self decodeTextFieldsIfNeeded];
+    return _directors;
+}
+
+- (NSArray *)writers
 {
-    if (_airedDate == nil) return @(NSIntegerMax);
+    [self decodeTextFieldsIfNeeded];
+    return _writers;
+}
+
+- (NSArray *)guestStars
+{
+    [self decodeTextFieldsIfNeeded];
+    return _guestStars;
+}
+
+- (void)setOverview:(NSString *)overview
+{
+    [self decodeTextFieldsIfNeeded];
+    _overview = [overview copy];
+}
+
+- (void)setDirectors:(NSArray *)directors
+{
+    [self decodeTextFieldsIfNeeded];
+    _directors = [directors copy];
+}
+
+- (void)setWriters:(NSArray *)writers
+{
+    [self decodeTextFieldsIfNeeded];
+    _writers = [writers copy];
+}
+
+- (void)setGuestStars:(NSArray *)guestStars
+{
+    [self decodeTextFieldsIfNeeded];
+    _guestStars = [guestStars copy];
+}
+
+static BOOL LRTVDBBufferRangesAreEqual(NSData *buffer, NSRange range, NSData *otherBuffer, NSRange otherRange)
+{
+    NSUInteger length = range.location == NSNotFound ? 0 : range.length;
+    NSUInteger otherLength = otherRange.location == NSNotFound ? 0 : otherRange.length;
+    
+    if (length != otherLength) return NO;
     
-    static NSCalendar *calendar = nil;
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        calendar = [NSCalendar currentCalendar];
-    });
+    return length == 0 || memcmp((const char *)[buffer bytes] + range.location,
+                                 (const char *)[otherBuffer bytes] + otherRange.location, length) == 0;
+}
+
+/**
+ Takes the text fields from the updated episode without decoding them
+ if they are still pending.
+ @return YES if any of the text fields has changed.
+ @remarks If only the updated episode has pending text fields, they are
+ considered changed rather than decoding them just to compare.
+ */
+- (BOOL)updateTextFieldsWithEpisode:(LRTVDBEpisode *)updatedEpisode
+{
+    NSData *buffer = nil;
+    LRTVDBEpisodeTextRanges ranges;
     
-    // Timezones are really difficult to deal with. Ignoring time...
-    NSDate *fromDate = [[NSDate date] dateByIgnoringTime];
-    NSDate *toDate = [_airedDate dateByIgnoringTime];
+    @synchronized(updatedEpisode)
+    {
+        buffer = updatedEpisode->_textFieldsBuffer;
+        ranges = updatedEpisode->_textFieldsRanges;
+    }
+    
+    if (buffer)
+    {
+        @synchronized(self)
+        {
+            if (_textFieldsBuffer &&
+                LRTVDBBufferRangesAreEqual(_textFieldsBuffer, _textFieldsRanges.overview, buffer, ranges.overview) &&
+                LRTVDBBufferRangesAreEqual(_textFieldsBuffer, _textFieldsRanges.directors, buffer, ranges.directors) &&
+                LRTVDBBufferRangesAreEqual(_textFieldsBuffer, _textFieldsRanges.writers, buffer, ranges.writers) &&
+                LRTVDBBufferRangesAreEqual(_textFieldsBuffer, _textFieldsRanges.guestStars, buffer, ranges.guestStars))
+            {
+                return NO;
+            }
+        }
+        
+        [self willChangeValueForKey:@"overview"];
+        [self willChangeValueForKey:@"directors"];
+        [self willChangeValueForKey:@"writers"];
+        [self willChangeValueForKey:@"guestStars"];
+        
+        [self setTextFieldsBuffer:buffer ranges:ranges];
+        
+        [self didChangeValueForKey:@"guestStars"];
+        [self didChangeValueForKey:@"writers"];
+        [self didChangeValueForKey:@"directors"];
+        [self didChangeValueForKey:@"overview"];
+        
+        return YES;
+    }
+    
+    BOOL hasChanged = (LRTVDBValuesDiffer(self.overview, updatedEpisode.overview) ||
+                       LRTVDBValuesDiffer(self.writers, updatedEpisode.writers) ||
+                       LRTVDBValuesDiffer(self.guestStars, updatedEpisode.guestStars) ||
+                       LRTVDBValuesDiffer(self.directors, updatedEpisode.directors));
+    
+    if (hasChanged)
+    {
+        self.overview = updatedEpisode.overview;
+        self.writers = updatedEpisode.writers;
+        self.guestStars = updatedEpisode.guestStars;
+        self.directors = updatedEpisode.directors;
+    }
+    
+    return hasChanged;
+}
+
+#pragma mark - Memory size
+
+- (size_t)memorySize
+{
+    // Language, show ID and the names in writers, directors and guest stars
+    // are interned, shared by every episode, so they're not counted.
+    size_t size = (LRTVDBMallocSize(self) + LRTVDBMallocSize(_title) + LRTVDBMallocSize(_episodeID) +
+                   LRTVDBMallocSize(_imdbID) + LRTVDBMallocSizeOfURL(_imageURL));
+    
+    @synchronized(self)
+    {
+        if (_hasPendingTextFields)
+        {
+            size += (_textFieldsRanges.overview.length + _textFieldsRanges.directors.length +
+                     _textFieldsRanges.writers.length + _textFieldsRanges.guestStars.length);
+        }
+        else
+        {
+            size += (LRTVDBMallocSize(_overview) + LRTVDBMallocSize(_directors) +
+                     LRTVDBMallocSize(_writers) + LRTVDBMallocSize(_guestStars));
+        }
+    }
     
-    NSDateComponents *components = [calendar components:NSDayCalendarUnit
-                                               fromDate:fromDate
-                                                 toDate:toDate
-                                                options:0];
-    return @(components.day);
+    return size;
 }
 
 #pragma mark - Is Episode Special ?
 
 - (BOOL)isSpecial
 {
-    return [self.seasonNumber isEqualToNumber:@(0)];
+    return _seasonNumberValue == 0;
 }
 
 #pragma mark - Has episode already aired ?
 
 - (BOOL)hasAlreadyAired
 {
-    return self.numberOfDaysToAir && [self.numberOfDaysToAir integerValue] <= 0;
+    return [self numberOfDaysToAir] <= 0;
 }
 
 #pragma mark - Is Episode correct?
@@ -166,35 +481,54 @@ NSComparator LRTVDBEpisodeComparator = ^NSComparisonResult(LRTVDBEpisode *firstE
 
 #pragma mark - Update episode
 
-- (void)updateWithEpisode:(LRTVDBEpisode *)updatedEpisode;
+- (BOOL)updateWithEpisode:(LRTVDBEpisode *)updatedEpisode;
 {
-    if (updatedEpisode == nil) return;
+    if (updatedEpisode == nil) return NO;
     
     NSAssert([self isEqual:updatedEpisode], @"Trying to update episode with one with different ID?");
     
-    self.episodeID = updatedEpisode.episodeID;
-    self.title = updatedEpisode.title;
-    self.episodeNumber = updatedEpisode.episodeNumber;
-    self.seasonNumber = updatedEpisode.seasonNumber;
-    self.rating = updatedEpisode.rating;
-    self.ratingCount = updatedEpisode.ratingCount;
-    self.airedDate = updatedEpisode.airedDate;
-    self.overview = updatedEpisode.overview;
-    self.imageURL = updatedEpisode.imageURL;
-    self.imdbID = updatedEpisode.imdbID;
-    self.language = updatedEpisode.language;
-    self.showID = updatedEpisode.showID;
-    self.writers = updatedEpisode.writers;
-    self.guestStars = updatedEpisode.guestStars;
-    self.directors = updatedEpisode.directors;
+    BOOL hasChanged = (LRTVDBValuesDiffer(self.title, updatedEpisode.title) ||
+                       self.episodeNumberValue != updatedEpisode.episodeNumberValue ||
+                       self.seasonNumberValue != updatedEpisode.seasonNumberValue ||
+                       LRTVDBValuesDiffer(self.rating, updatedEpisode.rating) ||
+                       LRTVDBValuesDiffer(self.ratingCount, updatedEpisode.ratingCount) ||
+                       self.airedDayNumber != updatedEpisode.airedDayNumber ||
+                       LRTVDBValuesDiffer(self.imageURL, updatedEpisode.imageURL) ||
+                       LRTVDBValuesDiffer(self.imdbID, updatedEpisode.imdbID) ||
+                       LRTVDBValuesDiffer(self.language, updatedEpisode.language) ||
+                       LRTVDBValuesDiffer(self.showID, updatedEpisode.showID));
+    
+    if (hasChanged)
+    {
+        self.episodeID = updatedEpisode.episodeID;
+        self.title = updatedEpisode.title;
+        self.episodeNumberValue = updatedEpisode.episodeNumberValue;
+        self.seasonNumberValue = updatedEpisode.seasonNumberValue;
+        self.ratingValue = updatedEpisode.ratingValue;
+        self.ratingCount = updatedEpisode.ratingCount;
+        self.airedDayNumber = updatedEpisode.airedDayNumber;
+        self.imageURL = updatedEpisode.imageURL;
+        self.imdbID = updatedEpisode.imdbID;
+        self.language = updatedEpisode.language;
+        self.showID = updatedEpisode.showID;
+    }
+    
+    return [self updateTextFieldsWithEpisode:updatedEpisode] || hasChanged;
 }
 
 #pragma mark - LRTVDBSerializableModelProtocol
 
 + (LRTVDBEpisode *)deserialize:(NSDictionary *)dictionary error:(NSError **)error
+{
+    return [self deserialize:dictionary showID:nil error:error];
+}
+
++ (LRTVDBEpisode *)deserialize:(NSDictionary *)dictionary showID:(NSString *)owningShowID error:(NSError **)error
 {    
     LRTVDBEpisode *episode = [[LRTVDBEpisode alloc] init];
     
+    LRTVDBStringInterner *interner = [LRTVDBStringInterner sharedInterner];
+    
     id episodeId = LREmptyStringToNil(dictionary[kEpisodeIDKey]);
     CHECK_NIL(episodeId, @"episodeId", *error);
     CHECK_TYPE(episodeId, [NSString class], @"episodeId", *error);
@@ -211,7 +545,7 @@ NSComparator LRTVDBEpisodeComparator = ^NSComparisonResult(LRTVDBEpisode *firstE
 
     id imageURL = LREmptyStringToNil(dictionary[kEpisodeImageURLKey]);
     CHECK_TYPE(imageURL, [NSString class], @"imageURL", *error);
-    episode.imageURL = [NSURL URLWithString:imageURL];
+    episode.imageURL = LRTVDBImageURLForPath(imageURL);
 
     id airedDate = LREmptyStringToNil(dictionary[kEpisodeAiredDateKey]);
     CHECK_TYPE(airedDate, [NSDate class], @"airedDate", *error);
@@ -223,15 +557,15 @@ NSComparator LRTVDBEpisodeComparator = ^NSComparisonResult(LRTVDBEpisode *firstE
 
     id directors = LREmptyStringToNil(dictionary[kEpisodeDirectorsKey]);
     CHECK_TYPE(directors, [NSArray class], @"directors", *error);
-    episode.directors = directors;
+    episode.directors = [interner internStringsInArray:directors];
 
     id writers = LREmptyStringToNil(dictionary[kEpisodeWritersKey]);
     CHECK_TYPE(writers, [NSArray class], @"writers", *error);
-    episode.writers = writers;
+    episode.writers = [interner internStringsInArray:writers];
 
     id guestStars = LREmptyStringToNil(dictionary[kEpisodeGuestStarsKey]);
     CHECK_TYPE(guestStars, [NSArray class], @"guestStars", *error);
-    episode.guestStars = guestStars;
+    episode.guestStars = [interner internStringsInArray:guestStars];
 
     id seasonNumber = LREmptyStringToNil(dictionary[kEpisodeSeasonNumberKey]);
     CHECK_NIL(seasonNumber, @"seasonNumber", *error);
@@ -253,12 +587,12 @@ NSComparator LRTVDBEpisodeComparator = ^NSComparisonResult(LRTVDBEpisode *firstE
 
     id language = LREmptyStringToNil(dictionary[kEpisodeLanguageKey]);
     CHECK_TYPE(language, [NSString class], @"language", *error);
-    episode.language = language;
+    episode.language = [interner internString:language];
 
-    id showID = LREmptyStringToNil(dictionary[kEpisodeShowIDKey]);
+    id showID = LREmptyStringToNil(dictionary[kEpisodeShowIDKey]) ? : owningShowID;
     CHECK_NIL(showID, @"showID", *error);
     CHECK_TYPE(showID, [NSString class], @"showID", *error);
-    episode.showID = showID;
+    episode.showID = [interner internString:showID];
 
     id seen = LREmptyStringToNil(dictionary[kEpisodeSeenKey]);
     CHECK_TYPE(seen, [NSNumber class], @"seen", *error);
@@ -272,7 +606,7 @@ NSComparator LRTVDBEpisodeComparator = ^NSComparisonResult(LRTVDBEpisode *firstE
     return @{ kEpisodeIDKey : LRNilToEmptyString(self.episodeID),
               kEpisodeTitleKey : LRNilToEmptyString(self.title),
               kEpisodeOverviewKey : LRNilToEmptyString(self.overview),
-              kEpisodeImageURLKey : LRNilToEmptyString([self.imageURL absoluteString]),
+              kEpisodeImageURLKey : LRNilToEmptyString(LRTVDBImagePathForURL(self.imageURL)),
               kEpisodeAiredDateKey : LRNilToEmptyString(self.airedDate),
               kEpisodeImdbIDKey : LRNilToEmptyString(self.imdbID),
               kEpisodeDirectorsKey : LRNilToEmptyString(self.directors),
@@ -288,6 +622,127 @@ NSComparator LRTVDBEpisodeComparator = ^NSComparisonResult(LRTVDBEpisode *firstE
             };    
 }
 
++ (NSUInteger)binarySchemaVersion
+{
+    return kEpisodeBinarySchemaVersion;
+}
+
++ (LRTVDBEpisode *)decodeWithDecoder:(LRTVDBBinaryDecoder *)decoder
+{
+    LRTVDBEpisode *episode = [[LRTVDBEpisode alloc] init];
+    
+    LRTVDBStringInterner *interner = [LRTVDBStringInterner sharedInterner];
+    
+    // Strings are already shared inside the same data through its string table,
+    // they're interned anyway so that they're shared with other shows too.
+    LRTVDBBinaryTag tag;
+    
+    while ([decoder decodeNextFieldTag:&tag])
+    {
+        switch (tag)
+        {
+            case kEpisodeIDTag:
+                episode.episodeID = [decoder decodeString];
+                break;
+            case kEpisodeTitleTag:
+                episode.title = [decoder decodeString];
+                break;
+            case kEpisodeOverviewTag:
+                episode.overview = [decoder decodeString];
+                break;
+            case kEpisodeImageURLTag:
+                episode.imageURL = LRTVDBImageURLForDecodedString([decoder decodeString], decoder.recordSchemaVersion);
+                break;
+            case kEpisodeAiredDayNumberTag:
+                episode.airedDayNumber = [decoder decodeDayNumber];
+                break;
+            case kEpisodeImdbIDTag:
+                episode.imdbID = [decoder decodeString];
+                break;
+            case kEpisodeDirectorsTag:
+                episode.directors = [interner internStringsInArray:[decoder decodeStrings]];
+                break;
+            case kEpisodeWritersTag:
+                episode.writers = [interner internStringsInArray:[decoder decodeStrings]];
+                break;
+            case kEpisodeGuestStarsTag:
+                episode.guestStars = [interner internStringsInArray:[decoder decodeStrings]];
+                break;
+            case kEpisodeSeasonNumberTag:
+                episode.seasonNumberValue = (NSInteger)[decoder decodeInteger];
+                break;
+            case kEpisodeNumberTag:
+                episode.episodeNumberValue = (NSInteger)[decoder decodeInteger];
+                break;
+            case kEpisodeRatingTag:
+                episode.ratingValue = [decoder decodeDouble];
+                break;
+            case kEpisodeRatingCountTag:
+                episode.ratingCount = @([decoder decodeInteger]);
+                break;
+            case kEpisodeLanguageTag:
+                episode.language = [interner internString:[decoder decodeString]];
+                break;
+            case kEpisodeShowIDTag:
+                episode.showID = [interner internString:[decoder decodeString]];
+                break;
+            case kEpisodeSeenTag:
+                episode.seen = [decoder decodeBool];
+                break;
+            default:
+                [decoder skipField];
+                break;
+        }
+    }
+    
+    // Same required values as deserialize:error:, but the show ID, which is taken
+    // from the owning show when it's missing (see LRTVDBShow).
+    if (!episode.episodeID || !episode.title || !episode.seasonNumber || !episode.episodeNumber)
+    {
+        return nil;
+    }
+    
+    return episode;
+}
+
+- (void)encodeWithEncoder:(LRTVDBBinaryEncoder *)encoder
+{
+    [encoder encodeString:self.episodeID forTag:kEpisodeIDTag];
+    [encoder encodeString:self.title forTag:kEpisodeTitleTag];
+    [encoder encodeString:self.overview forTag:kEpisodeOverviewTag];
+    [encoder encodeString:LRTVDBImagePathForURL(self.imageURL) forTag:kEpisodeImageURLTag];
+    [encoder encodeDayNumber:self.airedDayNumber forTag:kEpisodeAiredDayNumberTag];
+    [encoder encodeString:self.imdbID forTag:kEpisodeImdbIDTag];
+    [encoder encodeStrings:self.directors forTag:kEpisodeDirectorsTag];
+    [encoder encodeStrings:self.writers forTag:kEpisodeWritersTag];
+    [encoder encodeStrings:self.guestStars forTag:kEpisodeGuestStarsTag];
+    
+    if (self.seasonNumberValue != NSIntegerMax)
+    {
+        [encoder encodeInteger:self.seasonNumberValue forTag:kEpisodeSeasonNumberTag];
+    }
+    
+    if (self.episodeNumberValue != NSIntegerMax)
+    {
+        [encoder encodeInteger:self.episodeNumberValue forTag:kEpisodeNumberTag];
+    }
+    
+    [encoder encodeDouble:self.ratingValue forTag:kEpisodeRatingTag];
+    
+    if (self.ratingCount)
+    {
+        [encoder encodeInteger:[self.ratingCount longLongValue] forTag:kEpisodeRatingCountTag];
+    }
+    
+    [encoder encodeString:self.language forTag:kEpisodeLanguageTag];
+    [encoder encodeString:self.showID forTag:kEpisodeShowIDTag];
+    
+    if (self.seen)
+    {
+        [encoder encodeBool:YES forTag:kEpisodeSeenTag];
+    }
+}
+
 #pragma mark - Equality methods
 
 - (BOOL)isEqual:(id)object
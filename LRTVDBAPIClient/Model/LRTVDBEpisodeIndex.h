@@ -0,0 +1,105 @@
+// LRTVDBEpisodeIndex.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "NSDate+LRTVDBAdditions.h"
+
+/**
+ Immutable index over the sorted episodes of a show.
+ @discussion It keeps the episodes with aired date sorted by aired day, so that
+ last and next episode are found with a binary search, the range of every season
+ in the episodes array and some cached counts. Merges update it incrementally
+ instead of rebuilding it from scratch.
+ @remarks Thread safe.
+ */
+@interface LRTVDBEpisodeIndex : NSObject
+
+/**
+ Creates the index from scratch.
+ @param episodes Array of LRTVDBEpisode instances sorted by LRTVDBEpisodeComparator.
+ */
+- (id)initWithEpisodes:(NSArray *)episodes;
+
+/**
+ Creates a new index after a merge without re-sorting the unchanged episodes.
+ @param episodes The merged episodes. The episodes of the receiver must keep
+ their relative order in it.
+ @param insertedIndexes Indexes of the new episodes in the merged episodes.
+ @param updatedIndexes Indexes of the updated episodes in the merged episodes.
+ @remarks O(n + m log m), being m the number of inserted and updated episodes.
+ */
+- (LRTVDBEpisodeIndex *)indexWithEpisodes:(NSArray *)episodes
+                          insertedIndexes:(NSIndexSet *)insertedIndexes
+                           updatedIndexes:(NSIndexSet *)updatedIndexes;
+
+/** Indexed episodes. */
+@property (nonatomic, copy, readonly) NSArray *episodes;
+
+/** Index of the first episode which is not special, NSNotFound if none. */
+@property (nonatomic, readonly) NSUInteger firstRegularEpisodeIndex;
+
+/** Number of episodes which are not special. */
+@property (nonatomic, readonly) NSUInteger numberOfRegularEpisodes;
+
+/** Number of special episodes. */
+@property (nonatomic, readonly) NSUInteger numberOfSpecials;
+
+/**
+ @return The highest index of the episodes aired before the provided day,
+ NSNotFound if none. O(log n).
+ */
+- (NSUInteger)indexOfLastEpisodeAiredBeforeDay:(LRTVDBDayNumber)dayNumber;
+
+/**
+ @return The number of episodes which are not special aired on or before the
+ provided day. O(log n).
+ */
+- (NSUInteger)numberOfRegularEpisodesAiredOnOrBeforeDay:(LRTVDBDayNumber)dayNumber;
+
+/**
+ @return The episodes of the season, nil if the season has no episodes. O(log n)
+ the first time, cached afterwards.
+ */
+- (NSArray *)episodesForSeason:(NSNumber *)seasonNumber;
+
+/**
+ @return The range of the season in the episodes array, {NSNotFound, 0} if the
+ season has no episodes. O(log n).
+ */
+- (NSRange)rangeOfSeason:(NSNumber *)seasonNumber;
+
+/**
+ @return The average rating of the rated episodes of the season, nil if none.
+ */
+- (NSNumber *)averageRatingForSeason:(NSNumber *)seasonNumber;
+
+/**
+ Columns with the scalar values of the episodes, one entry per episode and in
+ the same order. Aggregate queries scan them without touching the episodes.
+ @remarks Unknown values are NSIntegerMax, LRTVDBUnknownDayNumber or NAN.
+ */
+- (const NSInteger *)seasonNumbers;
+- (const NSInteger *)episodeNumbers;
+- (const LRTVDBDayNumber *)airedDayNumbers;
+- (const float *)ratings;
+
+@end
@@ -0,0 +1,454 @@
+// LRTVDBEpisodeIndex.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBEpisodeIndex.h"
+#import "LRTVDBEpisode.h"
+#import "LRTVDBEpisode+Private.h"
+#import <libkern/OSAtomic.h>
+
+typedef struct
+{
+    LRTVDBDayNumber dayNumber;
+    NSUInteger index;
+    BOOL special;
+} LRTVDBAiredEpisodeEntry;
+
+typedef struct
+{
+    NSInteger seasonNumber;
+    NSRange range;
+} LRTVDBSeasonEntry;
+
+NS_INLINE NSInteger LRTVDBSeasonNumberOfEpisode(LRTVDBEpisode *episode)
+{
+    // Same as LRTVDBEpisodeComparator, episodes without season go last.
+    return episode.seasonNumberValue;
+}
+
+NS_INLINE LRTVDBAiredEpisodeEntry LRTVDBAiredEpisodeEntryMake(LRTVDBEpisode *episode, NSUInteger index)
+{
+    return (LRTVDBAiredEpisodeEntry){ episode.airedDayNumber, index, LRTVDBSeasonNumberOfEpisode(episode) == 0 };
+}
+
+NS_INLINE NSComparisonResult LRTVDBCompareAiredEpisodeEntries(const LRTVDBAiredEpisodeEntry *first,
+                                                             const LRTVDBAiredEpisodeEntry *second)
+{
+    if (first->dayNumber != second->dayNumber) return first->dayNumber < second->dayNumber ? NSOrderedAscending : NSOrderedDescending;
+    if (first->index != second->index) return first->index < second->index ? NSOrderedAscending : NSOrderedDescending;
+    return NSOrderedSame;
+}
+
+static int LRTVDBQSortAiredEpisodeEntries(const void *first, const void *second)
+{
+    return (int)LRTVDBCompareAiredEpisodeEntries(first, second);
+}
+
+@interface LRTVDBEpisodeIndex ()
+{
+    // Episodes with aired date, sorted by aired day (and index).
+    LRTVDBAiredEpisodeEntry *_airedEntries;
+    NSUInteger _numberOfAiredEntries;
+    
+    // _maxIndexes[k] is the highest index in _airedEntries[0...k].
+    NSUInteger *_maxIndexes;
+    
+    // Aired days of the regular episodes, sorted.
+    LRTVDBDayNumber *_regularDayNumbers;
+    NSUInteger _numberOfRegularDayNumbers;
+    
+    LRTVDBSeasonEntry *_seasons;
+    NSUInteger _numberOfSeasons;
+    
+    // Columns, one entry per episode.
+    NSInteger *_seasonNumbers;
+    NSInteger *_episodeNumbers;
+    LRTVDBDayNumber *_airedDayNumbers;
+    float *_ratings;
+    
+    NSMutableDictionary *_seasonEpisodesCache;
+    OSSpinLock _seasonEpisodesCacheLock;
+}
+
+@property (nonatomic, copy) NSArray *episodes;
+@property (nonatomic) NSUInteger firstRegularEpisodeIndex;
+@property (nonatomic) NSUInteger numberOfRegularEpisodes;
+@property (nonatomic) NSUInteger numberOfSpecials;
+
+@end
+
+@implementation LRTVDBEpisodeIndex
+
+- (id)initWithEpisodes:(NSArray *)episodes
+{
+    return [self initWithEpisodes:episodes airedEntries:NULL numberOfAiredEntries:0];
+}
+
+/**
+ Designated initializer.
+ @param airedEntries Already sorted entries, owned by the index from now on.
+ If NULL, entries are computed and sorted from the episodes.
+ */
+- (id)initWithEpisodes:(NSArray *)episodes
+          airedEntries:(LRTVDBAiredEpisodeEntry *)airedEntries
+  numberOfAiredEntries:(NSUInteger)numberOfAiredEntries
+{
+    if (self = [super init])
+    {
+        _episodes = [episodes copy];
+        _seasonEpisodesCache = [NSMutableDictionary dictionary];
+        _seasonEpisodesCacheLock = OS_SPINLOCK_INIT;
+        
+        if (airedEntries == NULL)
+        {
+            airedEntries = malloc(MAX([_episodes count], 1) * sizeof(LRTVDBAiredEpisodeEntry));
+            numberOfAiredEntries = 0;
+            
+            NSUInteger index = 0;
+            
+            for (LRTVDBEpisode *episode in _episodes)
+            {
+                if (episode.airedDayNumber != LRTVDBUnknownDayNumber)
+                {
+                    airedEntries[numberOfAiredEntries++] = LRTVDBAiredEpisodeEntryMake(episode, index);
+                }
+                
+                index++;
+            }
+            
+            qsort(airedEntries, numberOfAiredEntries, sizeof(LRTVDBAiredEpisodeEntry), LRTVDBQSortAiredEpisodeEntries);
+        }
+        
+        _airedEntries = airedEntries;
+        _numberOfAiredEntries = numberOfAiredEntries;
+        
+        [self computeDerivedInformation];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_airedEntries);
+    free(_maxIndexes);
+    free(_regularDayNumbers);
+    free(_seasons);
+    free(_seasonNumbers);
+    free(_episodeNumbers);
+    free(_airedDayNumbers);
+    free(_ratings);
+}
+
+- (void)computeDerivedInformation
+{
+    NSUInteger numberOfAiredEntries = _numberOfAiredEntries;
+    
+    _maxIndexes = malloc(MAX(numberOfAiredEntries, 1) * sizeof(NSUInteger));
+    _regularDayNumbers = malloc(MAX(numberOfAiredEntries, 1) * sizeof(LRTVDBDayNumber));
+    _numberOfRegularDayNumbers = 0;
+    
+    NSUInteger maxIndex = 0;
+    
+    for (NSUInteger i = 0; i < numberOfAiredEntries; i++)
+    {
+        maxIndex = MAX(maxIndex, _airedEntries[i].index);
+        _maxIndexes[i] = maxIndex;
+        
+        if (!_airedEntries[i].special)
+        {
+            _regularDayNumbers[_numberOfRegularDayNumbers++] = _airedEntries[i].dayNumber;
+        }
+    }
+    
+    // Sorted episodes have every season in a contiguous range.
+    NSUInteger count = [_episodes count];
+    
+    _seasons = malloc(MAX(count, 1) * sizeof(LRTVDBSeasonEntry));
+    _numberOfSeasons = 0;
+    _firstRegularEpisodeIndex = NSNotFound;
+    _numberOfSpecials = 0;
+    
+    _seasonNumbers = malloc(MAX(count, 1) * sizeof(NSInteger));
+    _episodeNumbers = malloc(MAX(count, 1) * sizeof(NSInteger));
+    _airedDayNumbers = malloc(MAX(count, 1) * sizeof(LRTVDBDayNumber));
+    _ratings = malloc(MAX(count, 1) * sizeof(float));
+    
+    NSUInteger index = 0;
+    
+    for (LRTVDBEpisode *episode in _episodes)
+    {
+        NSInteger seasonNumber = LRTVDBSeasonNumberOfEpisode(episode);
+        
+        _seasonNumbers[index] = seasonNumber;
+        _episodeNumbers[index] = episode.episodeNumberValue;
+        _airedDayNumbers[index] = episode.airedDayNumber;
+        _ratings[index] = (float)episode.ratingValue;
+        
+        if (_numberOfSeasons > 0 && _seasons[_numberOfSeasons - 1].seasonNumber == seasonNumber)
+        {
+            _seasons[_numberOfSeasons - 1].range.length++;
+        }
+        else
+        {
+            _seasons[_numberOfSeasons++] = (LRTVDBSeasonEntry){ seasonNumber, NSMakeRange(index, 1) };
+        }
+        
+        if (seasonNumber == 0)
+        {
+            _numberOfSpecials++;
+        }
+        else if (_firstRegularEpisodeIndex == NSNotFound)
+        {
+            _firstRegularEpisodeIndex = index;
+        }
+        
+        index++;
+    }
+    
+    _numberOfRegularEpisodes = count - _numberOfSpecials;
+}
+
+#pragma mark - Incremental update
+
+- (LRTVDBEpisodeIndex *)indexWithEpisodes:(NSArray *)episodes
+                          insertedIndexes:(NSIndexSet *)insertedIndexes
+                           updatedIndexes:(NSIndexSet *)updatedIndexes
+{
+    NSUInteger count = [episodes count];
+    NSUInteger oldCount = [_episodes count];
+    
+    NSAssert(oldCount + [insertedIndexes count] == count, @"Episodes can't be removed incrementally");
+    
+    // Old episodes keep their relative order, so their new indexes are the ones not inserted.
+    NSUInteger *newIndexes = malloc(MAX(oldCount, 1) * sizeof(NSUInteger));
+    NSUInteger oldIndex = 0;
+    
+    for (NSUInteger index = 0; index < count && oldIndex < oldCount; index++)
+    {
+        if (![insertedIndexes containsIndex:index])
+        {
+            newIndexes[oldIndex++] = index;
+        }
+    }
+    
+    // Entries of untouched episodes (or updated ones whose aired day hasn't changed)
+    // are still sorted once remapped, as the remapping keeps the order.
+    LRTVDBAiredEpisodeEntry *keptEntries = malloc(MAX(_numberOfAiredEntries, 1) * sizeof(LRTVDBAiredEpisodeEntry));
+    NSUInteger numberOfKeptEntries = 0;
+    NSMutableIndexSet *keptUpdatedIndexes = [NSMutableIndexSet indexSet];
+    
+    for (NSUInteger i = 0; i < _numberOfAiredEntries; i++)
+    {
+        LRTVDBAiredEpisodeEntry entry = _airedEntries[i];
+        entry.index = newIndexes[entry.index];
+        
+        if ([updatedIndexes containsIndex:entry.index])
+        {
+            LRTVDBAiredEpisodeEntry updatedEntry = LRTVDBAiredEpisodeEntryMake(episodes[entry.index], entry.index);
+            
+            if (updatedEntry.dayNumber != entry.dayNumber || updatedEntry.special != entry.special) continue;
+            
+            [keptUpdatedIndexes addIndex:entry.index];
+        }
+        
+        keptEntries[numberOfKeptEntries++] = entry;
+    }
+    
+    free(newIndexes);
+    
+    // New entries: inserted episodes and updated ones whose entry has been dropped.
+    NSMutableIndexSet *newEntriesIndexes = [insertedIndexes mutableCopy];
+    [newEntriesIndexes addIndexes:updatedIndexes];
+    [newEntriesIndexes removeIndexes:keptUpdatedIndexes];
+    
+    LRTVDBAiredEpisodeEntry *newEntries = malloc(MAX([newEntriesIndexes count], 1) * sizeof(LRTVDBAiredEpisodeEntry));
+    __block NSUInteger numberOfNewEntries = 0;
+    
+    [newEntriesIndexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+        
+        LRTVDBEpisode *episode = episodes[index];
+        
+        if (episode.airedDayNumber != LRTVDBUnknownDayNumber)
+        {
+            newEntries[numberOfNewEntries++] = LRTVDBAiredEpisodeEntryMake(episode, index);
+        }
+    }];
+    
+    qsort(newEntries, numberOfNewEntries, sizeof(LRTVDBAiredEpisodeEntry), LRTVDBQSortAiredEpisodeEntries);
+    
+    // Linear merge of both sorted entries arrays.
+    NSUInteger numberOfAiredEntries = numberOfKeptEntries + numberOfNewEntries;
+    LRTVDBAiredEpisodeEntry *airedEntries = malloc(MAX(numberOfAiredEntries, 1) * sizeof(LRTVDBAiredEpisodeEntry));
+    NSUInteger keptIndex = 0, newIndex = 0;
+    
+    for (NSUInteger i = 0; i < numberOfAiredEntries; i++)
+    {
+        BOOL takeKept = (newIndex == numberOfNewEntries ||
+                         (keptIndex < numberOfKeptEntries &&
+                          LRTVDBCompareAiredEpisodeEntries(&keptEntries[keptIndex], &newEntries[newIndex]) == NSOrderedAscending));
+        
+        airedEntries[i] = takeKept ? keptEntries[keptIndex++] : newEntries[newIndex++];
+    }
+    
+    free(keptEntries);
+    free(newEntries);
+    
+    return [[LRTVDBEpisodeIndex alloc] initWithEpisodes:episodes
+                                           airedEntries:airedEntries
+                                   numberOfAiredEntries:numberOfAiredEntries];
+}
+
+#pragma mark - Queries
+
+- (NSUInteger)indexOfLastEpisodeAiredBeforeDay:(LRTVDBDayNumber)dayNumber
+{
+    // Number of entries aired before the day.
+    NSUInteger low = 0, high = _numberOfAiredEntries;
+    
+    while (low < high)
+    {
+        NSUInteger middle = low + (high - low) / 2;
+        
+        if (_airedEntries[middle].dayNumber < dayNumber)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    
+    return low > 0 ? _maxIndexes[low - 1] : NSNotFound;
+}
+
+- (NSUInteger)numberOfRegularEpisodesAiredOnOrBeforeDay:(LRTVDBDayNumber)dayNumber
+{
+    NSUInteger low = 0, high = _numberOfRegularDayNumbers;
+    
+    while (low < high)
+    {
+        NSUInteger middle = low + (high - low) / 2;
+        
+        if (_regularDayNumbers[middle] <= dayNumber)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    
+    return low;
+}
+
+- (NSRange)rangeOfSeason:(NSNumber *)seasonNumber
+{
+    NSInteger season = seasonNumber ? [seasonNumber integerValue] : NSIntegerMax;
+    NSUInteger low = 0, high = _numberOfSeasons;
+    
+    while (low < high)
+    {
+        NSUInteger middle = low + (high - low) / 2;
+        
+        if (_seasons[middle].seasonNumber < season)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    
+    if (low == _numberOfSeasons || _seasons[low].seasonNumber != season) return NSMakeRange(NSNotFound, 0);
+    
+    return _seasons[low].range;
+}
+
+- (NSArray *)episodesForSeason:(NSNumber *)seasonNumber
+{
+    NSInteger season = seasonNumber ? [seasonNumber integerValue] : NSIntegerMax;
+    
+    OSSpinLockLock(&_seasonEpisodesCacheLock);
+    NSArray *seasonEpisodes = _seasonEpisodesCache[@(season)];
+    OSSpinLockUnlock(&_seasonEpisodesCacheLock);
+    
+    if (seasonEpisodes) return seasonEpisodes;
+    
+    NSRange range = [self rangeOfSeason:seasonNumber];
+    
+    if (range.location == NSNotFound) return nil;
+    
+    seasonEpisodes = [_episodes subarrayWithRange:range];
+    
+    OSSpinLockLock(&_seasonEpisodesCacheLock);
+    _seasonEpisodesCache[@(season)] = seasonEpisodes;
+    OSSpinLockUnlock(&_seasonEpisodesCacheLock);
+    
+    return seasonEpisodes;
+}
+
+- (NSNumber *)averageRatingForSeason:(NSNumber *)seasonNumber
+{
+    NSRange range = [self rangeOfSeason:seasonNumber];
+    
+    if (range.location == NSNotFound) return nil;
+    
+    const float *ratings = _ratings + range.location;
+    float sum = 0;
+    NSUInteger numberOfRatings = 0;
+    
+    // Branchless, so that it can be vectorized.
+    for (NSUInteger i = 0; i < range.length; i++)
+    {
+        BOOL isRated = !isnan(ratings[i]);
+        sum += isRated ? ratings[i] : 0;
+        numberOfRatings += isRated;
+    }
+    
+    return numberOfRatings > 0 ? @(sum / numberOfRatings) : nil;
+}
+
+#pragma mark - Columns
+
+- (const NSInteger *)seasonNumbers
+{
+    return _seasonNumbers;
+}
+
+- (const NSInteger *)episodeNumbers
+{
+    return _episodeNumbers;
+}
+
+- (const LRTVDBDayNumber *)airedDayNumbers
+{
+    return _airedDayNumbers;
+}
+
+- (const float *)ratings
+{
+    return _ratings;
+}
+
+@end
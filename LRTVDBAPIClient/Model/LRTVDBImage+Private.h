@@ -26,13 +26,27 @@
 
 @property (nonatomic, strong) NSURL *url;
 @property (nonatomic, strong) NSURL *thumbnailURL;
+
+/**
+ Paths of url and thumbnailURL relative to the TVDB image base URL (see
+ LRTVDBImageURLForPath), which is all that images store.
+ */
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, copy) NSString *thumbnailPath;
 @property (nonatomic, strong) NSNumber *rating;
 @property (nonatomic, strong) NSNumber *ratingCount;
 @property (nonatomic) LRTVDBImageType type;
+@property (nonatomic, strong) NSNumber *seasonNumber;
 
 /**
  Updates an image.
+ @return YES if any of its values has changed.
+ */
+- (BOOL)updateWithImage:(LRTVDBImage *)updatedImage;
+
+/**
+ @return Estimated heap bytes used by the image (see LRTVDBShow memoryUsage).
  */
-- (void)updateWithImage:(LRTVDBImage *)updatedImage;
+- (size_t)memorySize;
 
 @end
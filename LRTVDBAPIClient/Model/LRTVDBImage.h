@@ -49,4 +49,7 @@ typedef NS_ENUM(NSInteger, LRTVDBImageType)
 
 @property (nonatomic, readonly) LRTVDBImageType type;
 
+/** Season of the image. Only available for LRTVDBImageTypeSeason images. */
+@property (nonatomic, strong, readonly) NSNumber *seasonNumber;
+
 @end
@@ -21,6 +21,8 @@
 // THE SOFTWARE.
 
 #import "LRTVDBImage.h"
+#import "LRTVDBBinaryCodec.h"
+#import "LRTVDBAPIClient+Private.h"
 
 // Persistence keys
 static NSString *const kImageURLKey = @"kImageURLKey";
@@ -28,6 +30,16 @@ static NSString *const kImageThumbnailURLKey = @"kImageThumbnailURLKey";
 static NSString *const kImageRatingKey = @"kImageRatingKey";
 static NSString *const kImageRatingCountKey = @"kImageRatingCountKey";
 static NSString *const kImageTypeKey = @"kImageTypeKey";
+static NSString *const kImageSeasonNumberKey = @"kImageSeasonNumberKey";
+
+// Binary codec tags
+static const NSUInteger kImageBinarySchemaVersion = 2;
+static const LRTVDBBinaryTag kImageURLTag = 1;
+static const LRTVDBBinaryTag kImageThumbnailURLTag = 2;
+static const LRTVDBBinaryTag kImageRatingTag = 3;
+static const LRTVDBBinaryTag kImageRatingCountTag = 4;
+static const LRTVDBBinaryTag kImageTypeTag = 5;
+static const LRTVDBBinaryTag kImageSeasonNumberTag = 6;
 
 NSComparator LRTVDBImageComparator = ^NSComparisonResult(LRTVDBImage *firstImage, LRTVDBImage *secondImage)
 {
@@ -63,27 +75,74 @@ NSComparator LRTVDBImageComparator = ^NSComparisonResult(LRTVDBImage *firstImage
 
 @property (nonatomic, strong) NSURL *url;
 @property (nonatomic, strong) NSURL *thumbnailURL;
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, copy) NSString *thumbnailPath;
 @property (nonatomic, strong) NSNumber *rating;
 @property (nonatomic, strong) NSNumber *ratingCount;
 @property (nonatomic) LRTVDBImageType type;
+@property (nonatomic, strong) NSNumber *seasonNumber;
 
 @end
 
 @implementation LRTVDBImage
 
+#pragma mark - URLs
+
+// Only paths are stored, the base URL is the same for every image.
+
+- (NSURL *)url
+{
+    return LRTVDBImageURLForPath(self.path);
+}
+
+- (void)setUrl:(NSURL *)url
+{
+    self.path = LRTVDBImagePathForURL(url);
+}
+
+- (NSURL *)thumbnailURL
+{
+    return LRTVDBImageURLForPath(self.thumbnailPath);
+}
+
+- (void)setThumbnailURL:(NSURL *)thumbnailURL
+{
+    self.thumbnailPath = LRTVDBImagePathForURL(thumbnailURL);
+}
+
 #pragma mark - Update image
 
-- (void)updateWithImage:(LRTVDBImage *)updatedImage
+- (BOOL)updateWithImage:(LRTVDBImage *)updatedImage
 {
-    if (updatedImage == nil) return;
+    if (updatedImage == nil) return NO;
     
     NSAssert([self isEqual:updatedImage], @"Trying to update image with one with different url?");
     
-    self.url = updatedImage.url;
-    self.thumbnailURL = updatedImage.thumbnailURL;
-    self.rating = updatedImage.rating;
-    self.ratingCount = updatedImage.ratingCount;
-    self.type = updatedImage.type;
+    BOOL hasChanged = (LRTVDBValuesDiffer(self.thumbnailPath, updatedImage.thumbnailPath) ||
+                       LRTVDBValuesDiffer(self.rating, updatedImage.rating) ||
+                       LRTVDBValuesDiffer(self.ratingCount, updatedImage.ratingCount) ||
+                       self.type != updatedImage.type ||
+                       LRTVDBValuesDiffer(self.seasonNumber, updatedImage.seasonNumber));
+    
+    if (hasChanged)
+    {
+        self.path = updatedImage.path;
+        self.thumbnailPath = updatedImage.thumbnailPath;
+        self.rating = updatedImage.rating;
+        self.ratingCount = updatedImage.ratingCount;
+        self.type = updatedImage.type;
+        self.seasonNumber = updatedImage.seasonNumber;
+    }
+    
+    return hasChanged;
+}
+
+#pragma mark - Memory size
+
+- (size_t)memorySize
+{
+    return (LRTVDBMallocSize(self) + LRTVDBMallocSize(self.path) + LRTVDBMallocSize(self.thumbnailPath) +
+            LRTVDBMallocSize(self.rating) + LRTVDBMallocSize(self.ratingCount) + LRTVDBMallocSize(self.seasonNumber));
 }
 
 #pragma mark - LRTVDBSerializableModelProtocol
@@ -95,15 +154,15 @@ NSComparator LRTVDBImageComparator = ^NSComparisonResult(LRTVDBImage *firstImage
     id url = LREmptyStringToNil(dictionary[kImageURLKey]);
     CHECK_NIL(url, @"url", *error);
     CHECK_TYPE(url, [NSString class], @"url", *error);
-    image.url = [NSURL URLWithString:url];
+    image.path = LRTVDBImagePathForURLString(url);
     
     id thumbnailURL = LREmptyStringToNil(dictionary[kImageThumbnailURLKey]);
     CHECK_TYPE(thumbnailURL, [NSString class], @"thumbnailURL", *error);
-    image.thumbnailURL = [NSURL URLWithString:thumbnailURL];
+    image.thumbnailPath = LRTVDBImagePathForURLString(thumbnailURL);
     
     id rating = LREmptyStringToNil(dictionary[kImageRatingKey]);
     CHECK_TYPE(rating, [NSNumber class], @"rating", *error);
-    image.rating = rating;
+    image.rating = rating ? @(LRTVDBRatingValue(rating)) : nil;
 
     id ratingCount = LREmptyStringToNil(dictionary[kImageRatingCountKey]);
     CHECK_TYPE(ratingCount, [NSNumber class], @"ratingCount", *error);
@@ -113,19 +172,92 @@ NSComparator LRTVDBImageComparator = ^NSComparisonResult(LRTVDBImage *firstImage
     CHECK_TYPE(imageType, [NSNumber class], @"imageType", *error);
     image.type = [imageType unsignedIntegerValue];
     
+    id seasonNumber = LREmptyStringToNil(dictionary[kImageSeasonNumberKey]);
+    CHECK_TYPE(seasonNumber, [NSNumber class], @"seasonNumber", *error);
+    image.seasonNumber = seasonNumber;
+    
     return image;
 }
 
 - (NSDictionary *)serialize
 {
-    return @{ kImageURLKey : LRNilToEmptyString([self.url absoluteString]),
-              kImageThumbnailURLKey : LRNilToEmptyString([self.thumbnailURL absoluteString]),
+    return @{ kImageURLKey : LRNilToEmptyString(self.path),
+              kImageThumbnailURLKey : LRNilToEmptyString(self.thumbnailPath),
               kImageRatingKey : LRNilToEmptyString(self.rating),
               kImageRatingCountKey : LRNilToEmptyString(self.ratingCount),
-              kImageTypeKey : @(self.type)
+              kImageTypeKey : @(self.type),
+              kImageSeasonNumberKey : LRNilToEmptyString(self.seasonNumber)
             };
 }
 
++ (NSUInteger)binarySchemaVersion
+{
+    return kImageBinarySchemaVersion;
+}
+
++ (LRTVDBImage *)decodeWithDecoder:(LRTVDBBinaryDecoder *)decoder
+{
+    LRTVDBImage *image = [[LRTVDBImage alloc] init];
+    
+    // Earlier records encode whole URLs.
+    BOOL encodesPaths = (decoder.recordSchemaVersion >= kLRTVDBImagePathsSchemaVersion);
+    
+    LRTVDBBinaryTag tag;
+    
+    while ([decoder decodeNextFieldTag:&tag])
+    {
+        switch (tag)
+        {
+            case kImageURLTag:
+                image.path = encodesPaths ? [decoder decodeString] : LRTVDBImagePathForURLString([decoder decodeString]);
+                break;
+            case kImageThumbnailURLTag:
+                image.thumbnailPath = encodesPaths ? [decoder decodeString] : LRTVDBImagePathForURLString([decoder decodeString]);
+                break;
+            case kImageRatingTag:
+                image.rating = @([decoder decodeDouble]);
+                break;
+            case kImageRatingCountTag:
+                image.ratingCount = @([decoder decodeInteger]);
+                break;
+            case kImageTypeTag:
+                image.type = (LRTVDBImageType)[decoder decodeUnsignedInteger];
+                break;
+            case kImageSeasonNumberTag:
+                image.seasonNumber = @([decoder decodeInteger]);
+                break;
+            default:
+                [decoder skipField];
+                break;
+        }
+    }
+    
+    return image.path ? image : nil;
+}
+
+- (void)encodeWithEncoder:(LRTVDBBinaryEncoder *)encoder
+{
+    [encoder encodeString:self.path forTag:kImageURLTag];
+    [encoder encodeString:self.thumbnailPath forTag:kImageThumbnailURLTag];
+    
+    if (self.rating)
+    {
+        [encoder encodeDouble:LRTVDBRatingValue(self.rating) forTag:kImageRatingTag];
+    }
+    
+    if (self.ratingCount)
+    {
+        [encoder encodeInteger:[self.ratingCount longLongValue] forTag:kImageRatingCountTag];
+    }
+    
+    [encoder encodeUnsignedInteger:self.type forTag:kImageTypeTag];
+    
+    if (self.seasonNumber)
+    {
+        [encoder encodeInteger:[self.seasonNumber longLongValue] forTag:kImageSeasonNumberTag];
+    }
+}
+
 #pragma mark - Equality methods
 
 - (BOOL)isEqual:(id)object
@@ -136,13 +268,13 @@ NSComparator LRTVDBImageComparator = ^NSComparisonResult(LRTVDBImage *firstImage
     }
     else
     {
-        return [self.url isEqual:[(LRTVDBImage *)object url]];
+        return [self.path isEqualToString:[(LRTVDBImage *)object path]];
     }
 }
 
 - (NSUInteger)hash
 {
-    return [self.url hash];
+    return [self.path hash];
 }
 
 - (NSComparisonResult)compare:(id)object
@@ -154,8 +286,8 @@ NSComparator LRTVDBImageComparator = ^NSComparisonResult(LRTVDBImage *firstImage
 
 - (NSString *)description
 {
-    return [NSString stringWithFormat:@"\nURL: %@\nThumbnail URL: %@\nRating: %@\nRating Count: %@\nType: %d\n",
-            self.url, self.thumbnailURL, self.rating, self.ratingCount, self.type];
+    return [NSString stringWithFormat:@"\nURL: %@\nThumbnail URL: %@\nRating: %@\nRating Count: %@\nType: %d\nSeason: %@\n",
+            self.url, self.thumbnailURL, self.rating, self.ratingCount, self.type, self.seasonNumber];
 }
 
 @end
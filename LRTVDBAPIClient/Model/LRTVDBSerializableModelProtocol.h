@@ -33,6 +33,12 @@ NS_INLINE id LREmptyStringToNil(id obj)
     return [obj isEqual:@""] ? nil : obj;
 }
 
+// Model updates
+NS_INLINE BOOL LRTVDBValuesDiffer(id value, id otherValue)
+{
+    return value != otherValue && ![value isEqual:otherValue];
+}
+
 static NSString *const kPlistTypeErrorDomain = @"kPlistTypeErrorDomain";
 static NSString *const kPlistTypeErrorKeyName = @"kPlistTypeErrorKeyName";
 
@@ -70,9 +76,26 @@ return nil; \
 } \
 }
 
+@class LRTVDBBinaryEncoder;
+@class LRTVDBBinaryDecoder;
+
 @protocol LRTVDBSerializableModelProtocol <NSObject>
 
 + (id<LRTVDBSerializableModelProtocol>)deserialize:(NSDictionary *)dictionary error:(NSError **)error;
 - (NSDictionary *)serialize;
 
+/**
+ Version of the fields written by encodeWithEncoder:. It must be increased
+ whenever the meaning of an existing tag changes.
+ @see LRTVDBBinaryDecoder recordSchemaVersion.
+ */
++ (NSUInteger)binarySchemaVersion;
+
+/**
+ @return A new instance with the fields of the current record of the decoder,
+ nil if the record is not valid.
+ */
++ (id<LRTVDBSerializableModelProtocol>)decodeWithDecoder:(LRTVDBBinaryDecoder *)decoder;
+- (void)encodeWithEncoder:(LRTVDBBinaryEncoder *)encoder;
+
 @end
@@ -32,6 +32,32 @@ typedef NS_ENUM(NSUInteger, LRTVDBShowBasicStatus)
     LRTVDBShowBasicStatusEnded,
 };
 
+/**
+ Sections a show is persisted in.
+ */
+typedef NS_OPTIONS(uint32_t, LRTVDBShowSection)
+{
+    LRTVDBShowSectionInfo = 1 << 0,
+    LRTVDBShowSectionEpisodes = 1 << 1,
+    LRTVDBShowSectionImages = 1 << 2,
+    LRTVDBShowSectionActors = 1 << 3,
+    LRTVDBShowSectionAll = (LRTVDBShowSectionInfo | LRTVDBShowSectionEpisodes |
+                            LRTVDBShowSectionImages | LRTVDBShowSectionActors),
+};
+
+/**
+ Source of the persisted relationships of a show which haven't been decoded yet.
+ */
+@protocol LRTVDBShowRelationshipsProvider <NSObject>
+
+/**
+ @return The serialized episodes, images and actors sections of the show
+ (see serializeSection:), merged in a single dictionary.
+ */
+- (NSDictionary *)serializedRelationshipsForShow:(LRTVDBShow *)show;
+
+@end
+
 @interface LRTVDBShow (Private)
 
 @property (nonatomic, copy) NSString *showID;
@@ -52,7 +78,13 @@ typedef NS_ENUM(NSUInteger, LRTVDBShowBasicStatus)
 @property (nonatomic, copy) NSArray *actorsNames;
 @property (nonatomic) LRTVDBShowBasicStatus basicStatus;
 
-@property (nonatomic, strong) NSMutableArray *seenEpisodes;
+/**
+ Fingerprints of the downloaded data the show was last updated from: show
+ info (along with its episodes), images and actors. nil if unknown.
+ */
+@property (nonatomic, strong) NSNumber *infoFingerprint;
+@property (nonatomic, strong) NSNumber *imagesFingerprint;
+@property (nonatomic, strong) NSNumber *actorsFingerprint;
 
 /**
  Methods to manage relationships.
@@ -63,18 +95,122 @@ typedef NS_ENUM(NSUInteger, LRTVDBShowBasicStatus)
 
 /**
  Updates a show.
+ @discussion Sections whose fingerprint hasn't changed since the last update
+ are skipped, so no property is reassigned and no KVO notification is fired.
+ @return The number of skipped sections.
  */
-- (void)updateWithShow:(LRTVDBShow *)updatedShow
-        updateEpisodes:(BOOL)updateEpisodes
-          updateImages:(BOOL)updateImages
-          updateActors:(BOOL)updateActors
-        replaceArtwork:(BOOL)replaceArtwork;
+- (NSUInteger)updateWithShow:(LRTVDBShow *)updatedShow
+              updateEpisodes:(BOOL)updateEpisodes
+                updateImages:(BOOL)updateImages
+                updateActors:(BOOL)updateActors
+              replaceArtwork:(BOOL)replaceArtwork;
+
+/**
+ Serializes a single section of the show.
+ @discussion The dictionaries of every section, once merged, are the
+ serialize dictionary, which is what deserialize:error: expects.
+ */
+- (NSDictionary *)serializeSection:(LRTVDBShowSection)section;
+
+/**
+ @param serializedEpisodes Serialized LRTVDBEpisode objects.
+ @return The episodes section (see serializeSection:) with the provided episodes.
+ */
++ (NSDictionary *)serializedEpisodesSectionWithEpisodes:(NSArray *)serializedEpisodes;
+
+/**
+ Marks sections as changed since they were last persisted.
+ @discussion New shows have every section dirty. Merges, updates and seen
+ status changes mark the sections they change.
+ */
+- (void)markSectionsAsDirty:(LRTVDBShowSection)sections;
+
+/**
+ @return The dirty sections, clearing them atomically.
+ */
+- (LRTVDBShowSection)takeDirtySections;
+
+/**
+ Runs the block while no merge or update can change the show, so everything
+ the block reads comes from the same state of the show.
+ @remarks The block must not block on other shows.
+ */
+- (void)performBlockWithConsistentState:(void (^)(void))block;
+
+/**
+ Takes the dirty sections and serializes them, along with the provided
+ extra sections, while no merge or update can change the show.
+ @discussion Every serialized section comes from the same state of the show,
+ so they can be written while other queues keep merging into it.
+ @param dirtySections On return, the taken dirty sections.
+ @return Serialized sections (see serializeSection:) keyed by section.
+ */
+- (NSDictionary *)serializedSectionsByTakingDirtySections:(LRTVDBShowSection *)dirtySections
+                                            extraSections:(LRTVDBShowSection)extraSections;
+
+/**
+ Turns the relationships of the show into a fault.
+ @discussion Episodes, images and actors are decoded from the provider the
+ first time any of them (or any episode derived from them) is accessed,
+ from whatever thread it's accessed. Values computed from the summary of the
+ episodes persisted with the info section (status, daysToNextEpisode,
+ numberOfSeasons and the sort key) don't fulfill it. Faulting doesn't mark
+ any section as dirty.
+ */
+- (void)setRelationshipsFaultWithProvider:(id<LRTVDBShowRelationshipsProvider>)provider;
+
+@property (nonatomic, readonly, getter = isRelationshipsFault) BOOL relationshipsFault;
+
+/**
+ Turns the loaded relationships of the show back into a fault, releasing
+ the episodes, images and actors until they're accessed again.
+ @discussion Only relationships whose sections aren't dirty can be evicted,
+ since they're reloaded from the provider as they were persisted. Episodes,
+ images and actors observers are notified of a setting change both when
+ they're evicted and when they're reloaded. Derived values are computed from
+ the episodes summary afterwards (see setRelationshipsFaultWithProvider:),
+ so reading status doesn't reload anything, while lastEpisode, nextEpisode
+ and activeEpisode are dropped and reload the episodes. Seen status changes
+ made to episodes read before the eviction are forwarded to the reloaded
+ ones.
+ @remarks Observers aren't notified by this method, so they're never called
+ with the show locked. Callers bracket it with willEvictRelationships and
+ didEvictRelationships instead.
+ @return YES if the relationships have been evicted.
+ */
+- (BOOL)evictRelationshipsWithProvider:(id<LRTVDBShowRelationshipsProvider>)provider;
+
+/**
+ Notifies episodes, images and actors observers of the eviction of the
+ relationships (see evictRelationshipsWithProvider:). Must be called out of
+ any lock or queue the eviction is serialized with, since observers may
+ read the show.
+ */
+- (void)willEvictRelationships;
+- (void)didEvictRelationships;
+
+/**
+ Access period (see beginRelationshipsAccessPeriod) in which the
+ relationships of the show were last read.
+ */
+@property (nonatomic, readonly) uint32_t relationshipsAccessPeriod;
+
+/**
+ Starts a new relationships access period. Shows read from now on record
+ the new period, so shows whose relationships haven't been read since any
+ given call can be told apart cheaply.
+ @return The period that has just finished.
+ */
++ (uint32_t)beginRelationshipsAccessPeriod;
 
 /**
  Recomputes next episode to be watched
  */
 - (void)reloadActiveEpisode;
 
+/**
+ Updates the seen state of the show after the episode seen status changes. O(1).
+ */
 - (void)seenStatusDidChangeForEpisode:(LRTVDBEpisode *)episode;
 
 @end
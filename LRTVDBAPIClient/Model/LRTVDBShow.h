@@ -21,6 +21,7 @@
 // THE SOFTWARE.
 
 #import "LRTVDBSerializableModelProtocol.h"
+#import "LRTVDBImage.h"
 
 /**
  Show comparison block.
@@ -52,6 +53,27 @@ typedef NS_ENUM(NSInteger, LRTVDBShowStatus)
     LRTVDBShowStatusEnded, /** Show no longer airs. */
 };
 
+/**
+ Estimated heap bytes used by a show, by section (see memoryUsage).
+ */
+typedef struct
+{
+    size_t info; /** The show itself and its basic properties. */
+    size_t episodes; /** Episodes, along with their index. */
+    size_t images;
+    size_t actors;
+} LRTVDBShowMemoryUsage;
+
+NS_INLINE size_t LRTVDBShowMemoryUsageTotal(LRTVDBShowMemoryUsage memoryUsage)
+{
+    return memoryUsage.info + memoryUsage.episodes + memoryUsage.images + memoryUsage.actors;
+}
+
+NS_INLINE size_t LRTVDBShowMemoryUsageRelationships(LRTVDBShowMemoryUsage memoryUsage)
+{
+    return memoryUsage.episodes + memoryUsage.images + memoryUsage.actors;
+}
+
 @class LRTVDBEpisode;
 
 @interface LRTVDBShow : NSObject <LRTVDBSerializableModelProtocol>
@@ -170,6 +192,21 @@ typedef NS_ENUM(NSInteger, LRTVDBShowStatus)
 @property (nonatomic, copy, readonly) NSArray *seasonImages;
 @property (nonatomic, copy, readonly) NSArray *bannerImages;
 
+/**
+ @return The best rated images of the type, at most count of them.
+ */
+- (NSArray *)bestImagesOfType:(LRTVDBImageType)type count:(NSUInteger)count;
+
+/**
+ @return The best rated image of the type, nil if none.
+ */
+- (LRTVDBImage *)bestImageOfType:(LRTVDBImageType)type;
+
+/**
+ @return The best rated season image of the season, nil if none.
+ */
+- (LRTVDBImage *)bestImageForSeason:(NSNumber *)seasonNumber;
+
 /** Array of LRTVDBActor instances. */
 @property (nonatomic, copy, readonly) NSArray *actors;
 
@@ -182,19 +219,47 @@ typedef NS_ENUM(NSInteger, LRTVDBShowStatus)
  */
 - (NSArray *)episodesForSeason:(NSNumber *)seasonNumber;
 
+/**
+ @return The number of seen episodes of the season.
+ */
+- (NSUInteger)numberOfSeenEpisodesForSeason:(NSNumber *)seasonNumber;
+
+/**
+ @return The average rating of the rated episodes of the season, nil if none.
+ */
+- (NSNumber *)averageRatingForSeason:(NSNumber *)seasonNumber;
+
+/**
+ Marks several episodes as seen or not seen at once.
+ @param seen The new seen status.
+ @param range Range of the episodes in the episodes array.
+ @discussion Active episode and number of episodes behind are only
+ recomputed once, after every episode has been marked.
+ */
+- (void)setSeen:(BOOL)seen forEpisodesInRange:(NSRange)range;
+
 /**
  Refreshes episodes information about a show.
  
- @discussion lastEpisode, nextEpisode and daysToNextEpisode depend on the
- current date ([NSDate date]). One valid option could be computing this values
- in the corresponding lazy getters without caching anything. Thus,
- [NSDate date] would be different and so would be last and
- next episode. As this values are very common to be shown in tableViews,
- it's not a good idea to compute them every time while the user is scrolling due
- to performance-wise reasons (even if this time is not that big).
- So, if this values need to be updated/refreshed, this method clears the cache
- and updates them based on the new [NSDate date] value.
+ @discussion lastEpisode, nextEpisode, daysToNextEpisode, status and the active
+ episode depend on the current day. They're cached, as they're very common to be
+ shown in tableViews, along with the day they were computed for. When any of them
+ is read after the day rolls over, the whole episodes information is refreshed
+ first, so there's usually no need to call this method.
+ @remarks Thread safe. Values are refreshed under the same lock as merges and
+ published at once, readers never see them half refreshed.
  */
 - (void)refreshEpisodesInfomation;
 
+/**
+ Estimated heap bytes used by the show and by each of its relationships.
+ 
+ @discussion Objects are measured with malloc_size. Strings interned across
+ shows aren't counted, and relationships which haven't been loaded from the
+ persistence store (see LRTVDBRelationshipsCache) use no memory at all.
+ Reading this doesn't load them. O(n) in the number of episodes, images and
+ actors.
+ */
+@property (nonatomic, readonly) LRTVDBShowMemoryUsage memoryUsage;
+
 @end
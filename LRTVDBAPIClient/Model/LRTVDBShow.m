@@ -25,50 +25,393 @@
 #import "LRTVDBImage+Private.h"
 #import "LRTVDBActor+Private.h"
 #import "NSDate+LRTVDBAdditions.h"
+#import "LRTVDBStringInterner.h"
+#import "LRTVDBEpisodeIndex.h"
+#import "LRTVDBArtworkIndex.h"
+#import "LRTVDBBitSet.h"
+#import "NSArray+LRTVDBAdditions.h"
+#import "LRTVDBBinaryCodec.h"
+#import "LRTVDBAPIClient+Private.h"
+#import <libkern/OSAtomic.h>
+#import <pthread.h>
 
 #pragma mark - LRUpdate categories
 
 @interface LRTVDBEpisode (LRUpdate)
 
-- (void)updateWithObject:(LRTVDBEpisode *)episode;
+- (BOOL)updateWithObject:(LRTVDBEpisode *)episode;
 
 @end
 
 @interface LRTVDBImage (LRUpdate)
 
-- (void)updateWithObject:(LRTVDBImage *)image;
+- (BOOL)updateWithObject:(LRTVDBImage *)image;
 
 @end
 
 @interface LRTVDBActor (LRUpdate)
 
-- (void)updateWithObject:(LRTVDBActor *)actor;
+- (BOOL)updateWithObject:(LRTVDBActor *)actor;
 
 @end
 
 @implementation LRTVDBEpisode (LRUpdate)
 
-- (void)updateWithObject:(LRTVDBEpisode *)episode
+- (BOOL)updateWithObject:(LRTVDBEpisode *)episode
 {
-    [self updateWithEpisode:episode];
+    return [self updateWithEpisode:episode];
 }
 
 @end
 
 @implementation LRTVDBImage (LRUpdate)
 
-- (void)updateWithObject:(LRTVDBImage *)image
+- (BOOL)updateWithObject:(LRTVDBImage *)image
 {
-    [self updateWithImage:image];
+    return [self updateWithImage:image];
 }
 
 @end
 
 @implementation LRTVDBActor (LRUpdate)
 
-- (void)updateWithObject:(LRTVDBActor *)actor
+- (BOOL)updateWithObject:(LRTVDBActor *)actor
 {
-    [self updateWithActor:actor];
+    return [self updateWithActor:actor];
+}
+
+@end
+
+#pragma mark - LRTVDBMergeResult
+
+/**
+ Changes produced by merging a batch of objects into the current ones.
+ @discussion removedIndexes refer to the current objects. insertedIndexes and
+ updatedIndexes refer to the merged objects, once the removals have been applied.
+ When current objects change their relative order, indexes can't describe the
+ change and requiresReload is YES.
+ */
+@interface LRTVDBMergeResult : NSObject
+
+@property (nonatomic, copy) NSArray *objects;
+@property (nonatomic, strong) NSMutableIndexSet *insertedIndexes;
+@property (nonatomic, strong) NSMutableIndexSet *updatedIndexes;
+@property (nonatomic, strong) NSMutableIndexSet *removedIndexes;
+@property (nonatomic) BOOL requiresReload;
+
+- (BOOL)hasChanges;
+
+@end
+
+@implementation LRTVDBMergeResult
+
+- (id)init
+{
+    if (self = [super init])
+    {
+        _insertedIndexes = [NSMutableIndexSet indexSet];
+        _updatedIndexes = [NSMutableIndexSet indexSet];
+        _removedIndexes = [NSMutableIndexSet indexSet];
+    }
+    return self;
+}
+
+- (BOOL)hasChanges
+{
+    return (self.requiresReload || [self.insertedIndexes count] > 0 ||
+            [self.updatedIndexes count] > 0 || [self.removedIndexes count] > 0);
+}
+
+@end
+
+#pragma mark - LRTVDBShowSnapshot
+
+/**
+ Immutable relationships of a show at a given point in time.
+ @discussion Writers build a new snapshot and publish it, so readers never
+ see a merge in progress and never wait for it to finish.
+ */
+@interface LRTVDBShowSnapshot : NSObject
+
+@property (nonatomic, copy, readonly) NSArray *episodes;
+@property (nonatomic, strong, readonly) LRTVDBEpisodeIndex *episodeIndex;
+@property (nonatomic, copy, readonly) NSArray *images;
+@property (nonatomic, strong, readonly) LRTVDBArtworkIndex *artworkIndex;
+@property (nonatomic, copy, readonly) NSArray *actors;
+
+- (id)initWithEpisodes:(NSArray *)episodes
+          episodeIndex:(LRTVDBEpisodeIndex *)episodeIndex
+                images:(NSArray *)images
+          artworkIndex:(LRTVDBArtworkIndex *)artworkIndex
+                actors:(NSArray *)actors;
+
+@end
+
+@implementation LRTVDBShowSnapshot
+
+- (id)initWithEpisodes:(NSArray *)episodes
+          episodeIndex:(LRTVDBEpisodeIndex *)episodeIndex
+                images:(NSArray *)images
+          artworkIndex:(LRTVDBArtworkIndex *)artworkIndex
+                actors:(NSArray *)actors
+{
+    if (self = [super init])
+    {
+        _episodes = [episodes copy];
+        _episodeIndex = episodeIndex;
+        _images = [images copy];
+        _artworkIndex = artworkIndex;
+        _actors = [actors copy];
+    }
+    return self;
+}
+
+@end
+
+#pragma mark - LRTVDBShowEpisodesInformation
+
+// Episodes summary keys
+static NSString *const kEpisodesSummaryDayNumberKey = @"kEpisodesSummaryDayNumberKey";
+static NSString *const kEpisodesSummaryNumberOfEpisodesKey = @"kEpisodesSummaryNumberOfEpisodesKey";
+static NSString *const kEpisodesSummaryFirstEpisodeIndexKey = @"kEpisodesSummaryFirstEpisodeIndexKey";
+static NSString *const kEpisodesSummaryLastEpisodeIndexKey = @"kEpisodesSummaryLastEpisodeIndexKey";
+static NSString *const kEpisodesSummaryNumberOfSeasonsKey = @"kEpisodesSummaryNumberOfSeasonsKey";
+static NSString *const kEpisodesSummaryUpcomingEpisodesKey = @"kEpisodesSummaryUpcomingEpisodesKey";
+
+/**
+ Values derived from the episodes of a show on a given day.
+ @discussion Immutable as well. They're computed under the write lock of the
+ show and published as a whole, so readers never write them and never see
+ them half refreshed.
+ 
+ Along with them goes a summary of the episodes, persisted with the info of
+ the show, from which they can be computed again for any later day without
+ the episodes themselves. Information computed that way has no episodes.
+ */
+@interface LRTVDBShowEpisodesInformation : NSObject
+
+@property (nonatomic, readonly) LRTVDBDayNumber dayNumber;
+@property (nonatomic, copy, readonly) NSArray *episodes;
+@property (nonatomic, copy, readonly) NSDictionary *summary;
+@property (nonatomic, readonly) NSUInteger firstEpisodeIndex;
+@property (nonatomic, readonly) NSUInteger lastEpisodeIndex;
+@property (nonatomic, readonly) NSUInteger nextEpisodeIndex;
+@property (nonatomic, strong, readonly) NSNumber *daysToNextEpisode;
+@property (nonatomic, strong, readonly) NSNumber *numberOfSeasons;
+@property (nonatomic, readonly) LRTVDBShowStatus status;
+
+- (id)initWithEpisodeIndex:(LRTVDBEpisodeIndex *)episodeIndex
+               basicStatus:(LRTVDBShowBasicStatus)basicStatus
+                 dayNumber:(LRTVDBDayNumber)dayNumber;
+
+/**
+ @return nil if the summary is malformed or was made after the given day.
+ */
+- (id)initWithSummary:(NSDictionary *)summary
+          basicStatus:(LRTVDBShowBasicStatus)basicStatus
+            dayNumber:(LRTVDBDayNumber)dayNumber;
+
+- (LRTVDBEpisode *)firstEpisode;
+- (LRTVDBEpisode *)lastEpisode;
+- (LRTVDBEpisode *)nextEpisode;
+
+@end
+
+@implementation LRTVDBShowEpisodesInformation
+
+- (id)initWithEpisodeIndex:(LRTVDBEpisodeIndex *)episodeIndex
+               basicStatus:(LRTVDBShowBasicStatus)basicStatus
+                 dayNumber:(LRTVDBDayNumber)dayNumber
+{
+    if (self = [super init])
+    {
+        NSArray *episodes = episodeIndex.episodes;
+        NSUInteger numberOfEpisodes = [episodes count];
+        
+        _dayNumber = dayNumber;
+        _episodes = [episodes copy];
+        _firstEpisodeIndex = _lastEpisodeIndex = _nextEpisodeIndex = NSNotFound;
+        _status = LRTVDBShowStatusUnknown;
+        
+        if (numberOfEpisodes == 0)
+        {
+            _summary = @{ kEpisodesSummaryDayNumberKey: @(dayNumber),
+                          kEpisodesSummaryNumberOfEpisodesKey: @0,
+                          kEpisodesSummaryFirstEpisodeIndexKey: @(NSNotFound),
+                          kEpisodesSummaryLastEpisodeIndexKey: @(NSNotFound),
+                          kEpisodesSummaryUpcomingEpisodesKey: @[],
+                        };
+            return self;
+        }
+        
+        const LRTVDBDayNumber *airedDayNumbers = [episodeIndex airedDayNumbers];
+        
+        // First episode (addEpisodes: guarantees there's at least one)
+        _firstEpisodeIndex = episodeIndex.firstRegularEpisodeIndex;
+        
+        // Last episode
+        NSUInteger lastEpisodeAiredIndex = [episodeIndex indexOfLastEpisodeAiredBeforeDay:dayNumber];
+        
+        _lastEpisodeIndex = (basicStatus == LRTVDBShowBasicStatusEnded ? numberOfEpisodes - 1 : lastEpisodeAiredIndex);
+        
+        // Number of seasons
+        _numberOfSeasons = [[episodes lastObject] seasonNumber];
+        
+        // Episodes airing from now on, which are the only ones that can
+        // change the values above on a later day.
+        NSMutableArray *upcomingEpisodes = [NSMutableArray array];
+        
+        for (NSUInteger index = 0; index < numberOfEpisodes; index++)
+        {
+            if (airedDayNumbers[index] != LRTVDBUnknownDayNumber && airedDayNumbers[index] >= dayNumber)
+            {
+                [upcomingEpisodes addObject:@(index)];
+                [upcomingEpisodes addObject:@(airedDayNumbers[index])];
+            }
+        }
+        
+        _summary = @{ kEpisodesSummaryDayNumberKey: @(dayNumber),
+                      kEpisodesSummaryNumberOfEpisodesKey: @(numberOfEpisodes),
+                      kEpisodesSummaryFirstEpisodeIndexKey: @(_firstEpisodeIndex),
+                      kEpisodesSummaryLastEpisodeIndexKey: @(lastEpisodeAiredIndex),
+                      kEpisodesSummaryNumberOfSeasonsKey: LRNilToEmptyString(_numberOfSeasons),
+                      kEpisodesSummaryUpcomingEpisodesKey: upcomingEpisodes,
+                    };
+        
+        [self computeNextEpisodeWithNumberOfEpisodes:numberOfEpisodes
+                                         basicStatus:basicStatus
+                                     airedDayNumbers:^LRTVDBDayNumber(NSUInteger index) {
+                                         return airedDayNumbers[index];
+                                     }];
+    }
+    return self;
+}
+
+- (id)initWithSummary:(NSDictionary *)summary
+          basicStatus:(LRTVDBShowBasicStatus)basicStatus
+            dayNumber:(LRTVDBDayNumber)dayNumber
+{
+    if (![summary isKindOfClass:[NSDictionary class]]) return nil;
+    
+    id summaryDayNumber = summary[kEpisodesSummaryDayNumberKey];
+    id numberOfEpisodes = summary[kEpisodesSummaryNumberOfEpisodesKey];
+    id firstEpisodeIndex = summary[kEpisodesSummaryFirstEpisodeIndexKey];
+    id lastEpisodeIndex = summary[kEpisodesSummaryLastEpisodeIndexKey];
+    id numberOfSeasons = LREmptyStringToNil(summary[kEpisodesSummaryNumberOfSeasonsKey]);
+    id upcomingEpisodes = summary[kEpisodesSummaryUpcomingEpisodesKey];
+    
+    if (![summaryDayNumber isKindOfClass:[NSNumber class]] ||
+        ![numberOfEpisodes isKindOfClass:[NSNumber class]] ||
+        ![firstEpisodeIndex isKindOfClass:[NSNumber class]] ||
+        ![lastEpisodeIndex isKindOfClass:[NSNumber class]] ||
+        (numberOfSeasons && ![numberOfSeasons isKindOfClass:[NSNumber class]]) ||
+        ![upcomingEpisodes isKindOfClass:[NSArray class]] || [upcomingEpisodes count] % 2 != 0 ||
+        dayNumber < [summaryDayNumber integerValue])
+    {
+        return nil;
+    }
+    
+    if (self = [super init])
+    {
+        _dayNumber = dayNumber;
+        _summary = [summary copy];
+        _firstEpisodeIndex = _lastEpisodeIndex = _nextEpisodeIndex = NSNotFound;
+        _status = LRTVDBShowStatusUnknown;
+        
+        if ([numberOfEpisodes unsignedIntegerValue] == 0) return self;
+        
+        _firstEpisodeIndex = [firstEpisodeIndex unsignedIntegerValue];
+        _numberOfSeasons = numberOfSeasons;
+        
+        // Last episode: the one aired last when the summary was made, unless
+        // an upcoming one has aired since then.
+        _lastEpisodeIndex = [lastEpisodeIndex unsignedIntegerValue];
+        
+        for (NSUInteger i = 0; i < [upcomingEpisodes count]; i += 2)
+        {
+            NSUInteger index = [upcomingEpisodes[i] unsignedIntegerValue];
+            
+            if ([upcomingEpisodes[i + 1] integerValue] < dayNumber &&
+                (_lastEpisodeIndex == NSNotFound || index > _lastEpisodeIndex))
+            {
+                _lastEpisodeIndex = index;
+            }
+        }
+        
+        if (basicStatus == LRTVDBShowBasicStatusEnded)
+        {
+            _lastEpisodeIndex = [numberOfEpisodes unsignedIntegerValue] - 1;
+        }
+        
+        [self computeNextEpisodeWithNumberOfEpisodes:[numberOfEpisodes unsignedIntegerValue]
+                                         basicStatus:basicStatus
+                                     airedDayNumbers:^LRTVDBDayNumber(NSUInteger index) {
+                                         
+                                         for (NSUInteger i = 0; i < [upcomingEpisodes count]; i += 2)
+                                         {
+                                             if ([upcomingEpisodes[i] unsignedIntegerValue] == index)
+                                             {
+                                                 return [upcomingEpisodes[i + 1] integerValue];
+                                             }
+                                         }
+                                         
+                                         // Aired before the summary was made, or unknown.
+                                         return LRTVDBUnknownDayNumber;
+                                     }];
+    }
+    return self;
+}
+
+/**
+ Next episode, days to it and show status, once the first and last episodes are known.
+ */
+- (void)computeNextEpisodeWithNumberOfEpisodes:(NSUInteger)numberOfEpisodes
+                                   basicStatus:(LRTVDBShowBasicStatus)basicStatus
+                               airedDayNumbers:(LRTVDBDayNumber (^)(NSUInteger index))airedDayNumbers
+{
+    // Next episode
+    _nextEpisodeIndex = _lastEpisodeIndex == NSNotFound ? _firstEpisodeIndex : _lastEpisodeIndex + 1;
+    
+    if (_nextEpisodeIndex >= numberOfEpisodes) _nextEpisodeIndex = NSNotFound;
+    
+    // Days to next episode
+    LRTVDBDayNumber nextEpisodeDayNumber = (_nextEpisodeIndex != NSNotFound ?
+                                            airedDayNumbers(_nextEpisodeIndex) :
+                                            LRTVDBUnknownDayNumber);
+    
+    _daysToNextEpisode = (nextEpisodeDayNumber == LRTVDBUnknownDayNumber ?
+                          @(NSIntegerMax) : @(nextEpisodeDayNumber - _dayNumber));
+    
+    // Show status
+    if (basicStatus == LRTVDBShowBasicStatusEnded)
+    {
+        _status = LRTVDBShowStatusEnded;
+    }
+    else if (basicStatus == LRTVDBShowBasicStatusContinuing)
+    {
+        _status = [_daysToNextEpisode isEqualToNumber:@(NSIntegerMax)] ?
+                  LRTVDBShowStatusTBA : LRTVDBShowStatusUpcoming;
+    }
+}
+
+- (LRTVDBEpisode *)episodeAtIndex:(NSUInteger)index
+{
+    return index < [_episodes count] ? _episodes[index] : nil;
+}
+
+- (LRTVDBEpisode *)firstEpisode
+{
+    return [self episodeAtIndex:_firstEpisodeIndex];
+}
+
+- (LRTVDBEpisode *)lastEpisode
+{
+    return [self episodeAtIndex:_lastEpisodeIndex];
+}
+
+- (LRTVDBEpisode *)nextEpisode
+{
+    return [self episodeAtIndex:_nextEpisodeIndex];
 }
 
 @end
@@ -100,12 +443,39 @@ static NSString *const kShowRuntimeKey = @"kShowRuntimeKey";
 static NSString *const kShowActorsKey = @"kShowActorsKey";
 static NSString *const kShowEpisodesKey = @"kShowEpisodesKey";
 static NSString *const kShowImagesKey = @"kShowImagesKey";
-
-#if OS_OBJECT_USE_OBJC
-#define LRDispatchQueuePropertyModifier strong
-#else
-#define LRDispatchQueuePropertyModifier assign
-#endif
+static NSString *const kShowInfoFingerprintKey = @"kShowInfoFingerprintKey";
+static NSString *const kShowImagesFingerprintKey = @"kShowImagesFingerprintKey";
+static NSString *const kShowActorsFingerprintKey = @"kShowActorsFingerprintKey";
+static NSString *const kShowEpisodesSummaryKey = @"kShowEpisodesSummaryKey";
+
+// Binary codec tags
+static const NSUInteger kShowBinarySchemaVersion = 2;
+static const LRTVDBBinaryTag kShowIDTag = 1;
+static const LRTVDBBinaryTag kShowNameTag = 2;
+static const LRTVDBBinaryTag kShowOverviewTag = 3;
+static const LRTVDBBinaryTag kShowAirDayTag = 4;
+static const LRTVDBBinaryTag kShowAirTimeTag = 5;
+static const LRTVDBBinaryTag kShowFanartURLTag = 6;
+static const LRTVDBBinaryTag kShowBannerURLTag = 7;
+static const LRTVDBBinaryTag kShowPosterURLTag = 8;
+static const LRTVDBBinaryTag kShowPremiereDayNumberTag = 9;
+static const LRTVDBBinaryTag kShowGenresTag = 10;
+static const LRTVDBBinaryTag kShowActorsNamesTag = 11;
+static const LRTVDBBinaryTag kShowImdbIDTag = 12;
+static const LRTVDBBinaryTag kShowNetworkTag = 13;
+static const LRTVDBBinaryTag kShowLanguageTag = 14;
+static const LRTVDBBinaryTag kShowAvailableLanguagesTag = 15;
+static const LRTVDBBinaryTag kShowRatingTag = 16;
+static const LRTVDBBinaryTag kShowRatingCountTag = 17;
+static const LRTVDBBinaryTag kShowBasicStatusTag = 18;
+static const LRTVDBBinaryTag kShowContentRatingTag = 19;
+static const LRTVDBBinaryTag kShowRuntimeTag = 20;
+static const LRTVDBBinaryTag kShowInfoFingerprintTag = 21;
+static const LRTVDBBinaryTag kShowImagesFingerprintTag = 22;
+static const LRTVDBBinaryTag kShowActorsFingerprintTag = 23;
+static const LRTVDBBinaryTag kShowEpisodesTag = 24;
+static const LRTVDBBinaryTag kShowImagesTag = 25;
+static const LRTVDBBinaryTag kShowActorsTag = 26;
 
 const struct LRTVDBShowAttributes LRTVDBShowAttributes = {
     .activeEpisode = @"activeEpisode",
@@ -117,67 +487,59 @@ const struct LRTVDBShowAttributes LRTVDBShowAttributes = {
     .actors = @"actors",
 };
 
-NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, LRTVDBShow *secondShow)
+/** Packed values the shows are sorted by (see compareBySortKeyToShow:). */
+typedef struct
 {
-    // Days to next episode
-    NSNumber *firstShowDaysToNextEpisode = firstShow.daysToNextEpisode ? : @(NSIntegerMax);
-    NSNumber *secondShowDaysToNextEpisode = secondShow.daysToNextEpisode ? : @(NSIntegerMax);
+    uint64_t prefix;
+    double rating;
+    NSUInteger ratingCount;
+} LRTVDBShowSortKey;
+
+@interface LRTVDBShow ()
+{
+    // Seen state, indexed by episode position (see LRTVDBEpisode indexInShow).
+    LRTVDBBitSet *_seenEpisodesBitSet;
+    LRTVDBBitSet *_regularEpisodesBitSet;
+    LRTVDBBitSet *_countedEpisodesBitSet; // Regular episodes with aired date
+    NSArray *_seenStateEpisodes;
+    NSUInteger _numberOfSeenEpisodes; // Seen episodes in _countedEpisodesBitSet
+    OSSpinLock _seenStateLock;
     
-    NSComparisonResult comparisonResult = [firstShowDaysToNextEpisode compare:secondShowDaysToNextEpisode];
+    BOOL _updatingSeenStatusInBatch;
     
-    if (comparisonResult == NSOrderedSame)
-    {
-        // status: unknown status at the end
-        LRTVDBShowStatus firstShowStatus = firstShow.status;
-        LRTVDBShowStatus secondShowStatus = secondShow.status;
-        
-        if (firstShowStatus == LRTVDBShowStatusUnknown) { firstShowStatus = NSIntegerMax; }
-        if (secondShowStatus == LRTVDBShowStatusUnknown) { secondShowStatus = NSIntegerMax; }
-        
-        comparisonResult = [@(firstShowStatus) compare:@(secondShowStatus)];
-        
-        if (comparisonResult == NSOrderedSame)
-        {
-            // Rating
-            NSNumber *firstShowRating = firstShow.rating ? : @(0);
-            NSNumber *secondShowRating = secondShow.rating ? : @(0);
-            comparisonResult = [secondShowRating compare:firstShowRating];
-            
-            if (comparisonResult == NSOrderedSame)
-            {
-                // Rating count
-                NSNumber *firstShowRatingCount = firstShow.ratingCount ? : @(0);
-                NSNumber *secondShowRatingCount = secondShow.ratingCount ? : @(0);
-                comparisonResult = [secondShowRatingCount compare:firstShowRatingCount];
-                
-                if (comparisonResult == NSOrderedSame)
-                {
-                    // Name
-                    if (!secondShow.name && !firstShow.name)
-                    {
-                        comparisonResult = NSOrderedSame;
-                    }
-                    else if (!secondShow.name)
-                    {
-                        comparisonResult = NSOrderedAscending;
-                    }
-                    else if (!firstShow.name)
-                    {
-                        comparisonResult = NSOrderedDescending;
-                    }
-                    else
-                    {
-                        comparisonResult = [firstShow.name compare:secondShow.name options:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)];
-                    }
-                }
-            }
-        }
-    }
+    // Derived episodes information (see refreshEpisodesInformationIfNeeded).
+    // Written under _writeLock, read under _episodesInformationLock.
+    LRTVDBShowEpisodesInformation *_episodesInformation;
+    OSSpinLock _episodesInformationLock;
+    BOOL _refreshingEpisodesInformation;
     
-    return comparisonResult;
-};
-
-@interface LRTVDBShow ()
+    // Serializes relationship merges, updates and persistence snapshots.
+    // Readers don't take it. It's recursive, since merges read the snapshot,
+    // which may fulfill the relationships fault.
+    pthread_mutex_t _writeLock;
+    
+    LRTVDBShowSnapshot *_snapshot;
+    OSSpinLock _snapshotLock;
+    
+    // Relationships fault (see setRelationshipsFaultWithProvider:), guarded by _writeLock.
+    id<LRTVDBShowRelationshipsProvider> _relationshipsProvider;
+    volatile BOOL _relationshipsFault;
+    BOOL _fulfillingRelationshipsFault;
+    
+    // See beginRelationshipsAccessPeriod.
+    volatile uint32_t _relationshipsAccessPeriod;
+    
+    // Sort key (see compareBySortKeyToShow:), guarded by _sortKeyLock, since
+    // shows are sorted from any thread.
+    LRTVDBShowSortKey _sortKey;
+    NSString *_sortKeyName;
+    BOOL _sortKeyNeedsUpdate;
+    uint32_t _sortKeyGeneration;
+    OSSpinLock _sortKeyLock;
+    
+    // Sections changed since they were last persisted (LRTVDBShowSection).
+    volatile uint32_t _dirtySections;
+}
 
 @property (nonatomic, copy) NSString *showID;
 @property (nonatomic, copy) NSString *name;
@@ -193,202 +555,567 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 @property (nonatomic, strong) NSNumber *runtime;
 @property (nonatomic, strong) NSNumber *rating;
 @property (nonatomic, strong) NSNumber *ratingCount;
-@property (nonatomic) LRTVDBShowStatus status;
 @property (nonatomic) LRTVDBShowBasicStatus basicStatus;
 
+@property (nonatomic, strong) NSNumber *infoFingerprint;
+@property (nonatomic, strong) NSNumber *imagesFingerprint;
+@property (nonatomic, strong) NSNumber *actorsFingerprint;
+
 @property (nonatomic, copy) NSArray *genres;
 @property (nonatomic, copy) NSArray *actorsNames;
 
-@property (nonatomic, copy) NSArray *episodes;
-@property (nonatomic, strong) LRTVDBEpisode *firstEpisode;
-@property (nonatomic, strong) LRTVDBEpisode *lastEpisode;
-@property (nonatomic, strong) LRTVDBEpisode *nextEpisode;
-@property (nonatomic, strong) NSNumber *daysToNextEpisode;
-@property (nonatomic, strong) NSNumber *numberOfSeasons;
+@property (nonatomic, strong, readonly) LRTVDBEpisode *firstEpisode;
 
 @property (nonatomic, strong) LRTVDBEpisode *activeEpisode;
 @property (nonatomic, strong) NSNumber *daysToActiveEpisode;
 @property (nonatomic, strong) NSNumber *numberOfEpisodesBehind;
 
-@property (nonatomic, strong) NSMutableArray *seenEpisodes;
 
-@property (nonatomic, copy) NSArray *images;
-@property (nonatomic, copy) NSArray *fanartImages;
-@property (nonatomic, copy) NSArray *posterImages;
-@property (nonatomic, copy) NSArray *seasonImages;
-@property (nonatomic, copy) NSArray *bannerImages;
+/**
+ Current relationships of the show. Reading it is just an atomic load of
+ the pointer (plus a retain), no matter how many merges are going on.
+ */
+@property (nonatomic, strong) LRTVDBShowSnapshot *snapshot;
 
-@property (nonatomic, copy) NSArray *actors;
+- (NSComparisonResult)compareBySortKeyToShow:(LRTVDBShow *)show;
 
-@property (nonatomic, strong) NSMutableDictionary *seasonToEpisodesDictionary;
+@end
 
-@property (nonatomic, LRDispatchQueuePropertyModifier) dispatch_queue_t syncQueue;
+/** Current relationships access period (see beginRelationshipsAccessPeriod). */
+static volatile int32_t sRelationshipsAccessPeriod = 1;
 
-@end
+NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, LRTVDBShow *secondShow)
+{
+    return [firstShow compareBySortKeyToShow:secondShow];
+};
 
 @implementation LRTVDBShow
 
+- (id)init
+{
+    if (self = [super init])
+    {
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&_writeLock, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+        
+        _snapshotLock = OS_SPINLOCK_INIT;
+        _episodesInformationLock = OS_SPINLOCK_INIT;
+        _sortKeyLock = OS_SPINLOCK_INIT;
+        _sortKeyNeedsUpdate = YES;
+        _dirtySections = LRTVDBShowSectionAll;
+    }
+    return self;
+}
+
 - (void)dealloc
 {
-#if !OS_OBJECT_USE_OBJC
-    if (_syncQueue != NULL)
+    pthread_mutex_destroy(&_writeLock);
+}
+
+#pragma mark - Snapshots
+
+- (LRTVDBShowSnapshot *)snapshot
+{
+    [self fulfillRelationshipsFaultIfNeeded];
+    
+    // Only written when the period changes, so readers don't keep writing
+    // to the same cache line.
+    uint32_t accessPeriod = (uint32_t)sRelationshipsAccessPeriod;
+    if (_relationshipsAccessPeriod != accessPeriod) _relationshipsAccessPeriod = accessPeriod;
+    
+    OSSpinLockLock(&_snapshotLock);
+    LRTVDBShowSnapshot *snapshot = _snapshot;
+    OSSpinLockUnlock(&_snapshotLock);
+    
+    // Evicted after the fault was checked. Eviction faults the show before
+    // dropping the snapshot, so the fault is always seen here.
+    if (!snapshot && _relationshipsFault)
+    {
+        [self fulfillRelationshipsFault];
+        
+        OSSpinLockLock(&_snapshotLock);
+        snapshot = _snapshot;
+        OSSpinLockUnlock(&_snapshotLock);
+    }
+    
+    return snapshot;
+}
+
+- (void)setSnapshot:(LRTVDBShowSnapshot *)snapshot
+{
+    OSSpinLockLock(&_snapshotLock);
+    LRTVDBShowSnapshot *oldSnapshot = _snapshot; // Released out of the lock
+    _snapshot = snapshot;
+    OSSpinLockUnlock(&_snapshotLock);
+    
+    oldSnapshot = nil;
+}
+
+- (LRTVDBShowSnapshot *)snapshotByReplacingEpisodes:(NSArray *)episodes
+                                       episodeIndex:(LRTVDBEpisodeIndex *)episodeIndex
+{
+    LRTVDBShowSnapshot *snapshot = self.snapshot;
+    
+    return [[LRTVDBShowSnapshot alloc] initWithEpisodes:episodes
+                                           episodeIndex:episodeIndex
+                                                 images:snapshot.images
+                                           artworkIndex:snapshot.artworkIndex
+                                                 actors:snapshot.actors];
+}
+
+- (LRTVDBShowSnapshot *)snapshotByReplacingImages:(NSArray *)images
+                                     artworkIndex:(LRTVDBArtworkIndex *)artworkIndex
+{
+    LRTVDBShowSnapshot *snapshot = self.snapshot;
+    
+    return [[LRTVDBShowSnapshot alloc] initWithEpisodes:snapshot.episodes
+                                           episodeIndex:snapshot.episodeIndex
+                                                 images:images
+                                           artworkIndex:artworkIndex
+                                                 actors:snapshot.actors];
+}
+
+- (LRTVDBShowSnapshot *)snapshotByReplacingActors:(NSArray *)actors
+{
+    LRTVDBShowSnapshot *snapshot = self.snapshot;
+    
+    return [[LRTVDBShowSnapshot alloc] initWithEpisodes:snapshot.episodes
+                                           episodeIndex:snapshot.episodeIndex
+                                                 images:snapshot.images
+                                           artworkIndex:snapshot.artworkIndex
+                                                 actors:actors];
+}
+
+#pragma mark - Relationships fault
+
+- (void)setRelationshipsFaultWithProvider:(id<LRTVDBShowRelationshipsProvider>)provider
+{
+    pthread_mutex_lock(&_writeLock);
+    
+    _relationshipsProvider = provider;
+    OSMemoryBarrier();
+    _relationshipsFault = (provider != nil);
+    
+    pthread_mutex_unlock(&_writeLock);
+}
+
+- (BOOL)isRelationshipsFault
+{
+    return _relationshipsFault;
+}
+
+/**
+ Must be called before reading anything derived from the relationships
+ which isn't read through the snapshot.
+ */
+- (void)fulfillRelationshipsFaultIfNeeded
+{
+    if (_relationshipsFault)
+    {
+        [self fulfillRelationshipsFault];
+    }
+}
+
+- (void)fulfillRelationshipsFault
+{
+    pthread_mutex_lock(&_writeLock);
+    
+    // The merges below read the snapshot again from this very thread, and
+    // must get the relationships merged so far.
+    if (_relationshipsFault && !_fulfillingRelationshipsFault)
+    {
+        _fulfillingRelationshipsFault = YES;
+        
+        uint32_t dirtySections = _dirtySections;
+        BOOL hasEpisodesSummary = (_episodesInformation.summary != nil);
+        NSDictionary *relationships = [_relationshipsProvider serializedRelationshipsForShow:self];
+        
+        NSArray *episodes = [[self class] deserializeEpisodes:LREmptyStringToNil(relationships[kShowEpisodesKey]) showID:self.showID];
+        NSArray *images = [[self class] deserializeImages:LREmptyStringToNil(relationships[kShowImagesKey])];
+        NSArray *actors = [[self class] deserializeActors:LREmptyStringToNil(relationships[kShowActorsKey])];
+        
+        if (episodes) [self addEpisodes:episodes];
+        if (images) [self addImages:images];
+        if (actors) [self addActors:actors];
+        
+        // Information computed from the summary has no episodes.
+        if (!_episodesInformation.episodes) [self refreshEpisodesInfomation];
+        
+        // The relationships (and the episodes summary, unless it's missing
+        // from the store) are just as they were persisted.
+        uint32_t relationshipsSections = (LRTVDBShowSectionEpisodes | LRTVDBShowSectionImages | LRTVDBShowSectionActors);
+        if (hasEpisodesSummary) relationshipsSections |= LRTVDBShowSectionInfo;
+        OSAtomicAnd32Barrier(~(relationshipsSections & ~dirtySections), &_dirtySections);
+        
+        _relationshipsProvider = nil;
+        _fulfillingRelationshipsFault = NO;
+        OSMemoryBarrier();
+        _relationshipsFault = NO;
+    }
+    
+    pthread_mutex_unlock(&_writeLock);
+}
+
+#pragma mark - Relationships eviction
+
+- (BOOL)evictRelationshipsWithProvider:(id<LRTVDBShowRelationshipsProvider>)provider
+{
+    uint32_t relationshipsSections = (LRTVDBShowSectionEpisodes | LRTVDBShowSectionImages | LRTVDBShowSectionActors);
+    
+    pthread_mutex_lock(&_writeLock);
+    
+    BOOL canEvict = (provider != nil && !_relationshipsFault && (_dirtySections & relationshipsSections) == 0);
+    
+    if (canEvict)
+    {
+        // Faulted before the snapshot is dropped, so new readers wait for
+        // the lock and reload the relationships.
+        _relationshipsProvider = provider;
+        OSMemoryBarrier();
+        _relationshipsFault = YES;
+        
+        self.snapshot = nil;
+        [self rebuildSeenStateWithEpisodeIndex:nil];
+        
+        // Computed from the episodes summary from now on, so derived values
+        // (lastEpisode, activeEpisode...) don't keep evicted episodes alive.
+        if (_episodesInformation) [self refreshEpisodesInfomation];
+    }
+    
+    pthread_mutex_unlock(&_writeLock);
+    
+    return canEvict;
+}
+
+// The relationships are set again, as a whole, when they're reloaded.
+
+- (void)willEvictRelationships
+{
+    [self willChangeValueForKey:LRTVDBShowAttributes.episodes];
+    [self willChangeValueForKey:LRTVDBShowAttributes.images];
+    [self willChangeValueForKey:LRTVDBShowAttributes.actors];
+}
+
+- (void)didEvictRelationships
+{
+    [self didChangeValueForKey:LRTVDBShowAttributes.actors];
+    [self didChangeValueForKey:LRTVDBShowAttributes.images];
+    [self didChangeValueForKey:LRTVDBShowAttributes.episodes];
+}
+
+- (uint32_t)relationshipsAccessPeriod
+{
+    return _relationshipsAccessPeriod;
+}
+
++ (uint32_t)beginRelationshipsAccessPeriod
+{
+    return (uint32_t)OSAtomicIncrement32Barrier(&sRelationshipsAccessPeriod) - 1;
+}
+
+#pragma mark - Memory usage
+
+- (LRTVDBShowMemoryUsage)memoryUsage
+{
+    LRTVDBShowMemoryUsage memoryUsage;
+    
+    memoryUsage.info = (LRTVDBMallocSize(self) + LRTVDBMallocSize(_showID) + LRTVDBMallocSize(_name) +
+                        LRTVDBMallocSize(_overview) + LRTVDBMallocSize(_imdbID) + LRTVDBMallocSize(_network) +
+                        LRTVDBMallocSize(_premiereDate) + LRTVDBMallocSizeOfArray(_actorsNames) +
+                        LRTVDBMallocSizeOfURL(_fanartURL) + LRTVDBMallocSizeOfURL(_bannerURL) +
+                        LRTVDBMallocSizeOfURL(_posterURL));
+    
+    // Read without fulfilling the fault.
+    OSSpinLockLock(&_snapshotLock);
+    LRTVDBShowSnapshot *snapshot = _snapshot;
+    OSSpinLockUnlock(&_snapshotLock);
+    
+    NSUInteger numberOfEpisodes = [snapshot.episodes count];
+    
+    memoryUsage.episodes = LRTVDBMallocSize(snapshot.episodes) + LRTVDBMallocSize(snapshot.episodeIndex);
+    memoryUsage.episodes += numberOfEpisodes * (sizeof(NSInteger) + sizeof(LRTVDBDayNumber)); // Index arrays
+    memoryUsage.episodes += 3 * ((numberOfEpisodes + 7) / 8); // Seen state bit sets
+    
+    for (LRTVDBEpisode *episode in snapshot.episodes)
+    {
+        memoryUsage.episodes += [episode memorySize];
+    }
+    
+    memoryUsage.images = LRTVDBMallocSize(snapshot.images) + LRTVDBMallocSize(snapshot.artworkIndex);
+    
+    for (LRTVDBImage *image in snapshot.images)
+    {
+        memoryUsage.images += [image memorySize];
+    }
+    
+    memoryUsage.actors = LRTVDBMallocSize(snapshot.actors);
+    
+    for (LRTVDBActor *actor in snapshot.actors)
     {
-        dispatch_release(_syncQueue);
+        memoryUsage.actors += [actor memorySize];
     }
-#endif
-    _syncQueue = NULL;
+    
+    return memoryUsage;
 }
 
 #pragma mark - Episodes handling
 
 - (NSArray *)episodes
 {
-    __block NSArray *localEpisodes = nil;
-    dispatch_sync(self.syncQueue, ^{
-        localEpisodes = _episodes;
-    });
-    return localEpisodes;
+    return self.snapshot.episodes;
 }
 
 - (void)addEpisodes:(NSArray *)episodes
 {
-    dispatch_sync(self.syncQueue, ^{
-        [self willChangeValueForKey:LRTVDBShowAttributes.episodes];
-        
-        _episodes = [[self mergeObjects:episodes
-                            withObjects:_episodes
-                        comparisonBlock:LRTVDBEpisodeComparator] copy];
-        
-        // Assign weak reference to the show.
-        for (LRTVDBEpisode *episode in _episodes)
-        {
-            episode.show = self;
-        }
-        
-        [self refreshEpisodesInfomation];
-        
-        [self didChangeValueForKey:LRTVDBShowAttributes.episodes];
-    });
+    NSArray *sortedEpisodes = [self sortedObjectsByRemovingDuplicates:episodes
+                                                      comparisonBlock:LRTVDBEpisodeComparator];
+    
+    pthread_mutex_lock(&_writeLock);
+    [self mergeSortedEpisodes:sortedEpisodes];
+    pthread_mutex_unlock(&_writeLock);
 }
 
-- (void)refreshEpisodesInfomation
+- (void)mergeSortedEpisodes:(NSArray *)sortedEpisodes
 {
-    if ([_episodes count] == 0) return;
+    NSArray *currentEpisodes = self.snapshot.episodes;
+    LRTVDBEpisodeIndex *currentEpisodeIndex = self.snapshot.episodeIndex;
     
-    // First episode
-    NSUInteger firstEpisodeIndex = [_episodes indexOfObjectPassingTest:^BOOL(LRTVDBEpisode *episode, NSUInteger idx, BOOL *stop) {
+    LRTVDBMergeResult *mergeResult = [self mergeSortedObjects:sortedEpisodes
+                                                  withObjects:currentEpisodes
+                                              comparisonBlock:LRTVDBEpisodeComparator];
+    
+    // Shows with only special episodes have no episodes at all.
+    NSUInteger firstEpisodeIndex = [mergeResult.objects indexOfObjectPassingTest:^BOOL(LRTVDBEpisode *episode, NSUInteger idx, BOOL *stop) {
         return ![episode isSpecial];
     }];
     
     if (firstEpisodeIndex == NSNotFound)
     {
-        _episodes = nil;
-        return;
+        mergeResult = [[LRTVDBMergeResult alloc] init];
+        mergeResult.objects = @[];
+        [mergeResult.removedIndexes addIndexesInRange:NSMakeRange(0, [currentEpisodes count])];
     }
     
-    self.firstEpisode = _episodes[firstEpisodeIndex];
+    if (![mergeResult hasChanges]) return;
     
-    // Last episode
-    if (self.basicStatus == LRTVDBShowBasicStatusEnded)
-    {
-        self.lastEpisode = [_episodes lastObject];
-    }
-    else
+    // The episodes summary is persisted along with the info.
+    [self markSectionsAsDirty:(LRTVDBShowSectionInfo | LRTVDBShowSectionEpisodes)];
+    
+    NSArray *insertedEpisodes = [mergeResult.objects objectsAtIndexes:mergeResult.insertedIndexes];
+    
+    // Assign weak reference to the show. Episodes created by hand may lack the show ID.
+    for (LRTVDBEpisode *episode in insertedEpisodes)
     {
-        NSDate *fromDate = [[NSDate date] dateByIgnoringTime];
-        
-        void (^block)(LRTVDBEpisode *, NSUInteger, BOOL *) = ^(LRTVDBEpisode *episode, NSUInteger idx, BOOL *stop) {
-            
-            NSDate *toDate = [episode.airedDate dateByIgnoringTime];
-            
-            if ([toDate compare:fromDate] == NSOrderedAscending)
-            {
-                self.lastEpisode = episode;
-                *stop = YES;
-            }
-        };
+        episode.show = self;
         
-        [_episodes enumerateObjectsWithOptions:NSEnumerationReverse usingBlock:block];
+        if (!episode.showID) episode.showID = self.showID;
     }
     
-    // Next episode
-
-    if (self.lastEpisode == nil)
-    {
-        self.nextEpisode = self.firstEpisode;
-    }
-    else
+    // The index can be updated incrementally as long as the current episodes keep their order.
+    BOOL incrementalUpdate = (currentEpisodeIndex != nil && !mergeResult.requiresReload &&
+                              [mergeResult.removedIndexes count] == 0);
+    
+    LRTVDBEpisodeIndex *episodeIndex = nil;
+    
+    if ([mergeResult.objects count] > 0)
     {
-        NSUInteger nextEpisodeIndex = [_episodes indexOfObjectIdenticalTo:self.lastEpisode] + 1;
-        BOOL notValidNextEpisode = nextEpisodeIndex >= [_episodes count];
-        self.nextEpisode = notValidNextEpisode ? nil : _episodes[nextEpisodeIndex];
+        episodeIndex = incrementalUpdate ? [currentEpisodeIndex indexWithEpisodes:mergeResult.objects
+                                                                  insertedIndexes:mergeResult.insertedIndexes
+                                                                   updatedIndexes:mergeResult.updatedIndexes] :
+                                           [[LRTVDBEpisodeIndex alloc] initWithEpisodes:mergeResult.objects];
     }
     
-    // Days to next episode
-    self.daysToNextEpisode = [self daysToEpisode:self.nextEpisode];
+    [self applyMergeResult:mergeResult
+                 toObjects:currentEpisodes
+                    forKey:LRTVDBShowAttributes.episodes
+                usingBlock:^(NSArray *mergedEpisodes) {
+                    
+                    NSArray *publishedEpisodes = [mergedEpisodes count] > 0 ? mergedEpisodes : nil;
+                    LRTVDBEpisodeIndex *publishedEpisodeIndex = episodeIndex;
+                    
+                    // Removals notified before insertions publish the remaining episodes.
+                    if (publishedEpisodes != nil && mergedEpisodes != mergeResult.objects)
+                    {
+                        publishedEpisodeIndex = [[LRTVDBEpisodeIndex alloc] initWithEpisodes:mergedEpisodes];
+                    }
+                    
+                    self.snapshot = [self snapshotByReplacingEpisodes:publishedEpisodes
+                                                         episodeIndex:publishedEpisodeIndex];
+                    
+                    [self rebuildSeenStateWithEpisodeIndex:publishedEpisodeIndex];
+                    
+                    [self refreshEpisodesInfomation];
+                }];
+}
+
+- (void)refreshEpisodesInfomation
+{
+    pthread_mutex_lock(&_writeLock);
     
-    // Number of seasons
-    self.numberOfSeasons = [[_episodes lastObject] seasonNumber];
+    _refreshingEpisodesInformation = YES;
     
-    // Show status
-    if (self.basicStatus == LRTVDBShowBasicStatusEnded)
+    LRTVDBShowEpisodesInformation *episodesInformation = nil;
+    
+    // Faulted shows are refreshed from the persisted summary, so sorting
+    // them or reading their status doesn't load the episodes.
+    if (_relationshipsFault && !_fulfillingRelationshipsFault)
     {
-        self.status = LRTVDBShowStatusEnded;
+        episodesInformation = [[LRTVDBShowEpisodesInformation alloc] initWithSummary:_episodesInformation.summary
+                                                                          basicStatus:self.basicStatus
+                                                                            dayNumber:LRTVDBTodayDayNumber()];
     }
-    else if (self.basicStatus == LRTVDBShowBasicStatusContinuing)
+    
+    if (!episodesInformation)
     {
-        self.status =  [self.daysToNextEpisode isEqualToNumber:@(NSIntegerMax)] ?
-                       LRTVDBShowStatusTBA : LRTVDBShowStatusUpcoming;
+        episodesInformation = [[LRTVDBShowEpisodesInformation alloc] initWithEpisodeIndex:self.snapshot.episodeIndex
+                                                                               basicStatus:self.basicStatus
+                                                                                 dayNumber:LRTVDBTodayDayNumber()];
     }
-    else
+    
+    [self willChangeValueForKey:LRTVDBShowAttributes.lastEpisode];
+    
+    OSSpinLockLock(&_episodesInformationLock);
+    LRTVDBShowEpisodesInformation *oldEpisodesInformation = _episodesInformation; // Released out of the lock
+    _episodesInformation = episodesInformation;
+    OSSpinLockUnlock(&_episodesInformationLock);
+    
+    oldEpisodesInformation = nil;
+    
+    [self setNeedsUpdateSortKey];
+    [self reloadActiveEpisode];
+    
+    [self didChangeValueForKey:LRTVDBShowAttributes.lastEpisode];
+    
+    _refreshingEpisodesInformation = NO;
+    
+    pthread_mutex_unlock(&_writeLock);
+}
+
+- (NSNumber *)daysToEpisode:(LRTVDBEpisode *)episode
+{
+    if (episode == nil || episode.airedDayNumber == LRTVDBUnknownDayNumber) return @(NSIntegerMax);
+    
+    return @(episode.airedDayNumber - LRTVDBTodayDayNumber());
+}
+
+#pragma mark - Day rollover
+
+// Every day dependent value is read through these getters. Comparing the day
+// the values were computed for with today's day number is cheap, so shows
+// are only refreshed after a day rollover if they're actually read.
+
+- (LRTVDBShowEpisodesInformation *)episodesInformation
+{
+    OSSpinLockLock(&_episodesInformationLock);
+    LRTVDBShowEpisodesInformation *episodesInformation = _episodesInformation;
+    OSSpinLockUnlock(&_episodesInformationLock);
+    
+    if (episodesInformation.dayNumber == LRTVDBTodayDayNumber()) return episodesInformation;
+    
+    pthread_mutex_lock(&_writeLock);
+    
+    // Another thread may have refreshed it while this one was waiting for the lock.
+    // Observers notified by the refresh itself get the values being replaced.
+    if (_episodesInformation.dayNumber != LRTVDBTodayDayNumber() && !_refreshingEpisodesInformation)
     {
-        self.status = LRTVDBShowStatusUnknown;
+        [self refreshEpisodesInfomation];
     }
     
-    // Re compute season dictionary
-    NSMutableDictionary *newSeasonToEpisodesDictionary = [NSMutableDictionary dictionary];
+    episodesInformation = _episodesInformation;
+    
+    pthread_mutex_unlock(&_writeLock);
     
-    self.seenEpisodes = nil; // Recompute
+    return episodesInformation;
+}
+
+- (void)refreshEpisodesInformationIfNeeded
+{
+    [self episodesInformation];
+}
 
-    for (LRTVDBEpisode *episode in _episodes)
+/**
+ Like episodesInformation, but with the episodes themselves, which may
+ require fulfilling the relationships fault.
+ */
+- (LRTVDBShowEpisodesInformation *)episodesInformationWithEpisodes
+{
+    LRTVDBShowEpisodesInformation *episodesInformation = [self episodesInformation];
+    
+    if (!episodesInformation.episodes && _relationshipsFault)
     {
-        NSMutableArray *episodesForSeason = [newSeasonToEpisodesDictionary[episode.seasonNumber] mutableCopy];
-        if (episodesForSeason == nil)
-        {
-            episodesForSeason = [NSMutableArray array];
-        }
-        
-        [episodesForSeason addObject:episode];
-        
-        newSeasonToEpisodesDictionary[episode.seasonNumber] = [episodesForSeason copy];
-        
-        [self seenStatusDidChangeForEpisode:episode];
+        [self fulfillRelationshipsFault];
+        episodesInformation = [self episodesInformation];
     }
     
-    self.seasonToEpisodesDictionary = newSeasonToEpisodesDictionary;
+    return episodesInformation;
+}
+
+- (NSDictionary *)episodesSummary
+{
+    OSSpinLockLock(&_episodesInformationLock);
+    NSDictionary *episodesSummary = _episodesInformation.summary;
+    OSSpinLockUnlock(&_episodesInformationLock);
     
-    [self reloadActiveEpisode];
+    return episodesSummary;
 }
 
-- (NSNumber *)daysToEpisode:(LRTVDBEpisode *)episode
+- (void)setEpisodesSummary:(NSDictionary *)episodesSummary
 {
-    if (episode.airedDate == nil) return @(NSIntegerMax);
+    pthread_mutex_lock(&_writeLock);
     
-    static NSCalendar *calendar = nil;
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        calendar = [NSCalendar currentCalendar];
-    });
+    id summaryDayNumber = episodesSummary[kEpisodesSummaryDayNumberKey];
     
-    // Timezones are really difficult to deal with. Ignoring time...
-    NSDate *fromDate = [[NSDate date] dateByIgnoringTime];
-    NSDate *toDate = [episode.airedDate dateByIgnoringTime];
+    LRTVDBShowEpisodesInformation *episodesInformation =
+    [[LRTVDBShowEpisodesInformation alloc] initWithSummary:episodesSummary
+                                               basicStatus:self.basicStatus
+                                                 dayNumber:[summaryDayNumber integerValue]];
+    
+    if (episodesInformation)
+    {
+        OSSpinLockLock(&_episodesInformationLock);
+        LRTVDBShowEpisodesInformation *oldEpisodesInformation = _episodesInformation; // Released out of the lock
+        _episodesInformation = episodesInformation;
+        OSSpinLockUnlock(&_episodesInformationLock);
+        
+        oldEpisodesInformation = nil;
+        
+        [self setNeedsUpdateSortKey];
+    }
     
-    NSDateComponents *components = [calendar components:NSDayCalendarUnit
-                                               fromDate:fromDate
-                                                 toDate:toDate
-                                                options:0];
-    return @(components.day);
+    pthread_mutex_unlock(&_writeLock);
+}
+
+- (LRTVDBEpisode *)firstEpisode
+{
+    return [[self episodesInformationWithEpisodes] firstEpisode];
+}
+
+- (LRTVDBEpisode *)lastEpisode
+{
+    return [[self episodesInformationWithEpisodes] lastEpisode];
+}
+
+- (LRTVDBEpisode *)nextEpisode
+{
+    return [[self episodesInformationWithEpisodes] nextEpisode];
+}
+
+- (NSNumber *)daysToNextEpisode
+{
+    return [self episodesInformation].daysToNextEpisode;
+}
+
+- (NSNumber *)numberOfSeasons
+{
+    return [self episodesInformation].numberOfSeasons;
+}
+
+- (LRTVDBShowStatus)status
+{
+    return [self episodesInformation].status;
 }
 
 - (NSArray *)specials
@@ -398,103 +1125,157 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
 - (NSArray *)episodesForSeason:(NSNumber *)seasonNumber
 {
-    return self.seasonToEpisodesDictionary[seasonNumber] ? : @[];
+    return [self.snapshot.episodeIndex episodesForSeason:seasonNumber] ? : @[];
+}
+
+- (NSNumber *)averageRatingForSeason:(NSNumber *)seasonNumber
+{
+    return [self.snapshot.episodeIndex averageRatingForSeason:seasonNumber];
 }
 
 #pragma mark - Images handling
 
 - (NSArray *)images
 {
-    __block NSArray *localImages = nil;
-    dispatch_sync(self.syncQueue, ^{
-        localImages = _images;
-    });
-    return localImages;
+    return self.snapshot.images;
 }
 
 - (void)addImages:(NSArray *)images
 {
-    dispatch_sync(self.syncQueue, ^{
-        [self willChangeValueForKey:LRTVDBShowAttributes.images];
-        
-        _images = [[self mergeObjects:images
-                          withObjects:_images
-                      comparisonBlock:LRTVDBImageComparator] copy];
-        
-        [self computeImagesInformation];
-        
-        [self didChangeValueForKey:LRTVDBShowAttributes.images];
-    });
-}
-
-- (void)computeImagesInformation
-{
-    NSMutableArray *fanartArray = [NSMutableArray array];
-    NSMutableArray *posterArray = [NSMutableArray array];
-    NSMutableArray *seasonArray = [NSMutableArray array];
-    NSMutableArray *bannerArray = [NSMutableArray array];
+    NSArray *sortedImages = [self sortedObjectsByRemovingDuplicates:images
+                                                    comparisonBlock:LRTVDBImageComparator];
     
-    for (LRTVDBImage *image in _images)
+    pthread_mutex_lock(&_writeLock);
+    
+    NSArray *currentImages = self.snapshot.images;
+    LRTVDBArtworkIndex *currentArtworkIndex = self.snapshot.artworkIndex;
+    
+    LRTVDBMergeResult *mergeResult = [self mergeSortedObjects:sortedImages
+                                                  withObjects:currentImages
+                                              comparisonBlock:LRTVDBImageComparator];
+    
+    if ([mergeResult hasChanges])
     {
-        switch (image.type)
-        {
-            case LRTVDBImageTypeFanart:
-                [fanartArray addObject:image];
-                break;
-            case LRTVDBImageTypePoster:
-                [posterArray addObject:image];
-                break;
-            case LRTVDBImageTypeSeason:
-                [seasonArray addObject:image];
-                break;
-            case LRTVDBImageTypeBanner:
-                [bannerArray addObject:image];
-                break;
-            default:
-                break;
-        }
+        [self markSectionsAsDirty:LRTVDBShowSectionImages];
     }
     
-    self.fanartImages = fanartArray;
-    self.posterImages = posterArray;
-    self.seasonImages = seasonArray;
-    self.bannerImages = bannerArray;
+    // Updated images may have changed their type, the index is rebuilt then.
+    BOOL incrementalUpdate = (currentArtworkIndex != nil && !mergeResult.requiresReload &&
+                              [mergeResult.updatedIndexes count] == 0);
+    
+    LRTVDBArtworkIndex *artworkIndex = incrementalUpdate ?
+                                       [currentArtworkIndex indexWithImages:mergeResult.objects
+                                                            insertedIndexes:mergeResult.insertedIndexes
+                                                              removedImages:[currentImages objectsAtIndexes:mergeResult.removedIndexes]] :
+                                       [[LRTVDBArtworkIndex alloc] initWithImages:mergeResult.objects];
+    
+    [self applyMergeResult:mergeResult
+                 toObjects:currentImages
+                    forKey:LRTVDBShowAttributes.images
+                usingBlock:^(NSArray *mergedImages) {
+                    
+                    // Removals notified before insertions publish the remaining images.
+                    LRTVDBArtworkIndex *publishedArtworkIndex = (mergedImages == mergeResult.objects ? artworkIndex :
+                                                                 [[LRTVDBArtworkIndex alloc] initWithImages:mergedImages]);
+                    
+                    self.snapshot = [self snapshotByReplacingImages:mergedImages
+                                                       artworkIndex:publishedArtworkIndex];
+                }];
+    
+    pthread_mutex_unlock(&_writeLock);
 }
 
-#pragma mark - Actors handling
+#pragma mark - Artwork
 
-- (NSArray *)actors
+- (NSArray *)fanartImages
 {
-    __block NSArray *localActors = nil;
-    dispatch_sync(self.syncQueue, ^{
-        localActors = _actors;
-    });
-    return localActors;
+    return [self.snapshot.artworkIndex imagesOfType:LRTVDBImageTypeFanart];
 }
 
-- (void)addActors:(NSArray *)actors
+- (NSArray *)posterImages
 {
-    dispatch_sync(self.syncQueue, ^{
-        [self willChangeValueForKey:LRTVDBShowAttributes.actors];
-        
-        _actors = [[self mergeObjects:actors
-                          withObjects:_actors
-                      comparisonBlock:LRTVDBActorComparator] copy];
-        
-        [self didChangeValueForKey:LRTVDBShowAttributes.actors];
-    });
-};
+    return [self.snapshot.artworkIndex imagesOfType:LRTVDBImageTypePoster];
+}
+
+- (NSArray *)seasonImages
+{
+    return [self.snapshot.artworkIndex imagesOfType:LRTVDBImageTypeSeason];
+}
+
+- (NSArray *)bannerImages
+{
+    return [self.snapshot.artworkIndex imagesOfType:LRTVDBImageTypeBanner];
+}
+
++ (NSSet *)keyPathsForValuesAffectingFanartImages
+{
+    return [NSSet setWithObject:LRTVDBShowAttributes.images];
+}
+
++ (NSSet *)keyPathsForValuesAffectingPosterImages
+{
+    return [NSSet setWithObject:LRTVDBShowAttributes.images];
+}
+
++ (NSSet *)keyPathsForValuesAffectingSeasonImages
+{
+    return [NSSet setWithObject:LRTVDBShowAttributes.images];
+}
+
++ (NSSet *)keyPathsForValuesAffectingBannerImages
+{
+    return [NSSet setWithObject:LRTVDBShowAttributes.images];
+}
+
+- (NSArray *)bestImagesOfType:(LRTVDBImageType)type count:(NSUInteger)count
+{
+    return [self.snapshot.artworkIndex bestImagesOfType:type count:count] ? : @[];
+}
+
+- (LRTVDBImage *)bestImageOfType:(LRTVDBImageType)type
+{
+    return [self.snapshot.artworkIndex bestImageOfType:type];
+}
+
+- (LRTVDBImage *)bestImageForSeason:(NSNumber *)seasonNumber
+{
+    return [[self.snapshot.artworkIndex imagesForSeason:seasonNumber] lr_firstObject];
+}
+
+#pragma mark - Actors handling
 
-#pragma mark - Sync Queue
+- (NSArray *)actors
+{
+    return self.snapshot.actors;
+}
 
-- (dispatch_queue_t)syncQueue
+- (void)addActors:(NSArray *)actors
 {
-    if (_syncQueue == NULL)
+    NSArray *sortedActors = [self sortedObjectsByRemovingDuplicates:actors
+                                                    comparisonBlock:LRTVDBActorComparator];
+    
+    pthread_mutex_lock(&_writeLock);
+    
+    NSArray *currentActors = self.snapshot.actors;
+    
+    LRTVDBMergeResult *mergeResult = [self mergeSortedObjects:sortedActors
+                                                  withObjects:currentActors
+                                              comparisonBlock:LRTVDBActorComparator];
+    
+    if ([mergeResult hasChanges])
     {
-        _syncQueue = dispatch_queue_create("com.LRTVDBAPIClient.LRTVDBShowQueue", NULL);
+        [self markSectionsAsDirty:LRTVDBShowSectionActors];
     }
     
-    return _syncQueue;
+    [self applyMergeResult:mergeResult
+                 toObjects:currentActors
+                    forKey:LRTVDBShowAttributes.actors
+                usingBlock:^(NSArray *mergedActors) {
+                    
+                    self.snapshot = [self snapshotByReplacingActors:mergedActors];
+                }];
+    
+    pthread_mutex_unlock(&_writeLock);
 }
 
 #pragma mark - IMDB URL
@@ -511,18 +1292,22 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
 - (LRTVDBEpisode *)activeEpisode
 {
+    [self refreshEpisodesInformationIfNeeded];
+    
     if (!_activeEpisode)
     {
         if (![self hasBeenFinished])
         {
-            for (LRTVDBEpisode *episode in _episodes)
-            {
-                if (![episode hasBeenSeen] && ![episode isSpecial])
-                {
-                    _activeEpisode = episode;
-                    break;
-                }
-            }
+            // The seen state is dropped along with evicted relationships.
+            [self fulfillRelationshipsFaultIfNeeded];
+            
+            // First regular episode not seen yet.
+            OSSpinLockLock(&_seenStateLock);
+            
+            NSUInteger index = [_regularEpisodesBitSet firstIndexNotContainedInBitSet:_seenEpisodesBitSet];
+            _activeEpisode = index != NSNotFound ? _seenStateEpisodes[index] : nil;
+            
+            OSSpinLockUnlock(&_seenStateLock);
         }
         else
         {
@@ -530,11 +1315,12 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
             
             if (_activeEpisode == self.nextEpisode && _activeEpisode.seen)
             {
-                NSUInteger index = [_episodes indexOfObjectIdenticalTo:_activeEpisode];
+                NSArray *episodes = self.episodes;
+                NSUInteger index = [episodes indexOfObjectIdenticalTo:_activeEpisode];
                 
-                if (index < [_episodes count] - 1)
+                if (index < [episodes count] - 1)
                 {
-                    _activeEpisode = _episodes[index + 1];
+                    _activeEpisode = episodes[index + 1];
                 }
             }
         }
@@ -545,6 +1331,8 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
 - (NSNumber *)daysToActiveEpisode
 {
+    [self refreshEpisodesInformationIfNeeded];
+    
     if (!_daysToActiveEpisode)
     {
         _daysToActiveEpisode = [self daysToEpisode:self.activeEpisode];
@@ -555,29 +1343,120 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
 #pragma mark - Seen episodes
 
-- (NSMutableArray *)seenEpisodes
+/**
+ Rebuilds the seen state for the episodes of the provided index.
+ @discussion Episodes store their position in the show so that toggling
+ their seen status is O(1).
+ */
+- (void)rebuildSeenStateWithEpisodeIndex:(LRTVDBEpisodeIndex *)episodeIndex
 {
-    if (!_seenEpisodes)
+    NSArray *episodes = episodeIndex.episodes;
+    NSUInteger numberOfEpisodes = [episodes count];
+    const NSInteger *seasonNumbers = [episodeIndex seasonNumbers];
+    const LRTVDBDayNumber *airedDayNumbers = [episodeIndex airedDayNumbers];
+    
+    LRTVDBBitSet *seenEpisodesBitSet = [[LRTVDBBitSet alloc] initWithNumberOfBits:numberOfEpisodes];
+    LRTVDBBitSet *regularEpisodesBitSet = [[LRTVDBBitSet alloc] initWithNumberOfBits:numberOfEpisodes];
+    LRTVDBBitSet *countedEpisodesBitSet = [[LRTVDBBitSet alloc] initWithNumberOfBits:numberOfEpisodes];
+    NSUInteger numberOfSeenEpisodes = 0;
+    
+    OSSpinLockLock(&_seenStateLock);
+    
+    NSUInteger index = 0;
+    
+    for (LRTVDBEpisode *episode in episodes)
     {
-        _seenEpisodes = [NSMutableArray array];
+        episode.indexInShow = index;
+        
+        if (seasonNumbers[index] != 0)
+        {
+            [regularEpisodesBitSet addIndex:index];
+            
+            // Special episodes or those without aired date don't count as seen ones.
+            if (airedDayNumbers[index] != LRTVDBUnknownDayNumber)
+            {
+                [countedEpisodesBitSet addIndex:index];
+            }
+        }
+        
+        if ([episode hasBeenSeen])
+        {
+            [seenEpisodesBitSet addIndex:index];
+            
+            if ([countedEpisodesBitSet containsIndex:index]) numberOfSeenEpisodes++;
+        }
+        
+        index++;
     }
+    
+    _seenEpisodesBitSet = seenEpisodesBitSet;
+    _regularEpisodesBitSet = regularEpisodesBitSet;
+    _countedEpisodesBitSet = countedEpisodesBitSet;
+    _seenStateEpisodes = episodes;
+    _numberOfSeenEpisodes = numberOfSeenEpisodes;
+    
+    OSSpinLockUnlock(&_seenStateLock);
+}
+
+- (NSUInteger)numberOfSeenEpisodes
+{
+    [self fulfillRelationshipsFaultIfNeeded];
+    
+    OSSpinLockLock(&_seenStateLock);
+    NSUInteger numberOfSeenEpisodes = _numberOfSeenEpisodes;
+    OSSpinLockUnlock(&_seenStateLock);
+    
+    return numberOfSeenEpisodes;
+}
+
+- (NSUInteger)numberOfSeenEpisodesForSeason:(NSNumber *)seasonNumber
+{
+    LRTVDBEpisodeIndex *episodeIndex = self.snapshot.episodeIndex;
+    NSRange range = [episodeIndex rangeOfSeason:seasonNumber];
+    
+    if (range.location == NSNotFound) return 0;
+    
+    OSSpinLockLock(&_seenStateLock);
+    
+    // The seen state may belong to a newer snapshot.
+    NSUInteger numberOfSeenEpisodes = _seenStateEpisodes == episodeIndex.episodes ?
+                                      [_seenEpisodesBitSet countOfIndexesInRange:range] : 0;
+    
+    OSSpinLockUnlock(&_seenStateLock);
+    
+    return numberOfSeenEpisodes;
+}
 
-    return _seenEpisodes;
+- (void)setSeen:(BOOL)seen forEpisodesInRange:(NSRange)range
+{
+    NSArray *episodes = self.episodes;
+    NSRange validRange = NSIntersectionRange(range, NSMakeRange(0, [episodes count]));
+    
+    if (validRange.length == 0) return;
+    
+    _updatingSeenStatusInBatch = YES;
+    
+    for (LRTVDBEpisode *episode in [episodes subarrayWithRange:validRange])
+    {
+        episode.seen = seen;
+    }
+    
+    _updatingSeenStatusInBatch = NO;
+    
+    [self reloadActiveEpisode];
 }
 
 #pragma mark - Number of episodes behind
 
 - (NSNumber *)numberOfEpisodesBehind
 {
+    LRTVDBDayNumber dayNumber = [self episodesInformation].dayNumber;
+    
     if (!_numberOfEpisodesBehind)
     {
-        NSIndexSet *indexSet = [_episodes indexesOfObjectsPassingTest:^BOOL(LRTVDBEpisode *episode, NSUInteger idx, BOOL *stop) {
-            return [episode hasAlreadyAired] && ![episode isSpecial];
-        }];
+        NSUInteger numberOfAiredEpisodes = [self.snapshot.episodeIndex numberOfRegularEpisodesAiredOnOrBeforeDay:dayNumber];
         
-        NSArray *airedEpisodes = [_episodes objectsAtIndexes:indexSet];
-        
-        _numberOfEpisodesBehind = @([airedEpisodes count] - [self.seenEpisodes count]);
+        _numberOfEpisodesBehind = @(numberOfAiredEpisodes - [self numberOfSeenEpisodes]);
         
         // The episode that airs today can be marked as seen but doesn't count for the episodes
         // behind count
@@ -594,7 +1473,7 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
 - (BOOL)isActive
 {
-    return [self.seenEpisodes count] > 0;
+    return [self numberOfSeenEpisodes] > 0;
 }
 
 #pragma mark - Has show been finished?
@@ -615,19 +1494,42 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
 - (void)seenStatusDidChangeForEpisode:(LRTVDBEpisode *)episode
 {
-    // Special episodes or those without aire date doesn't change the active episode
-    if ([episode isSpecial] || !episode.airedDate)
+    [self fulfillRelationshipsFaultIfNeeded];
+    
+    LRTVDBEpisode *reloadedEpisode = nil;
+    
+    OSSpinLockLock(&_seenStateLock);
+    
+    NSUInteger index = episode.indexInShow;
+    
+    if (index < [_seenStateEpisodes count] && _seenStateEpisodes[index] == episode)
     {
-        return;
+        BOOL hasChanged = episode.seen ? [_seenEpisodesBitSet addIndex:index] : [_seenEpisodesBitSet removeIndex:index];
+        
+        if (hasChanged && [_countedEpisodesBitSet containsIndex:index])
+        {
+            _numberOfSeenEpisodes = episode.seen ? _numberOfSeenEpisodes + 1 : _numberOfSeenEpisodes - 1;
+        }
+    }
+    else if (index < [_seenStateEpisodes count] && [_seenStateEpisodes[index] isEqual:episode])
+    {
+        // Episode read before the relationships were evicted and reloaded.
+        reloadedEpisode = _seenStateEpisodes[index];
     }
     
-    if (episode.seen)
+    OSSpinLockUnlock(&_seenStateLock);
+    
+    if (reloadedEpisode)
     {
-        [self.seenEpisodes addObject:episode];
+        reloadedEpisode.seen = episode.seen;
+        return;
     }
-    else
+    
+    [self markSectionsAsDirty:LRTVDBShowSectionEpisodes];
+    
+    if (!_updatingSeenStatusInBatch)
     {
-        [self.seenEpisodes removeObject:episode];
+        [self reloadActiveEpisode];
     }
 }
 
@@ -640,110 +1542,295 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
 #pragma mark - Update show
 
-- (void)updateWithShow:(LRTVDBShow *)updatedShow
-        updateEpisodes:(BOOL)updateEpisodes
-          updateImages:(BOOL)updateImages
-          updateActors:(BOOL)updateActors
-        replaceArtwork:(BOOL)replaceArtwork
+- (NSUInteger)updateWithShow:(LRTVDBShow *)updatedShow
+              updateEpisodes:(BOOL)updateEpisodes
+                updateImages:(BOOL)updateImages
+                updateActors:(BOOL)updateActors
+              replaceArtwork:(BOOL)replaceArtwork
 {
-    if (updatedShow == nil) return;
+    if (updatedShow == nil) return 0;
     
     NSAssert([self isEqual:updatedShow], @"Trying to update show with one with different ID?");
     
-    self.showID = updatedShow.showID;
-    self.name = updatedShow.name;
-    self.overview = updatedShow.overview;
-    self.imdbID = updatedShow.imdbID;
-    self.language = updatedShow.language;
-    self.airDay = updatedShow.airDay;
-    self.airTime = updatedShow.airTime;
-    self.contentRating = updatedShow.contentRating;
-    self.genres = updatedShow.genres;
-    self.actorsNames = updatedShow.actorsNames;
-    self.network = updatedShow.network;
-    self.runtime = updatedShow.runtime;
-    self.basicStatus = updatedShow.basicStatus;
-    self.premiereDate = updatedShow.premiereDate;
-    self.rating = updatedShow.rating;
-    self.ratingCount = updatedShow.ratingCount;
-
-    self.bannerURL = replaceArtwork ? updatedShow.bannerURL : self.bannerURL;
-    self.fanartURL = replaceArtwork ? updatedShow.fanartURL : self.fanartURL;
-    self.posterURL = replaceArtwork ? updatedShow.posterURL : self.posterURL;
-
-    // Updates relationship info.
+    NSUInteger numberOfSkippedSections = 0;
     
-    if (updateEpisodes)
+    // Persistence snapshots must not see half updated shows.
+    pthread_mutex_lock(&_writeLock);
+    
+    // Show info and episodes come from the same data. Its fingerprint includes
+    // replaceArtwork, so artwork to be replaced is never skipped.
+    if ([updatedShow.infoFingerprint isEqual:self.infoFingerprint])
+    {
+        numberOfSkippedSections++;
+    }
+    else
     {
-        [self addEpisodes:updatedShow.episodes];
+        self.showID = updatedShow.showID;
+        self.name = updatedShow.name;
+        self.overview = updatedShow.overview;
+        self.imdbID = updatedShow.imdbID;
+        self.language = updatedShow.language;
+        self.airDay = updatedShow.airDay;
+        self.airTime = updatedShow.airTime;
+        self.contentRating = updatedShow.contentRating;
+        self.genres = updatedShow.genres;
+        self.actorsNames = updatedShow.actorsNames;
+        self.network = updatedShow.network;
+        self.runtime = updatedShow.runtime;
+        self.basicStatus = updatedShow.basicStatus;
+        self.premiereDate = updatedShow.premiereDate;
+        self.rating = updatedShow.rating;
+        self.ratingCount = updatedShow.ratingCount;
+        
+        self.bannerURL = replaceArtwork ? updatedShow.bannerURL : self.bannerURL;
+        self.fanartURL = replaceArtwork ? updatedShow.fanartURL : self.fanartURL;
+        self.posterURL = replaceArtwork ? updatedShow.posterURL : self.posterURL;
+        
+        [self markSectionsAsDirty:LRTVDBShowSectionInfo];
+        
+        if (updateEpisodes)
+        {
+            [self addEpisodes:updatedShow.episodes];
+        }
+        
+        self.infoFingerprint = updatedShow.infoFingerprint;
     }
     
+    // Updates relationship info.
+    
     if (updateImages)
     {
-        [self addImages:updatedShow.images];
+        if ([updatedShow.imagesFingerprint isEqual:self.imagesFingerprint])
+        {
+            numberOfSkippedSections++;
+        }
+        else
+        {
+            [self addImages:updatedShow.images];
+            self.imagesFingerprint = updatedShow.imagesFingerprint;
+            [self markSectionsAsDirty:LRTVDBShowSectionInfo];
+        }
     }
     
     if (updateActors)
     {
-        [self addActors:updatedShow.actors];
+        if ([updatedShow.actorsFingerprint isEqual:self.actorsFingerprint])
+        {
+            numberOfSkippedSections++;
+        }
+        else
+        {
+            [self addActors:updatedShow.actors];
+            self.actorsFingerprint = updatedShow.actorsFingerprint;
+            [self markSectionsAsDirty:LRTVDBShowSectionInfo];
+        }
     }
+    
+    pthread_mutex_unlock(&_writeLock);
+    
+    return numberOfSkippedSections;
 }
 
 #pragma mark - Private
 
 /**
- @remarks This method could have been easily implemented using
- NSSet's methods, but binary search performs much faster.
+ Sorts a batch of objects coming from the parser or the persistence layer.
+ @discussion Duplicates (same ID) are removed keeping the first occurrence, as
+ lr_arrayByRemovingDuplicates does. This is the only O(m log m) step of the merge,
+ so it's done before taking the write lock.
+ */
+- (NSArray *)sortedObjectsByRemovingDuplicates:(NSArray *)objects
+                               comparisonBlock:(NSComparator)comparator
+{
+    if ([objects count] == 0) return @[];
+    
+    NSMutableSet *uniqueObjects = [NSMutableSet setWithCapacity:[objects count]];
+    NSMutableArray *objectsToSort = [NSMutableArray arrayWithCapacity:[objects count]];
+    
+    for (id object in objects)
+    {
+        if (![uniqueObjects containsObject:object])
+        {
+            [uniqueObjects addObject:object];
+            [objectsToSort addObject:object];
+        }
+    }
+    
+    return [objectsToSort sortedArrayWithOptions:NSSortStable usingComparator:comparator];
+}
+
+/**
+ Merges a sorted batch of objects into the current sorted objects.
+ @discussion Objects already present (same ID) are updated in place so they keep their
+ identity. Once updated, they sort exactly as their new counterparts, so the batch
+ (with the old instances in place of the new ones) is still sorted and can be merged
+ with the rest of the old objects in one single linear pass.
+ @param sortedNewObjects Objects sorted by comparator and without duplicates.
+ @param oldObjects Current objects, sorted by comparator.
+ @return The merged objects along with the inserted and updated indexes. Objects are
+ never removed by a merge.
+ @remarks O(n + m), the batch has already been sorted outside the write lock.
  */
-- (NSArray *)mergeObjects:(NSArray *)newObjects
-              withObjects:(NSArray *)oldObjects
-          comparisonBlock:(NSComparator)comparator
+- (LRTVDBMergeResult *)mergeSortedObjects:(NSArray *)sortedNewObjects
+                              withObjects:(NSArray *)oldObjects
+                          comparisonBlock:(NSComparator)comparator
 {
-    NSArray *mergedObjects = nil;
+    LRTVDBMergeResult *mergeResult = [[LRTVDBMergeResult alloc] init];
     
-    if ([newObjects count] == 0)
+    if ([sortedNewObjects count] == 0)
     {
-        mergedObjects = [[oldObjects lr_arrayByRemovingDuplicates] sortedArrayUsingComparator:comparator];
+        mergeResult.objects = oldObjects ? : @[];
+        return mergeResult;
     }
-    else if ([oldObjects count] == 0)
+    
+    if ([oldObjects count] == 0)
     {
-        mergedObjects = [[newObjects lr_arrayByRemovingDuplicates] sortedArrayUsingComparator:comparator];
+        mergeResult.objects = sortedNewObjects;
+        [mergeResult.insertedIndexes addIndexesInRange:NSMakeRange(0, [sortedNewObjects count])];
+        return mergeResult;
     }
-    else
+    
+    NSSet *oldObjectsSet = [NSSet setWithArray:oldObjects];
+    NSMutableSet *matchedObjects = [NSMutableSet setWithCapacity:[sortedNewObjects count]];
+    NSMutableIndexSet *changedIncomingIndexes = [NSMutableIndexSet indexSet];
+    NSMutableArray *incomingObjects = [NSMutableArray arrayWithCapacity:[sortedNewObjects count]];
+    
+    for (id newObject in sortedNewObjects)
+    {
+        id oldObject = [oldObjectsSet member:newObject];
+        
+        if (oldObject)
+        {
+            if ([oldObject updateWithObject:newObject])
+            {
+                [changedIncomingIndexes addIndex:[incomingObjects count]];
+            }
+            
+            [matchedObjects addObject:oldObject];
+            [incomingObjects addObject:oldObject];
+        }
+        else
+        {
+            [incomingObjects addObject:newObject];
+        }
+    }
+    
+    NSUInteger oldCount = [oldObjects count];
+    NSUInteger incomingCount = [incomingObjects count];
+    NSUInteger oldIndex = 0;
+    NSUInteger incomingIndex = 0;
+    
+    // Old objects must show up in the merged objects in their previous order,
+    // otherwise some of them have moved.
+    NSUInteger expectedOldIndex = 0;
+    
+    NSMutableArray *mergedObjects = [NSMutableArray arrayWithCapacity:oldCount + incomingCount];
+    
+    while (oldIndex < oldCount || incomingIndex < incomingCount)
     {
-        NSMutableArray *mutableOldObjects = [oldObjects mutableCopy];
-        NSArray *copiedNewObjects = [newObjects copy];
-        [mutableOldObjects removeObjectsInArray:copiedNewObjects];
+        id oldObject = oldIndex < oldCount ? oldObjects[oldIndex] : nil;
+        
+        // Matched objects are already in the incoming batch, in their new position.
+        if (oldObject && [matchedObjects containsObject:oldObject])
+        {
+            oldIndex++;
+            continue;
+        }
         
-        NSSet *oldObjectsSet = [NSSet setWithArray:oldObjects];
+        id incomingObject = incomingIndex < incomingCount ? incomingObjects[incomingIndex] : nil;
         
-        for (id newObject in copiedNewObjects)
+        if (incomingObject == nil || (oldObject && comparator(oldObject, incomingObject) != NSOrderedDescending))
+        {
+            mergeResult.requiresReload |= (oldObject != oldObjects[expectedOldIndex++]);
+            
+            [mergedObjects addObject:oldObject];
+            oldIndex++;
+        }
+        else
         {
-            NSUInteger newIndexToInsertNewObject = [mutableOldObjects indexOfObject:newObject
-                                                                      inSortedRange:NSMakeRange(0, [mutableOldObjects count])
-                                                                            options:NSBinarySearchingInsertionIndex
-                                                                    usingComparator:comparator];
-            if (newIndexToInsertNewObject != NSNotFound)
+            if ([matchedObjects containsObject:incomingObject])
             {
-                id oldObject = [oldObjectsSet member:newObject];
+                mergeResult.requiresReload |= (incomingObject != oldObjects[expectedOldIndex++]);
                 
-                if ([oldObject isEqual:newObject])
+                if ([changedIncomingIndexes containsIndex:incomingIndex])
                 {
-                    [oldObject updateWithObject:newObject];
-                    
-                    [mutableOldObjects insertObject:oldObject atIndex:newIndexToInsertNewObject];
-                }
-                else
-                {
-                    [mutableOldObjects insertObject:newObject atIndex:newIndexToInsertNewObject];
+                    [mergeResult.updatedIndexes addIndex:[mergedObjects count]];
                 }
             }
+            else
+            {
+                [mergeResult.insertedIndexes addIndex:[mergedObjects count]];
+            }
+            
+            [mergedObjects addObject:incomingObject];
+            incomingIndex++;
+        }
+    }
+    
+    mergeResult.objects = mergedObjects;
+    
+    return mergeResult;
+}
+
+/**
+ Publishes the merged objects notifying KVO observers with indexed changes:
+ removals first, then insertions and finally replacements of the updated objects.
+ @param block Block which stores the objects. It's called with the final objects
+ once, and also with the intermediate objects when there are both removals and insertions.
+ @remarks Observers find the kind of change and the indexes in the change dictionary
+ (NSKeyValueChangeKindKey and NSKeyValueChangeIndexesKey). When objects have moved,
+ a single NSKeyValueChangeSetting change is sent.
+ */
+- (void)applyMergeResult:(LRTVDBMergeResult *)mergeResult
+               toObjects:(NSArray *)oldObjects
+                  forKey:(NSString *)key
+              usingBlock:(void (^)(NSArray *objects))block
+{
+    if (![mergeResult hasChanges]) return;
+    
+    // Relationships loaded by the fault are set as a whole.
+    if (mergeResult.requiresReload || _fulfillingRelationshipsFault)
+    {
+        [self willChangeValueForKey:key];
+        block(mergeResult.objects);
+        [self didChangeValueForKey:key];
+        return;
+    }
+    
+    BOOL finalObjectsApplied = NO;
+    
+    if ([mergeResult.removedIndexes count] > 0)
+    {
+        NSArray *remainingObjects = mergeResult.objects;
+        
+        if ([mergeResult.insertedIndexes count] > 0)
+        {
+            NSMutableArray *mutableRemainingObjects = [oldObjects mutableCopy];
+            [mutableRemainingObjects removeObjectsAtIndexes:mergeResult.removedIndexes];
+            remainingObjects = [mutableRemainingObjects copy];
         }
         
-        mergedObjects = [mutableOldObjects lr_arrayByRemovingDuplicates];
+        [self willChange:NSKeyValueChangeRemoval valuesAtIndexes:mergeResult.removedIndexes forKey:key];
+        block(remainingObjects);
+        finalObjectsApplied = (remainingObjects == mergeResult.objects);
+        [self didChange:NSKeyValueChangeRemoval valuesAtIndexes:mergeResult.removedIndexes forKey:key];
     }
     
-    return mergedObjects ? : @[];
+    if ([mergeResult.insertedIndexes count] > 0)
+    {
+        [self willChange:NSKeyValueChangeInsertion valuesAtIndexes:mergeResult.insertedIndexes forKey:key];
+        block(mergeResult.objects);
+        finalObjectsApplied = YES;
+        [self didChange:NSKeyValueChangeInsertion valuesAtIndexes:mergeResult.insertedIndexes forKey:key];
+    }
+    
+    if ([mergeResult.updatedIndexes count] > 0)
+    {
+        // Updated objects keep their identity, the replacement just tells which ones changed.
+        [self willChange:NSKeyValueChangeReplacement valuesAtIndexes:mergeResult.updatedIndexes forKey:key];
+        if (!finalObjectsApplied) block(mergeResult.objects);
+        [self didChange:NSKeyValueChangeReplacement valuesAtIndexes:mergeResult.updatedIndexes forKey:key];
+    }
 }
 
 #pragma mark - LRTVDBSerializableModelProtocol
@@ -752,6 +1839,8 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 {
     LRTVDBShow *show = [[LRTVDBShow alloc] init];
     
+    LRTVDBStringInterner *interner = [LRTVDBStringInterner sharedInterner];
+    
     id showId = LREmptyStringToNil(dictionary[kShowIDKey]);
     CHECK_NIL(showId, @"showId", *error);
     CHECK_TYPE(showId, [NSString class], @"showId", *error);
@@ -768,23 +1857,23 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
     
     id fanartURL = LREmptyStringToNil(dictionary[kShowFanartURLKey]);
     CHECK_TYPE(fanartURL, [NSString class], @"fanartURL", *error);
-    show.fanartURL = [NSURL URLWithString:fanartURL];
+    show.fanartURL = LRTVDBImageURLForPath(fanartURL);
 
     id bannerURL = LREmptyStringToNil(dictionary[kShowBannerURLKey]);
     CHECK_TYPE(bannerURL, [NSString class], @"bannerURL", *error);
-    show.bannerURL = [NSURL URLWithString:bannerURL];
+    show.bannerURL = LRTVDBImageURLForPath(bannerURL);
 
     id posterURL = LREmptyStringToNil(dictionary[kShowPosterURLKey]);
     CHECK_TYPE(posterURL, [NSString class], @"posterURL", *error);
-    show.posterURL = [NSURL URLWithString:posterURL];
+    show.posterURL = LRTVDBImageURLForPath(posterURL);
 
     id airTime = LREmptyStringToNil(dictionary[kShowAirTimeKey]);
     CHECK_TYPE(airTime, [NSString class], @"airTime", *error);
-    show.airTime = airTime;
+    show.airTime = [interner internString:airTime];
 
     id airDay = LREmptyStringToNil(dictionary[kShowAirDayKey]);
     CHECK_TYPE(airDay, [NSString class], @"airDay", *error);
-    show.airDay = airDay;
+    show.airDay = [interner internString:airDay];
 
     id premiereDate = LREmptyStringToNil(dictionary[kShowPremiereDateKey]);
     CHECK_TYPE(premiereDate, [NSDate class], @"premiereDate", *error);
@@ -792,11 +1881,11 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
     id genres = LREmptyStringToNil(dictionary[kShowGenresKey]);
     CHECK_TYPE(genres, [NSArray class], @"genres", *error);
-    show.genres = genres;
+    show.genres = [interner internStringsInArray:genres];
 
     id actorsNames = LREmptyStringToNil(dictionary[kShowActorsNamesKey]);
     CHECK_TYPE(actorsNames, [NSArray class], @"actorsNames", *error);
-    show.actorsNames = actorsNames;
+    show.actorsNames = [interner internStringsInArray:actorsNames];
 
     id imdbID = LREmptyStringToNil(dictionary[kShowImdbIDKey]);
     CHECK_TYPE(imdbID, [NSString class], @"imdbID", *error);
@@ -804,11 +1893,11 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
     id network = LREmptyStringToNil(dictionary[kShowNetworkKey]);
     CHECK_TYPE(network, [NSString class], @"network", *error);
-    show.network = network;
+    show.network = [interner internString:network];
 
     id language = LREmptyStringToNil(dictionary[kShowLanguageKey]);
     CHECK_TYPE(language, [NSString class], @"language", *error);
-    show.language = language;
+    show.language = [interner internString:language];
 
     id availableLanguages = LREmptyStringToNil(dictionary[kShowAvailableLanguagesKey]);
     CHECK_TYPE(availableLanguages, [NSArray class], @"availableLanguages", *error);
@@ -816,7 +1905,7 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
     id rating = LREmptyStringToNil(dictionary[kShowRatingKey]);
     CHECK_TYPE(rating, [NSNumber class], @"rating", *error);
-    show.rating = rating;
+    show.rating = rating ? @(LRTVDBRatingValue(rating)) : nil;
 
     id ratingCount = LREmptyStringToNil(dictionary[kShowRatingCountKey]);
     CHECK_TYPE(ratingCount, [NSNumber class], @"ratingCount", *error);
@@ -829,7 +1918,7 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
     id contentRating = LREmptyStringToNil(dictionary[kShowContentRatingKey]);
     CHECK_TYPE(contentRating, [NSString class], @"contentRating", *error);
-    show.contentRating = contentRating;
+    show.contentRating = [interner internString:contentRating];
 
     // Due to an error in the parser, previous versions of the app may have saved this value
     // as a NSString, let's check both possible values and get a NSNumber out of it.
@@ -839,12 +1928,29 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
     
     NSString *lastEpisodeSeenID = LREmptyStringToNil(dictionary[kShowLastEpisodeSeenKey]);
     CHECK_TYPE(lastEpisodeSeenID, [NSString class], @"lastEpisodeSeenID", *error);
+    
+    id infoFingerprint = LREmptyStringToNil(dictionary[kShowInfoFingerprintKey]);
+    CHECK_TYPE(infoFingerprint, [NSNumber class], @"infoFingerprint", *error);
+    show.infoFingerprint = infoFingerprint;
+    
+    id imagesFingerprint = LREmptyStringToNil(dictionary[kShowImagesFingerprintKey]);
+    CHECK_TYPE(imagesFingerprint, [NSNumber class], @"imagesFingerprint", *error);
+    show.imagesFingerprint = imagesFingerprint;
+    
+    id actorsFingerprint = LREmptyStringToNil(dictionary[kShowActorsFingerprintKey]);
+    CHECK_TYPE(actorsFingerprint, [NSNumber class], @"actorsFingerprint", *error);
+    show.actorsFingerprint = actorsFingerprint;
+    
+    // Replaced as soon as the episodes are added, if they come along.
+    id episodesSummary = LREmptyStringToNil(dictionary[kShowEpisodesSummaryKey]);
+    CHECK_TYPE(episodesSummary, [NSDictionary class], @"episodesSummary", *error);
+    if (episodesSummary) [show setEpisodesSummary:episodesSummary];
 
     NSArray *episodesDictionaries = LREmptyStringToNil(dictionary[kShowEpisodesKey]);
     NSArray *imagesDictionaries = LREmptyStringToNil(dictionary[kShowImagesKey]);
     NSArray *actorsDictionaries = LREmptyStringToNil(dictionary[kShowActorsKey]);
         
-    NSArray *episodes = [self deserializeEpisodes:episodesDictionaries];
+    NSArray *episodes = [self deserializeEpisodes:episodesDictionaries showID:show.showID];
     
     if (episodes) [show addEpisodes:episodes];
 
@@ -865,17 +1971,7 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
         // Migration
         if (lastEpisodeSeenIndex != NSNotFound)
         {
-            LRTVDBEpisode *lastEpisodeSeen = show.episodes[lastEpisodeSeenIndex];
-            
-            for (LRTVDBEpisode *episode in show.episodes)
-            {
-                episode.seen = YES;
-                
-                if (episode == lastEpisodeSeen)
-                {
-                    break;
-                }
-            }
+            [show setSeen:YES forEpisodesInRange:NSMakeRange(0, lastEpisodeSeenIndex + 1)];
         }
         
         [show reloadActiveEpisode];
@@ -886,33 +1982,211 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
 
 - (NSDictionary *)serialize
 {
-    return @{ kShowIDKey: LRNilToEmptyString(self.showID),
-              kShowNameKey: LRNilToEmptyString(self.name),
-              kShowOverviewKey: LRNilToEmptyString(self.overview),
-              kShowAirDayKey: LRNilToEmptyString(self.airDay),
-              kShowAirTimeKey: LRNilToEmptyString(self.airTime),
-              kShowFanartURLKey: LRNilToEmptyString([self.fanartURL absoluteString]),
-              kShowBannerURLKey: LRNilToEmptyString([self.bannerURL absoluteString]),
-              kShowPosterURLKey: LRNilToEmptyString([self.posterURL absoluteString]),
-              kShowPremiereDateKey: LRNilToEmptyString(self.premiereDate),
-              kShowGenresKey: LRNilToEmptyString(self.genres),
-              kShowActorsNamesKey: LRNilToEmptyString(self.actorsNames),
-              kShowImdbIDKey: LRNilToEmptyString(self.imdbID),
-              kShowNetworkKey: LRNilToEmptyString(self.network),
-              kShowLanguageKey: LRNilToEmptyString(self.language),
-              kShowAvailableLanguagesKey: LRNilToEmptyString(self.availableLanguages),
-              kShowRatingKey: LRNilToEmptyString(self.rating),
-              kShowRatingCountKey: LRNilToEmptyString(self.ratingCount),
-              kShowBasicStatusKey: @(self.basicStatus),
-              kShowContentRatingKey : LRNilToEmptyString(self.contentRating),
-              kShowRuntimeKey : LRNilToEmptyString(self.runtime),
-              kShowEpisodesKey : LRNilToEmptyString([self serializeEpisodes:self.episodes]),
-              kShowImagesKey : LRNilToEmptyString([self serializeImages:self.images]),
-              kShowActorsKey : LRNilToEmptyString([self serializeActors:self.actors]),
-            };
-}
-
-+ (NSArray *)deserializeEpisodes:(NSArray *)episodes
+    NSMutableDictionary *dictionary = [[self serializeSection:LRTVDBShowSectionInfo] mutableCopy];
+    
+    [dictionary addEntriesFromDictionary:[self serializeSection:LRTVDBShowSectionEpisodes]];
+    [dictionary addEntriesFromDictionary:[self serializeSection:LRTVDBShowSectionImages]];
+    [dictionary addEntriesFromDictionary:[self serializeSection:LRTVDBShowSectionActors]];
+    
+    return [dictionary copy];
+}
+
+- (NSDictionary *)serializeSection:(LRTVDBShowSection)section
+{
+    switch (section)
+    {
+        case LRTVDBShowSectionInfo:
+            return @{ kShowIDKey: LRNilToEmptyString(self.showID),
+                      kShowNameKey: LRNilToEmptyString(self.name),
+                      kShowOverviewKey: LRNilToEmptyString(self.overview),
+                      kShowAirDayKey: LRNilToEmptyString(self.airDay),
+                      kShowAirTimeKey: LRNilToEmptyString(self.airTime),
+                      kShowFanartURLKey: LRNilToEmptyString(LRTVDBImagePathForURL(self.fanartURL)),
+                      kShowBannerURLKey: LRNilToEmptyString(LRTVDBImagePathForURL(self.bannerURL)),
+                      kShowPosterURLKey: LRNilToEmptyString(LRTVDBImagePathForURL(self.posterURL)),
+                      kShowPremiereDateKey: LRNilToEmptyString(self.premiereDate),
+                      kShowGenresKey: LRNilToEmptyString(self.genres),
+                      kShowActorsNamesKey: LRNilToEmptyString(self.actorsNames),
+                      kShowImdbIDKey: LRNilToEmptyString(self.imdbID),
+                      kShowNetworkKey: LRNilToEmptyString(self.network),
+                      kShowLanguageKey: LRNilToEmptyString(self.language),
+                      kShowAvailableLanguagesKey: LRNilToEmptyString(self.availableLanguages),
+                      kShowRatingKey: LRNilToEmptyString(self.rating),
+                      kShowRatingCountKey: LRNilToEmptyString(self.ratingCount),
+                      kShowBasicStatusKey: @(self.basicStatus),
+                      kShowContentRatingKey : LRNilToEmptyString(self.contentRating),
+                      kShowRuntimeKey : LRNilToEmptyString(self.runtime),
+                      kShowInfoFingerprintKey : LRNilToEmptyString(self.infoFingerprint),
+                      kShowImagesFingerprintKey : LRNilToEmptyString(self.imagesFingerprint),
+                      kShowActorsFingerprintKey : LRNilToEmptyString(self.actorsFingerprint),
+                      kShowEpisodesSummaryKey : LRNilToEmptyString([self episodesSummary]),
+                    };
+        case LRTVDBShowSectionEpisodes:
+            return @{ kShowEpisodesKey : LRNilToEmptyString([self serializeEpisodes:self.episodes]) };
+        case LRTVDBShowSectionImages:
+            return @{ kShowImagesKey : LRNilToEmptyString([self serializeImages:self.images]) };
+        case LRTVDBShowSectionActors:
+            return @{ kShowActorsKey : LRNilToEmptyString([self serializeActors:self.actors]) };
+        default:
+            NSAssert(NO, @"Only a single section can be serialized");
+            return nil;
+    }
+}
+
++ (NSDictionary *)serializedEpisodesSectionWithEpisodes:(NSArray *)serializedEpisodes
+{
+    return @{ kShowEpisodesKey : LRNilToEmptyString(serializedEpisodes) };
+}
+
++ (NSUInteger)binarySchemaVersion
+{
+    return kShowBinarySchemaVersion;
+}
+
++ (LRTVDBShow *)decodeWithDecoder:(LRTVDBBinaryDecoder *)decoder
+{
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    
+    LRTVDBStringInterner *interner = [LRTVDBStringInterner sharedInterner];
+    
+    NSArray *episodes = nil;
+    NSArray *images = nil;
+    NSArray *actors = nil;
+    
+    LRTVDBBinaryTag tag;
+    
+    while ([decoder decodeNextFieldTag:&tag])
+    {
+        switch (tag)
+        {
+            case kShowIDTag:
+                show.showID = [decoder decodeString];
+                break;
+            case kShowNameTag:
+                show.name = [decoder decodeString];
+                break;
+            case kShowOverviewTag:
+                show.overview = [decoder decodeString];
+                break;
+            case kShowAirDayTag:
+                show.airDay = [interner internString:[decoder decodeString]];
+                break;
+            case kShowAirTimeTag:
+                show.airTime = [interner internString:[decoder decodeString]];
+                break;
+            case kShowFanartURLTag:
+                show.fanartURL = LRTVDBImageURLForDecodedString([decoder decodeString], decoder.recordSchemaVersion);
+                break;
+            case kShowBannerURLTag:
+                show.bannerURL = LRTVDBImageURLForDecodedString([decoder decodeString], decoder.recordSchemaVersion);
+                break;
+            case kShowPosterURLTag:
+                show.posterURL = LRTVDBImageURLForDecodedString([decoder decodeString], decoder.recordSchemaVersion);
+                break;
+            case kShowPremiereDayNumberTag:
+                show.premiereDate = [decoder decodeDate];
+                break;
+            case kShowGenresTag:
+                show.genres = [interner internStringsInArray:[decoder decodeStrings]];
+                break;
+            case kShowActorsNamesTag:
+                show.actorsNames = [interner internStringsInArray:[decoder decodeStrings]];
+                break;
+            case kShowImdbIDTag:
+                show.imdbID = [decoder decodeString];
+                break;
+            case kShowNetworkTag:
+                show.network = [interner internString:[decoder decodeString]];
+                break;
+            case kShowLanguageTag:
+                show.language = [interner internString:[decoder decodeString]];
+                break;
+            case kShowAvailableLanguagesTag:
+                show.availableLanguages = [decoder decodeStrings];
+                break;
+            case kShowRatingTag:
+                show.rating = @([decoder decodeDouble]);
+                break;
+            case kShowRatingCountTag:
+                show.ratingCount = @([decoder decodeInteger]);
+                break;
+            case kShowBasicStatusTag:
+                show.basicStatus = (LRTVDBShowBasicStatus)[decoder decodeUnsignedInteger];
+                break;
+            case kShowContentRatingTag:
+                show.contentRating = [interner internString:[decoder decodeString]];
+                break;
+            case kShowRuntimeTag:
+                show.runtime = @([decoder decodeInteger]);
+                break;
+            case kShowInfoFingerprintTag:
+                show.infoFingerprint = @([decoder decodeUnsignedInteger]);
+                break;
+            case kShowImagesFingerprintTag:
+                show.imagesFingerprint = @([decoder decodeUnsignedInteger]);
+                break;
+            case kShowActorsFingerprintTag:
+                show.actorsFingerprint = @([decoder decodeUnsignedInteger]);
+                break;
+            case kShowEpisodesTag:
+                episodes = [decoder decodeObjectsOfClass:[LRTVDBEpisode class]];
+                break;
+            case kShowImagesTag:
+                images = [decoder decodeObjectsOfClass:[LRTVDBImage class]];
+                break;
+            case kShowActorsTag:
+                actors = [decoder decodeObjectsOfClass:[LRTVDBActor class]];
+                break;
+            default:
+                [decoder skipField];
+                break;
+        }
+    }
+    
+    if (!show.showID || !show.name || decoder.error) return nil;
+    
+    if (episodes) [show addEpisodes:episodes];
+    if (images) [show addImages:images];
+    if (actors) [show addActors:actors];
+    
+    return show;
+}
+
+- (void)encodeWithEncoder:(LRTVDBBinaryEncoder *)encoder
+{
+    [encoder encodeString:self.showID forTag:kShowIDTag];
+    [encoder encodeString:self.name forTag:kShowNameTag];
+    [encoder encodeString:self.overview forTag:kShowOverviewTag];
+    [encoder encodeString:self.airDay forTag:kShowAirDayTag];
+    [encoder encodeString:self.airTime forTag:kShowAirTimeTag];
+    [encoder encodeString:LRTVDBImagePathForURL(self.fanartURL) forTag:kShowFanartURLTag];
+    [encoder encodeString:LRTVDBImagePathForURL(self.bannerURL) forTag:kShowBannerURLTag];
+    [encoder encodeString:LRTVDBImagePathForURL(self.posterURL) forTag:kShowPosterURLTag];
+    [encoder encodeDate:self.premiereDate forTag:kShowPremiereDayNumberTag];
+    [encoder encodeStrings:self.genres forTag:kShowGenresTag];
+    [encoder encodeStrings:self.actorsNames forTag:kShowActorsNamesTag];
+    [encoder encodeString:self.imdbID forTag:kShowImdbIDTag];
+    [encoder encodeString:self.network forTag:kShowNetworkTag];
+    [encoder encodeString:self.language forTag:kShowLanguageTag];
+    [encoder encodeStrings:self.availableLanguages forTag:kShowAvailableLanguagesTag];
+    
+    if (self.rating) [encoder encodeDouble:LRTVDBRatingValue(self.rating) forTag:kShowRatingTag];
+    if (self.ratingCount) [encoder encodeInteger:[self.ratingCount longLongValue] forTag:kShowRatingCountTag];
+    
+    [encoder encodeUnsignedInteger:self.basicStatus forTag:kShowBasicStatusTag];
+    [encoder encodeString:self.contentRating forTag:kShowContentRatingTag];
+    
+    if (self.runtime) [encoder encodeInteger:[self.runtime longLongValue] forTag:kShowRuntimeTag];
+    if (self.infoFingerprint) [encoder encodeUnsignedInteger:[self.infoFingerprint unsignedLongLongValue] forTag:kShowInfoFingerprintTag];
+    if (self.imagesFingerprint) [encoder encodeUnsignedInteger:[self.imagesFingerprint unsignedLongLongValue] forTag:kShowImagesFingerprintTag];
+    if (self.actorsFingerprint) [encoder encodeUnsignedInteger:[self.actorsFingerprint unsignedLongLongValue] forTag:kShowActorsFingerprintTag];
+    
+    [encoder encodeObjects:self.episodes forTag:kShowEpisodesTag];
+    [encoder encodeObjects:self.images forTag:kShowImagesTag];
+    [encoder encodeObjects:self.actors forTag:kShowActorsTag];
+}
+
++ (NSArray *)deserializeEpisodes:(NSArray *)episodes showID:(NSString *)showID
 {
     if (!episodes) return nil;
 
@@ -922,7 +2196,7 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
     {
         NSError *error;
         
-        LRTVDBEpisode *episode = [LRTVDBEpisode deserialize:dictionary error:&error];
+        LRTVDBEpisode *episode = [LRTVDBEpisode deserialize:dictionary showID:showID error:&error];
         
         if (episode)
         {
@@ -1017,6 +2291,51 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
     return [serializedActors copy];
 }
 
+#pragma mark - Dirty sections
+
+- (void)markSectionsAsDirty:(LRTVDBShowSection)sections
+{
+    OSAtomicOr32Barrier(sections, &_dirtySections);
+}
+
+- (LRTVDBShowSection)takeDirtySections
+{
+    return OSAtomicAnd32OrigBarrier(0, &_dirtySections);
+}
+
+- (void)performBlockWithConsistentState:(void (^)(void))block
+{
+    pthread_mutex_lock(&_writeLock);
+    block();
+    pthread_mutex_unlock(&_writeLock);
+}
+
+- (NSDictionary *)serializedSectionsByTakingDirtySections:(LRTVDBShowSection *)dirtySections
+                                            extraSections:(LRTVDBShowSection)extraSections
+{
+    NSMutableDictionary *serializedSections = [NSMutableDictionary dictionary];
+    
+    __block LRTVDBShowSection takenSections = 0;
+    
+    [self performBlockWithConsistentState:^{
+        
+        takenSections = [self takeDirtySections];
+        LRTVDBShowSection sections = takenSections | extraSections;
+        
+        for (LRTVDBShowSection section = LRTVDBShowSectionInfo; section <= LRTVDBShowSectionActors; section <<= 1)
+        {
+            if (sections & section)
+            {
+                serializedSections[@(section)] = [self serializeSection:section];
+            }
+        }
+    }];
+    
+    if (dirtySections) *dirtySections = takenSections;
+    
+    return [serializedSections copy];
+}
+
 #pragma mark - Equality methods
 
 - (BOOL)isEqual:(id)object
@@ -1041,6 +2360,158 @@ NSComparator LRTVDBShowComparator = ^NSComparisonResult(LRTVDBShow *firstShow, L
     return LRTVDBShowComparator(self, object);
 }
 
+#pragma mark - Sort key
+
+// LRTVDBShowComparator runs on every comparison while sorting shows, so the
+// values it depends on are packed into a cached key, refreshed only when any
+// of them changes. Shows are sorted by:
+//
+// - Days to next episode (ascending)
+// - Status (unknown status at the end)
+// - Rating (descending)
+// - Rating count (descending)
+// - Name (case and diacritic insensitive, shows without name at the end)
+//
+// The first four fields are packed (24 + 3 + 16 + 21 bits) into a 64 bit
+// prefix. Packing clamps and rounds, which never reverses the order of two
+// shows but can make different values equal, so exact rating and rating
+// count are compared again when prefixes are equal.
+
+static const NSInteger kLRTVDBSortKeyDaysBias = 1 << 23;
+static const uint64_t kLRTVDBSortKeyDaysMask = (1 << 24) - 1;
+static const uint64_t kLRTVDBSortKeyStatusMask = (1 << 3) - 1;
+static const uint64_t kLRTVDBSortKeyRatingMask = (1 << 16) - 1;
+static const uint64_t kLRTVDBSortKeyRatingCountMask = (1 << 21) - 1;
+
+NS_INLINE uint64_t LRTVDBClampedSortKeyField(double value, uint64_t mask)
+{
+    return value <= 0 ? 0 : (value >= mask ? mask : (uint64_t)value);
+}
+
+- (void)updateSortKeyIfNeeded
+{
+    // Days to next episode and status change when the day rolls over.
+    LRTVDBShowEpisodesInformation *episodesInformation = [self episodesInformation];
+    
+    OSSpinLockLock(&_sortKeyLock);
+    BOOL needsUpdate = _sortKeyNeedsUpdate;
+    uint32_t generation = _sortKeyGeneration;
+    _sortKeyNeedsUpdate = NO;
+    OSSpinLockUnlock(&_sortKeyLock);
+    
+    if (!needsUpdate) return;
+    
+    // Unknown days to next episode sort after every known one.
+    uint64_t days = kLRTVDBSortKeyDaysMask;
+    NSNumber *daysToNextEpisode = episodesInformation.daysToNextEpisode;
+    
+    if (daysToNextEpisode && [daysToNextEpisode integerValue] != NSIntegerMax)
+    {
+        days = LRTVDBClampedSortKeyField((double)[daysToNextEpisode integerValue] + kLRTVDBSortKeyDaysBias,
+                                         kLRTVDBSortKeyDaysMask - 1);
+    }
+    
+    LRTVDBShowStatus showStatus = episodesInformation.status;
+    uint64_t status = showStatus == LRTVDBShowStatusUnknown ? kLRTVDBSortKeyStatusMask : (uint64_t)showStatus;
+    
+    LRTVDBShowSortKey sortKey;
+    sortKey.rating = [_rating doubleValue];
+    sortKey.ratingCount = [_ratingCount unsignedIntegerValue];
+    
+    // Descending fields are stored complemented.
+    uint64_t rating = kLRTVDBSortKeyRatingMask - LRTVDBClampedSortKeyField(round(sortKey.rating * 100), kLRTVDBSortKeyRatingMask);
+    uint64_t ratingCount = kLRTVDBSortKeyRatingCountMask - LRTVDBClampedSortKeyField(sortKey.ratingCount, kLRTVDBSortKeyRatingCountMask);
+    
+    sortKey.prefix = (days << 40) | (status << 37) | (rating << 21) | ratingCount;
+    
+    NSString *sortKeyName = [_name stringByFoldingWithOptions:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)
+                                                       locale:nil];
+    
+    OSSpinLockLock(&_sortKeyLock);
+    NSString *oldSortKeyName = _sortKeyName; // Released out of the lock
+    _sortKey = sortKey;
+    _sortKeyName = sortKeyName;
+    // Changed while the key was being built, so it's built again next time.
+    if (_sortKeyGeneration != generation) _sortKeyNeedsUpdate = YES;
+    OSSpinLockUnlock(&_sortKeyLock);
+    
+    oldSortKeyName = nil;
+}
+
+- (void)setNeedsUpdateSortKey
+{
+    OSSpinLockLock(&_sortKeyLock);
+    _sortKeyNeedsUpdate = YES;
+    _sortKeyGeneration++;
+    OSSpinLockUnlock(&_sortKeyLock);
+}
+
+/**
+ Copies the sort key, updating it first if needed.
+ @return The name of the sort key.
+ */
+- (NSString *)getSortKey:(LRTVDBShowSortKey *)sortKey
+{
+    [self updateSortKeyIfNeeded];
+    
+    OSSpinLockLock(&_sortKeyLock);
+    *sortKey = _sortKey;
+    NSString *sortKeyName = _sortKeyName;
+    OSSpinLockUnlock(&_sortKeyLock);
+    
+    return sortKeyName;
+}
+
+- (NSComparisonResult)compareBySortKeyToShow:(LRTVDBShow *)show
+{
+    LRTVDBShowSortKey sortKey, otherSortKey;
+    
+    NSString *sortKeyName = [self getSortKey:&sortKey];
+    NSString *otherSortKeyName = [show getSortKey:&otherSortKey];
+    
+    if (sortKey.prefix != otherSortKey.prefix)
+    {
+        return sortKey.prefix < otherSortKey.prefix ? NSOrderedAscending : NSOrderedDescending;
+    }
+    
+    if (sortKey.rating != otherSortKey.rating)
+    {
+        return sortKey.rating > otherSortKey.rating ? NSOrderedAscending : NSOrderedDescending;
+    }
+    
+    if (sortKey.ratingCount != otherSortKey.ratingCount)
+    {
+        return sortKey.ratingCount > otherSortKey.ratingCount ? NSOrderedAscending : NSOrderedDescending;
+    }
+    
+    if (!sortKeyName || !otherSortKeyName)
+    {
+        if (!sortKeyName && !otherSortKeyName) return NSOrderedSame;
+        
+        return sortKeyName ? NSOrderedAscending : NSOrderedDescending;
+    }
+    
+    return [sortKeyName compare:otherSortKeyName options:NSLiteralSearch];
+}
+
+- (void)setName:(NSString *)name
+{
+    _name = [name copy];
+    [self setNeedsUpdateSortKey];
+}
+
+- (void)setRating:(NSNumber *)rating
+{
+    _rating = rating;
+    [self setNeedsUpdateSortKey];
+}
+
+- (void)setRatingCount:(NSNumber *)ratingCount
+{
+    _ratingCount = ratingCount;
+    [self setNeedsUpdateSortKey];
+}
+
 #pragma mark - Description
 
 - (NSString *)description
@@ -23,6 +23,7 @@
 #import "LRTVDBAPIClient+Private.h"
 #import "LRTVDBActor+Private.h"
 #import "LRTVDBActorParser.h"
+#import "LRTVDBParseContext.h"
 #import "NSString+LRTVDBAdditions.h"
 #import "TBXML.h"
 
@@ -34,11 +35,27 @@ static NSString *const kLRTVDBActorRoleXMLKey = @"Role";
 static NSString *const kLRTVDBActorImageXMLKey = @"Image";
 static NSString *const kLRTVDBActorSortOrderXMLKey = @"SortOrder";
 
+@interface LRTVDBActorParser ()
+
+@property (nonatomic, strong) LRTVDBParseContext *context;
+
+@end
+
 @implementation LRTVDBActorParser
 
 + (instancetype)parser
 {
-    return [[self alloc] init];
+    return [self parserWithContext:[LRTVDBParseContext defaultContext]];
+}
+
++ (instancetype)parserWithContext:(LRTVDBParseContext *)context
+{
+    NSParameterAssert(context);
+    
+    LRTVDBActorParser *parser = [[self alloc] init];
+    parser.context = context;
+    
+    return parser;
 }
 
 - (NSArray *)actorsFromData:(NSData *)data
@@ -0,0 +1,62 @@
+// LRTVDBArchiveParser.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class LRTVDBParseContext;
+@class LRTVDBShow;
+
+/**
+ Parses the zip file of a show, as served by TVDB: the series XML with its
+ episodes, the banners XML and the actors XML, in that order.
+ */
+@interface LRTVDBArchiveParser : NSObject
+
+/**
+ @return A parser using the default context.
+ */
++ (instancetype)parser;
+
+/**
+ @return A parser using the provided context.
+ */
++ (instancetype)parserWithContext:(LRTVDBParseContext *)context;
+
+@property (nonatomic, strong, readonly) LRTVDBParseContext *context;
+
+/**
+ @param replaceArtwork Whether the artwork of the current show is replaced
+ by the one in the zip (see LRTVDBFingerprint). YES for new shows.
+ @param currentShow The show being updated, if any. Sections whose fingerprint
+ matches the current show one are not parsed, not even inflated.
+ @return The show in the zip data, an empty show only identified by its ID
+ if its info hasn't changed since the current show, or nil if the data is
+ not a show zip.
+ */
+- (LRTVDBShow *)showFromData:(NSData *)data
+             includeEpisodes:(BOOL)includeEpisodes
+               includeImages:(BOOL)includeImages
+               includeActors:(BOOL)includeActors
+              replaceArtwork:(BOOL)replaceArtwork
+                 currentShow:(LRTVDBShow *)currentShow;
+
+@end
@@ -0,0 +1,132 @@
+// LRTVDBArchiveParser.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBAPIClient+Private.h"
+#import "LRTVDBActorParser.h"
+#import "LRTVDBArchiveParser.h"
+#import "LRTVDBEpisodeParser.h"
+#import "LRTVDBImageParser.h"
+#import "LRTVDBParseContext.h"
+#import "LRTVDBShow+Private.h"
+#import "LRTVDBShowParser.h"
+#import "NSArray+LRTVDBAdditions.h"
+#import "ZZArchive.h"
+#import "ZZArchiveEntry.h"
+
+@interface LRTVDBArchiveParser ()
+
+@property (nonatomic, strong) LRTVDBParseContext *context;
+
+@end
+
+@implementation LRTVDBArchiveParser
+
++ (instancetype)parser
+{
+    return [self parserWithContext:[LRTVDBParseContext defaultContext]];
+}
+
++ (instancetype)parserWithContext:(LRTVDBParseContext *)context
+{
+    NSParameterAssert(context);
+    
+    LRTVDBArchiveParser *parser = [[self alloc] init];
+    parser.context = context;
+    
+    return parser;
+}
+
+- (LRTVDBShow *)showFromData:(NSData *)data
+             includeEpisodes:(BOOL)includeEpisodes
+               includeImages:(BOOL)includeImages
+               includeActors:(BOOL)includeActors
+              replaceArtwork:(BOOL)replaceArtwork
+                 currentShow:(LRTVDBShow *)currentShow
+{
+    if (!data) return nil;
+    
+    ZZArchive *archive = [ZZArchive archiveWithData:data];
+    
+    if ([archive.entries count] == 0) return nil;
+    
+    LRTVDBParseContext *context = self.context;
+    
+    // series XML info
+    ZZArchiveEntry *firstArchiveEntry = archive.entries[0];
+    // images XML info
+    ZZArchiveEntry *secondArchiveEntry = [archive.entries count] > 1 ?
+    archive.entries[1] : nil;
+    // actors XML info
+    ZZArchiveEntry *thirdArchiveEntry = [archive.entries count] > 2 ?
+    archive.entries[2] : nil;
+    
+    // The CRC32 of every entry comes in the zip directory, so
+    // unchanged entries are not even inflated.
+    NSNumber *infoFingerprint = LRTVDBFingerprint((uint32_t)firstArchiveEntry.crc32, context, includeEpisodes, replaceArtwork);
+    NSNumber *imagesFingerprint = secondArchiveEntry ? LRTVDBFingerprint((uint32_t)secondArchiveEntry.crc32, context, NO, NO) : nil;
+    NSNumber *actorsFingerprint = thirdArchiveEntry ? LRTVDBFingerprint((uint32_t)thirdArchiveEntry.crc32, context, NO, NO) : nil;
+    
+    LRTVDBShow *show = nil;
+    
+    if (currentShow && [infoFingerprint isEqual:currentShow.infoFingerprint])
+    {
+        show = LRTVDBUnchangedShow(currentShow);
+    }
+    else
+    {
+        NSData *infoData = firstArchiveEntry.data;
+        
+        // We know there's only one
+        show = [[[LRTVDBShowParser parserWithContext:context] parseShowInfoFromData:infoData] lr_firstObject];
+        
+        if (includeEpisodes)
+        {
+            [show addEpisodes:[[LRTVDBEpisodeParser parserWithContext:context] episodesFromData:infoData]];
+        }
+    }
+    
+    show.infoFingerprint = infoFingerprint;
+    
+    if (includeImages)
+    {
+        if (!currentShow || ![imagesFingerprint isEqual:currentShow.imagesFingerprint])
+        {
+            [show addImages:[[LRTVDBImageParser parserWithContext:context] imagesFromData:secondArchiveEntry.data]];
+        }
+        
+        show.imagesFingerprint = imagesFingerprint;
+    }
+    
+    if (includeActors)
+    {
+        if (!currentShow || ![actorsFingerprint isEqual:currentShow.actorsFingerprint])
+        {
+            [show addActors:[[LRTVDBActorParser parserWithContext:context] actorsFromData:thirdArchiveEntry.data]];
+        }
+        
+        show.actorsFingerprint = actorsFingerprint;
+    }
+    
+    return show;
+}
+
+@end
@@ -21,9 +21,10 @@
 // THE SOFTWARE.
 
 #import "LRTVDBAPIClient+Private.h"
-#import "LRTVDBAPIClient.h"
 #import "LRTVDBEpisode+Private.h"
 #import "LRTVDBEpisodeParser.h"
+#import "LRTVDBParseContext.h"
+#import "LRTVDBStringInterner.h"
 #import "NSString+LRTVDBAdditions.h"
 #import "TBXML.h"
 
@@ -45,11 +46,42 @@ static NSString *const kLRTVDBEpisodeRatingCountXMLKey = @"RatingCount";
 static NSString *const kLRTVDBEpisodeNumberXMLKey = @"EpisodeNumber";
 static NSString *const kLRTVDBEpisodeSeasonNumberXMLKey = @"SeasonNumber";
 
+/**
+ Appends the raw text of the element to the buffer.
+ @return The range of the text inside the buffer.
+ */
+static NSRange LRTVDBAppendElementText(NSMutableData *buffer, TBXMLElement *element)
+{
+    if (element == NULL || element->text == NULL) return NSMakeRange(NSNotFound, 0);
+    
+    NSRange range = NSMakeRange([buffer length], strlen(element->text));
+    
+    [buffer appendBytes:element->text length:range.length];
+    
+    return range;
+}
+
+@interface LRTVDBEpisodeParser ()
+
+@property (nonatomic, strong) LRTVDBParseContext *context;
+
+@end
+
 @implementation LRTVDBEpisodeParser
 
 + (instancetype)parser
 {
-    return [[self alloc] init];
+    return [self parserWithContext:[LRTVDBParseContext defaultContext]];
+}
+
++ (instancetype)parserWithContext:(LRTVDBParseContext *)context
+{
+    NSParameterAssert(context);
+    
+    LRTVDBEpisodeParser *parser = [[self alloc] init];
+    parser.context = context;
+    
+    return parser;
 }
 
 - (NSArray *)episodesFromData:(NSData *)data
@@ -64,6 +96,12 @@ static NSString *const kLRTVDBEpisodeSeasonNumberXMLKey = @"SeasonNumber";
     
     NSMutableArray *episodes = [NSMutableArray array];
     
+    LRTVDBStringInterner *interner = [LRTVDBStringInterner sharedInterner];
+    
+    // Raw text of the heavy fields and their location for each episode when lazyEpisodeTextFields is on.
+    NSMutableData *textFieldsBuffer = self.context.lazyEpisodeTextFields ? [NSMutableData data] : nil;
+    NSMutableArray *textFieldsRanges = self.context.lazyEpisodeTextFields ? [NSMutableArray array] : nil;
+    
     while (episodeElement != nil)
     {
         LRTVDBEpisode *episode = [[LRTVDBEpisode alloc] init];
@@ -86,35 +124,66 @@ static NSString *const kLRTVDBEpisodeSeasonNumberXMLKey = @"SeasonNumber";
 
         if (episodeIdElement) episode.episodeID = LREmptyStringToNil([TBXML textForElement:episodeIdElement]);
         if (episodeTitleElement) episode.title = [LREmptyStringToNil([TBXML textForElement:episodeTitleElement]) unescapeHTMLEntities];
-        if (episodeOverviewElement) episode.overview = [LREmptyStringToNil([TBXML textForElement:episodeOverviewElement]) unescapeHTMLEntities];
-        if (episodeLanguageElement) episode.language = LREmptyStringToNil([TBXML textForElement:episodeLanguageElement]);
+        if (episodeLanguageElement) episode.language = [interner internString:LREmptyStringToNil([TBXML textForElement:episodeLanguageElement])];
         if (episodeImageUrlElement) episode.imageURL = LRTVDBImageURLForPath(LREmptyStringToNil([TBXML textForElement:episodeImageUrlElement]));
         if (episodeImdbIdElement) episode.imdbID = LREmptyStringToNil([TBXML textForElement:episodeImdbIdElement]);
-        if (episodeShowIdElement) episode.showID = LREmptyStringToNil([TBXML textForElement:episodeShowIdElement]);
-        if (episodeDirectorsElement) episode.directors = [[LREmptyStringToNil([TBXML textForElement:episodeDirectorsElement]) pipedStringToArray] lr_arrayByRemovingDuplicates];
-        if (episodeWritersElement) episode.writers = [[LREmptyStringToNil([TBXML textForElement:episodeWritersElement]) pipedStringToArray] lr_arrayByRemovingDuplicates];
-        if (episodeGuestStarsElement) episode.guestStars = [[LREmptyStringToNil([TBXML textForElement:episodeGuestStarsElement]) pipedStringToArray] lr_arrayByRemovingDuplicates];
-        if (episodeAiredDateElement) episode.airedDate = [LREmptyStringToNil([TBXML textForElement:episodeAiredDateElement]) dateValue];
-        if (episodeRatingElement) episode.rating = @([LREmptyStringToNil([TBXML textForElement:episodeRatingElement]) floatValue]);
+        if (episodeShowIdElement) episode.showID = [interner internString:LREmptyStringToNil([TBXML textForElement:episodeShowIdElement])];
+        if (episodeAiredDateElement) episode.airedDayNumber = LRTVDBDayNumberFromISODateCString(episodeAiredDateElement->text);
+        if (episodeRatingElement) episode.rating = @([LREmptyStringToNil([TBXML textForElement:episodeRatingElement]) doubleValue]);
         if (episodeRatingCountElement) episode.ratingCount = @([LREmptyStringToNil([TBXML textForElement:episodeRatingCountElement]) integerValue]);
         if (episodeSeasonNumberElement) episode.seasonNumber = @([LREmptyStringToNil([TBXML textForElement:episodeSeasonNumberElement]) integerValue]);
         if (episodeNumberElement) episode.episodeNumber = @([LREmptyStringToNil([TBXML textForElement:episodeNumberElement]) integerValue]);
 
         BOOL shouldIncludeEpisode = YES;
         
-        if ([LRTVDBAPIClient sharedClient].includeSpecials == NO)
+        if (self.context.includeSpecials == NO)
         {
             shouldIncludeEpisode = ![episode isSpecial];
         }
         
         if (shouldIncludeEpisode && [episode isCorrect])
         {
+            LRTVDBEpisodeTextRanges ranges = LRTVDBEpisodeEmptyTextRanges();
+            
+            // Excluded episodes never get here, so their text is neither decoded nor kept in the buffer.
+            if (textFieldsBuffer)
+            {
+                ranges.overview = LRTVDBAppendElementText(textFieldsBuffer, episodeOverviewElement);
+                ranges.directors = LRTVDBAppendElementText(textFieldsBuffer, episodeDirectorsElement);
+                ranges.writers = LRTVDBAppendElementText(textFieldsBuffer, episodeWritersElement);
+                ranges.guestStars = LRTVDBAppendElementText(textFieldsBuffer, episodeGuestStarsElement);
+            }
+            else
+            {
+                if (episodeOverviewElement) episode.overview = [LREmptyStringToNil([TBXML textForElement:episodeOverviewElement]) unescapeHTMLEntities];
+                if (episodeDirectorsElement) episode.directors = [interner internStringsInArray:[[LREmptyStringToNil([TBXML textForElement:episodeDirectorsElement]) pipedStringToArray] lr_arrayByRemovingDuplicates]];
+                if (episodeWritersElement) episode.writers = [interner internStringsInArray:[[LREmptyStringToNil([TBXML textForElement:episodeWritersElement]) pipedStringToArray] lr_arrayByRemovingDuplicates]];
+                if (episodeGuestStarsElement) episode.guestStars = [interner internStringsInArray:[[LREmptyStringToNil([TBXML textForElement:episodeGuestStarsElement]) pipedStringToArray] lr_arrayByRemovingDuplicates]];
+            }
+            
             [episodes addObject:episode];
+            [textFieldsRanges addObject:[NSValue valueWithBytes:&ranges objCType:@encode(LRTVDBEpisodeTextRanges)]];
         }
         
         episodeElement = [TBXML nextSiblingNamed:kLRTVDBEpisodeSiblingXMLKey searchFromElement:episodeElement];
     }
     
+    if ([textFieldsBuffer length] > 0)
+    {
+        // Exactly sized copy. Every episode drops its reference once decoded, so the
+        // buffer goes away as soon as the last pending episode has been decoded.
+        NSData *sharedBuffer = [textFieldsBuffer copy];
+        textFieldsBuffer = nil;
+        
+        [episodes enumerateObjectsUsingBlock:^(LRTVDBEpisode *episode, NSUInteger idx, BOOL *stop) {
+            
+            LRTVDBEpisodeTextRanges ranges;
+            [textFieldsRanges[idx] getValue:&ranges];
+            
+            [episode setTextFieldsBuffer:sharedBuffer ranges:ranges];
+        }];
+    }
+    
     return [episodes copy];    
 }
 
@@ -22,10 +22,22 @@
 
 #import <Foundation/Foundation.h>
 
+@class LRTVDBParseContext;
+
 @interface LRTVDBImageParser : NSObject
 
+/**
+ @return A parser using the default context.
+ */
 + (instancetype)parser;
 
+/**
+ @return A parser using the provided context.
+ */
++ (instancetype)parserWithContext:(LRTVDBParseContext *)context;
+
+@property (nonatomic, strong, readonly) LRTVDBParseContext *context;
+
 - (NSArray *)imagesFromData:(NSData *)data;
 
 @end
@@ -23,6 +23,7 @@
 #import "LRTVDBAPIClient+Private.h"
 #import "LRTVDBImage+Private.h"
 #import "LRTVDBImageParser.h"
+#import "LRTVDBParseContext.h"
 #import "TBXML.h"
 
 // XML keys
@@ -32,16 +33,33 @@ static NSString *const kLRTVDBImageUrlThumbnailXMLKey = @"ThumbnailPath";
 static NSString *const kLRTVDBImageRatingXMLKey = @"Rating";
 static NSString *const kLRTVDBImageRatingCountXMLKey = @"RatingCount";
 static NSString *const kLRTVDBImageTypeXMLKey = @"BannerType";
+static NSString *const kLRTVDBImageSeasonXMLKey = @"Season";
 static NSString *const kLRTVDBImageTypeFanartXMLKey = @"fanart";
 static NSString *const kLRTVDBImageTypePosterXMLKey = @"poster";
 static NSString *const kLRTVDBImageTypeSeasonXMLKey = @"season";
 static NSString *const kLRTVDBImageTypeSeriesXMLKey = @"series";
 
+@interface LRTVDBImageParser ()
+
+@property (nonatomic, strong) LRTVDBParseContext *context;
+
+@end
+
 @implementation LRTVDBImageParser
 
 + (instancetype)parser
 {
-    return [[self alloc] init];
+    return [self parserWithContext:[LRTVDBParseContext defaultContext]];
+}
+
++ (instancetype)parserWithContext:(LRTVDBParseContext *)context
+{
+    NSParameterAssert(context);
+    
+    LRTVDBImageParser *parser = [[self alloc] init];
+    parser.context = context;
+    
+    return parser;
 }
 
 - (NSArray *)imagesFromData:(NSData *)data
@@ -65,10 +83,11 @@ static NSString *const kLRTVDBImageTypeSeriesXMLKey = @"series";
         TBXMLElement *imageRatingElement = [TBXML childElementNamed:kLRTVDBImageRatingXMLKey parentElement:imageElement];
         TBXMLElement *imageRatingCountElement = [TBXML childElementNamed:kLRTVDBImageRatingCountXMLKey parentElement:imageElement];
         TBXMLElement *imageTypeElement = [TBXML childElementNamed:kLRTVDBImageTypeXMLKey parentElement:imageElement];
+        TBXMLElement *imageSeasonElement = [TBXML childElementNamed:kLRTVDBImageSeasonXMLKey parentElement:imageElement];
         
-        if (imageUrlElement) image.url = LRTVDBImageURLForPath(LREmptyStringToNil([TBXML textForElement:imageUrlElement]));
-        if (imageThumbnailUrlElement) image.thumbnailURL = LRTVDBImageURLForPath(LREmptyStringToNil([TBXML textForElement:imageThumbnailUrlElement]));
-        if (imageRatingElement) image.rating = @([LREmptyStringToNil([TBXML textForElement:imageRatingElement]) floatValue]);
+        if (imageUrlElement) image.path = LREmptyStringToNil([TBXML textForElement:imageUrlElement]);
+        if (imageThumbnailUrlElement) image.thumbnailPath = LREmptyStringToNil([TBXML textForElement:imageThumbnailUrlElement]);
+        if (imageRatingElement) image.rating = @([LREmptyStringToNil([TBXML textForElement:imageRatingElement]) doubleValue]);
         if (imageRatingCountElement) image.ratingCount = @([LREmptyStringToNil([TBXML textForElement:imageRatingCountElement]) integerValue]);
         
         if (imageTypeElement)
@@ -86,6 +105,9 @@ static NSString *const kLRTVDBImageTypeSeriesXMLKey = @"series";
             else if ([imageTypeString isEqualToString:kLRTVDBImageTypeSeasonXMLKey])
             {
                 image.type = LRTVDBImageTypeSeason;
+                
+                NSString *seasonString = imageSeasonElement ? LREmptyStringToNil([TBXML textForElement:imageSeasonElement]) : nil;
+                if (seasonString) image.seasonNumber = @([seasonString integerValue]);
             }
             else if ([imageTypeString isEqualToString:kLRTVDBImageTypeSeriesXMLKey])
             {
@@ -0,0 +1,56 @@
+// LRTVDBParseContext.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ Immutable configuration used by the parsers.
+ @discussion Every LRTVDBAPIClient builds a new context for each request with
+ its own configuration at the time of the request, so parsers never depend on
+ mutable global state and several clients can be used side by side.
+ */
+@interface LRTVDBParseContext : NSObject <NSCopying>
+
+/**
+ Context with the default configuration: English language, no specials and
+ eager decoding of every episode field.
+ */
++ (instancetype)defaultContext;
+
+- (id)initWithLanguage:(NSString *)language
+       includeSpecials:(BOOL)includeSpecials
+ lazyEpisodeTextFields:(BOOL)lazyEpisodeTextFields;
+
+/** Language used to choose between the different language versions of the same show. */
+@property (nonatomic, copy, readonly) NSString *language;
+
+/** If NO, special episodes (season 0) are discarded. */
+@property (nonatomic, readonly) BOOL includeSpecials;
+
+/**
+ If YES, overview, directors, writers and guest stars are not decoded while
+ parsing. Their raw text is kept in a buffer shared by every parsed episode
+ and they are decoded on first access.
+ */
+@property (nonatomic, readonly) BOOL lazyEpisodeTextFields;
+
+@end
@@ -0,0 +1,77 @@
+// LRTVDBParseContext.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBParseContext.h"
+#import "LRTVDBAPIClient+Private.h"
+
+@implementation LRTVDBParseContext
+
++ (instancetype)defaultContext
+{
+    static LRTVDBParseContext *defaultContext = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        defaultContext = [[self alloc] initWithLanguage:LRTVDBDefaultLanguage()
+                                        includeSpecials:NO
+                                  lazyEpisodeTextFields:NO];
+    });
+    
+    return defaultContext;
+}
+
+- (id)init
+{
+    return [self initWithLanguage:LRTVDBDefaultLanguage()
+                  includeSpecials:NO
+            lazyEpisodeTextFields:NO];
+}
+
+- (id)initWithLanguage:(NSString *)language
+       includeSpecials:(BOOL)includeSpecials
+ lazyEpisodeTextFields:(BOOL)lazyEpisodeTextFields
+{
+    if (self = [super init])
+    {
+        _language = [(language ?: LRTVDBDefaultLanguage()) copy];
+        _includeSpecials = includeSpecials;
+        _lazyEpisodeTextFields = lazyEpisodeTextFields;
+    }
+    return self;
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    // Immutable
+    return self;
+}
+
+#pragma mark - Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"Language: %@\nInclude specials: %d\nLazy episode text fields: %d\n",
+            self.language, self.includeSpecials, self.lazyEpisodeTextFields];
+}
+
+@end
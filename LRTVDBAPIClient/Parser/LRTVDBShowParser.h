@@ -22,14 +22,42 @@
 
 #import <Foundation/Foundation.h>
 
+@class LRTVDBParseContext;
+
 @interface LRTVDBShowParser : NSObject
 
+/**
+ @return A parser using the default context.
+ */
 + (instancetype)parser;
 
+/**
+ @return A parser using the provided context.
+ */
++ (instancetype)parserWithContext:(LRTVDBParseContext *)context;
+
+@property (nonatomic, strong, readonly) LRTVDBParseContext *context;
+
+/**
+ Parses search results.
+ @return Shows without language duplicates, in the same order as the results.
+ The context language is used to choose between the different language
+ versions of the same show.
+ */
 - (NSArray *)parseBasicShowInfoFromData:(NSData *)data;
 
 - (NSArray *)parseShowInfoFromData:(NSData *)data;
 
 - (NSArray *)showsIDsFromData:(NSData *)data;
 
+/**
+ Keeps one show per show ID. The chosen one is the first show in the
+ preferred language, or else the last one in English, or else the first one.
+ The languages of every version are set as the show availableLanguages.
+ @return Shows in the order of the first appearance of each show ID.
+ @remarks Runs in linear time.
+ */
++ (NSArray *)removeLanguageDuplicatesFromShows:(NSArray *)showsWithLanguageDuplicates
+                             preferredLanguage:(NSString *)preferredLanguage;
+
 @end
@@ -21,9 +21,10 @@
 // THE SOFTWARE.
 
 #import "LRTVDBAPIClient+Private.h"
-#import "LRTVDBAPIClient.h"
 #import "LRTVDBShow+Private.h"
 #import "LRTVDBShowParser.h"
+#import "LRTVDBParseContext.h"
+#import "LRTVDBStringInterner.h"
 #import "NSString+LRTVDBAdditions.h"
 #import "TBXML.h"
 
@@ -53,11 +54,27 @@ static NSString *const kLRTVDBShowBasicStatusXMLKey = @"Status";
 static NSString *const kLRTVDBShowBasicStatusContinuingXMLKey = @"Continuing";
 static NSString *const kLRTVDBShowBasicStatusEndedXMLKey = @"Ended";
 
+@interface LRTVDBShowParser ()
+
+@property (nonatomic, strong) LRTVDBParseContext *context;
+
+@end
+
 @implementation LRTVDBShowParser
 
 + (instancetype)parser
 {
-    return [[self alloc] init];
+    return [self parserWithContext:[LRTVDBParseContext defaultContext]];
+}
+
++ (instancetype)parserWithContext:(LRTVDBParseContext *)context
+{
+    NSParameterAssert(context);
+    
+    LRTVDBShowParser *parser = [[self alloc] init];
+    parser.context = context;
+    
+    return parser;
 }
 
 - (NSArray *)parseBasicShowInfoFromData:(NSData *)data
@@ -72,6 +89,8 @@ static NSString *const kLRTVDBShowBasicStatusEndedXMLKey = @"Ended";
     
     NSMutableArray *shows = [NSMutableArray array];
     
+    LRTVDBStringInterner *interner = [LRTVDBStringInterner sharedInterner];
+    
     while (showElement != nil)
     {
         LRTVDBShow *show = [[LRTVDBShow alloc] init];
@@ -88,10 +107,10 @@ static NSString *const kLRTVDBShowBasicStatusEndedXMLKey = @"Ended";
         if (showIdElement) show.showID = LREmptyStringToNil([TBXML textForElement:showIdElement]);
         if (showNameElement) show.name = [LREmptyStringToNil([TBXML textForElement:showNameElement]) unescapeHTMLEntities];
         if (showOverviewElement) show.overview = [LREmptyStringToNil([TBXML textForElement:showOverviewElement]) unescapeHTMLEntities];
-        if (showLanguageElement) show.language = LREmptyStringToNil([TBXML textForElement:showLanguageElement]);
-        if (premiereDateElement) show.premiereDate = [LREmptyStringToNil([TBXML textForElement:premiereDateElement]) dateValue];
+        if (showLanguageElement) show.language = [interner internString:LREmptyStringToNil([TBXML textForElement:showLanguageElement])];
+        if (premiereDateElement) show.premiereDate = [NSDate lr_dateWithDayNumber:LRTVDBDayNumberFromISODateCString(premiereDateElement->text)];
         if (showBannerElement) show.bannerURL = LRTVDBImageURLForPath(LREmptyStringToNil([TBXML textForElement:showBannerElement]));
-        if (networkElement) show.network = LREmptyStringToNil([TBXML textForElement:networkElement]);
+        if (networkElement) show.network = [interner internString:LREmptyStringToNil([TBXML textForElement:networkElement])];
         if (imdbIdElement) show.imdbID = LREmptyStringToNil([TBXML textForElement:imdbIdElement]);
         
         [shows addObject:show];
@@ -99,7 +118,7 @@ static NSString *const kLRTVDBShowBasicStatusEndedXMLKey = @"Ended";
         showElement = [TBXML nextSiblingNamed:kLRTVDBShowSiblingXMLKey searchFromElement:showElement];
     }
     
-    return [[self class] removeLanguageDuplicatesFromShows:shows];
+    return [[self class] removeLanguageDuplicatesFromShows:shows preferredLanguage:self.context.language];
 }
 
 
@@ -115,6 +134,8 @@ static NSString *const kLRTVDBShowBasicStatusEndedXMLKey = @"Ended";
     
     NSMutableArray *shows = [NSMutableArray array];
     
+    LRTVDBStringInterner *interner = [LRTVDBStringInterner sharedInterner];
+    
     while (showElement != nil)
     {
         LRTVDBShow *show = [[LRTVDBShow alloc] init];
@@ -142,20 +163,20 @@ static NSString *const kLRTVDBShowBasicStatusEndedXMLKey = @"Ended";
         if (showIdElement) show.showID = LREmptyStringToNil([TBXML textForElement:showIdElement]);
         if (showNameElement) show.name = [LREmptyStringToNil([TBXML textForElement:showNameElement]) unescapeHTMLEntities];
         if (showOverviewElement) show.overview = [LREmptyStringToNil([TBXML textForElement:showOverviewElement]) unescapeHTMLEntities];
-        if (showLanguageElement) show.language = LREmptyStringToNil([TBXML textForElement:showLanguageElement]);
-        if (premiereDateElement) show.premiereDate = [LREmptyStringToNil([TBXML textForElement:premiereDateElement]) dateValue];
+        if (showLanguageElement) show.language = [interner internString:LREmptyStringToNil([TBXML textForElement:showLanguageElement])];
+        if (premiereDateElement) show.premiereDate = [NSDate lr_dateWithDayNumber:LRTVDBDayNumberFromISODateCString(premiereDateElement->text)];
         if (showBannerElement) show.bannerURL = LRTVDBImageURLForPath(LREmptyStringToNil([TBXML textForElement:showBannerElement]));
-        if (networkElement) show.network = LREmptyStringToNil([TBXML textForElement:networkElement]);
+        if (networkElement) show.network = [interner internString:LREmptyStringToNil([TBXML textForElement:networkElement])];
         if (imdbIdElement) show.imdbID = LREmptyStringToNil([TBXML textForElement:imdbIdElement]);
         if (showPosterElement) show.posterURL = LRTVDBImageURLForPath(LREmptyStringToNil([TBXML textForElement:showPosterElement]));
         if (showFanartElement) show.fanartURL = LRTVDBImageURLForPath(LREmptyStringToNil([TBXML textForElement:showFanartElement]));
-        if (airTimeElement) show.airTime = LREmptyStringToNil([TBXML textForElement:airTimeElement]);
-        if (airDayElement) show.airDay = LREmptyStringToNil([TBXML textForElement:airDayElement]);
-        if (genresElement) show.genres = [[LREmptyStringToNil([TBXML textForElement:genresElement]) pipedStringToArray] lr_arrayByRemovingDuplicates];
-        if (actorsNamesElement) show.actorsNames = [[LREmptyStringToNil([TBXML textForElement:actorsNamesElement]) pipedStringToArray] lr_arrayByRemovingDuplicates];
-        if (ratingElement) show.rating = @([LREmptyStringToNil([TBXML textForElement:ratingElement]) floatValue]);
+        if (airTimeElement) show.airTime = [interner internString:LREmptyStringToNil([TBXML textForElement:airTimeElement])];
+        if (airDayElement) show.airDay = [interner internString:LREmptyStringToNil([TBXML textForElement:airDayElement])];
+        if (genresElement) show.genres = [interner internStringsInArray:[[LREmptyStringToNil([TBXML textForElement:genresElement]) pipedStringToArray] lr_arrayByRemovingDuplicates]];
+        if (actorsNamesElement) show.actorsNames = [interner internStringsInArray:[[LREmptyStringToNil([TBXML textForElement:actorsNamesElement]) pipedStringToArray] lr_arrayByRemovingDuplicates]];
+        if (ratingElement) show.rating = @([LREmptyStringToNil([TBXML textForElement:ratingElement]) doubleValue]);
         if (ratingCountElement) show.ratingCount = @([LREmptyStringToNil([TBXML textForElement:ratingCountElement]) integerValue]);
-        if (contentRatingElement) show.contentRating = LREmptyStringToNil([TBXML textForElement:contentRatingElement]);
+        if (contentRatingElement) show.contentRating = [interner internString:LREmptyStringToNil([TBXML textForElement:contentRatingElement])];
         if (runtimeElement) show.runtime = @([LREmptyStringToNil([TBXML textForElement:runtimeElement]) integerValue]);
 
         if (statusElement)
@@ -206,57 +227,54 @@ static NSString *const kLRTVDBShowBasicStatusEndedXMLKey = @"Ended";
 #pragma mark - Private
 
 + (NSArray *)removeLanguageDuplicatesFromShows:(NSArray *)showsWithLanguageDuplicates
+                             preferredLanguage:(NSString *)preferredLanguage
 {
-    NSMutableArray *showsWithoutLanguageDuplicates = [NSMutableArray array];
+    // One entry per show ID, in order of first appearance so that the ranking is kept.
+    NSMutableArray *selectedShows = [NSMutableArray array];
+    NSMutableArray *availableLanguages = [NSMutableArray array];
+    NSMutableIndexSet *preferredLanguageIndexes = [NSMutableIndexSet indexSet];
     
-    void (^__block __unsafe_unretained removeLanguageDuplicatesBlock)(NSMutableArray *) = ^(NSMutableArray *showsWithLanguageDuplicates) {
-        
-        if ([showsWithLanguageDuplicates count] == 0) return;
-        
-        LRTVDBShow *firstShow = [showsWithLanguageDuplicates lr_firstObject];
-        
-        // Get shows subset with that ID = firstShow.ID
-        NSIndexSet *indexSet = [showsWithLanguageDuplicates indexesOfObjectsPassingTest:^BOOL(LRTVDBShow *show, NSUInteger idx, BOOL *stop) {
-            return [show isEqual:firstShow];
-        }];
-        
-        NSArray *sameIdShows = [showsWithLanguageDuplicates objectsAtIndexes:indexSet];
+    NSMutableDictionary *indexesByShowID = [NSMutableDictionary dictionaryWithCapacity:[showsWithLanguageDuplicates count]];
+    
+    for (LRTVDBShow *show in showsWithLanguageDuplicates)
+    {
+        if (show.showID == nil) continue;
         
-        __block LRTVDBShow *correctShow = [sameIdShows lr_firstObject];
+        NSNumber *indexNumber = indexesByShowID[show.showID];
+        NSUInteger index = [indexNumber unsignedIntegerValue];
         
-        [sameIdShows enumerateObjectsUsingBlock:^(LRTVDBShow *show, NSUInteger idx, BOOL *stop) {
+        if (indexNumber == nil)
+        {
+            index = [selectedShows count];
+            indexesByShowID[show.showID] = @(index);
             
-            if ([show.language isEqualToString:[LRTVDBAPIClient sharedClient].language])
-            {
-                correctShow = show;
-                *stop = YES;
-            }
-            else if ([show.language isEqualToString:LRTVDBDefaultLanguage()])
-            {
-                correctShow = show;
-            }
-        }];
-        
-        NSMutableArray *availableLanguages = [NSMutableArray array];
+            [selectedShows addObject:show];
+            [availableLanguages addObject:[NSMutableArray array]];
+        }
         
-        for (LRTVDBShow *show in sameIdShows)
+        if (show.language)
         {
-            [availableLanguages addObject:show.language];
+            [availableLanguages[index] addObject:show.language];
         }
         
-        correctShow.availableLanguages = availableLanguages;
+        if ([preferredLanguageIndexes containsIndex:index]) continue;
         
-        [showsWithoutLanguageDuplicates addObject:correctShow];
-        [showsWithLanguageDuplicates removeObjectsInArray:sameIdShows];
-        
-        removeLanguageDuplicatesBlock(showsWithLanguageDuplicates);
-    };
-    
-    removeLanguageDuplicatesBlock([showsWithLanguageDuplicates mutableCopy]);
+        if ([show.language isEqualToString:preferredLanguage])
+        {
+            selectedShows[index] = show;
+            [preferredLanguageIndexes addIndex:index];
+        }
+        else if ([show.language isEqualToString:LRTVDBDefaultLanguage()])
+        {
+            selectedShows[index] = show;
+        }
+    }
     
-    removeLanguageDuplicatesBlock = nil;
+    [selectedShows enumerateObjectsUsingBlock:^(LRTVDBShow *show, NSUInteger idx, BOOL *stop) {
+        show.availableLanguages = [availableLanguages[idx] copy];
+    }];
     
-    return [showsWithoutLanguageDuplicates copy];
+    return [selectedShows copy];
 }
 
 static id LRTVDBAPICheckEmptyString(id obj)
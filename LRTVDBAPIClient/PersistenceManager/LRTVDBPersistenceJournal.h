@@ -0,0 +1,115 @@
+// LRTVDBPersistenceJournal.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(uint8_t, LRTVDBJournalRecordType)
+{
+    LRTVDBJournalRecordTypeEpisodeSeen = 1,
+    LRTVDBJournalRecordTypeEpisodeNotSeen = 2,
+    LRTVDBJournalRecordTypeShowAdded = 3, /** Segments of the show are listed in the record. */
+    LRTVDBJournalRecordTypeShowRemoved = 4,
+};
+
+/**
+ Single change of the persisted shows.
+ */
+@interface LRTVDBJournalRecord : NSObject
+
++ (instancetype)recordWithType:(LRTVDBJournalRecordType)type
+                        showID:(NSString *)showID
+                     episodeID:(NSString *)episodeID
+              segmentFileNames:(NSArray *)segmentFileNames;
+
+@property (nonatomic, readonly) LRTVDBJournalRecordType type;
+@property (nonatomic, copy, readonly) NSString *showID;
+@property (nonatomic, copy, readonly) NSString *episodeID;
+@property (nonatomic, copy, readonly) NSArray *segmentFileNames;
+
+@end
+
+/**
+ Append-only log of the changes made to the shows since they were last saved.
+ 
+ @discussion Records are appended to the current journal file from a serial
+ queue. Every record appended while the previous ones are being written is
+ written along with the rest of them in a single write and made durable with
+ a single fsync, so each change costs a few bytes and, under load, a fraction
+ of a sync.
+ 
+ Every record is framed with its length and its CRC32, so a record torn by a
+ crash is detected and skipped, and reading goes on with the next valid one.
+ Records whose write fails are cut off the file and retried on the next write.
+ 
+ Saving the shows compacts the journal: the journal is rotated right before
+ the shows are serialized and the rotated files are removed once the new
+ manifest has been written. The journal isn't compacted otherwise.
+ @remarks Thread safe.
+ */
+@interface LRTVDBPersistenceJournal : NSObject
+
+/**
+ @param directoryPath Directory of the journal files.
+ */
+- (id)initWithDirectoryPath:(NSString *)directoryPath;
+
+/**
+ Appends a record asynchronously.
+ */
+- (void)appendRecord:(LRTVDBJournalRecord *)record;
+
+/**
+ Waits until every appended record has been written and synced.
+ */
+- (void)synchronize;
+
+/**
+ Sequence number of the current journal file. Records appended from now on
+ are written to a new file.
+ @return The sequence number of the last rotated file.
+ */
+- (NSUInteger)rotate;
+
+/**
+ Removes the journal files up to the provided sequence number, included.
+ */
+- (void)removeFilesUpToSequence:(NSUInteger)sequence;
+
+/**
+ Reads every record of every journal file, in the order they were appended.
+ */
+- (NSArray *)records;
+
+/**
+ @return YES if the file name belongs to a journal file.
+ */
++ (BOOL)isJournalFileName:(NSString *)fileName;
+
+@property (nonatomic, readonly) NSUInteger currentSequence;
+
+/** Bytes appended since the journal was created. */
+@property (nonatomic, readonly) unsigned long long numberOfWrittenBytes;
+
+/** Number of fsync calls since the journal was created. */
+@property (nonatomic, readonly) NSUInteger numberOfSyncs;
+
+@end
@@ -0,0 +1,441 @@
+// LRTVDBPersistenceJournal.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBPersistenceJournal.h"
+#import <libkern/OSAtomic.h>
+#import <zlib.h>
+#import <fcntl.h>
+#import <unistd.h>
+
+static NSString *const kLRTVDBJournalFileNamePrefix = @"Journal-";
+
+/** Length and CRC32 of the payload, both little endian. */
+static const NSUInteger kLRTVDBJournalFrameHeaderLength = 2 * sizeof(uint32_t);
+
+#pragma mark - Records encoding
+
+static void LRTVDBJournalAppendString(NSMutableData *data, NSString *string)
+{
+    NSData *stringData = [(string ? : @"") dataUsingEncoding:NSUTF8StringEncoding];
+    uint16_t length = CFSwapInt16HostToLittle((uint16_t)MIN([stringData length], UINT16_MAX));
+    
+    [data appendBytes:&length length:sizeof(length)];
+    [data appendBytes:[stringData bytes] length:CFSwapInt16LittleToHost(length)];
+}
+
+/**
+ Reads a string, advancing the position.
+ @return nil if there are not enough bytes.
+ */
+static NSString *LRTVDBJournalReadString(const uint8_t *bytes, NSUInteger length, NSUInteger *position)
+{
+    uint16_t stringLength;
+    
+    if (length - *position < sizeof(stringLength)) return nil;
+    
+    memcpy(&stringLength, bytes + *position, sizeof(stringLength));
+    stringLength = CFSwapInt16LittleToHost(stringLength);
+    *position += sizeof(stringLength);
+    
+    if (length - *position < stringLength) return nil;
+    
+    NSString *string = [[NSString alloc] initWithBytes:bytes + *position length:stringLength encoding:NSUTF8StringEncoding];
+    *position += stringLength;
+    
+    return string;
+}
+
+#pragma mark - LRTVDBJournalRecord
+
+@interface LRTVDBJournalRecord ()
+
+@property (nonatomic) LRTVDBJournalRecordType type;
+@property (nonatomic, copy) NSString *showID;
+@property (nonatomic, copy) NSString *episodeID;
+@property (nonatomic, copy) NSArray *segmentFileNames;
+
+@end
+
+@implementation LRTVDBJournalRecord
+
++ (instancetype)recordWithType:(LRTVDBJournalRecordType)type
+                        showID:(NSString *)showID
+                     episodeID:(NSString *)episodeID
+              segmentFileNames:(NSArray *)segmentFileNames
+{
+    LRTVDBJournalRecord *record = [[self alloc] init];
+    
+    record.type = type;
+    record.showID = showID;
+    record.episodeID = episodeID;
+    record.segmentFileNames = segmentFileNames;
+    
+    return record;
+}
+
+- (NSData *)frame
+{
+    NSMutableData *payload = [NSMutableData data];
+    
+    uint8_t type = self.type;
+    uint8_t numberOfSegments = (uint8_t)MIN([self.segmentFileNames count], UINT8_MAX);
+    
+    [payload appendBytes:&type length:sizeof(type)];
+    LRTVDBJournalAppendString(payload, self.showID);
+    LRTVDBJournalAppendString(payload, self.episodeID);
+    [payload appendBytes:&numberOfSegments length:sizeof(numberOfSegments)];
+    
+    for (NSUInteger i = 0; i < numberOfSegments; i++)
+    {
+        LRTVDBJournalAppendString(payload, self.segmentFileNames[i]);
+    }
+    
+    uint32_t header[2] = {
+        CFSwapInt32HostToLittle((uint32_t)[payload length]),
+        CFSwapInt32HostToLittle((uint32_t)crc32(0, [payload bytes], (uInt)[payload length])),
+    };
+    
+    NSMutableData *frame = [NSMutableData dataWithBytes:header length:sizeof(header)];
+    [frame appendData:payload];
+    
+    return frame;
+}
+
++ (instancetype)recordWithPayloadBytes:(const uint8_t *)bytes length:(NSUInteger)length
+{
+    NSUInteger position = 0;
+    
+    if (length < 1) return nil;
+    
+    LRTVDBJournalRecordType type = bytes[position++];
+    
+    NSString *showID = LRTVDBJournalReadString(bytes, length, &position);
+    NSString *episodeID = LRTVDBJournalReadString(bytes, length, &position);
+    
+    if (!showID || !episodeID || position >= length) return nil;
+    
+    NSUInteger numberOfSegments = bytes[position++];
+    NSMutableArray *segmentFileNames = [NSMutableArray arrayWithCapacity:numberOfSegments];
+    
+    for (NSUInteger i = 0; i < numberOfSegments; i++)
+    {
+        NSString *segmentFileName = LRTVDBJournalReadString(bytes, length, &position);
+        
+        if (!segmentFileName) return nil;
+        
+        [segmentFileNames addObject:segmentFileName];
+    }
+    
+    return [self recordWithType:type
+                         showID:showID
+                      episodeID:[episodeID length] > 0 ? episodeID : nil
+               segmentFileNames:[segmentFileNames count] > 0 ? segmentFileNames : nil];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"Type: %d\nShow ID: %@\nEpisode ID: %@\nSegments: %@\n",
+            self.type, self.showID, self.episodeID, self.segmentFileNames];
+}
+
+@end
+
+#pragma mark - LRTVDBPersistenceJournal
+
+@interface LRTVDBPersistenceJournal ()
+{
+    NSString *_directoryPath;
+    
+    // Appended records not written yet, guarded by _pendingLock.
+    NSMutableData *_pendingData;
+    BOOL _flushScheduled;
+    OSSpinLock _pendingLock;
+    
+    // Only used from _queue.
+    dispatch_queue_t _queue;
+    int _fileDescriptor;
+}
+
+@property (nonatomic) NSUInteger currentSequence;
+@property (nonatomic) unsigned long long numberOfWrittenBytes;
+@property (nonatomic) NSUInteger numberOfSyncs;
+
+@end
+
+@implementation LRTVDBPersistenceJournal
+
+- (id)initWithDirectoryPath:(NSString *)directoryPath
+{
+    if (self = [super init])
+    {
+        _directoryPath = [directoryPath copy];
+        _pendingData = [NSMutableData data];
+        _pendingLock = OS_SPINLOCK_INIT;
+        _queue = dispatch_queue_create("com.LRTVDBAPIClient.LRTVDBPersistenceJournalQueue", DISPATCH_QUEUE_SERIAL);
+        _fileDescriptor = -1;
+        _currentSequence = [[[self journalFileSequences] lastObject] unsignedIntegerValue] + 1;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_fileDescriptor >= 0) close(_fileDescriptor);
+
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(_queue);
+#endif
+}
+
+- (void)appendRecord:(LRTVDBJournalRecord *)record
+{
+    NSData *frame = [record frame];
+    
+    OSSpinLockLock(&_pendingLock);
+    [_pendingData appendData:frame];
+    BOOL scheduleFlush = !_flushScheduled;
+    _flushScheduled = YES;
+    OSSpinLockUnlock(&_pendingLock);
+    
+    // Records appended while a flush is syncing are left for the next one,
+    // which writes and syncs all of them at once.
+    if (scheduleFlush)
+    {
+        dispatch_async(_queue, ^{
+            [self flush];
+        });
+    }
+}
+
+- (void)synchronize
+{
+    dispatch_sync(_queue, ^{
+        [self flush];
+    });
+}
+
+- (NSUInteger)rotate
+{
+    __block NSUInteger rotatedSequence;
+    
+    dispatch_sync(_queue, ^{
+        
+        [self flush];
+        
+        if (_fileDescriptor >= 0)
+        {
+            close(_fileDescriptor);
+            _fileDescriptor = -1;
+        }
+        
+        rotatedSequence = self.currentSequence++;
+    });
+    
+    return rotatedSequence;
+}
+
+- (void)removeFilesUpToSequence:(NSUInteger)sequence
+{
+    for (NSNumber *fileSequence in [self journalFileSequences])
+    {
+        if ([fileSequence unsignedIntegerValue] > sequence) break;
+        
+        [[NSFileManager defaultManager] removeItemAtPath:[self pathForSequence:[fileSequence unsignedIntegerValue]] error:NULL];
+    }
+}
+
+- (NSArray *)records
+{
+    [self synchronize];
+    
+    NSMutableArray *records = [NSMutableArray array];
+    
+    for (NSNumber *sequence in [self journalFileSequences])
+    {
+        NSData *data = [NSData dataWithContentsOfFile:[self pathForSequence:[sequence unsignedIntegerValue]]];
+        
+        const uint8_t *bytes = [data bytes];
+        NSUInteger length = [data length];
+        NSUInteger position = 0;
+        BOOL skippingTornRecord = NO;
+        
+        while (length - position >= kLRTVDBJournalFrameHeaderLength)
+        {
+            uint32_t header[2];
+            memcpy(header, bytes + position, sizeof(header));
+            
+            NSUInteger payloadLength = CFSwapInt32LittleToHost(header[0]);
+            uint32_t payloadCRC = CFSwapInt32LittleToHost(header[1]);
+            NSUInteger payloadPosition = position + kLRTVDBJournalFrameHeaderLength;
+            
+            // Torn records are left behind by crashes and by failed writes that
+            // couldn't be truncated. Records appended after them are still valid,
+            // so the next frame whose CRC matches is looked for byte by byte.
+            if (length - payloadPosition < payloadLength ||
+                crc32(0, bytes + payloadPosition, (uInt)payloadLength) != payloadCRC)
+            {
+                if (!skippingTornRecord)
+                {
+                    NSLog(@"Ignoring torn journal record in %@", [self pathForSequence:[sequence unsignedIntegerValue]]);
+                }
+                
+                skippingTornRecord = YES;
+                position++;
+                continue;
+            }
+            
+            skippingTornRecord = NO;
+            
+            LRTVDBJournalRecord *record = [LRTVDBJournalRecord recordWithPayloadBytes:bytes + payloadPosition length:payloadLength];
+            
+            if (record) [records addObject:record];
+            
+            position = payloadPosition + payloadLength;
+        }
+    }
+    
+    return [records copy];
+}
+
++ (BOOL)isJournalFileName:(NSString *)fileName
+{
+    return [fileName hasPrefix:kLRTVDBJournalFileNamePrefix];
+}
+
+#pragma mark - Private
+
+/**
+ Writes the pending records and syncs them. Called from _queue.
+ @discussion Records that can't be written are put back in front of the
+ pending ones and written by the next flush.
+ */
+- (void)flush
+{
+    OSSpinLockLock(&_pendingLock);
+    NSData *data = _pendingData;
+    _pendingData = [NSMutableData data];
+    _flushScheduled = NO;
+    OSSpinLockUnlock(&_pendingLock);
+    
+    if ([data length] == 0) return;
+    
+    if (_fileDescriptor < 0)
+    {
+        [[NSFileManager defaultManager] createDirectoryAtPath:_directoryPath
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:NULL];
+        
+        _fileDescriptor = open([[self pathForSequence:self.currentSequence] fileSystemRepresentation], O_WRONLY | O_APPEND | O_CREAT, 0644);
+        
+        if (_fileDescriptor < 0)
+        {
+            NSLog(@"Unable to open the journal: %s", strerror(errno));
+            [self restorePendingData:data];
+            return;
+        }
+    }
+    
+    // End of the last record fully written.
+    off_t offset = lseek(_fileDescriptor, 0, SEEK_END);
+    
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    
+    while (length > 0)
+    {
+        ssize_t writtenLength = write(_fileDescriptor, bytes, length);
+        
+        if (writtenLength < 0)
+        {
+            if (errno == EINTR) continue;
+            
+            NSLog(@"Unable to write the journal: %s", strerror(errno));
+            [self discardWrittenDataFromOffset:offset];
+            [self restorePendingData:data];
+            return;
+        }
+        
+        bytes += writtenLength;
+        length -= writtenLength;
+    }
+    
+    fsync(_fileDescriptor);
+    
+    self.numberOfWrittenBytes += [data length];
+    self.numberOfSyncs++;
+}
+
+/**
+ Cuts the records partially written by a failed write off the current file.
+ If it can't be truncated, records are appended to a new file from now on,
+ so the torn one is at least the last record of its file. Called from _queue.
+ */
+- (void)discardWrittenDataFromOffset:(off_t)offset
+{
+    if (offset >= 0 && ftruncate(_fileDescriptor, offset) == 0) return;
+    
+    NSLog(@"Unable to truncate the journal: %s", strerror(errno));
+    
+    close(_fileDescriptor);
+    _fileDescriptor = -1;
+    
+    self.currentSequence++;
+}
+
+/**
+ Puts records that couldn't be written back in front of the pending ones.
+ */
+- (void)restorePendingData:(NSData *)data
+{
+    NSMutableData *pendingData = [data mutableCopy];
+    
+    OSSpinLockLock(&_pendingLock);
+    [pendingData appendData:_pendingData];
+    _pendingData = pendingData;
+    OSSpinLockUnlock(&_pendingLock);
+}
+
+- (NSString *)pathForSequence:(NSUInteger)sequence
+{
+    return [_directoryPath stringByAppendingPathComponent:[NSString stringWithFormat:@"%@%lu", kLRTVDBJournalFileNamePrefix, (unsigned long)sequence]];
+}
+
+/**
+ @return Sequence numbers of the journal files in the directory, sorted.
+ */
+- (NSArray *)journalFileSequences
+{
+    NSMutableArray *sequences = [NSMutableArray array];
+    
+    for (NSString *fileName in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:_directoryPath error:NULL])
+    {
+        if ([[self class] isJournalFileName:fileName])
+        {
+            [sequences addObject:@([[fileName substringFromIndex:[kLRTVDBJournalFileNamePrefix length]] integerValue])];
+        }
+    }
+    
+    return [sequences sortedArrayUsingSelector:@selector(compare:)];
+}
+
+@end
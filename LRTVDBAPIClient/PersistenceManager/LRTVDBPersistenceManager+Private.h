@@ -0,0 +1,89 @@
+// LRTVDBPersistenceManager+Private.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBPersistenceManager.h"
+
+@class LRTVDBPersistenceJournal;
+
+/**
+ Decodes a persisted entry into a show.
+ @return nil if the entry can't be decoded.
+ */
+typedef LRTVDBShow *(^LRTVDBShowDecodingBlock)(id entry);
+
+/**
+ Extension points for persistence backends other than the segment store.
+ */
+@interface LRTVDBPersistenceManager (Private)
+
+@property (nonatomic) NSUInteger numberOfWrittenSegments;
+
+/**
+ @return The object shared by every manager of the store at the path for the
+ key, such as the writer queue or the journal. It's created by the block the
+ first time it's requested.
+ */
++ (id)sharedObjectForKey:(NSString *)key storePath:(NSString *)storePath creationBlock:(id (^)(void))creationBlock;
+
+/**
+ Path of the store the manager reads and writes. Managers of the same store
+ share their writer (see writeShows:error:).
+ */
+- (NSString *)storePath;
+
+/**
+ Journal of the changes made since the shows were last saved (see
+ journalSeenStatusOfEpisodes:).
+ */
+@property (nonatomic, strong, readonly) LRTVDBPersistenceJournal *journal;
+
+/**
+ Writes the dirty sections of the shows, removing every other show except
+ the ones added through the journal which haven't been retrieved yet (see
+ saveShowsInPersistenceStorage:error:). Called from the writer queue, one
+ save at a time.
+ */
+- (void)writeShows:(NSArray *)shows error:(__autoreleasing NSError **)error;
+
+/**
+ Called once the shows of the entries have been retrieved, so the shows
+ added through the journal among them are no longer kept by the next saves.
+ */
+- (void)markEntriesAsRetrieved:(NSArray *)entries;
+
+/**
+ @param decodingBlock On return, the block decoding the returned entries.
+ It's called concurrently.
+ @return The entries of every persisted show, in order. nil if none can be read.
+ */
+- (NSArray *)persistedEntriesWithDecodingBlock:(__autoreleasing LRTVDBShowDecodingBlock *)decodingBlock error:(__autoreleasing NSError **)error;
+
+/**
+ @return Providers of the persisted relationships (see
+ LRTVDBShowRelationshipsProvider) of the shows, keyed by show ID. Shows which
+ haven't been saved are missing. Called from the writer queue.
+ */
+- (NSDictionary *)relationshipsProvidersForShows:(NSArray *)shows;
+
+- (NSString *)documentsDirectory;
+
+@end
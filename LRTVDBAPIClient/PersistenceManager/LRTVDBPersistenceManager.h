@@ -22,15 +22,83 @@
 
 #import <Foundation/Foundation.h>
 
+@class LRTVDBShow;
+
 @interface LRTVDBPersistenceManager : NSObject
 
 + (instancetype)manager;
 
 /**
  Saves an array of LRTVDBShow objects to disk via NSPropertyListSerialization.
+ @discussion Every show is stored in one segment file per section (info,
+ episodes, images and actors) plus a small manifest with the order of the
+ shows and their segments. Only the sections which have changed since they
+ were last saved are written, each of them to a new segment file, and the
+ manifest is atomically replaced once every segment has been written. Until
+ then, the previous manifest and segments are left untouched, so a save is
+ as atomic as writing a single file with NSDataWritingAtomic. The journal
+ records made before the save are removed once the manifest is written.
+ 
+ Stored shows which aren't among the provided ones are removed, except for
+ the ones added through the journal (see journalAddedShow:,
+ LRTVDBBulkImporter) which haven't been retrieved yet: they're kept after
+ the provided shows, whatever the number of saves, until
+ showsFromPersistenceStorageWithError: (or its asynchronous version) hands
+ them out. Use journalRemovedShow: to remove them before.
+ 
+ Every show is serialized from a consistent snapshot, so shows can be saved
+ while other queues are merging into them. Saves are written one at a time
+ from the writer queue; this method blocks until its save is written and
+ discards any pending background save.
+ @see saveShowsInBackground:
  */
 - (void)saveShowsInPersistenceStorage:(NSArray *)shows error:(__autoreleasing NSError **)error;
 
+/**
+ Saves an array of LRTVDBShow objects to disk from the writer queue, without
+ blocking the caller.
+ @discussion Save requests are coalesced: a save waits a fraction of a
+ second and only the shows of the last request made meanwhile are written,
+ in a single write.
+ @see saveShowsInPersistenceStorage:error:
+ */
+- (void)saveShowsInBackground:(NSArray *)shows;
+
+/**
+ Writes the pending background save right away, if any, and syncs the
+ journal.
+ @param completionBlock Called on the main queue with the error of the last
+ background save, nil if it succeeded. It can be nil.
+ */
+- (void)flushPendingSavesWithCompletionBlock:(void (^)(NSError *error))completionBlock;
+
+/**
+ Blocking version of flushPendingSavesWithCompletionBlock:, meant for
+ shutdown (applicationWillTerminate: and the like).
+ @return NO if the last background save failed.
+ */
+- (BOOL)flushPendingSaves:(__autoreleasing NSError **)error;
+
+/**
+ Number of background saves written since launch.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfBackgroundWrites;
+
+/**
+ Number of segment files written by the last save.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfWrittenSegments;
+
+/**
+ Whether the segments written by this manager are compressed. NO by default.
+ @discussion Segments are compressed with zlib and a preset dictionary of the
+ strings every show repeats, which typically makes them several times
+ smaller, at the cost of some CPU when they're written and read. Compressed
+ and uncompressed segments can live in the same store and both are read
+ transparently, so this can be changed at any time.
+ */
+@property (nonatomic, getter = isCompressionEnabled) BOOL compressionEnabled;
+
 /**
  Converts an array of LRTVDBShow objects to NSData via NSPropertyListSerialization.
  */
@@ -38,11 +106,90 @@
 
 /**
  Retrieves an array of LRTVDBShow objects from disk via NSPropertyListSerialization.
+ @discussion Only the manifest and the info segment of every show are read,
+ so the cost of opening the store depends on the number of shows, not on the
+ number of episodes. Episodes, images and actors segments are memory mapped
+ and decoded the first time the relationships of their show are accessed.
+ Shows saved by previous versions in a single file are read too (eagerly).
+ They're moved to the segment store on the next save.
+ 
+ Shows are decoded concurrently across every core, in the same order as
+ they were saved. Shows which can't be decoded are skipped. Changes recorded
+ in the journal since the last save are applied to them.
  */
 - (NSArray *)showsFromPersistenceStorageWithError:(__autoreleasing NSError **)error;
 
+/**
+ Retrieves the persisted LRTVDBShow objects asynchronously.
+ @param progressBlock Called with every batch of decoded shows, in order, so
+ that they can be shown while the following ones are still being decoded.
+ The first batches are the smallest. It can be nil.
+ @param completionBlock Called with every decoded show, nil (and the error)
+ if the storage can't be read.
+ @discussion Both blocks are called on the main queue, the progress block
+ always before the completion block.
+ @see showsFromPersistenceStorageWithError:
+ */
+- (void)showsFromPersistenceStorageWithProgressBlock:(void (^)(NSArray *shows))progressBlock
+                                     completionBlock:(void (^)(NSArray *shows, NSError *error))completionBlock;
+
+/**
+ Records the current seen status of the provided LRTVDBEpisode objects in
+ the journal, without saving their shows.
+ @discussion The journal is an append-only log of small change records,
+ replayed every time the shows are retrieved from the persistence storage
+ and compacted into the store on the next save. Records are appended
+ asynchronously and every record appended while the previous ones are being
+ synced is made durable with them in a single fsync.
+ 
+ Episodes aren't observed: whoever changes their seen status (setSeen:,
+ -[LRTVDBShow setSeen:forEpisodesInRange:]) must call this method with the
+ changed episodes afterwards. Changes which aren't journaled are only
+ persisted by the next save of their show.
+ @see synchronizeJournal
+ */
+- (void)journalSeenStatusOfEpisodes:(NSArray *)episodes;
+
+/**
+ Records a new show in the journal.
+ @discussion The sections of the show are written once, in their own
+ segments, so they don't need to be written again until they change.
+ */
+- (void)journalAddedShow:(LRTVDBShow *)show;
+
+/**
+ Records several new shows in the journal at once.
+ @discussion Used by bulk imports: the shows are written in a single pass
+ instead of one by one, without waiting for the saves being written.
+ @return NO if any of the shows couldn't be written.
+ */
+- (BOOL)journalAddedShows:(NSArray *)shows error:(__autoreleasing NSError **)error;
+
+/**
+ Records the removal of a show in the journal.
+ */
+- (void)journalRemovedShow:(LRTVDBShow *)show;
+
+/**
+ Waits until every change recorded in the journal is durable.
+ */
+- (void)synchronizeJournal;
+
+/**
+ Releases the episodes, images and actors of the shows, which are reloaded
+ from the store the next time they're accessed.
+ @discussion Only relationships which have been saved and haven't changed
+ since can be evicted. Eviction is serialized with saves, so the evicted
+ shows always reload what they were last saved as. Shows must stay in the
+ saved shows to be reloaded.
+ @see LRTVDBRelationshipsCache
+ @return The number of evicted shows.
+ */
+- (NSUInteger)evictRelationshipsOfShows:(NSArray *)shows;
+
 /**
  Retrieves an array of LRTVDBShow objects from data via NSPropertyListSerialization.
+ @discussion Shows are decoded concurrently, preserving their order.
  */
 - (NSArray *)showsFromData:(NSData *)data error:(__autoreleasing NSError **)error;
 
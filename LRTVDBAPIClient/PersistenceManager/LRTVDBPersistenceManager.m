@@ -21,11 +21,327 @@
 // THE SOFTWARE.
 
 #import "LRTVDBPersistenceManager.h"
-#import "LRTVDBShow.h"
+#import "LRTVDBPersistenceManager+Private.h"
+#import "LRTVDBPersistenceJournal.h"
+#import "LRTVDBShow+Private.h"
+#import "LRTVDBEpisode.h"
 #import "NSArray+LRTVDBAdditions.h"
+#import "NSData+LRTVDBAdditions.h"
+#import <libkern/OSAtomic.h>
+#import <pthread.h>
 
+/** Single file where previous versions saved every show. */
 static NSString *const kLRTVDBShowsPersistenceFileName = @"LRTVDBShowsPersistenceFile";
 
+/** Directory with the manifest and the segment files of every show. */
+static NSString *const kLRTVDBShowsStoreDirectoryName = @"LRTVDBShowsStore";
+static NSString *const kLRTVDBShowsStoreManifestFileName = @"Manifest";
+
+static NSString *const kManifestVersionKey = @"kManifestVersionKey";
+static NSString *const kManifestGenerationKey = @"kManifestGenerationKey";
+static NSString *const kManifestShowsKey = @"kManifestShowsKey";
+static NSString *const kManifestShowIDKey = @"kManifestShowIDKey";
+static NSString *const kManifestSegmentsKey = @"kManifestSegmentsKey";
+
+/** Set on shows added through the journal which haven't been retrieved yet. */
+static NSString *const kManifestImportedKey = @"kManifestImportedKey";
+
+static const NSUInteger kLRTVDBShowsStoreVersion = 1;
+
+/** Sections in the order their segments are listed in the manifest, info first. */
+static const LRTVDBShowSection kLRTVDBShowSections[] = {
+    LRTVDBShowSectionInfo,
+    LRTVDBShowSectionEpisodes,
+    LRTVDBShowSectionImages,
+    LRTVDBShowSectionActors,
+};
+
+#define kLRTVDBNumberOfShowSections (sizeof(kLRTVDBShowSections) / sizeof(kLRTVDBShowSections[0]))
+
+static NSString *const kLRTVDBShowSectionNames[kLRTVDBNumberOfShowSections] = { @"info", @"episodes", @"images", @"actors" };
+
+static NSString *LRTVDBSegmentFileName(NSString *showID, NSUInteger sectionIndex, NSUInteger generation)
+{
+    return [NSString stringWithFormat:@"%@-%@-%lu", showID, kLRTVDBShowSectionNames[sectionIndex], (unsigned long)generation];
+}
+
+/**
+ Segments of the shows added through the journal, named after the journal
+ file they're recorded in, so they never clash with the manifest ones.
+ */
+static NSString *LRTVDBJournalSegmentFileName(NSString *showID, NSUInteger sectionIndex, NSUInteger journalSequence)
+{
+    return [NSString stringWithFormat:@"%@-%@-j%lu", showID, kLRTVDBShowSectionNames[sectionIndex], (unsigned long)journalSequence];
+}
+
+/** Shows delivered in the first batch of an asynchronous load. Later batches double in size. */
+static const NSUInteger kLRTVDBFirstLoadBatchSize = 8;
+static const NSUInteger kLRTVDBMaxLoadBatchSize = 256;
+
+/**
+ Decodes the entries in the range concurrently, across every core.
+ @return The decoded shows in the same order as their entries. Entries which
+ can't be decoded are skipped.
+ */
+static NSArray *LRTVDBDecodeShowsConcurrently(NSArray *entries, NSRange range, LRTVDBShowDecodingBlock decodingBlock)
+{
+    if (range.length == 0) return @[];
+    
+    __strong LRTVDBShow **shows = (__strong LRTVDBShow **)calloc(range.length, sizeof(LRTVDBShow *));
+    
+    dispatch_apply(range.length, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        @autoreleasepool
+        {
+            shows[i] = decodingBlock(entries[range.location + i]);
+        }
+    });
+    
+    NSMutableArray *decodedShows = [NSMutableArray arrayWithCapacity:range.length];
+    
+    for (NSUInteger i = 0; i < range.length; i++)
+    {
+        if (shows[i]) [decodedShows addObject:shows[i]];
+        
+        shows[i] = nil;
+    }
+    
+    free(shows);
+    
+    return [decodedShows copy];
+}
+
+/**
+ Reads a segment, mapping its file instead of copying it into memory.
+ Compressed segments are inflated into memory instead.
+ */
+static NSDictionary *LRTVDBSegmentAtPath(NSString *path)
+{
+    NSData *segmentData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:NULL];
+    
+    if ([segmentData lr_isCompressedData])
+    {
+        segmentData = [segmentData lr_decompressedData];
+    }
+    
+    NSDictionary *segment = segmentData ? [NSPropertyListSerialization propertyListWithData:segmentData
+                                                                                   options:0
+                                                                                    format:NULL
+                                                                                     error:NULL] : nil;
+    
+    if (![segment isKindOfClass:[NSDictionary class]])
+    {
+        NSLog(@"Unable to read segment %@", [path lastPathComponent]);
+        return nil;
+    }
+    
+    return segment;
+}
+
+/**
+ @return The contents of the segment file of a serialized section.
+ @param compressed Whether to compress the segment. Segments which don't
+ shrink are written uncompressed anyway.
+ */
+static NSData *LRTVDBSegmentData(NSDictionary *serializedSection, BOOL compressed, __autoreleasing NSError **error)
+{
+    NSData *segmentData = [NSPropertyListSerialization dataWithPropertyList:serializedSection
+                                                                     format:NSPropertyListBinaryFormat_v1_0
+                                                                    options:0
+                                                                      error:error];
+    
+    if (segmentData && compressed)
+    {
+        NSData *compressedData = [segmentData lr_compressedData];
+        
+        if ([compressedData length] && [compressedData length] < [segmentData length])
+        {
+            segmentData = compressedData;
+        }
+    }
+    
+    return segmentData;
+}
+
+/**
+ Decodes the relationships segments of a show loaded from the store the
+ first time they're needed.
+ */
+@interface LRTVDBSegmentsRelationshipsProvider : NSObject <LRTVDBShowRelationshipsProvider>
+
+- (id)initWithStorePath:(NSString *)storePath segmentFileNames:(NSArray *)segmentFileNames;
+
+@end
+
+@implementation LRTVDBSegmentsRelationshipsProvider
+{
+    NSString *_storePath;
+    NSArray *_segmentFileNames;
+}
+
+- (id)initWithStorePath:(NSString *)storePath segmentFileNames:(NSArray *)segmentFileNames
+{
+    if (self = [super init])
+    {
+        _storePath = [storePath copy];
+        _segmentFileNames = [segmentFileNames copy];
+    }
+    return self;
+}
+
+- (NSDictionary *)serializedRelationshipsForShow:(LRTVDBShow *)show
+{
+    NSMutableDictionary *relationships = [NSMutableDictionary dictionary];
+    
+    for (NSString *segmentFileName in _segmentFileNames)
+    {
+        NSDictionary *segment = LRTVDBSegmentAtPath([_storePath stringByAppendingPathComponent:segmentFileName]);
+        
+        if (segment) [relationships addEntriesFromDictionary:segment];
+    }
+    
+    return relationships;
+}
+
+@end
+
+/** Time background saves wait for more save requests to coalesce with. */
+static const NSTimeInterval kLRTVDBBackgroundSaveDelay = 0.25;
+
+/**
+ State of the background saves, shared by every manager of the same store.
+ */
+@interface LRTVDBPersistenceWriter : NSObject
+
+/** Serial queue every save is written from. */
+- (dispatch_queue_t)queue;
+
+/**
+ Replaces the shows waiting to be written. Only the last shows of a burst
+ of save requests are written.
+ @return YES if no write is scheduled for the pending shows yet.
+ */
+- (BOOL)setPendingShows:(NSArray *)shows;
+
+/**
+ @return The shows waiting to be written, nil if there are none.
+ */
+- (NSArray *)takePendingShows;
+
+/**
+ Keeps segments written for a show added through the journal from being
+ removed by the saves until its record is appended (see
+ removeSegmentsNotInManifest:). Balanced by stopKeepingSegmentFileNames:.
+ */
+- (void)keepSegmentFileNames:(NSArray *)fileNames;
+
+- (void)stopKeepingSegmentFileNames:(NSArray *)fileNames;
+
+/**
+ @return Segments kept by keepSegmentFileNames:.
+ */
+- (NSSet *)keptSegmentFileNames;
+
+/** Error of the last background write, nil if it succeeded. */
+@property (atomic, strong) NSError *lastError;
+
+@property (atomic) NSUInteger numberOfWrites;
+
+@end
+
+@implementation LRTVDBPersistenceWriter
+{
+    dispatch_queue_t _queue;
+    
+    NSArray *_pendingShows;
+    OSSpinLock _pendingShowsLock;
+    
+    NSCountedSet *_keptSegmentFileNames;
+    OSSpinLock _keptSegmentsLock;
+}
+
+- (id)init
+{
+    if (self = [super init])
+    {
+        _queue = dispatch_queue_create("com.LRTVDBAPIClient.LRTVDBPersistenceWriterQueue", DISPATCH_QUEUE_SERIAL);
+        _pendingShowsLock = OS_SPINLOCK_INIT;
+        _keptSegmentFileNames = [NSCountedSet set];
+        _keptSegmentsLock = OS_SPINLOCK_INIT;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(_queue);
+#endif
+}
+
+- (dispatch_queue_t)queue
+{
+    return _queue;
+}
+
+- (BOOL)setPendingShows:(NSArray *)shows
+{
+    OSSpinLockLock(&_pendingShowsLock);
+    BOOL scheduleWrite = (_pendingShows == nil);
+    NSArray *oldPendingShows = _pendingShows; // Released out of the lock
+    _pendingShows = shows;
+    OSSpinLockUnlock(&_pendingShowsLock);
+    
+    oldPendingShows = nil;
+    
+    return scheduleWrite;
+}
+
+- (NSArray *)takePendingShows
+{
+    OSSpinLockLock(&_pendingShowsLock);
+    NSArray *pendingShows = _pendingShows;
+    _pendingShows = nil;
+    OSSpinLockUnlock(&_pendingShowsLock);
+    
+    return pendingShows;
+}
+
+- (void)keepSegmentFileNames:(NSArray *)fileNames
+{
+    OSSpinLockLock(&_keptSegmentsLock);
+    [_keptSegmentFileNames addObjectsFromArray:fileNames];
+    OSSpinLockUnlock(&_keptSegmentsLock);
+}
+
+- (void)stopKeepingSegmentFileNames:(NSArray *)fileNames
+{
+    OSSpinLockLock(&_keptSegmentsLock);
+    
+    for (NSString *fileName in fileNames)
+    {
+        [_keptSegmentFileNames removeObject:fileName];
+    }
+    
+    OSSpinLockUnlock(&_keptSegmentsLock);
+}
+
+- (NSSet *)keptSegmentFileNames
+{
+    OSSpinLockLock(&_keptSegmentsLock);
+    NSSet *fileNames = [NSSet setWithArray:[_keptSegmentFileNames allObjects]];
+    OSSpinLockUnlock(&_keptSegmentsLock);
+    
+    return fileNames;
+}
+
+@end
+
+@interface LRTVDBPersistenceManager ()
+
+@property (nonatomic) NSUInteger numberOfWrittenSegments;
+
+@end
+
 @implementation LRTVDBPersistenceManager
 
 + (instancetype)manager
@@ -33,22 +349,327 @@ static NSString *const kLRTVDBShowsPersistenceFileName = @"LRTVDBShowsPersistenc
     return [[self alloc] init];
 }
 
+#pragma mark - Shared store objects
+
++ (id)sharedObjectForKey:(NSString *)key storePath:(NSString *)storePath creationBlock:(id (^)(void))creationBlock
+{
+    static NSMutableDictionary *sharedObjects = nil;
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    
+    NSString *objectKey = [storePath stringByAppendingPathComponent:key];
+    
+    // Objects are created under the lock, so each one is only created once.
+    pthread_mutex_lock(&lock);
+    
+    if (!sharedObjects) sharedObjects = [NSMutableDictionary dictionary];
+    
+    id object = sharedObjects[objectKey];
+    
+    if (!object)
+    {
+        object = creationBlock();
+        
+        if (object) sharedObjects[objectKey] = object;
+    }
+    
+    pthread_mutex_unlock(&lock);
+    
+    return object;
+}
+
+- (NSString *)storePath
+{
+    return [self showsStorePath];
+}
+
 - (void)saveShowsInPersistenceStorage:(NSArray *)shows error:(__autoreleasing NSError **)error
 {
-    NSData *plistData = [self persistenceFileForShows:shows error:error];
+    LRTVDBPersistenceWriter *writer = [self writer];
+    
+    // Newer than any pending background save.
+    [writer takePendingShows];
+    
+    __block NSError *writeError = nil;
+    
+    dispatch_sync([writer queue], ^{
+        [self writeShows:shows error:&writeError];
+    });
+    
+    if (error) *error = writeError;
+}
+
+#pragma mark - Background saves
+
+- (LRTVDBPersistenceWriter *)writer
+{
+    return [[self class] sharedObjectForKey:@"Writer" storePath:[self storePath] creationBlock:^id{
+        return [[LRTVDBPersistenceWriter alloc] init];
+    }];
+}
+
+- (void)saveShowsInBackground:(NSArray *)shows
+{
+    LRTVDBPersistenceWriter *writer = [self writer];
     
-    if (!plistData || *error)
+    if ([writer setPendingShows:[shows copy] ? : @[]])
     {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kLRTVDBBackgroundSaveDelay * NSEC_PER_SEC)), [writer queue], ^{
+            [self writePendingShows];
+        });
+    }
+}
+
+- (void)flushPendingSavesWithCompletionBlock:(void (^)(NSError *error))completionBlock
+{
+    LRTVDBPersistenceWriter *writer = [self writer];
+    
+    dispatch_async([writer queue], ^{
+        
+        [self writePendingShows];
+        [self synchronizeJournal];
+        
+        NSError *error = writer.lastError;
+        
+        if (completionBlock)
+        {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionBlock(error);
+            });
+        }
+    });
+}
+
+- (BOOL)flushPendingSaves:(__autoreleasing NSError **)error
+{
+    LRTVDBPersistenceWriter *writer = [self writer];
+    
+    __block NSError *flushError = nil;
+    
+    dispatch_sync([writer queue], ^{
+        
+        [self writePendingShows];
+        [self synchronizeJournal];
+        
+        flushError = writer.lastError;
+    });
+    
+    if (error) *error = flushError;
+    
+    return flushError == nil;
+}
+
+- (NSUInteger)numberOfBackgroundWrites
+{
+    return [self writer].numberOfWrites;
+}
+
+/**
+ Writes the shows of the last background save request, if it hasn't been
+ written yet. Called from the writer queue.
+ */
+- (void)writePendingShows
+{
+    LRTVDBPersistenceWriter *writer = [self writer];
+    
+    NSArray *shows = [writer takePendingShows];
+    
+    if (!shows) return;
+    
+    NSError *error = nil;
+    
+    [self writeShows:shows error:&error];
+    
+    writer.lastError = error;
+    writer.numberOfWrites++;
+}
+
+#pragma mark - Writing
+
+/**
+ Writes the dirty sections of the shows and the new manifest. Called from
+ the writer queue.
+ */
+- (void)writeShows:(NSArray *)shows error:(__autoreleasing NSError **)error
+{
+    self.numberOfWrittenSegments = 0;
+    
+    NSString *storePath = [self showsStorePath];
+    
+    if (![[NSFileManager defaultManager] createDirectoryAtPath:storePath
+                                   withIntermediateDirectories:YES
+                                                    attributes:nil
+                                                         error:error])
+    {
+        NSLog(@"Unable to create the shows store directory: %@", error ? *error : nil);
         return;
     }
     
-    BOOL success = [plistData writeToFile:[self showsStoragePath]
-                                  options:NSDataWritingAtomic
-                                    error:error];
+    // Changes recorded from now on may not be in the shows being saved, so
+    // they're kept in a new journal file.
+    NSUInteger rotatedJournalSequence = [self.journal rotate];
     
-    if(!success || *error)
+    NSDictionary *previousManifest = [self manifest];
+    NSUInteger generation = [previousManifest[kManifestGenerationKey] unsignedIntegerValue] + 1;
+    
+    NSMutableDictionary *previousSegments = [NSMutableDictionary dictionary];
+    NSMutableArray *importedShowIDs = [NSMutableArray array]; // Not retrieved yet, in order
+    
+    for (NSDictionary *entry in previousManifest[kManifestShowsKey])
+    {
+        previousSegments[entry[kManifestShowIDKey]] = entry[kManifestSegmentsKey];
+        
+        if ([entry[kManifestImportedKey] boolValue]) [importedShowIDs addObject:entry[kManifestShowIDKey]];
+    }
+    
+    // Shows added through the journal since the last save, such as the ones
+    // imported in bulk, already have their segments written.
+    NSMutableDictionary *journalSegments = [NSMutableDictionary dictionary];
+    NSMutableArray *journalShowIDs = [NSMutableArray array]; // In the order they were added
+    
+    for (LRTVDBJournalRecord *record in [self.journal records])
     {
-        NSLog(@"Unable to write plist data to disk: %@", *error);
+        if (!record.showID) continue;
+        
+        if (record.type == LRTVDBJournalRecordTypeShowAdded && [record.segmentFileNames count] == kLRTVDBNumberOfShowSections)
+        {
+            if (!journalSegments[record.showID]) [journalShowIDs addObject:record.showID];
+            
+            journalSegments[record.showID] = record.segmentFileNames;
+        }
+        else if (record.type == LRTVDBJournalRecordTypeShowRemoved)
+        {
+            [journalSegments removeObjectForKey:record.showID];
+            [journalShowIDs removeObject:record.showID];
+            [importedShowIDs removeObject:record.showID];
+        }
+    }
+    
+    NSMutableArray *manifestShows = [NSMutableArray arrayWithCapacity:[shows count]];
+    
+    // Taken dirty sections, given back to the shows if the save fails.
+    NSMutableArray *takenDirtySections = [NSMutableArray arrayWithCapacity:[shows count]];
+    
+    BOOL success = YES;
+    
+    for (LRTVDBShow *show in shows)
+    {
+        // Shows without identifier can't be listed in the manifest. Nothing
+        // is taken from them, so nothing is given back on failure either.
+        if (!show.showID)
+        {
+            [takenDirtySections addObject:@0];
+            continue;
+        }
+        
+        NSArray *segments = previousSegments[show.showID];
+        
+        if (journalSegments[show.showID])
+        {
+            segments = [self segmentsByLinkingJournalSegments:journalSegments[show.showID]
+                                                 ofShowWithID:show.showID
+                                                   generation:generation];
+        }
+        
+        BOOL hasSegments = ([segments count] == kLRTVDBNumberOfShowSections);
+        LRTVDBShowSection dirtySections = 0;
+        
+        // Consistent even if the show is being merged into meanwhile.
+        NSDictionary *serializedSections = [show serializedSectionsByTakingDirtySections:&dirtySections
+                                                                           extraSections:hasSegments ? 0 : LRTVDBShowSectionAll];
+        
+        [takenDirtySections addObject:@(dirtySections)];
+        
+        if (!hasSegments)
+        {
+            segments = @[@"", @"", @"", @""];
+        }
+        
+        NSMutableArray *mutableSegments = [segments mutableCopy];
+        
+        for (NSUInteger i = 0; i < kLRTVDBNumberOfShowSections; i++)
+        {
+            NSDictionary *serializedSection = serializedSections[@(kLRTVDBShowSections[i])];
+            
+            if (!serializedSection) continue;
+            
+            NSData *segmentData = LRTVDBSegmentData(serializedSection, self.compressionEnabled, error);
+            
+            NSString *segmentFileName = LRTVDBSegmentFileName(show.showID, i, generation);
+            
+            success = segmentData && [segmentData writeToFile:[storePath stringByAppendingPathComponent:segmentFileName]
+                                                      options:NSDataWritingAtomic
+                                                        error:error];
+            
+            if (!success) break;
+            
+            mutableSegments[i] = segmentFileName;
+            self.numberOfWrittenSegments++;
+        }
+        
+        if (!success) break;
+        
+        [manifestShows addObject:@{ kManifestShowIDKey: show.showID,
+                                    kManifestSegmentsKey: [mutableSegments copy] }];
+    }
+    
+    if (success)
+    {
+        // Shows added through the journal which aren't among the saved ones,
+        // such as the ones imported in bulk while the caller was saving the
+        // shows it had retrieved before, are kept after them, flagged until
+        // they're retrieved (see markEntriesAsRetrieved:). Only removed shows
+        // are dropped.
+        NSSet *savedShowIDs = [NSSet setWithArray:[manifestShows valueForKey:kManifestShowIDKey]];
+        
+        NSMutableOrderedSet *keptShowIDs = [NSMutableOrderedSet orderedSetWithArray:importedShowIDs];
+        [keptShowIDs addObjectsFromArray:journalShowIDs];
+        
+        for (NSString *showID in keptShowIDs)
+        {
+            if ([savedShowIDs containsObject:showID]) continue;
+            
+            NSArray *segments = previousSegments[showID];
+            
+            if (journalSegments[showID])
+            {
+                // Journal segments stay in the store as long as a manifest lists them.
+                segments = [self segmentsByLinkingJournalSegments:journalSegments[showID]
+                                                     ofShowWithID:showID
+                                                       generation:generation] ? : journalSegments[showID];
+            }
+            
+            if (!segments) continue;
+            
+            [manifestShows addObject:@{ kManifestShowIDKey: showID,
+                                        kManifestSegmentsKey: segments,
+                                        kManifestImportedKey: @YES }];
+        }
+    }
+    
+    if (success)
+    {
+        NSDictionary *manifest = @{ kManifestVersionKey: @(kLRTVDBShowsStoreVersion),
+                                    kManifestGenerationKey: @(generation),
+                                    kManifestShowsKey: manifestShows };
+        
+        // Commit point: until the manifest is replaced, the previous one is still valid.
+        success = [self writeManifest:manifest error:error];
+        
+        if (success)
+        {
+            [self.journal removeFilesUpToSequence:rotatedJournalSequence];
+            [self removeSegmentsNotInManifest:manifest];
+            [[NSFileManager defaultManager] removeItemAtPath:[self showsStoragePath] error:NULL];
+        }
+    }
+    
+    if (!success)
+    {
+        NSLog(@"Unable to write shows to disk: %@", error ? *error : nil);
+        
+        [takenDirtySections enumerateObjectsUsingBlock:^(NSNumber *dirtySections, NSUInteger idx, BOOL *stop) {
+            [shows[idx] markSectionsAsDirty:(LRTVDBShowSection)[dirtySections unsignedIntValue]];
+        }];
     }
 }
 
@@ -80,22 +701,345 @@ static NSString *const kLRTVDBShowsPersistenceFileName = @"LRTVDBShowsPersistenc
 
 - (NSArray *)showsFromPersistenceStorageWithError:(__autoreleasing NSError **)error
 {
-    NSData *plistData = [NSData dataWithContentsOfFile:[self showsStoragePath]
-                                               options:0
-                                                 error:error];
+    LRTVDBShowDecodingBlock decodingBlock = nil;
     
-    if(!plistData || *error)
+    NSArray *entries = [self persistedEntriesWithDecodingBlock:&decodingBlock error:error];
+    
+    if (!entries) return nil;
+    
+    NSArray *shows = LRTVDBDecodeShowsConcurrently(entries, NSMakeRange(0, [entries count]), decodingBlock);
+    
+    [self markEntriesAsRetrieved:entries];
+    
+    return shows;
+}
+
+- (void)showsFromPersistenceStorageWithProgressBlock:(void (^)(NSArray *shows))progressBlock
+                                     completionBlock:(void (^)(NSArray *shows, NSError *error))completionBlock
+{
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
+        
+        NSError *error = nil;
+        LRTVDBShowDecodingBlock decodingBlock = nil;
+        
+        NSArray *entries = [self persistedEntriesWithDecodingBlock:&decodingBlock error:&error];
+        NSMutableArray *shows = [NSMutableArray arrayWithCapacity:[entries count]];
+        
+        NSUInteger location = 0;
+        NSUInteger batchSize = kLRTVDBFirstLoadBatchSize;
+        
+        while (location < [entries count])
+        {
+            NSRange range = NSMakeRange(location, MIN(batchSize, [entries count] - location));
+            
+            location = NSMaxRange(range);
+            batchSize = MIN(batchSize * 2, kLRTVDBMaxLoadBatchSize);
+            
+            NSArray *batch = LRTVDBDecodeShowsConcurrently(entries, range, decodingBlock);
+            
+            [shows addObjectsFromArray:batch];
+            
+            // The main queue is serial, so batches are delivered in order.
+            if (progressBlock && [batch count] > 0)
+            {
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    progressBlock(batch);
+                });
+            }
+        }
+        
+        if (entries) [self markEntriesAsRetrieved:entries];
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (completionBlock) completionBlock(entries ? [shows copy] : nil, error);
+        });
+    });
+}
+
+- (NSArray *)showsFromData:(NSData *)data error:(__autoreleasing NSError **)error
+{
+    NSArray *serializedEntries = [self serializedShowsFromData:data error:error];
+    
+    if (!serializedEntries) return nil;
+    
+    return LRTVDBDecodeShowsConcurrently(serializedEntries, NSMakeRange(0, [serializedEntries count]), [self serializedShowDecodingBlock]);
+}
+
+#pragma mark - Journal
+
+- (LRTVDBPersistenceJournal *)journal
+{
+    NSString *storePath = [self showsStorePath];
+    
+    return [[self class] sharedObjectForKey:@"Journal" storePath:storePath creationBlock:^id{
+        return [[LRTVDBPersistenceJournal alloc] initWithDirectoryPath:storePath];
+    }];
+}
+
+- (void)journalSeenStatusOfEpisodes:(NSArray *)episodes
+{
+    for (LRTVDBEpisode *episode in episodes)
     {
-        NSLog(@"Unable to read plist data from disk: %@", *error);
-        return nil;
+        NSString *showID = episode.showID ? : episode.show.showID;
+        
+        if (!showID || !episode.episodeID) continue;
+        
+        LRTVDBJournalRecordType type = episode.hasBeenSeen ? LRTVDBJournalRecordTypeEpisodeSeen : LRTVDBJournalRecordTypeEpisodeNotSeen;
+        
+        [self.journal appendRecord:[LRTVDBJournalRecord recordWithType:type
+                                                                showID:showID
+                                                             episodeID:episode.episodeID
+                                                      segmentFileNames:nil]];
+    }
+}
+
+- (void)journalAddedShow:(LRTVDBShow *)show
+{
+    NSError *error = nil;
+    
+    if (![self journalAddedShows:@[show] error:&error])
+    {
+        NSLog(@"Unable to journal added show %@: %@", show.showID, error);
+    }
+}
+
+- (BOOL)journalAddedShows:(NSArray *)shows error:(__autoreleasing NSError **)error
+{
+    // Written while saves go on: the segments are kept from being removed
+    // by them until their records are appended.
+    for (LRTVDBShow *show in shows)
+    {
+        if (![self writeJournalAddedShow:show error:error]) return NO;
+    }
+    
+    return YES;
+}
+
+- (BOOL)writeJournalAddedShow:(LRTVDBShow *)show error:(__autoreleasing NSError **)error
+{
+    NSString *storePath = [self showsStorePath];
+    
+    [[NSFileManager defaultManager] createDirectoryAtPath:storePath
+                              withIntermediateDirectories:YES
+                                               attributes:nil
+                                                    error:NULL];
+    
+    LRTVDBPersistenceWriter *writer = [self writer];
+    NSUInteger journalSequence = self.journal.currentSequence;
+    NSMutableArray *segmentFileNames = [NSMutableArray arrayWithCapacity:kLRTVDBNumberOfShowSections];
+    
+    for (NSUInteger i = 0; i < kLRTVDBNumberOfShowSections; i++)
+    {
+        [segmentFileNames addObject:LRTVDBJournalSegmentFileName(show.showID, i, journalSequence)];
+    }
+    
+    // Kept before they're written, so no save can list them unkept.
+    [writer keepSegmentFileNames:segmentFileNames];
+    
+    BOOL success = YES;
+    
+    for (NSUInteger i = 0; i < kLRTVDBNumberOfShowSections && success; i++)
+    {
+        NSData *segmentData = LRTVDBSegmentData([show serializeSection:kLRTVDBShowSections[i]], self.compressionEnabled, error);
+        
+        success = segmentData && [segmentData writeToFile:[storePath stringByAppendingPathComponent:segmentFileNames[i]]
+                                                  options:NSDataWritingAtomic
+                                                    error:error];
+    }
+    
+    if (success)
+    {
+        [self.journal appendRecord:[LRTVDBJournalRecord recordWithType:LRTVDBJournalRecordTypeShowAdded
+                                                                showID:show.showID
+                                                             episodeID:nil
+                                                      segmentFileNames:segmentFileNames]];
+    }
+    
+    // From now on, the record keeps them.
+    [writer stopKeepingSegmentFileNames:segmentFileNames];
+    
+    return success;
+}
+
+- (void)journalRemovedShow:(LRTVDBShow *)show
+{
+    if (!show.showID) return;
+    
+    [self.journal appendRecord:[LRTVDBJournalRecord recordWithType:LRTVDBJournalRecordTypeShowRemoved
+                                                            showID:show.showID
+                                                         episodeID:nil
+                                                  segmentFileNames:nil]];
+}
+
+- (void)synchronizeJournal
+{
+    [self.journal synchronize];
+}
+
+#pragma mark - Entries
+
+/**
+ Reads the entries of every persisted show, without decoding them.
+ @param decodingBlock On return, the block decoding an entry into a show. It
+ can be called from any thread.
+ @return Manifest entries if the shows are in the segment store, serialized
+ shows if they're in the single file of previous versions, followed by the
+ entries of the shows added through the journal. nil if none can be read.
+ */
+- (NSArray *)persistedEntriesWithDecodingBlock:(__autoreleasing LRTVDBShowDecodingBlock *)decodingBlock error:(__autoreleasing NSError **)error
+{
+    NSDictionary *manifest = [self manifest];
+    NSArray *records = [self.journal records];
+    
+    NSArray *entries = nil;
+    LRTVDBShowDecodingBlock storedEntryDecodingBlock = nil;
+    
+    if (manifest)
+    {
+        storedEntryDecodingBlock = [self manifestEntryDecodingBlock];
+        entries = manifest[kManifestShowsKey];
     }
     else
     {
-        return [self showsFromData:plistData error:error];
+        NSData *plistData = [NSData dataWithContentsOfFile:[self showsStoragePath]
+                                                   options:0
+                                                     error:error];
+        
+        if(!plistData || *error)
+        {
+            // Shows may have been added through the journal before the first save.
+            if ([records count] == 0)
+            {
+                NSLog(@"Unable to read plist data from disk: %@", *error);
+                return nil;
+            }
+            
+            *error = nil;
+        }
+        else
+        {
+            storedEntryDecodingBlock = [self serializedShowDecodingBlock];
+            entries = [self serializedShowsFromData:plistData error:error];
+            
+            if (!entries) return nil;
+        }
     }
+    
+    if ([records count] == 0)
+    {
+        *decodingBlock = storedEntryDecodingBlock;
+        return entries;
+    }
+    
+    return [self entries:entries byReplayingJournalRecords:records storedEntryDecodingBlock:storedEntryDecodingBlock decodingBlock:decodingBlock];
 }
 
-- (NSArray *)showsFromData:(NSData *)data error:(__autoreleasing NSError **)error
+/**
+ Applies the journal records to the persisted entries.
+ @discussion Added shows are appended as new entries, removed ones are
+ filtered once decoded, and seen changes are applied to the decoded shows.
+ Replaying records already in the store is harmless, so a crash between
+ writing the manifest and removing the journal loses nothing.
+ */
+- (NSArray *)entries:(NSArray *)entries
+byReplayingJournalRecords:(NSArray *)records
+storedEntryDecodingBlock:(LRTVDBShowDecodingBlock)storedEntryDecodingBlock
+       decodingBlock:(__autoreleasing LRTVDBShowDecodingBlock *)decodingBlock
+{
+    NSMutableSet *removedShowIDs = [NSMutableSet set];
+    NSMutableDictionary *addedEntries = [NSMutableDictionary dictionary];
+    NSMutableArray *addedShowIDs = [NSMutableArray array];
+    NSMutableDictionary *seenChanges = [NSMutableDictionary dictionary];
+    
+    for (LRTVDBJournalRecord *record in records)
+    {
+        NSString *showID = record.showID;
+        
+        switch (record.type)
+        {
+            case LRTVDBJournalRecordTypeShowAdded:
+                
+                if ([record.segmentFileNames count] != kLRTVDBNumberOfShowSections) break;
+                
+                // Seen changes recorded before are already in the added segments.
+                [removedShowIDs removeObject:showID];
+                [seenChanges removeObjectForKey:showID];
+                [addedShowIDs removeObject:showID];
+                [addedShowIDs addObject:showID];
+                addedEntries[showID] = @{ kManifestShowIDKey: showID,
+                                          kManifestSegmentsKey: record.segmentFileNames };
+                break;
+                
+            case LRTVDBJournalRecordTypeShowRemoved:
+                
+                [removedShowIDs addObject:showID];
+                [seenChanges removeObjectForKey:showID];
+                [addedShowIDs removeObject:showID];
+                [addedEntries removeObjectForKey:showID];
+                break;
+                
+            case LRTVDBJournalRecordTypeEpisodeSeen:
+            case LRTVDBJournalRecordTypeEpisodeNotSeen:
+                
+                if (!record.episodeID) break;
+                
+                if (!seenChanges[showID]) seenChanges[showID] = [NSMutableArray array];
+                
+                [seenChanges[showID] addObject:record];
+                break;
+        }
+    }
+    
+    NSMutableArray *replayedEntries = [NSMutableArray arrayWithArray:entries];
+    
+    for (NSString *showID in addedShowIDs)
+    {
+        [replayedEntries addObject:addedEntries[showID]];
+    }
+    
+    LRTVDBShowDecodingBlock manifestEntryDecodingBlock = [self manifestEntryDecodingBlock];
+    NSSet *finalRemovedShowIDs = [removedShowIDs copy];
+    NSDictionary *finalAddedEntries = [addedEntries copy];
+    NSDictionary *finalSeenChanges = [seenChanges copy];
+    
+    *decodingBlock = ^LRTVDBShow *(NSDictionary *entry) {
+        
+        // Added entries are always manifest entries, even before the first save.
+        LRTVDBShowDecodingBlock entryDecodingBlock = entry[kManifestSegmentsKey] ? manifestEntryDecodingBlock : storedEntryDecodingBlock;
+        
+        LRTVDBShow *show = entryDecodingBlock(entry);
+        
+        if (!show || [finalRemovedShowIDs containsObject:show.showID]) return nil;
+        
+        // Stored show replaced by a newer one added through the journal.
+        NSDictionary *addedEntry = finalAddedEntries[show.showID];
+        
+        if (addedEntry && addedEntry != entry) return nil;
+        
+        NSArray *showSeenChanges = finalSeenChanges[show.showID];
+        
+        if ([showSeenChanges count] > 0)
+        {
+            NSMutableDictionary *episodesByID = [NSMutableDictionary dictionaryWithCapacity:[show.episodes count]];
+            
+            for (LRTVDBEpisode *episode in show.episodes)
+            {
+                if (episode.episodeID) episodesByID[episode.episodeID] = episode;
+            }
+            
+            for (LRTVDBJournalRecord *record in showSeenChanges)
+            {
+                [episodesByID[record.episodeID] setSeen:record.type == LRTVDBJournalRecordTypeEpisodeSeen];
+            }
+        }
+        
+        return show;
+    };
+    
+    return [replayedEntries copy];
+}
+
+- (NSArray *)serializedShowsFromData:(NSData *)data error:(__autoreleasing NSError **)error
 {
     NSArray *serializedEntries = [NSPropertyListSerialization propertyListWithData:data
                                                                            options:0
@@ -107,30 +1051,281 @@ static NSString *const kLRTVDBShowsPersistenceFileName = @"LRTVDBShowsPersistenc
         return nil;
     }
     
-    NSMutableArray *mutableShows = [NSMutableArray arrayWithCapacity:[serializedEntries count]];
+    return serializedEntries;
+}
+
+- (LRTVDBShowDecodingBlock)serializedShowDecodingBlock
+{
+    return ^LRTVDBShow *(NSDictionary *serializedEntry) {
+        
+        NSError *error = nil;
+        
+        return [LRTVDBShow deserialize:serializedEntry error:&error];
+    };
+}
+
+#pragma mark - Relationships eviction
+
+- (NSUInteger)evictRelationshipsOfShows:(NSArray *)shows
+{
+    __block NSUInteger numberOfEvictedShows = 0;
+    
+    NSIndexSet *loadedIndexes = [shows indexesOfObjectsPassingTest:^BOOL(LRTVDBShow *show, NSUInteger idx, BOOL *stop) {
+        return ![show isRelationshipsFault];
+    }];
+    
+    NSArray *loadedShows = [shows objectsAtIndexes:loadedIndexes];
+    
+    // Observers are notified out of the writer queue, since they may read
+    // the shows (and reload what has just been evicted).
+    [loadedShows makeObjectsPerformSelector:@selector(willEvictRelationships)];
     
-    for (NSDictionary *serializedEntry in serializedEntries)
+    // No save can replace the segments of the shows meanwhile.
+    dispatch_sync([[self writer] queue], ^{
+        
+        NSDictionary *providers = [self relationshipsProvidersForShows:loadedShows];
+        
+        for (LRTVDBShow *show in loadedShows)
+        {
+            if ([show evictRelationshipsWithProvider:providers[show.showID]]) numberOfEvictedShows++;
+        }
+    });
+    
+    [loadedShows makeObjectsPerformSelector:@selector(didEvictRelationships)];
+    
+    return numberOfEvictedShows;
+}
+
+- (NSDictionary *)relationshipsProvidersForShows:(NSArray *)shows
+{
+    NSString *storePath = [self showsStorePath];
+    NSSet *showIDs = [NSSet setWithArray:[shows valueForKey:@"showID"]];
+    NSMutableDictionary *providers = [NSMutableDictionary dictionaryWithCapacity:[shows count]];
+    
+    for (NSDictionary *entry in [self manifest][kManifestShowsKey])
     {
+        NSString *showID = entry[kManifestShowIDKey];
+        NSArray *segments = entry[kManifestSegmentsKey];
+        
+        if (![showIDs containsObject:showID] || [segments count] != kLRTVDBNumberOfShowSections) continue;
+        
+        NSArray *relationshipsSegments = [segments subarrayWithRange:NSMakeRange(1, kLRTVDBNumberOfShowSections - 1)];
+        
+        providers[showID] = [[LRTVDBSegmentsRelationshipsProvider alloc] initWithStorePath:storePath
+                                                                         segmentFileNames:relationshipsSegments];
+    }
+    
+    return providers;
+}
+
+#pragma mark - Segment store
+
+- (NSDictionary *)manifest
+{
+    NSData *manifestData = [NSData dataWithContentsOfFile:[self manifestPath]];
+    
+    if (!manifestData) return nil;
+    
+    NSDictionary *manifest = [NSPropertyListSerialization propertyListWithData:manifestData
+                                                                       options:0
+                                                                        format:NULL
+                                                                         error:NULL];
+    
+    if (![manifest isKindOfClass:[NSDictionary class]] ||
+        [manifest[kManifestVersionKey] unsignedIntegerValue] != kLRTVDBShowsStoreVersion)
+    {
+        NSLog(@"Unable to decode the shows store manifest");
+        return nil;
+    }
+    
+    return manifest;
+}
+
+- (BOOL)writeManifest:(NSDictionary *)manifest error:(__autoreleasing NSError **)error
+{
+    NSData *manifestData = [NSPropertyListSerialization dataWithPropertyList:manifest
+                                                                      format:NSPropertyListBinaryFormat_v1_0
+                                                                     options:0
+                                                                       error:error];
+    
+    return manifestData && [manifestData writeToFile:[self manifestPath]
+                                             options:NSDataWritingAtomic
+                                               error:error];
+}
+
+- (void)markEntriesAsRetrieved:(NSArray *)entries
+{
+    NSMutableSet *retrievedShowIDs = [NSMutableSet set];
+    
+    for (NSDictionary *entry in entries)
+    {
+        if ([entry[kManifestImportedKey] boolValue]) [retrievedShowIDs addObject:entry[kManifestShowIDKey]];
+    }
+    
+    if ([retrievedShowIDs count] == 0) return;
+    
+    // Serialized with the saves, which flag the shows.
+    dispatch_async([[self writer] queue], ^{
+        
+        NSDictionary *manifest = [self manifest];
+        NSMutableArray *manifestShows = [NSMutableArray arrayWithCapacity:[manifest[kManifestShowsKey] count]];
+        BOOL changed = NO;
+        
+        for (NSDictionary *entry in manifest[kManifestShowsKey])
+        {
+            if ([entry[kManifestImportedKey] boolValue] && [retrievedShowIDs containsObject:entry[kManifestShowIDKey]])
+            {
+                NSMutableDictionary *retrievedEntry = [entry mutableCopy];
+                [retrievedEntry removeObjectForKey:kManifestImportedKey];
+                [manifestShows addObject:retrievedEntry];
+                
+                changed = YES;
+            }
+            else
+            {
+                [manifestShows addObject:entry];
+            }
+        }
+        
+        if (!changed) return;
+        
+        NSMutableDictionary *retrievedManifest = [manifest mutableCopy];
+        retrievedManifest[kManifestShowsKey] = manifestShows;
+        
+        NSError *error = nil;
+        
+        if (![self writeManifest:retrievedManifest error:&error])
+        {
+            NSLog(@"Unable to mark imported shows as retrieved: %@", error);
+        }
+    });
+}
+
+- (LRTVDBShowDecodingBlock)manifestEntryDecodingBlock
+{
+    NSString *storePath = [self showsStorePath];
+    
+    return ^LRTVDBShow *(NSDictionary *entry) {
+        
+        NSArray *segments = entry[kManifestSegmentsKey];
+        
+        if ([segments count] != kLRTVDBNumberOfShowSections) return nil;
+        
+        // Only the info segment is read now, episodes, images and actors
+        // are decoded on first access.
+        NSDictionary *serializedShow = LRTVDBSegmentAtPath([storePath stringByAppendingPathComponent:segments[0]]);
+        
+        if (!serializedShow) return nil;
+        
         NSError *error = nil;
         
-        LRTVDBShow *show = [LRTVDBShow deserialize:serializedEntry error:&error];
+        LRTVDBShow *show = [LRTVDBShow deserialize:serializedShow error:&error];
         
         if (show)
         {
-            [mutableShows addObject:show];
+            NSArray *relationshipsSegments = [segments subarrayWithRange:NSMakeRange(1, kLRTVDBNumberOfShowSections - 1)];
+            
+            [show setRelationshipsFaultWithProvider:[[LRTVDBSegmentsRelationshipsProvider alloc] initWithStorePath:storePath
+                                                                                                  segmentFileNames:relationshipsSegments]];
+            
+            // Just as it is on disk.
+            [show takeDirtySections];
         }
+        
+        return show;
+    };
+}
+
+/**
+ Links the segments of a show added through the journal under the names of
+ the new generation, so they outlive the journal without being written again.
+ @return The linked segment file names, nil if any of them couldn't be linked.
+ */
+- (NSArray *)segmentsByLinkingJournalSegments:(NSArray *)journalSegmentFileNames
+                                 ofShowWithID:(NSString *)showID
+                                   generation:(NSUInteger)generation
+{
+    NSString *storePath = [self showsStorePath];
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSMutableArray *segmentFileNames = [NSMutableArray arrayWithCapacity:kLRTVDBNumberOfShowSections];
+    
+    for (NSUInteger i = 0; i < kLRTVDBNumberOfShowSections; i++)
+    {
+        NSString *segmentFileName = LRTVDBSegmentFileName(showID, i, generation);
+        NSString *segmentPath = [storePath stringByAppendingPathComponent:segmentFileName];
+        
+        // Left behind by a save which didn't get to write its manifest.
+        [fileManager removeItemAtPath:segmentPath error:NULL];
+        
+        if (![fileManager linkItemAtPath:[storePath stringByAppendingPathComponent:journalSegmentFileNames[i]]
+                                  toPath:segmentPath
+                                   error:NULL])
+        {
+            return nil;
+        }
+        
+        [segmentFileNames addObject:segmentFileName];
     }
     
-    return [mutableShows copy];
+    return [segmentFileNames copy];
+}
+
+/**
+ Removes the segments replaced by the last save, and any segment left behind
+ by a save which didn't get to write its manifest. Journal files, the
+ segments they refer to and the ones being written for them are kept.
+ */
+- (void)removeSegmentsNotInManifest:(NSDictionary *)manifest
+{
+    NSString *storePath = [self showsStorePath];
+    NSMutableSet *fileNames = [NSMutableSet setWithObject:kLRTVDBShowsStoreManifestFileName];
+    
+    for (NSDictionary *entry in manifest[kManifestShowsKey])
+    {
+        [fileNames addObjectsFromArray:entry[kManifestSegmentsKey]];
+    }
+    
+    // Shows being added through the journal meanwhile: segments are listed
+    // before they're looked up in the kept ones, and these before the
+    // records, so a segment is either kept, recorded, or not listed yet.
+    NSArray *storeFileNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:storePath error:NULL];
+    
+    [fileNames unionSet:[[self writer] keptSegmentFileNames]];
+    
+    for (LRTVDBJournalRecord *record in [self.journal records])
+    {
+        if (record.segmentFileNames) [fileNames addObjectsFromArray:record.segmentFileNames];
+    }
+    
+    for (NSString *fileName in storeFileNames)
+    {
+        if (![fileNames containsObject:fileName] && ![LRTVDBPersistenceJournal isJournalFileName:fileName])
+        {
+            [[NSFileManager defaultManager] removeItemAtPath:[storePath stringByAppendingPathComponent:fileName] error:NULL];
+        }
+    }
 }
 
 #pragma mark - Persistence File URL
 
+- (NSString *)documentsDirectory
+{
+    return [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) lr_firstObject];
+}
+
 - (NSString *)showsStoragePath
 {
-    NSString *docsDirectory = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) lr_firstObject];
-    
-    return [docsDirectory stringByAppendingPathComponent:kLRTVDBShowsPersistenceFileName];
+    return [[self documentsDirectory] stringByAppendingPathComponent:kLRTVDBShowsPersistenceFileName];
+}
+
+- (NSString *)showsStorePath
+{
+    return [[self documentsDirectory] stringByAppendingPathComponent:kLRTVDBShowsStoreDirectoryName];
+}
+
+- (NSString *)manifestPath
+{
+    return [[self showsStorePath] stringByAppendingPathComponent:kLRTVDBShowsStoreManifestFileName];
 }
 
 @end
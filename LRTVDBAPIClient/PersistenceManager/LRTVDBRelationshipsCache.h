@@ -0,0 +1,80 @@
+// LRTVDBRelationshipsCache.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class LRTVDBPersistenceManager;
+
+/**
+ Keeps the relationships (episodes, images and actors) of the shows loaded
+ only while they're being used.
+ 
+ @discussion Evicted relationships are released and transparently reloaded
+ from the persistence store the next time they're accessed (see
+ LRTVDBPersistenceManager evictRelationshipsOfShows:). Show properties,
+ including the ones derived from the episodes, such as lastEpisode or
+ status, stay loaded.
+ 
+ Shows are cold if their relationships haven't been read since the last
+ trim or eviction. Ended shows are evicted first, then the least recently
+ read ones.
+ 
+ On iOS, cold relationships are evicted on memory warnings (see
+ evictColdRelationships).
+ @remarks Thread safe. Relationships evicted while other threads are reading
+ them are reloaded for those threads.
+ */
+@interface LRTVDBRelationshipsCache : NSObject
+
+- (id)initWithPersistenceManager:(LRTVDBPersistenceManager *)persistenceManager;
+
+@property (nonatomic, strong, readonly) LRTVDBPersistenceManager *persistenceManager;
+
+/** Shows whose relationships are managed, usually every loaded show. */
+@property (atomic, copy) NSArray *shows;
+
+/**
+ Bytes of relationships trim keeps loaded. 0, the default, means no budget.
+ */
+@property (atomic) unsigned long long memoryBudget;
+
+/**
+ Evicts relationships, ended shows and least recently read ones first,
+ until the loaded ones fit in the memory budget.
+ @return The number of evicted shows.
+ */
+- (NSUInteger)trim;
+
+/**
+ Evicts the relationships of every cold or ended show, whatever the memory
+ budget is. Called on memory warnings on iOS.
+ @return The number of evicted shows.
+ */
+- (NSUInteger)evictColdRelationships;
+
+/**
+ Estimated bytes used by the loaded relationships of the shows (see
+ LRTVDBShow memoryUsage).
+ */
+@property (nonatomic, readonly) unsigned long long relationshipsMemorySize;
+
+@end
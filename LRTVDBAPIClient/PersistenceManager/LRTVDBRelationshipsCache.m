@@ -0,0 +1,148 @@
+// LRTVDBRelationshipsCache.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBRelationshipsCache.h"
+#import "LRTVDBPersistenceManager.h"
+#import "LRTVDBShow+Private.h"
+#if TARGET_OS_IPHONE
+#import <UIKit/UIKit.h>
+#endif
+
+@implementation LRTVDBRelationshipsCache
+
+- (id)initWithPersistenceManager:(LRTVDBPersistenceManager *)persistenceManager
+{
+    if (self = [super init])
+    {
+        _persistenceManager = persistenceManager;
+#if TARGET_OS_IPHONE
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+#endif
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - Eviction
+
+- (NSUInteger)trim
+{
+    // Shows read from now on are more recent than any loaded one.
+    [LRTVDBShow beginRelationshipsAccessPeriod];
+    
+    unsigned long long memoryBudget = self.memoryBudget;
+    
+    if (memoryBudget == 0) return 0;
+    
+    NSMutableArray *loadedShows = [NSMutableArray array];
+    NSMutableDictionary *memorySizes = [NSMutableDictionary dictionary];
+    unsigned long long memorySize = 0;
+    
+    for (LRTVDBShow *show in self.shows)
+    {
+        if ([show isRelationshipsFault] || !show.showID) continue;
+        
+        size_t showMemorySize = LRTVDBShowMemoryUsageRelationships(show.memoryUsage);
+        
+        [loadedShows addObject:show];
+        memorySizes[show.showID] = @(showMemorySize);
+        memorySize += showMemorySize;
+    }
+    
+    if (memorySize <= memoryBudget) return 0;
+    
+    [loadedShows sortUsingComparator:^NSComparisonResult(LRTVDBShow *firstShow, LRTVDBShow *secondShow) {
+        
+        BOOL firstShowEnded = (firstShow.basicStatus == LRTVDBShowBasicStatusEnded);
+        BOOL secondShowEnded = (secondShow.basicStatus == LRTVDBShowBasicStatusEnded);
+        
+        if (firstShowEnded != secondShowEnded)
+        {
+            return firstShowEnded ? NSOrderedAscending : NSOrderedDescending;
+        }
+        
+        uint32_t firstAccessPeriod = firstShow.relationshipsAccessPeriod;
+        uint32_t secondAccessPeriod = secondShow.relationshipsAccessPeriod;
+        
+        return firstAccessPeriod < secondAccessPeriod ? NSOrderedAscending :
+               (firstAccessPeriod > secondAccessPeriod ? NSOrderedDescending : NSOrderedSame);
+    }];
+    
+    NSMutableArray *showsToEvict = [NSMutableArray array];
+    
+    for (LRTVDBShow *show in loadedShows)
+    {
+        if (memorySize <= memoryBudget) break;
+        
+        [showsToEvict addObject:show];
+        memorySize -= [memorySizes[show.showID] unsignedLongLongValue];
+    }
+    
+    return [self.persistenceManager evictRelationshipsOfShows:showsToEvict];
+}
+
+- (NSUInteger)evictColdRelationships
+{
+    uint32_t lastAccessPeriod = [LRTVDBShow beginRelationshipsAccessPeriod];
+    
+    NSMutableArray *showsToEvict = [NSMutableArray array];
+    
+    for (LRTVDBShow *show in self.shows)
+    {
+        if ([show isRelationshipsFault]) continue;
+        
+        if (show.basicStatus == LRTVDBShowBasicStatusEnded || show.relationshipsAccessPeriod < lastAccessPeriod)
+        {
+            [showsToEvict addObject:show];
+        }
+    }
+    
+    return [self.persistenceManager evictRelationshipsOfShows:showsToEvict];
+}
+
+- (void)didReceiveMemoryWarning:(NSNotification *)notification
+{
+    [self evictColdRelationships];
+}
+
+#pragma mark - Memory size
+
+- (unsigned long long)relationshipsMemorySize
+{
+    unsigned long long memorySize = 0;
+    
+    for (LRTVDBShow *show in self.shows)
+    {
+        memorySize += LRTVDBShowMemoryUsageRelationships(show.memoryUsage);
+    }
+    
+    return memorySize;
+}
+
+@end
@@ -0,0 +1,107 @@
+// LRTVDBSQLitePersistenceManager.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBPersistenceManager.h"
+#import "NSDate+LRTVDBAdditions.h"
+
+static NSString *const kSQLiteErrorDomain = @"kSQLiteErrorDomain";
+
+/**
+ Lightweight row with the indexed values of a persisted episode.
+ */
+@interface LRTVDBEpisodeRow : NSObject
+
+@property (nonatomic, copy, readonly) NSString *episodeID;
+@property (nonatomic, copy, readonly) NSString *showID;
+@property (nonatomic, copy, readonly) NSString *title;
+@property (nonatomic, readonly) NSInteger seasonNumber;
+@property (nonatomic, readonly) NSInteger episodeNumber;
+
+/** LRTVDBUnknownDayNumber if the episode has no aired date. */
+@property (nonatomic, readonly) LRTVDBDayNumber airedDayNumber;
+@property (nonatomic, readonly) NSDate *airedDate;
+
+@property (nonatomic, readonly, getter = hasBeenSeen) BOOL seen;
+
+@end
+
+/**
+ Persistence backend storing the shows in a SQLite database, so that
+ questions about the episodes of every show can be answered without
+ materializing every show.
+ 
+ @discussion Shows are stored one per row, with their info, images and
+ actors sections as in the segment store. Episodes are stored one per row,
+ indexed by aired day, by show, season and episode number, and by seen
+ status. Saves only write the dirty sections of every show, in a single
+ transaction.
+ 
+ Shows are retrieved just like in the segment store: only their info is
+ decoded, the relationships are decoded from the database on first access.
+ 
+ There's no journal: seen status changes are written asynchronously to the
+ rows of their episodes, in the database queue, so every later read sees
+ them (synchronizeJournal waits for them). Shows added or removed through
+ the journal methods are written (or removed) right away. Added shows are
+ flagged in their row until they're retrieved, so saves keep them meanwhile.
+ */
+@interface LRTVDBSQLitePersistenceManager : LRTVDBPersistenceManager
+
+/**
+ @return Rows of the episodes aired between both dates (days included),
+ sorted by aired day. nil if the database can't be read.
+ */
+- (NSArray *)episodeRowsAiredFromDate:(NSDate *)fromDate
+                               toDate:(NSDate *)toDate
+                                error:(__autoreleasing NSError **)error;
+
+/**
+ @return LRTVDBEpisode objects aired between both dates (days included),
+ sorted by aired day. They don't belong to any show object.
+ */
+- (NSArray *)episodesAiredFromDate:(NSDate *)fromDate
+                            toDate:(NSDate *)toDate
+                             error:(__autoreleasing NSError **)error;
+
+/**
+ @return Rows of the episodes of a season of a show, sorted by episode number.
+ */
+- (NSArray *)episodeRowsOfShowWithID:(NSString *)showID
+                        seasonNumber:(NSInteger)seasonNumber
+                               error:(__autoreleasing NSError **)error;
+
+/**
+ @return LRTVDBEpisode objects of a season of a show, sorted by episode number.
+ They don't belong to any show object.
+ */
+- (NSArray *)episodesOfShowWithID:(NSString *)showID
+                     seasonNumber:(NSInteger)seasonNumber
+                            error:(__autoreleasing NSError **)error;
+
+/**
+ @return LRTVDBShow objects with regular episodes already aired and not
+ seen, in the order they were saved. Their relationships are decoded on
+ first access.
+ */
+- (NSArray *)showsWithUnseenEpisodesWithError:(__autoreleasing NSError **)error;
+
+@end
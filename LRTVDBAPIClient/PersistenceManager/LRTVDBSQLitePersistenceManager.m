@@ -0,0 +1,1261 @@
+// LRTVDBSQLitePersistenceManager.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBSQLitePersistenceManager.h"
+#import "LRTVDBPersistenceManager+Private.h"
+#import "LRTVDBShow+Private.h"
+#import "LRTVDBEpisode+Private.h"
+#import "NSData+LRTVDBAdditions.h"
+#import <sqlite3.h>
+
+static NSString *const kLRTVDBSQLiteDatabaseFileName = @"LRTVDBShows.sqlite";
+
+/** Increased whenever the schema changes. Databases with another version are rebuilt. */
+static const int kLRTVDBSQLiteSchemaVersion = 2;
+
+static NSString *const kLRTVDBSQLiteSchema =
+    @"DROP TABLE IF EXISTS shows;"
+    @"DROP TABLE IF EXISTS episodes;"
+    @"CREATE TABLE shows (show_id TEXT PRIMARY KEY NOT NULL, position INTEGER NOT NULL, info BLOB NOT NULL, images BLOB, actors BLOB, "
+    @"imported INTEGER NOT NULL DEFAULT 0);"
+    @"CREATE TABLE episodes (show_id TEXT NOT NULL, episode_id TEXT NOT NULL, title TEXT, season_number INTEGER, episode_number INTEGER, "
+    @"aired_day INTEGER, seen INTEGER NOT NULL, data BLOB NOT NULL, PRIMARY KEY (show_id, episode_id));"
+    @"CREATE INDEX episodes_aired_day ON episodes (aired_day);"
+    @"CREATE INDEX episodes_season ON episodes (show_id, season_number, episode_number);"
+    @"CREATE INDEX episodes_seen ON episodes (seen, aired_day);";
+
+static NSString *const kLRTVDBSQLiteEpisodeRowColumns = @"show_id, episode_id, title, season_number, episode_number, aired_day, seen";
+
+/** Entries of the stored shows (see persistedEntriesWithDecodingBlock:error:). */
+static NSString *const kSQLiteEntryShowIDKey = @"kSQLiteEntryShowIDKey";
+static NSString *const kSQLiteEntryInfoKey = @"kSQLiteEntryInfoKey";
+static NSString *const kSQLiteEntryImportedKey = @"kSQLiteEntryImportedKey";
+
+static char kLRTVDBSQLiteDatabaseQueueKey;
+
+#pragma mark - Helpers
+
+/**
+ @param compressed Whether to compress the blob, if it shrinks (see compressionEnabled).
+ */
+static NSData *LRTVDBPropertyListData(id propertyList, BOOL compressed, NSError **error)
+{
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:propertyList
+                                                              format:NSPropertyListBinaryFormat_v1_0
+                                                             options:0
+                                                               error:error];
+    
+    if (data && compressed)
+    {
+        NSData *compressedData = [data lr_compressedData];
+        
+        if ([compressedData length] && [compressedData length] < [data length]) data = compressedData;
+    }
+    
+    return data;
+}
+
+static NSDictionary *LRTVDBDictionaryFromPropertyListData(NSData *data)
+{
+    if ([data lr_isCompressedData]) data = [data lr_decompressedData];
+    
+    NSDictionary *dictionary = data ? [NSPropertyListSerialization propertyListWithData:data
+                                                                               options:0
+                                                                                format:NULL
+                                                                                 error:NULL] : nil;
+    
+    return [dictionary isKindOfClass:[NSDictionary class]] ? dictionary : nil;
+}
+
+/**
+ Binds strings as text, data as blobs, numbers as integers and NSNull as NULL.
+ */
+static void LRTVDBBindArguments(sqlite3_stmt *statement, NSArray *arguments)
+{
+    [arguments enumerateObjectsUsingBlock:^(id argument, NSUInteger idx, BOOL *stop) {
+        
+        int index = (int)idx + 1;
+        
+        if ([argument isKindOfClass:[NSString class]])
+        {
+            sqlite3_bind_text(statement, index, [argument UTF8String], -1, SQLITE_TRANSIENT);
+        }
+        else if ([argument isKindOfClass:[NSData class]])
+        {
+            sqlite3_bind_blob(statement, index, [argument bytes], (int)[argument length], SQLITE_TRANSIENT);
+        }
+        else if ([argument isKindOfClass:[NSNumber class]])
+        {
+            sqlite3_bind_int64(statement, index, [argument longLongValue]);
+        }
+        else
+        {
+            sqlite3_bind_null(statement, index);
+        }
+    }];
+}
+
+static NSString *LRTVDBColumnString(sqlite3_stmt *statement, int column)
+{
+    const unsigned char *text = sqlite3_column_text(statement, column);
+    
+    return text ? [NSString stringWithUTF8String:(const char *)text] : nil;
+}
+
+static NSData *LRTVDBColumnData(sqlite3_stmt *statement, int column)
+{
+    const void *bytes = sqlite3_column_blob(statement, column);
+    
+    return bytes ? [NSData dataWithBytes:bytes length:sqlite3_column_bytes(statement, column)] : nil;
+}
+
+/**
+ @return The integer of the column, unknownValue if it's NULL.
+ */
+static NSInteger LRTVDBColumnInteger(sqlite3_stmt *statement, int column, NSInteger unknownValue)
+{
+    return sqlite3_column_type(statement, column) == SQLITE_NULL ? unknownValue : (NSInteger)sqlite3_column_int64(statement, column);
+}
+
+#pragma mark - LRTVDBSQLiteDatabase
+
+/**
+ Single connection to the database, used from its own serial queue.
+ */
+@interface LRTVDBSQLiteDatabase : NSObject
+
+- (id)initWithPath:(NSString *)path;
+
+/**
+ Runs the block in the database queue, waiting for it. It can be called
+ from the database queue itself.
+ */
+- (void)performBlock:(void (^)(void))block;
+
+/**
+ Runs the block in the database queue, without waiting for it.
+ */
+- (void)performBlockAsynchronously:(void (^)(void))block;
+
+/**
+ Methods below must be called from performBlock:.
+ */
+
+/**
+ Opens the database, creating its schema, if it's not open yet.
+ */
+- (BOOL)open;
+
+/**
+ Runs a statement, preparing it only the first time.
+ @param rowBlock Called for every row. It can be nil.
+ */
+- (BOOL)executeSQL:(NSString *)SQL arguments:(NSArray *)arguments rowBlock:(void (^)(sqlite3_stmt *statement))rowBlock;
+
+/**
+ Runs the block in a transaction, which is rolled back if the block returns NO.
+ */
+- (BOOL)performTransaction:(BOOL (^)(void))block;
+
+/** Rows changed by the last statement. */
+- (NSInteger)numberOfChanges;
+
+/** Error of the last failed call. */
+@property (nonatomic, strong, readonly) NSError *lastError;
+
+@end
+
+@interface LRTVDBSQLiteDatabase ()
+
+@property (nonatomic, strong) NSError *lastError;
+
+@end
+
+@implementation LRTVDBSQLiteDatabase
+{
+    NSString *_path;
+    sqlite3 *_database;
+    dispatch_queue_t _queue;
+    
+    // SQL -> prepared statement (NSValue with a sqlite3_stmt pointer).
+    NSMutableDictionary *_statements;
+}
+
+- (id)initWithPath:(NSString *)path
+{
+    if (self = [super init])
+    {
+        _path = [path copy];
+        _statements = [NSMutableDictionary dictionary];
+        _queue = dispatch_queue_create("com.LRTVDBAPIClient.LRTVDBSQLiteDatabaseQueue", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(_queue, &kLRTVDBSQLiteDatabaseQueueKey, (__bridge void *)self, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (NSValue *statement in [_statements allValues])
+    {
+        sqlite3_finalize([statement pointerValue]);
+    }
+    
+    if (_database) sqlite3_close(_database);
+    
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(_queue);
+#endif
+}
+
+- (void)performBlock:(void (^)(void))block
+{
+    if (dispatch_get_specific(&kLRTVDBSQLiteDatabaseQueueKey) == (__bridge void *)self)
+    {
+        block();
+    }
+    else
+    {
+        dispatch_sync(_queue, block);
+    }
+}
+
+- (void)performBlockAsynchronously:(void (^)(void))block
+{
+    dispatch_async(_queue, block);
+}
+
+- (BOOL)open
+{
+    if (_database) return YES;
+    
+    sqlite3 *database = NULL;
+    
+    if (sqlite3_open_v2([_path fileSystemRepresentation], &database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK)
+    {
+        self.lastError = [self errorWithDatabase:database];
+        sqlite3_close(database);
+        
+        NSLog(@"Unable to open the shows database: %@", self.lastError);
+        
+        return NO;
+    }
+    
+    _database = database;
+    
+    __block int schemaVersion = 0;
+    
+    BOOL success = [self executeSQL:@"PRAGMA journal_mode = WAL" arguments:nil rowBlock:nil] &&
+                   [self executeSQL:@"PRAGMA user_version" arguments:nil rowBlock:^(sqlite3_stmt *statement) {
+                       schemaVersion = sqlite3_column_int(statement, 0);
+                   }];
+    
+    if (success && schemaVersion != kLRTVDBSQLiteSchemaVersion)
+    {
+        success = [self performTransaction:^BOOL{
+            
+            NSString *versionSQL = [NSString stringWithFormat:@"PRAGMA user_version = %d", kLRTVDBSQLiteSchemaVersion];
+            
+            return [self executeScript:kLRTVDBSQLiteSchema] && [self executeScript:versionSQL];
+        }];
+    }
+    
+    if (!success)
+    {
+        NSLog(@"Unable to create the shows database: %@", self.lastError);
+        
+        [self close];
+    }
+    
+    return success;
+}
+
+- (BOOL)executeSQL:(NSString *)SQL arguments:(NSArray *)arguments rowBlock:(void (^)(sqlite3_stmt *statement))rowBlock
+{
+    sqlite3_stmt *statement = [_statements[SQL] pointerValue];
+    
+    if (!statement)
+    {
+        if (sqlite3_prepare_v2(_database, [SQL UTF8String], -1, &statement, NULL) != SQLITE_OK)
+        {
+            self.lastError = [self errorWithDatabase:_database];
+            return NO;
+        }
+        
+        _statements[SQL] = [NSValue valueWithPointer:statement];
+    }
+    
+    LRTVDBBindArguments(statement, arguments);
+    
+    int result;
+    
+    while ((result = sqlite3_step(statement)) == SQLITE_ROW)
+    {
+        if (rowBlock) rowBlock(statement);
+    }
+    
+    if (result != SQLITE_DONE)
+    {
+        self.lastError = [self errorWithDatabase:_database];
+    }
+    
+    // Resetting the statement ends its implicit read transaction.
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+    
+    return result == SQLITE_DONE;
+}
+
+- (BOOL)performTransaction:(BOOL (^)(void))block
+{
+    if (![self executeScript:@"BEGIN IMMEDIATE"]) return NO;
+    
+    if (block() && [self executeScript:@"COMMIT"]) return YES;
+    
+    [self executeScript:@"ROLLBACK"];
+    
+    return NO;
+}
+
+- (NSInteger)numberOfChanges
+{
+    return sqlite3_changes(_database);
+}
+
+#pragma mark - Private
+
+/**
+ Runs statements which are not worth caching.
+ */
+- (BOOL)executeScript:(NSString *)SQL
+{
+    if (sqlite3_exec(_database, [SQL UTF8String], NULL, NULL, NULL) != SQLITE_OK)
+    {
+        self.lastError = [self errorWithDatabase:_database];
+        return NO;
+    }
+    
+    return YES;
+}
+
+- (void)close
+{
+    for (NSValue *statement in [_statements allValues])
+    {
+        sqlite3_finalize([statement pointerValue]);
+    }
+    
+    [_statements removeAllObjects];
+    
+    sqlite3_close(_database);
+    _database = NULL;
+}
+
+- (NSError *)errorWithDatabase:(sqlite3 *)database
+{
+    NSString *message = database ? @(sqlite3_errmsg(database)) : @"Out of memory";
+    
+    return [NSError errorWithDomain:kSQLiteErrorDomain
+                               code:database ? sqlite3_errcode(database) : SQLITE_NOMEM
+                           userInfo:@{NSLocalizedDescriptionKey: message}];
+}
+
+@end
+
+#pragma mark - LRTVDBEpisodeRow
+
+@interface LRTVDBEpisodeRow ()
+
+@property (nonatomic, copy) NSString *episodeID;
+@property (nonatomic, copy) NSString *showID;
+@property (nonatomic, copy) NSString *title;
+@property (nonatomic) NSInteger seasonNumber;
+@property (nonatomic) NSInteger episodeNumber;
+@property (nonatomic) LRTVDBDayNumber airedDayNumber;
+@property (nonatomic, getter = hasBeenSeen) BOOL seen;
+
+/** Serialized episode, only read or written when models are needed. */
+@property (nonatomic, strong) NSDictionary *serializedEpisode;
+@property (nonatomic, strong) NSData *data;
+
+@end
+
+@implementation LRTVDBEpisodeRow
+
++ (instancetype)rowWithEpisode:(LRTVDBEpisode *)episode showID:(NSString *)showID
+{
+    LRTVDBEpisodeRow *row = [[self alloc] init];
+    
+    row.episodeID = episode.episodeID;
+    row.showID = showID;
+    row.title = episode.title;
+    row.seasonNumber = episode.seasonNumberValue;
+    row.episodeNumber = episode.episodeNumberValue;
+    row.airedDayNumber = episode.airedDayNumber;
+    row.seen = episode.seen;
+    row.serializedEpisode = [episode serialize];
+    
+    return row;
+}
+
+/**
+ @param statement Statement selecting kLRTVDBSQLiteEpisodeRowColumns, and
+ optionally the data of the episode after them.
+ */
++ (instancetype)rowWithStatement:(sqlite3_stmt *)statement
+{
+    LRTVDBEpisodeRow *row = [[self alloc] init];
+    
+    row.showID = LRTVDBColumnString(statement, 0);
+    row.episodeID = LRTVDBColumnString(statement, 1);
+    row.title = LRTVDBColumnString(statement, 2);
+    row.seasonNumber = LRTVDBColumnInteger(statement, 3, NSIntegerMax);
+    row.episodeNumber = LRTVDBColumnInteger(statement, 4, NSIntegerMax);
+    row.airedDayNumber = LRTVDBColumnInteger(statement, 5, LRTVDBUnknownDayNumber);
+    row.seen = sqlite3_column_int(statement, 6) != 0;
+    
+    if (sqlite3_column_count(statement) > 7)
+    {
+        row.data = LRTVDBColumnData(statement, 7);
+    }
+    
+    return row;
+}
+
+/**
+ @return Values of the columns of the row, in kLRTVDBSQLiteEpisodeRowColumns
+ order, followed by its data.
+ */
+- (NSArray *)arguments
+{
+    return @[self.showID,
+             self.episodeID,
+             self.title ? : [NSNull null],
+             self.seasonNumber != NSIntegerMax ? @(self.seasonNumber) : [NSNull null],
+             self.episodeNumber != NSIntegerMax ? @(self.episodeNumber) : [NSNull null],
+             self.airedDayNumber != LRTVDBUnknownDayNumber ? @(self.airedDayNumber) : [NSNull null],
+             @(self.seen),
+             self.data];
+}
+
+- (NSDate *)airedDate
+{
+    return [NSDate lr_dateWithDayNumber:self.airedDayNumber];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"Show ID: %@\nEpisode ID: %@\nTitle: %@\nSeason number: %ld\nEpisode number: %ld\nSeen: %d\n",
+            self.showID, self.episodeID, self.title, (long)self.seasonNumber, (long)self.episodeNumber, self.seen];
+}
+
+@end
+
+#pragma mark - LRTVDBSQLiteShowRecord
+
+/**
+ Sections of a show to be written. Sections which don't have to be written
+ are nil.
+ */
+@interface LRTVDBSQLiteShowRecord : NSObject
+
+@property (nonatomic, strong) LRTVDBShow *show;
+@property (nonatomic, copy) NSString *showID;
+
+/** NSNotFound to place the show after every other one. */
+@property (nonatomic) NSInteger position;
+
+/** YES for shows added through the journal, kept until they're retrieved. */
+@property (nonatomic) BOOL imported;
+
+/** Dirty sections taken from the show, given back if the write fails. */
+@property (nonatomic) LRTVDBShowSection takenDirtySections;
+
+@property (nonatomic, strong) NSData *info;
+@property (nonatomic, strong) NSData *images;
+@property (nonatomic, strong) NSData *actors;
+@property (nonatomic, copy) NSArray *episodeRows;
+
+- (NSUInteger)numberOfSections;
+
+@end
+
+@implementation LRTVDBSQLiteShowRecord
+
+- (NSUInteger)numberOfSections
+{
+    return (self.info != nil) + (self.images != nil) + (self.actors != nil) + (self.episodeRows != nil);
+}
+
+@end
+
+#pragma mark - LRTVDBSQLiteRelationshipsProvider
+
+/**
+ Decodes the relationships of a show loaded from the database the first
+ time they're needed.
+ */
+@interface LRTVDBSQLiteRelationshipsProvider : NSObject <LRTVDBShowRelationshipsProvider>
+
+- (id)initWithDatabase:(LRTVDBSQLiteDatabase *)database;
+
+@end
+
+@implementation LRTVDBSQLiteRelationshipsProvider
+{
+    LRTVDBSQLiteDatabase *_database;
+}
+
+- (id)initWithDatabase:(LRTVDBSQLiteDatabase *)database
+{
+    if (self = [super init])
+    {
+        _database = database;
+    }
+    return self;
+}
+
+- (NSDictionary *)serializedRelationshipsForShow:(LRTVDBShow *)show
+{
+    NSString *showID = show.showID;
+    
+    NSMutableArray *sectionsData = [NSMutableArray arrayWithCapacity:2];
+    NSMutableArray *episodesData = [NSMutableArray array];
+    
+    [_database performBlock:^{
+        
+        if (![_database open]) return;
+        
+        [_database executeSQL:@"SELECT images, actors FROM shows WHERE show_id = ?" arguments:@[showID] rowBlock:^(sqlite3_stmt *statement) {
+            
+            for (int column = 0; column < 2; column++)
+            {
+                NSData *data = LRTVDBColumnData(statement, column);
+                
+                if (data) [sectionsData addObject:data];
+            }
+        }];
+        
+        [_database executeSQL:@"SELECT data FROM episodes WHERE show_id = ?" arguments:@[showID] rowBlock:^(sqlite3_stmt *statement) {
+            
+            NSData *data = LRTVDBColumnData(statement, 0);
+            
+            if (data) [episodesData addObject:data];
+        }];
+    }];
+    
+    // Decoded out of the database queue.
+    NSMutableDictionary *relationships = [NSMutableDictionary dictionary];
+    NSMutableArray *serializedEpisodes = [NSMutableArray arrayWithCapacity:[episodesData count]];
+    
+    for (NSData *data in sectionsData)
+    {
+        NSDictionary *section = LRTVDBDictionaryFromPropertyListData(data);
+        
+        if (section) [relationships addEntriesFromDictionary:section];
+    }
+    
+    for (NSData *data in episodesData)
+    {
+        NSDictionary *serializedEpisode = LRTVDBDictionaryFromPropertyListData(data);
+        
+        if (serializedEpisode) [serializedEpisodes addObject:serializedEpisode];
+    }
+    
+    [relationships addEntriesFromDictionary:[LRTVDBShow serializedEpisodesSectionWithEpisodes:serializedEpisodes]];
+    
+    return relationships;
+}
+
+@end
+
+#pragma mark - LRTVDBSQLitePersistenceManager
+
+@implementation LRTVDBSQLitePersistenceManager
+
+- (NSString *)storePath
+{
+    return [[self documentsDirectory] stringByAppendingPathComponent:kLRTVDBSQLiteDatabaseFileName];
+}
+
+- (LRTVDBSQLiteDatabase *)database
+{
+    NSString *storePath = [self storePath];
+    
+    return [[self class] sharedObjectForKey:@"Database" storePath:storePath creationBlock:^id{
+        return [[LRTVDBSQLiteDatabase alloc] initWithPath:storePath];
+    }];
+}
+
+#pragma mark - Writing
+
+- (void)writeShows:(NSArray *)shows error:(__autoreleasing NSError **)error
+{
+    self.numberOfWrittenSegments = 0;
+    
+    NSSet *storedShowIDs = [self storedShowIDsWithError:error];
+    
+    if (!storedShowIDs) return;
+    
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:[shows count]];
+    NSMutableSet *savedShowIDs = [NSMutableSet setWithCapacity:[shows count]];
+    
+    BOOL success = YES;
+    
+    for (LRTVDBShow *show in shows)
+    {
+        if (!show.showID || [savedShowIDs containsObject:show.showID]) continue;
+        
+        // Shows not stored yet have every section written.
+        LRTVDBShowSection extraSections = [storedShowIDs containsObject:show.showID] ? 0 : LRTVDBShowSectionAll;
+        
+        LRTVDBSQLiteShowRecord *record = [self recordForShow:show
+                                         takingDirtySections:YES
+                                               extraSections:extraSections
+                                                       error:error];
+        
+        if (!record)
+        {
+            success = NO;
+            break;
+        }
+        
+        record.position = [records count];
+        
+        [records addObject:record];
+        [savedShowIDs addObject:show.showID];
+    }
+    
+    // Read after the stored shows, so every stored show added through the
+    // journal is in it. The ones which haven't been retrieved yet are kept,
+    // after the saved ones (see saveShowsInPersistenceStorage:error:).
+    NSArray *importedShowIDs = success ? [self importedShowIDsWithError:error] : nil;
+    NSMutableArray *keptShowIDs = [NSMutableArray arrayWithCapacity:[importedShowIDs count]];
+    
+    success = success && importedShowIDs;
+    
+    for (NSString *showID in importedShowIDs)
+    {
+        if ([storedShowIDs containsObject:showID] && ![savedShowIDs containsObject:showID]) [keptShowIDs addObject:showID];
+    }
+    
+    NSMutableSet *removedShowIDs = [storedShowIDs mutableCopy];
+    [removedShowIDs minusSet:savedShowIDs];
+    [removedShowIDs minusSet:[NSSet setWithArray:keptShowIDs]];
+    
+    success = success && [self writeShowRecords:records removingShowsWithIDs:removedShowIDs error:error];
+    
+    if (success)
+    {
+        self.numberOfWrittenSegments = [[records valueForKeyPath:@"@sum.numberOfSections"] unsignedIntegerValue];
+        
+        [self moveShowsWithIDs:keptShowIDs toPosition:[records count]];
+    }
+    else
+    {
+        NSLog(@"Unable to write shows to disk: %@", error ? *error : nil);
+        
+        for (LRTVDBSQLiteShowRecord *record in records)
+        {
+            [record.show markSectionsAsDirty:record.takenDirtySections];
+        }
+    }
+}
+
+/**
+ Serializes the sections of the show to be written.
+ @param takeDirtySections YES to take the dirty sections of the show and
+ write them.
+ @param extraSections Sections written even if they're not dirty.
+ @return nil if the show can't be serialized. Dirty sections are given back then.
+ */
+- (LRTVDBSQLiteShowRecord *)recordForShow:(LRTVDBShow *)show
+                      takingDirtySections:(BOOL)takeDirtySections
+                            extraSections:(LRTVDBShowSection)extraSections
+                                    error:(__autoreleasing NSError **)error
+{
+    LRTVDBSQLiteShowRecord *record = [[LRTVDBSQLiteShowRecord alloc] init];
+    record.show = show;
+    record.showID = show.showID;
+    
+    __block NSDictionary *info = nil;
+    __block NSDictionary *images = nil;
+    __block NSDictionary *actors = nil;
+    __block NSMutableArray *episodeRows = nil;
+    
+    // Every section from the same state of the show.
+    [show performBlockWithConsistentState:^{
+        
+        LRTVDBShowSection sections = extraSections;
+        
+        if (takeDirtySections)
+        {
+            record.takenDirtySections = [show takeDirtySections];
+            sections |= record.takenDirtySections;
+        }
+        
+        if (sections & LRTVDBShowSectionInfo) info = [show serializeSection:LRTVDBShowSectionInfo];
+        if (sections & LRTVDBShowSectionImages) images = [show serializeSection:LRTVDBShowSectionImages];
+        if (sections & LRTVDBShowSectionActors) actors = [show serializeSection:LRTVDBShowSectionActors];
+        
+        if (sections & LRTVDBShowSectionEpisodes)
+        {
+            episodeRows = [NSMutableArray arrayWithCapacity:[show.episodes count]];
+            
+            for (LRTVDBEpisode *episode in show.episodes)
+            {
+                if (episode.episodeID) [episodeRows addObject:[LRTVDBEpisodeRow rowWithEpisode:episode showID:show.showID]];
+            }
+        }
+    }];
+    
+    // Property lists are generated out of the lock.
+    BOOL compressed = self.compressionEnabled;
+    record.info = info ? LRTVDBPropertyListData(info, compressed, error) : nil;
+    record.images = images ? LRTVDBPropertyListData(images, compressed, error) : nil;
+    record.actors = actors ? LRTVDBPropertyListData(actors, compressed, error) : nil;
+    
+    BOOL success = (!info || record.info) && (!images || record.images) && (!actors || record.actors);
+    
+    for (LRTVDBEpisodeRow *row in episodeRows)
+    {
+        if (!success) break;
+        
+        row.data = LRTVDBPropertyListData(row.serializedEpisode, compressed, error);
+        row.serializedEpisode = nil;
+        
+        success = (row.data != nil);
+    }
+    
+    if (!success)
+    {
+        [show markSectionsAsDirty:record.takenDirtySections];
+        return nil;
+    }
+    
+    record.episodeRows = episodeRows;
+    
+    return record;
+}
+
+/**
+ Writes the records and removes the shows with the provided IDs, in a
+ single transaction.
+ */
+- (BOOL)writeShowRecords:(NSArray *)records removingShowsWithIDs:(NSSet *)removedShowIDs error:(__autoreleasing NSError **)error
+{
+    LRTVDBSQLiteDatabase *database = [self database];
+    
+    __block BOOL success = NO;
+    __block NSError *writeError = nil;
+    
+    [database performBlock:^{
+        
+        success = [database open] && [database performTransaction:^BOOL{
+            
+            for (NSString *showID in removedShowIDs)
+            {
+                if (![database executeSQL:@"DELETE FROM episodes WHERE show_id = ?" arguments:@[showID] rowBlock:nil] ||
+                    ![database executeSQL:@"DELETE FROM shows WHERE show_id = ?" arguments:@[showID] rowBlock:nil])
+                {
+                    return NO;
+                }
+            }
+            
+            for (LRTVDBSQLiteShowRecord *record in records)
+            {
+                __block NSInteger position = record.position;
+                
+                if (position == NSNotFound &&
+                    ![database executeSQL:@"SELECT IFNULL(MAX(position) + 1, 0) FROM shows" arguments:nil rowBlock:^(sqlite3_stmt *statement) {
+                        position = (NSInteger)sqlite3_column_int64(statement, 0);
+                    }])
+                {
+                    return NO;
+                }
+                
+                NSArray *arguments = @[@(position),
+                                       record.info ? : [NSNull null],
+                                       record.images ? : [NSNull null],
+                                       record.actors ? : [NSNull null],
+                                       @(record.imported),
+                                       record.showID];
+                
+                if (![database executeSQL:@"UPDATE shows SET position = ?1, info = IFNULL(?2, info), images = IFNULL(?3, images), actors = IFNULL(?4, actors), imported = ?5 WHERE show_id = ?6"
+                                arguments:arguments
+                                 rowBlock:nil])
+                {
+                    return NO;
+                }
+                
+                if ([database numberOfChanges] == 0 &&
+                    ![database executeSQL:@"INSERT INTO shows (position, info, images, actors, imported, show_id) VALUES (?, ?, ?, ?, ?, ?)"
+                                arguments:arguments
+                                 rowBlock:nil])
+                {
+                    return NO;
+                }
+                
+                if (!record.episodeRows) continue;
+                
+                if (![database executeSQL:@"DELETE FROM episodes WHERE show_id = ?" arguments:@[record.showID] rowBlock:nil]) return NO;
+                
+                NSString *insertSQL = [NSString stringWithFormat:@"INSERT OR REPLACE INTO episodes (%@, data) VALUES (?, ?, ?, ?, ?, ?, ?, ?)", kLRTVDBSQLiteEpisodeRowColumns];
+                
+                for (LRTVDBEpisodeRow *row in record.episodeRows)
+                {
+                    if (![database executeSQL:insertSQL arguments:[row arguments] rowBlock:nil]) return NO;
+                }
+            }
+            
+            return YES;
+        }];
+        
+        if (!success) writeError = database.lastError;
+    }];
+    
+    if (error) *error = writeError;
+    
+    return success;
+}
+
+#pragma mark - Journal
+
+// Changes are written to the database directly, there's nothing to replay.
+
+- (void)journalSeenStatusOfEpisodes:(NSArray *)episodes
+{
+    NSMutableArray *rows = [NSMutableArray arrayWithCapacity:[episodes count]];
+    
+    for (LRTVDBEpisode *episode in episodes)
+    {
+        NSString *showID = episode.showID ? : episode.show.showID;
+        
+        if (!showID || !episode.episodeID) continue;
+        
+        [rows addObject:[LRTVDBEpisodeRow rowWithEpisode:episode showID:showID]];
+    }
+    
+    LRTVDBSQLiteDatabase *database = [self database];
+    BOOL compressionEnabled = self.compressionEnabled;
+    
+    // Seen status changes are made from the UI, so they're encoded and
+    // written in the database queue, which serializes them with every read.
+    [database performBlockAsynchronously:^{
+        
+        BOOL success = [database open] && [database performTransaction:^BOOL{
+            
+            for (LRTVDBEpisodeRow *row in rows)
+            {
+                row.data = LRTVDBPropertyListData(row.serializedEpisode, compressionEnabled, NULL);
+                
+                if (!row.data) continue;
+                
+                if (![database executeSQL:@"UPDATE episodes SET seen = ?, data = ? WHERE show_id = ? AND episode_id = ?"
+                                arguments:@[@(row.seen), row.data, row.showID, row.episodeID]
+                                 rowBlock:nil])
+                {
+                    return NO;
+                }
+            }
+            
+            return YES;
+        }];
+        
+        if (!success) NSLog(@"Unable to write seen status of episodes: %@", database.lastError);
+    }];
+}
+
+- (void)journalAddedShow:(LRTVDBShow *)show
+{
+    NSError *error = nil;
+    
+    if (![self journalAddedShows:@[show] error:&error])
+    {
+        NSLog(@"Unable to write added show %@: %@", show.showID, error);
+    }
+}
+
+- (BOOL)journalAddedShows:(NSArray *)shows error:(__autoreleasing NSError **)error
+{
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:[shows count]];
+    
+    for (LRTVDBShow *show in shows)
+    {
+        LRTVDBSQLiteShowRecord *record = [self recordForShow:show
+                                         takingDirtySections:NO
+                                               extraSections:LRTVDBShowSectionAll
+                                                       error:error];
+        
+        if (!record) return NO;
+        
+        record.position = NSNotFound;
+        record.imported = YES;
+        [records addObject:record];
+    }
+    
+    // Every show of the batch is written in a single transaction, flagged as
+    // imported, so no save can see it unflagged.
+    return [self writeShowRecords:records removingShowsWithIDs:nil error:error];
+}
+
+- (void)journalRemovedShow:(LRTVDBShow *)show
+{
+    NSError *error = nil;
+    
+    if (!show.showID) return;
+    
+    if (![self writeShowRecords:nil removingShowsWithIDs:[NSSet setWithObject:show.showID] error:&error])
+    {
+        NSLog(@"Unable to remove show %@: %@", show.showID, error);
+    }
+}
+
+/**
+ Moves the shows to the provided position and the following ones, in order.
+ */
+- (void)moveShowsWithIDs:(NSArray *)showIDs toPosition:(NSUInteger)position
+{
+    if ([showIDs count] == 0) return;
+    
+    LRTVDBSQLiteDatabase *database = [self database];
+    
+    [database performBlock:^{
+        
+        BOOL success = [database open] && [database performTransaction:^BOOL{
+            
+            for (NSUInteger i = 0; i < [showIDs count]; i++)
+            {
+                if (![database executeSQL:@"UPDATE shows SET position = ? WHERE show_id = ?"
+                                arguments:@[@(position + i), showIDs[i]]
+                                 rowBlock:nil])
+                {
+                    return NO;
+                }
+            }
+            
+            return YES;
+        }];
+        
+        if (!success) NSLog(@"Unable to move shows added through the journal: %@", database.lastError);
+    }];
+}
+
+- (void)synchronizeJournal
+{
+    // Waits for the seen status changes still in the database queue.
+    [[self database] performBlock:^{}];
+}
+
+#pragma mark - Entries
+
+- (NSArray *)persistedEntriesWithDecodingBlock:(__autoreleasing LRTVDBShowDecodingBlock *)decodingBlock error:(__autoreleasing NSError **)error
+{
+    *decodingBlock = [self storedShowDecodingBlock];
+    
+    return [self showEntriesWithSQL:@"SELECT show_id, info, imported FROM shows ORDER BY position" arguments:nil error:error];
+}
+
+- (void)markEntriesAsRetrieved:(NSArray *)entries
+{
+    NSMutableArray *retrievedShowIDs = [NSMutableArray array];
+    
+    for (NSDictionary *entry in entries)
+    {
+        if ([entry[kSQLiteEntryImportedKey] boolValue]) [retrievedShowIDs addObject:entry[kSQLiteEntryShowIDKey]];
+    }
+    
+    if ([retrievedShowIDs count] == 0) return;
+    
+    LRTVDBSQLiteDatabase *database = [self database];
+    
+    // Serialized with the saves, which read the flag in the database queue.
+    [database performBlockAsynchronously:^{
+        
+        BOOL success = [database open] && [database performTransaction:^BOOL{
+            
+            for (NSString *showID in retrievedShowIDs)
+            {
+                if (![database executeSQL:@"UPDATE shows SET imported = 0 WHERE show_id = ?" arguments:@[showID] rowBlock:nil]) return NO;
+            }
+            
+            return YES;
+        }];
+        
+        if (!success) NSLog(@"Unable to mark imported shows as retrieved: %@", database.lastError);
+    }];
+}
+
+/**
+ @param SQL Statement selecting the ID and the info of shows, and optionally
+ whether they're imported.
+ @return Entries of the selected shows. nil if the database can't be read.
+ */
+- (NSArray *)showEntriesWithSQL:(NSString *)SQL arguments:(NSArray *)arguments error:(__autoreleasing NSError **)error
+{
+    LRTVDBSQLiteDatabase *database = [self database];
+    
+    NSMutableArray *entries = [NSMutableArray array];
+    
+    __block BOOL success = NO;
+    __block NSError *readError = nil;
+    
+    [database performBlock:^{
+        
+        success = [database open] && [database executeSQL:SQL arguments:arguments rowBlock:^(sqlite3_stmt *statement) {
+            
+            NSString *showID = LRTVDBColumnString(statement, 0);
+            NSData *info = LRTVDBColumnData(statement, 1);
+            
+            if (!showID || !info) return;
+            
+            BOOL imported = sqlite3_column_count(statement) > 2 && sqlite3_column_int(statement, 2);
+            
+            [entries addObject:@{ kSQLiteEntryShowIDKey: showID, kSQLiteEntryInfoKey: info, kSQLiteEntryImportedKey: @(imported) }];
+        }];
+        
+        if (!success) readError = database.lastError;
+    }];
+    
+    if (error) *error = readError;
+    
+    return success ? [entries copy] : nil;
+}
+
+- (NSSet *)storedShowIDsWithError:(__autoreleasing NSError **)error
+{
+    LRTVDBSQLiteDatabase *database = [self database];
+    
+    NSMutableSet *showIDs = [NSMutableSet set];
+    
+    __block BOOL success = NO;
+    __block NSError *readError = nil;
+    
+    [database performBlock:^{
+        
+        success = [database open] && [database executeSQL:@"SELECT show_id FROM shows" arguments:nil rowBlock:^(sqlite3_stmt *statement) {
+            [showIDs addObject:LRTVDBColumnString(statement, 0)];
+        }];
+        
+        if (!success) readError = database.lastError;
+    }];
+    
+    if (error) *error = readError;
+    
+    return success ? [showIDs copy] : nil;
+}
+
+/**
+ @return IDs of the stored shows added through the journal which haven't
+ been retrieved yet, in order. nil if the database can't be read.
+ */
+- (NSArray *)importedShowIDsWithError:(__autoreleasing NSError **)error
+{
+    LRTVDBSQLiteDatabase *database = [self database];
+    
+    NSMutableArray *showIDs = [NSMutableArray array];
+    
+    __block BOOL success = NO;
+    __block NSError *readError = nil;
+    
+    [database performBlock:^{
+        
+        success = [database open] && [database executeSQL:@"SELECT show_id FROM shows WHERE imported = 1 ORDER BY position" arguments:nil rowBlock:^(sqlite3_stmt *statement) {
+            [showIDs addObject:LRTVDBColumnString(statement, 0)];
+        }];
+        
+        if (!success) readError = database.lastError;
+    }];
+    
+    if (error) *error = readError;
+    
+    return success ? [showIDs copy] : nil;
+}
+
+- (LRTVDBShowDecodingBlock)storedShowDecodingBlock
+{
+    LRTVDBSQLiteDatabase *database = [self database];
+    
+    return ^LRTVDBShow *(NSDictionary *entry) {
+        
+        // Only the info is decoded now, episodes, images and actors are
+        // decoded on first access.
+        NSDictionary *serializedShow = LRTVDBDictionaryFromPropertyListData(entry[kSQLiteEntryInfoKey]);
+        
+        if (!serializedShow) return nil;
+        
+        NSError *error = nil;
+        
+        LRTVDBShow *show = [LRTVDBShow deserialize:serializedShow error:&error];
+        
+        if (show)
+        {
+            [show setRelationshipsFaultWithProvider:[[LRTVDBSQLiteRelationshipsProvider alloc] initWithDatabase:database]];
+            
+            // Just as it is on disk.
+            [show takeDirtySections];
+        }
+        
+        return show;
+    };
+}
+
+#pragma mark - Relationships eviction
+
+- (NSDictionary *)relationshipsProvidersForShows:(NSArray *)shows
+{
+    NSSet *storedShowIDs = [self storedShowIDsWithError:NULL];
+    NSMutableDictionary *providers = [NSMutableDictionary dictionaryWithCapacity:[shows count]];
+    
+    // Providers read by show ID, one is enough for every show.
+    LRTVDBSQLiteRelationshipsProvider *provider = [[LRTVDBSQLiteRelationshipsProvider alloc] initWithDatabase:[self database]];
+    
+    for (LRTVDBShow *show in shows)
+    {
+        if ([storedShowIDs containsObject:show.showID]) providers[show.showID] = provider;
+    }
+    
+    return providers;
+}
+
+#pragma mark - Queries
+
+- (NSArray *)episodeRowsAiredFromDate:(NSDate *)fromDate
+                               toDate:(NSDate *)toDate
+                                error:(__autoreleasing NSError **)error
+{
+    return [self episodeRowsWhere:@"aired_day BETWEEN ? AND ? ORDER BY aired_day, show_id, season_number, episode_number"
+                        arguments:@[@([fromDate lr_dayNumber]), @([toDate lr_dayNumber])]
+                    includingData:NO
+                            error:error];
+}
+
+- (NSArray *)episodesAiredFromDate:(NSDate *)fromDate
+                            toDate:(NSDate *)toDate
+                             error:(__autoreleasing NSError **)error
+{
+    NSArray *rows = [self episodeRowsWhere:@"aired_day BETWEEN ? AND ? ORDER BY aired_day, show_id, season_number, episode_number"
+                                 arguments:@[@([fromDate lr_dayNumber]), @([toDate lr_dayNumber])]
+                             includingData:YES
+                                     error:error];
+    
+    return [self episodesFromRows:rows];
+}
+
+- (NSArray *)episodeRowsOfShowWithID:(NSString *)showID
+                        seasonNumber:(NSInteger)seasonNumber
+                               error:(__autoreleasing NSError **)error
+{
+    return [self episodeRowsWhere:@"show_id = ? AND season_number = ? ORDER BY episode_number"
+                        arguments:@[showID ? : [NSNull null], @(seasonNumber)]
+                    includingData:NO
+                            error:error];
+}
+
+- (NSArray *)episodesOfShowWithID:(NSString *)showID
+                     seasonNumber:(NSInteger)seasonNumber
+                            error:(__autoreleasing NSError **)error
+{
+    NSArray *rows = [self episodeRowsWhere:@"show_id = ? AND season_number = ? ORDER BY episode_number"
+                                 arguments:@[showID ? : [NSNull null], @(seasonNumber)]
+                             includingData:YES
+                                     error:error];
+    
+    return [self episodesFromRows:rows];
+}
+
+- (NSArray *)showsWithUnseenEpisodesWithError:(__autoreleasing NSError **)error
+{
+    NSString *SQL = @"SELECT show_id, info FROM shows WHERE show_id IN "
+                    @"(SELECT show_id FROM episodes WHERE seen = 0 AND aired_day <= ? AND season_number > 0) "
+                    @"ORDER BY position";
+    
+    NSArray *entries = [self showEntriesWithSQL:SQL arguments:@[@(LRTVDBTodayDayNumber())] error:error];
+    
+    if (!entries) return nil;
+    
+    LRTVDBShowDecodingBlock decodingBlock = [self storedShowDecodingBlock];
+    NSMutableArray *shows = [NSMutableArray arrayWithCapacity:[entries count]];
+    
+    for (NSDictionary *entry in entries)
+    {
+        LRTVDBShow *show = decodingBlock(entry);
+        
+        if (show) [shows addObject:show];
+    }
+    
+    return [shows copy];
+}
+
+/**
+ @param condition Where clause (and order) of the query.
+ @param includeData YES to read the serialized episodes too.
+ */
+- (NSArray *)episodeRowsWhere:(NSString *)condition
+                    arguments:(NSArray *)arguments
+                includingData:(BOOL)includeData
+                        error:(__autoreleasing NSError **)error
+{
+    NSString *SQL = [NSString stringWithFormat:@"SELECT %@%@ FROM episodes WHERE %@",
+                     kLRTVDBSQLiteEpisodeRowColumns, includeData ? @", data" : @"", condition];
+    
+    LRTVDBSQLiteDatabase *database = [self database];
+    
+    NSMutableArray *rows = [NSMutableArray array];
+    
+    __block BOOL success = NO;
+    __block NSError *readError = nil;
+    
+    [database performBlock:^{
+        
+        success = [database open] && [database executeSQL:SQL arguments:arguments rowBlock:^(sqlite3_stmt *statement) {
+            [rows addObject:[LRTVDBEpisodeRow rowWithStatement:statement]];
+        }];
+        
+        if (!success) readError = database.lastError;
+    }];
+    
+    if (error) *error = readError;
+    
+    return success ? [rows copy] : nil;
+}
+
+- (NSArray *)episodesFromRows:(NSArray *)rows
+{
+    if (!rows) return nil;
+    
+    NSMutableArray *episodes = [NSMutableArray arrayWithCapacity:[rows count]];
+    
+    for (LRTVDBEpisodeRow *row in rows)
+    {
+        NSError *error = nil;
+        
+        LRTVDBEpisode *episode = [LRTVDBEpisode deserialize:LRTVDBDictionaryFromPropertyListData(row.data)
+                                                     showID:row.showID
+                                                      error:&error];
+        
+        if (episode) [episodes addObject:episode];
+    }
+    
+    return [episodes copy];
+}
+
+@end
@@ -0,0 +1,128 @@
+// LRTVDBBinaryCodec.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "NSDate+LRTVDBAdditions.h"
+
+static NSString *const kBinaryCodecErrorDomain = @"kBinaryCodecErrorDomain";
+
+typedef NS_ENUM (NSUInteger, BinaryCodecError)
+{
+    kBinaryCodecBadHeaderError,
+    kBinaryCodecMalformedDataError,
+    kBinaryCodecBadTypeError,
+    kBinaryCodecBadStringError,
+};
+
+/**
+ Identifies a field inside a record. Tags are positive and, once used by a
+ model, must never be reused for a different field.
+ */
+typedef uint32_t LRTVDBBinaryTag;
+
+/**
+ Encodes model objects in a compact tagged binary format.
+ 
+ @discussion The encoded data starts with a header (magic number and format
+ version) followed by a table with every distinct string, each of them
+ stored once, and the records of the root objects. Each record starts with
+ the schema version of its model and is a list of (tag, value) fields ended
+ by a zero tag. Integers are stored as varints, dates as day numbers and
+ strings as indexes in the string table. Every field carries its wire type,
+ so decoders can skip the fields they don't know about.
+ 
+ Nil values, unknown day numbers and NAN doubles are not encoded at all.
+ @remarks Not thread safe.
+ */
+@interface LRTVDBBinaryEncoder : NSObject
+
+/**
+ @return The encoded data of the provided model objects.
+ */
++ (NSData *)encodedDataWithRootObjects:(NSArray *)objects;
+
+- (void)encodeInteger:(int64_t)value forTag:(LRTVDBBinaryTag)tag;
+- (void)encodeUnsignedInteger:(uint64_t)value forTag:(LRTVDBBinaryTag)tag;
+- (void)encodeBool:(BOOL)value forTag:(LRTVDBBinaryTag)tag;
+- (void)encodeDouble:(double)value forTag:(LRTVDBBinaryTag)tag;
+- (void)encodeDayNumber:(LRTVDBDayNumber)dayNumber forTag:(LRTVDBBinaryTag)tag;
+- (void)encodeDate:(NSDate *)date forTag:(LRTVDBBinaryTag)tag;
+- (void)encodeString:(NSString *)string forTag:(LRTVDBBinaryTag)tag;
+
+/**
+ @param strings Array of NSString objects.
+ */
+- (void)encodeStrings:(NSArray *)strings forTag:(LRTVDBBinaryTag)tag;
+
+/**
+ Encodes a list of nested records.
+ @param objects Array of objects conforming to LRTVDBSerializableModelProtocol.
+ */
+- (void)encodeObjects:(NSArray *)objects forTag:(LRTVDBBinaryTag)tag;
+
+@end
+
+/**
+ Decodes the data generated by LRTVDBBinaryEncoder.
+ 
+ @discussion Models read the fields of their record in a loop, calling
+ decodeNextFieldTag: and then the decoding method matching the tag. Fields
+ with unknown tags must be skipped with skipField. Reading a field with the
+ wrong decoding method or finding truncated data sets the error property,
+ and every decoding method returns zero or nil from then on.
+ @remarks Not thread safe.
+ */
+@interface LRTVDBBinaryDecoder : NSObject
+
+/**
+ @return The root objects of the encoded data, nil if it's not valid.
+ @remarks Records whose model returns nil are skipped.
+ */
++ (NSArray *)decodedRootObjectsOfClass:(Class)objectClass data:(NSData *)data error:(__autoreleasing NSError **)error;
+
+/** Schema version the current record was encoded with. */
+@property (nonatomic, readonly) NSUInteger recordSchemaVersion;
+
+@property (nonatomic, strong, readonly) NSError *error;
+
+/**
+ Moves to the next field of the current record.
+ @return NO once every field of the record has been read.
+ */
+- (BOOL)decodeNextFieldTag:(LRTVDBBinaryTag *)tag;
+
+- (int64_t)decodeInteger;
+- (uint64_t)decodeUnsignedInteger;
+- (BOOL)decodeBool;
+- (double)decodeDouble;
+- (LRTVDBDayNumber)decodeDayNumber;
+- (NSDate *)decodeDate;
+- (NSString *)decodeString;
+- (NSArray *)decodeStrings;
+- (NSArray *)decodeObjectsOfClass:(Class)objectClass;
+
+/**
+ Skips the value of the current field.
+ */
+- (void)skipField;
+
+@end
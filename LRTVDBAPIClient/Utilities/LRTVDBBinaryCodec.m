@@ -0,0 +1,562 @@
+// LRTVDBBinaryCodec.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBBinaryCodec.h"
+#import "LRTVDBSerializableModelProtocol.h"
+
+static const uint8_t kLRTVDBBinaryMagic[4] = { 'L', 'R', 'T', 'B' };
+static const uint64_t kLRTVDBBinaryFormatVersion = 1;
+
+typedef NS_ENUM(uint8_t, LRTVDBWireType)
+{
+    LRTVDBWireTypeVarint = 0,   /** Zigzag or plain varint. */
+    LRTVDBWireTypeFixed64 = 1,  /** Little endian double. */
+    LRTVDBWireTypeString = 2,   /** Varint index in the string table. */
+    LRTVDBWireTypeStrings = 3,  /** Varint count followed by the string indexes. */
+    LRTVDBWireTypeRecords = 4,  /** Varint count followed by the records. */
+};
+
+static const NSUInteger kLRTVDBWireTypeBits = 3;
+static const uint64_t kLRTVDBWireTypeMask = (1 << kLRTVDBWireTypeBits) - 1;
+
+/** Tag closing every record. */
+static const uint64_t kLRTVDBEndOfRecordKey = 0;
+
+NS_INLINE uint64_t LRTVDBZigZagEncode(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+NS_INLINE int64_t LRTVDBZigZagDecode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static void LRTVDBAppendVarint(NSMutableData *data, uint64_t value)
+{
+    uint8_t buffer[10];
+    NSUInteger length = 0;
+    
+    while (value >= 0x80)
+    {
+        buffer[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    
+    buffer[length++] = (uint8_t)value;
+    
+    [data appendBytes:buffer length:length];
+}
+
+#pragma mark - LRTVDBBinaryEncoder
+
+@implementation LRTVDBBinaryEncoder
+{
+    NSMutableData *_body;
+    NSMutableArray *_strings;
+    NSMutableDictionary *_stringIndexes;
+}
+
++ (NSData *)encodedDataWithRootObjects:(NSArray *)objects
+{
+    LRTVDBBinaryEncoder *encoder = [[self alloc] init];
+    
+    [encoder appendRecords:objects];
+    
+    return [encoder encodedData];
+}
+
+- (id)init
+{
+    if (self = [super init])
+    {
+        _body = [NSMutableData data];
+        _strings = [NSMutableArray array];
+        _stringIndexes = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSData *)encodedData
+{
+    NSMutableData *data = [NSMutableData dataWithCapacity:[_body length] + 32 * [_strings count]];
+    
+    [data appendBytes:kLRTVDBBinaryMagic length:sizeof(kLRTVDBBinaryMagic)];
+    LRTVDBAppendVarint(data, kLRTVDBBinaryFormatVersion);
+    LRTVDBAppendVarint(data, [_strings count]);
+    
+    for (NSString *string in _strings)
+    {
+        NSData *stringData = [string dataUsingEncoding:NSUTF8StringEncoding];
+        
+        LRTVDBAppendVarint(data, [stringData length]);
+        [data appendData:stringData];
+    }
+    
+    [data appendData:_body];
+    
+    return [data copy];
+}
+
+- (void)encodeInteger:(int64_t)value forTag:(LRTVDBBinaryTag)tag
+{
+    [self appendKeyWithTag:tag wireType:LRTVDBWireTypeVarint];
+    LRTVDBAppendVarint(_body, LRTVDBZigZagEncode(value));
+}
+
+- (void)encodeUnsignedInteger:(uint64_t)value forTag:(LRTVDBBinaryTag)tag
+{
+    [self appendKeyWithTag:tag wireType:LRTVDBWireTypeVarint];
+    LRTVDBAppendVarint(_body, value);
+}
+
+- (void)encodeBool:(BOOL)value forTag:(LRTVDBBinaryTag)tag
+{
+    [self encodeUnsignedInteger:value ? 1 : 0 forTag:tag];
+}
+
+- (void)encodeDouble:(double)value forTag:(LRTVDBBinaryTag)tag
+{
+    if (isnan(value)) return;
+    
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = CFSwapInt64HostToLittle(bits);
+    
+    [self appendKeyWithTag:tag wireType:LRTVDBWireTypeFixed64];
+    [_body appendBytes:&bits length:sizeof(bits)];
+}
+
+- (void)encodeDayNumber:(LRTVDBDayNumber)dayNumber forTag:(LRTVDBBinaryTag)tag
+{
+    if (dayNumber == LRTVDBUnknownDayNumber) return;
+    
+    [self encodeInteger:dayNumber forTag:tag];
+}
+
+- (void)encodeDate:(NSDate *)date forTag:(LRTVDBBinaryTag)tag
+{
+    if (!date) return;
+    
+    [self encodeDayNumber:[date lr_dayNumber] forTag:tag];
+}
+
+- (void)encodeString:(NSString *)string forTag:(LRTVDBBinaryTag)tag
+{
+    if (!string) return;
+    
+    [self appendKeyWithTag:tag wireType:LRTVDBWireTypeString];
+    LRTVDBAppendVarint(_body, [self indexOfString:string]);
+}
+
+- (void)encodeStrings:(NSArray *)strings forTag:(LRTVDBBinaryTag)tag
+{
+    if (!strings) return;
+    
+    [self appendKeyWithTag:tag wireType:LRTVDBWireTypeStrings];
+    LRTVDBAppendVarint(_body, [strings count]);
+    
+    for (NSString *string in strings)
+    {
+        LRTVDBAppendVarint(_body, [self indexOfString:string]);
+    }
+}
+
+- (void)encodeObjects:(NSArray *)objects forTag:(LRTVDBBinaryTag)tag
+{
+    if (!objects) return;
+    
+    [self appendKeyWithTag:tag wireType:LRTVDBWireTypeRecords];
+    [self appendRecords:objects];
+}
+
+#pragma mark - Private
+
+- (void)appendKeyWithTag:(LRTVDBBinaryTag)tag wireType:(LRTVDBWireType)wireType
+{
+    NSAssert(tag > 0, @"Tag 0 is reserved for the end of the records");
+    
+    LRTVDBAppendVarint(_body, ((uint64_t)tag << kLRTVDBWireTypeBits) | wireType);
+}
+
+- (void)appendRecords:(NSArray *)objects
+{
+    LRTVDBAppendVarint(_body, [objects count]);
+    
+    for (id<LRTVDBSerializableModelProtocol> object in objects)
+    {
+        LRTVDBAppendVarint(_body, [[object class] binarySchemaVersion]);
+        [object encodeWithEncoder:self];
+        LRTVDBAppendVarint(_body, kLRTVDBEndOfRecordKey);
+    }
+}
+
+- (NSUInteger)indexOfString:(NSString *)string
+{
+    NSNumber *index = _stringIndexes[string];
+    
+    if (!index)
+    {
+        index = @([_strings count]);
+        [_strings addObject:string];
+        _stringIndexes[string] = index;
+    }
+    
+    return [index unsignedIntegerValue];
+}
+
+@end
+
+#pragma mark - LRTVDBBinaryDecoder
+
+@interface LRTVDBBinaryDecoder ()
+
+@property (nonatomic) NSUInteger recordSchemaVersion;
+@property (nonatomic, strong) NSError *error;
+
+@end
+
+@implementation LRTVDBBinaryDecoder
+{
+    NSData *_data;
+    const uint8_t *_bytes;
+    NSUInteger _length;
+    NSUInteger _position;
+    NSArray *_strings;
+    LRTVDBWireType _fieldWireType;
+    BOOL _atEndOfRecord;
+}
+
++ (NSArray *)decodedRootObjectsOfClass:(Class)objectClass data:(NSData *)data error:(__autoreleasing NSError **)error
+{
+    LRTVDBBinaryDecoder *decoder = [[self alloc] initWithData:data];
+    
+    NSArray *objects = [decoder readRecordsOfClass:objectClass];
+    
+    if (decoder.error)
+    {
+        NSLog(@"Unable to decode binary data: %@", decoder.error);
+        
+        if (error) *error = decoder.error;
+        
+        return nil;
+    }
+    
+    return objects;
+}
+
+- (id)initWithData:(NSData *)data
+{
+    if (self = [super init])
+    {
+        _data = data;
+        _bytes = [data bytes];
+        _length = [data length];
+        
+        [self readHeader];
+    }
+    return self;
+}
+
+- (BOOL)decodeNextFieldTag:(LRTVDBBinaryTag *)tag
+{
+    if (_error || _atEndOfRecord) return NO;
+    
+    uint64_t key = [self readVarint];
+    
+    if (key == kLRTVDBEndOfRecordKey || _error)
+    {
+        _atEndOfRecord = YES;
+        return NO;
+    }
+    
+    _fieldWireType = (LRTVDBWireType)(key & kLRTVDBWireTypeMask);
+    *tag = (LRTVDBBinaryTag)(key >> kLRTVDBWireTypeBits);
+    
+    return YES;
+}
+
+- (int64_t)decodeInteger
+{
+    return [self expectWireType:LRTVDBWireTypeVarint] ? LRTVDBZigZagDecode([self readVarint]) : 0;
+}
+
+- (uint64_t)decodeUnsignedInteger
+{
+    return [self expectWireType:LRTVDBWireTypeVarint] ? [self readVarint] : 0;
+}
+
+- (BOOL)decodeBool
+{
+    return [self decodeUnsignedInteger] != 0;
+}
+
+- (double)decodeDouble
+{
+    if (![self expectWireType:LRTVDBWireTypeFixed64] || ![self canReadLength:sizeof(uint64_t)]) return NAN;
+    
+    uint64_t bits;
+    memcpy(&bits, _bytes + _position, sizeof(bits));
+    bits = CFSwapInt64LittleToHost(bits);
+    _position += sizeof(bits);
+    
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    
+    return value;
+}
+
+- (LRTVDBDayNumber)decodeDayNumber
+{
+    return [self expectWireType:LRTVDBWireTypeVarint] ? (LRTVDBDayNumber)LRTVDBZigZagDecode([self readVarint]) : LRTVDBUnknownDayNumber;
+}
+
+- (NSDate *)decodeDate
+{
+    return [NSDate lr_dateWithDayNumber:[self decodeDayNumber]];
+}
+
+- (NSString *)decodeString
+{
+    return [self expectWireType:LRTVDBWireTypeString] ? [self readString] : nil;
+}
+
+- (NSArray *)decodeStrings
+{
+    if (![self expectWireType:LRTVDBWireTypeStrings]) return nil;
+    
+    NSUInteger count = [self readCount];
+    NSMutableArray *strings = [NSMutableArray arrayWithCapacity:count];
+    
+    for (NSUInteger i = 0; i < count && !_error; i++)
+    {
+        NSString *string = [self readString];
+        
+        if (string) [strings addObject:string];
+    }
+    
+    return _error ? nil : [strings copy];
+}
+
+- (NSArray *)decodeObjectsOfClass:(Class)objectClass
+{
+    return [self expectWireType:LRTVDBWireTypeRecords] ? [self readRecordsOfClass:objectClass] : nil;
+}
+
+- (void)skipField
+{
+    if (_error) return;
+    
+    switch (_fieldWireType)
+    {
+        case LRTVDBWireTypeVarint:
+        case LRTVDBWireTypeString:
+            [self readVarint];
+            break;
+        case LRTVDBWireTypeFixed64:
+            if ([self canReadLength:sizeof(uint64_t)]) _position += sizeof(uint64_t);
+            break;
+        case LRTVDBWireTypeStrings:
+        {
+            NSUInteger count = [self readCount];
+            
+            for (NSUInteger i = 0; i < count && !_error; i++)
+            {
+                [self readVarint];
+            }
+            break;
+        }
+        case LRTVDBWireTypeRecords:
+            [self readRecordsOfClass:Nil];
+            break;
+        default:
+            [self failWithCode:kBinaryCodecBadTypeError];
+            break;
+    }
+}
+
+#pragma mark - Private
+
+- (void)failWithCode:(BinaryCodecError)code
+{
+    if (!_error)
+    {
+        self.error = [NSError errorWithDomain:kBinaryCodecErrorDomain code:code userInfo:nil];
+    }
+    
+    // Nothing else is read from now on.
+    _position = _length;
+}
+
+- (BOOL)canReadLength:(NSUInteger)length
+{
+    if (_length - _position < length)
+    {
+        [self failWithCode:kBinaryCodecMalformedDataError];
+        return NO;
+    }
+    
+    return YES;
+}
+
+- (BOOL)expectWireType:(LRTVDBWireType)wireType
+{
+    if (_error) return NO;
+    
+    if (_fieldWireType != wireType)
+    {
+        [self failWithCode:kBinaryCodecBadTypeError];
+        return NO;
+    }
+    
+    return YES;
+}
+
+- (uint64_t)readVarint
+{
+    uint64_t value = 0;
+    
+    for (NSUInteger shift = 0; shift < 64 && _position < _length; shift += 7)
+    {
+        uint8_t byte = _bytes[_position++];
+        
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        
+        if ((byte & 0x80) == 0) return value;
+    }
+    
+    [self failWithCode:kBinaryCodecMalformedDataError];
+    
+    return 0;
+}
+
+/**
+ Reads the number of elements of a list. Every element takes at least one
+ byte, so bigger counts can only come from malformed data.
+ */
+- (NSUInteger)readCount
+{
+    uint64_t count = [self readVarint];
+    
+    if (count > _length - _position)
+    {
+        [self failWithCode:kBinaryCodecMalformedDataError];
+        return 0;
+    }
+    
+    return (NSUInteger)count;
+}
+
+- (NSString *)readString
+{
+    uint64_t index = [self readVarint];
+    
+    if (_error) return nil;
+    
+    if (index >= [_strings count])
+    {
+        [self failWithCode:kBinaryCodecBadStringError];
+        return nil;
+    }
+    
+    return _strings[(NSUInteger)index];
+}
+
+- (void)readHeader
+{
+    if (_length < sizeof(kLRTVDBBinaryMagic) || memcmp(_bytes, kLRTVDBBinaryMagic, sizeof(kLRTVDBBinaryMagic)) != 0)
+    {
+        [self failWithCode:kBinaryCodecBadHeaderError];
+        return;
+    }
+    
+    _position = sizeof(kLRTVDBBinaryMagic);
+    
+    if ([self readVarint] != kLRTVDBBinaryFormatVersion)
+    {
+        [self failWithCode:kBinaryCodecBadHeaderError];
+        return;
+    }
+    
+    NSUInteger count = [self readCount];
+    NSMutableArray *strings = [NSMutableArray arrayWithCapacity:count];
+    
+    for (NSUInteger i = 0; i < count && !_error; i++)
+    {
+        NSUInteger length = (NSUInteger)[self readVarint];
+        
+        if (![self canReadLength:length]) break;
+        
+        NSString *string = [[NSString alloc] initWithBytes:_bytes + _position length:length encoding:NSUTF8StringEncoding];
+        
+        if (!string)
+        {
+            [self failWithCode:kBinaryCodecBadStringError];
+            break;
+        }
+        
+        [strings addObject:string];
+        _position += length;
+    }
+    
+    _strings = [strings copy];
+}
+
+/**
+ Reads a list of records. Records are skipped if objectClass is Nil.
+ */
+- (NSArray *)readRecordsOfClass:(Class)objectClass
+{
+    if (_error) return nil;
+    
+    NSUInteger count = [self readCount];
+    NSMutableArray *objects = objectClass ? [NSMutableArray arrayWithCapacity:count] : nil;
+    
+    // Records can be nested, the state of the enclosing one is restored afterwards.
+    NSUInteger enclosingSchemaVersion = _recordSchemaVersion;
+    BOOL enclosingAtEndOfRecord = _atEndOfRecord;
+    
+    for (NSUInteger i = 0; i < count && !_error; i++)
+    {
+        _recordSchemaVersion = (NSUInteger)[self readVarint];
+        _atEndOfRecord = NO;
+        
+        id object = [objectClass decodeWithDecoder:self];
+        
+        // Fields the model didn't read, if any.
+        LRTVDBBinaryTag tag;
+        
+        while ([self decodeNextFieldTag:&tag])
+        {
+            [self skipField];
+        }
+        
+        if (object && !_error) [objects addObject:object];
+    }
+    
+    _recordSchemaVersion = enclosingSchemaVersion;
+    _atEndOfRecord = enclosingAtEndOfRecord;
+    
+    return _error ? nil : [objects copy];
+}
+
+@end
@@ -0,0 +1,66 @@
+// LRTVDBBitSet.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ Fixed size set of indexes backed by 64 bit words.
+ @discussion Adding, removing and checking an index is O(1) and the number of
+ indexes is kept up to date. Queries involving two bit sets work a word at a time.
+ @remarks Not thread safe.
+ */
+@interface LRTVDBBitSet : NSObject
+
+/**
+ @param numberOfBits Size of the set. Valid indexes go from 0 to numberOfBits - 1.
+ */
+- (id)initWithNumberOfBits:(NSUInteger)numberOfBits;
+
+@property (nonatomic, readonly) NSUInteger numberOfBits;
+
+/** Number of indexes in the set. */
+@property (nonatomic, readonly) NSUInteger count;
+
+- (BOOL)containsIndex:(NSUInteger)index;
+
+/**
+ @return YES if the index was not in the set.
+ */
+- (BOOL)addIndex:(NSUInteger)index;
+
+/**
+ @return YES if the index was in the set.
+ */
+- (BOOL)removeIndex:(NSUInteger)index;
+
+/**
+ @return The first index of the receiver which is not in the provided bit set,
+ NSNotFound if none.
+ */
+- (NSUInteger)firstIndexNotContainedInBitSet:(LRTVDBBitSet *)bitSet;
+
+/**
+ @return The number of indexes of the receiver in the provided range.
+ */
+- (NSUInteger)countOfIndexesInRange:(NSRange)range;
+
+@end
@@ -0,0 +1,141 @@
+// LRTVDBBitSet.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBBitSet.h"
+
+typedef uint64_t LRTVDBBitSetWord;
+
+static const NSUInteger kLRTVDBBitSetWordBits = 64;
+
+NS_INLINE NSUInteger LRTVDBBitSetNumberOfWords(NSUInteger numberOfBits)
+{
+    return (numberOfBits + kLRTVDBBitSetWordBits - 1) / kLRTVDBBitSetWordBits;
+}
+
+NS_INLINE LRTVDBBitSetWord LRTVDBBitSetMask(NSUInteger index)
+{
+    return (LRTVDBBitSetWord)1 << (index % kLRTVDBBitSetWordBits);
+}
+
+@interface LRTVDBBitSet ()
+{
+    LRTVDBBitSetWord *_words;
+}
+
+@property (nonatomic) NSUInteger numberOfBits;
+@property (nonatomic) NSUInteger count;
+
+@end
+
+@implementation LRTVDBBitSet
+
+- (id)initWithNumberOfBits:(NSUInteger)numberOfBits
+{
+    if (self = [super init])
+    {
+        _numberOfBits = numberOfBits;
+        _words = calloc(MAX(LRTVDBBitSetNumberOfWords(numberOfBits), 1), sizeof(LRTVDBBitSetWord));
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_words);
+}
+
+- (BOOL)containsIndex:(NSUInteger)index
+{
+    if (index >= _numberOfBits) return NO;
+    
+    return (_words[index / kLRTVDBBitSetWordBits] & LRTVDBBitSetMask(index)) != 0;
+}
+
+- (BOOL)addIndex:(NSUInteger)index
+{
+    if (index >= _numberOfBits || [self containsIndex:index]) return NO;
+    
+    _words[index / kLRTVDBBitSetWordBits] |= LRTVDBBitSetMask(index);
+    _count++;
+    
+    return YES;
+}
+
+- (BOOL)removeIndex:(NSUInteger)index
+{
+    if (![self containsIndex:index]) return NO;
+    
+    _words[index / kLRTVDBBitSetWordBits] &= ~LRTVDBBitSetMask(index);
+    _count--;
+    
+    return YES;
+}
+
+- (NSUInteger)firstIndexNotContainedInBitSet:(LRTVDBBitSet *)bitSet
+{
+    NSUInteger numberOfWords = LRTVDBBitSetNumberOfWords(_numberOfBits);
+    NSUInteger numberOfOtherWords = bitSet ? LRTVDBBitSetNumberOfWords(bitSet->_numberOfBits) : 0;
+    
+    for (NSUInteger i = 0; i < numberOfWords; i++)
+    {
+        LRTVDBBitSetWord word = _words[i] & ~(i < numberOfOtherWords ? bitSet->_words[i] : 0);
+        
+        if (word != 0)
+        {
+            return i * kLRTVDBBitSetWordBits + __builtin_ctzll(word);
+        }
+    }
+    
+    return NSNotFound;
+}
+
+- (NSUInteger)countOfIndexesInRange:(NSRange)range
+{
+    NSUInteger end = MIN(NSMaxRange(range), _numberOfBits);
+    NSUInteger count = 0;
+    
+    for (NSUInteger index = range.location; index < end; )
+    {
+        NSUInteger wordIndex = index / kLRTVDBBitSetWordBits;
+        NSUInteger wordEnd = MIN((wordIndex + 1) * kLRTVDBBitSetWordBits, end);
+        LRTVDBBitSetWord word = _words[wordIndex] >> (index % kLRTVDBBitSetWordBits);
+        NSUInteger numberOfBits = wordEnd - index;
+        
+        if (numberOfBits < kLRTVDBBitSetWordBits)
+        {
+            word &= ((LRTVDBBitSetWord)1 << numberOfBits) - 1;
+        }
+        
+        count += __builtin_popcountll(word);
+        index = wordEnd;
+    }
+    
+    return count;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"Bits: %lu\nCount: %lu\n",
+            (unsigned long)self.numberOfBits, (unsigned long)self.count];
+}
+
+@end
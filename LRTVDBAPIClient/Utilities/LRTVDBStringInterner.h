@@ -0,0 +1,79 @@
+// LRTVDBStringInterner.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ Table of unique immutable strings.
+ @discussion Episodes and shows repeat plenty of values (language, show ID,
+ directors, writers, network, genres...). Parsers and deserialization use
+ the interner so that equal values share one single instance in memory.
+ The table is bounded by maximumNumberOfStrings and the shared interner is
+ purged on memory warnings, so it never grows beyond what parsing needs.
+ @remarks Thread safe.
+ */
+@interface LRTVDBStringInterner : NSObject
+
+/**
+ Shared interner used by parsers and deserialization.
+ */
++ (instancetype)sharedInterner;
+
+/**
+ @return The unique instance equal to the provided string, nil if the string is nil.
+ */
+- (NSString *)internString:(NSString *)string;
+
+/**
+ @return A new array with every string interned, nil if the array is nil.
+ Objects which are not strings are kept as they are.
+ */
+- (NSArray *)internStringsInArray:(NSArray *)strings;
+
+/**
+ Removes every string from the table. Previously interned strings are
+ still valid, they just won't be shared with new ones.
+ */
+- (void)removeAllStrings;
+
+/**
+ Maximum number of unique strings in the table. When reached, the table
+ is purged and starts over. Defaults to 8192.
+ */
+@property (nonatomic) NSUInteger maximumNumberOfStrings;
+
+/** Number of unique strings in the table. */
+@property (nonatomic, readonly) NSUInteger numberOfStrings;
+
+/** Number of calls to internString:. */
+@property (nonatomic, readonly) NSUInteger numberOfLookups;
+
+/** Number of lookups that returned an already interned string. */
+@property (nonatomic, readonly) NSUInteger numberOfHits;
+
+/**
+ Approximate number of bytes saved, i.e., heap size of the duplicated
+ strings that were released in favor of the interned ones.
+ */
+@property (nonatomic, readonly) unsigned long long bytesSaved;
+
+@end
@@ -0,0 +1,193 @@
+// LRTVDBStringInterner.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBStringInterner.h"
+#import <libkern/OSAtomic.h>
+#import <malloc/malloc.h>
+#if TARGET_OS_IPHONE
+#import <UIKit/UIKit.h>
+#endif
+
+static const NSUInteger kDefaultMaximumNumberOfStrings = 8192;
+
+@interface LRTVDBStringInterner ()
+{
+    OSSpinLock _lock;
+    NSMutableSet *_strings;
+    NSUInteger _maximumNumberOfStrings;
+    NSUInteger _numberOfLookups;
+    NSUInteger _numberOfHits;
+    unsigned long long _bytesSaved;
+}
+
+@end
+
+@implementation LRTVDBStringInterner
+
++ (instancetype)sharedInterner
+{
+    static LRTVDBStringInterner *sharedInterner = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedInterner = [[self alloc] init];
+#if TARGET_OS_IPHONE
+        [[NSNotificationCenter defaultCenter] addObserver:sharedInterner
+                                                 selector:@selector(removeAllStrings)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+#endif
+    });
+    
+    return sharedInterner;
+}
+
+- (id)init
+{
+    if (self = [super init])
+    {
+        _lock = OS_SPINLOCK_INIT;
+        _strings = [NSMutableSet set];
+        _maximumNumberOfStrings = kDefaultMaximumNumberOfStrings;
+    }
+    return self;
+}
+
+- (NSString *)internString:(NSString *)string
+{
+    if (string == nil) return nil;
+    
+    OSSpinLockLock(&_lock);
+    
+    _numberOfLookups++;
+    
+    NSString *internedString = [_strings member:string];
+    
+    if (internedString)
+    {
+        _numberOfHits++;
+        
+        if (internedString != string)
+        {
+            _bytesSaved += malloc_size((__bridge const void *)string);
+        }
+    }
+    else
+    {
+        if ([_strings count] >= _maximumNumberOfStrings)
+        {
+            [_strings removeAllObjects];
+        }
+        
+        // Mutable strings can't be shared.
+        internedString = [string copy];
+        [_strings addObject:internedString];
+    }
+    
+    OSSpinLockUnlock(&_lock);
+    
+    return internedString;
+}
+
+- (NSArray *)internStringsInArray:(NSArray *)strings
+{
+    if (strings == nil) return nil;
+    
+    NSMutableArray *internedStrings = [NSMutableArray arrayWithCapacity:[strings count]];
+    
+    for (id object in strings)
+    {
+        [internedStrings addObject:[object isKindOfClass:[NSString class]] ? [self internString:object] : object];
+    }
+    
+    return [internedStrings copy];
+}
+
+- (void)removeAllStrings
+{
+    OSSpinLockLock(&_lock);
+    [_strings removeAllObjects];
+    OSSpinLockUnlock(&_lock);
+}
+
+#pragma mark - Statistics
+
+- (NSUInteger)maximumNumberOfStrings
+{
+    OSSpinLockLock(&_lock);
+    NSUInteger maximumNumberOfStrings = _maximumNumberOfStrings;
+    OSSpinLockUnlock(&_lock);
+    
+    return maximumNumberOfStrings;
+}
+
+- (void)setMaximumNumberOfStrings:(NSUInteger)maximumNumberOfStrings
+{
+    OSSpinLockLock(&_lock);
+    _maximumNumberOfStrings = MAX(maximumNumberOfStrings, 1);
+    if ([_strings count] > _maximumNumberOfStrings) [_strings removeAllObjects];
+    OSSpinLockUnlock(&_lock);
+}
+
+- (NSUInteger)numberOfStrings
+{
+    OSSpinLockLock(&_lock);
+    NSUInteger numberOfStrings = [_strings count];
+    OSSpinLockUnlock(&_lock);
+    
+    return numberOfStrings;
+}
+
+- (NSUInteger)numberOfLookups
+{
+    OSSpinLockLock(&_lock);
+    NSUInteger numberOfLookups = _numberOfLookups;
+    OSSpinLockUnlock(&_lock);
+    
+    return numberOfLookups;
+}
+
+- (NSUInteger)numberOfHits
+{
+    OSSpinLockLock(&_lock);
+    NSUInteger numberOfHits = _numberOfHits;
+    OSSpinLockUnlock(&_lock);
+    
+    return numberOfHits;
+}
+
+- (unsigned long long)bytesSaved
+{
+    OSSpinLockLock(&_lock);
+    unsigned long long bytesSaved = _bytesSaved;
+    OSSpinLockUnlock(&_lock);
+    
+    return bytesSaved;
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"Strings: %lu\nLookups: %lu\nHits: %lu\nBytes saved: %llu\n",
+            (unsigned long)self.numberOfStrings, (unsigned long)self.numberOfLookups,
+            (unsigned long)self.numberOfHits, self.bytesSaved];
+}
+
+@end
@@ -0,0 +1,44 @@
+// LRTVDBAPIClientBenchmarks.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <SenTestingKit/SenTestingKit.h>
+
+/**
+ Performance benchmarks. They are built in their own test target,
+ LRTVDBAPIClientBenchmarks, so the default test suite doesn't pay for them.
+ Results of every run are written to LRTVDBAPIClientBenchmarks.plist in the
+ temporary directory, keyed by benchmark name.
+ */
+@interface LRTVDBAPIClientBenchmarks : SenTestCase
+
+- (void)testDateParsingBenchmark;
+- (void)testLanguageDuplicatesRemovalBenchmark;
+- (void)testEpisodesMergeBenchmark;
+- (void)testStoreOpeningBenchmark;
+- (void)testBinaryCodecBenchmark;
+- (void)testSQLiteQueryBenchmark;
+- (void)testCompressedStoreBenchmark;
+- (void)testBulkImportBenchmark;
+- (void)testSnapshotReadContentionBenchmark;
+- (void)testShowsSortingBenchmark;
+
+@end
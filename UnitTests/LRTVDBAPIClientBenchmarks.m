@@ -0,0 +1,710 @@
+// LRTVDBAPIClientBenchmarks.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "LRTVDBAPIClientBenchmarks.h"
+#import "SenTestCase+LRTVDBFixtures.h"
+#import "LRTVDBShow.h"
+#import "LRTVDBShow+Private.h"
+#import "LRTVDBEpisode.h"
+#import "LRTVDBPersistenceManager.h"
+#import "LRTVDBSQLitePersistenceManager.h"
+#import "LRTVDBBulkImporter.h"
+#import "NSString+LRTVDBAdditions.h"
+#import "NSArray+LRTVDBAdditions.h"
+#import "NSDate+LRTVDBAdditions.h"
+#import "LRTVDBShowParser.h"
+#import "LRTVDBEpisodeParser.h"
+#import "LRTVDBParseContext.h"
+#import "LRTVDBBinaryCodec.h"
+#import <libkern/OSAtomic.h>
+
+static NSString *const kBenchmarksResultsFileName = @"LRTVDBAPIClientBenchmarks.plist";
+
+@implementation LRTVDBAPIClientBenchmarks
+
+- (void)testDateParsingBenchmark
+{
+    static const NSInteger kNumberOfDates = 50000;
+    
+    NSMutableArray *dateStrings = [NSMutableArray arrayWithCapacity:kNumberOfDates];
+    
+    for (NSInteger i = 0; i < kNumberOfDates; i++)
+    {
+        [dateStrings addObject:[NSString stringWithFormat:@"%04d-%02d-%02d",
+                                (int)(1950 + i % 80), (int)(1 + i % 12), (int)(1 + i % 28)]];
+    }
+    
+    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
+    [dateFormatter setDateFormat:@"yyyy-MM-dd"];
+    
+    for (NSString *dateString in [dateStrings subarrayWithRange:NSMakeRange(0, 1000)])
+    {
+        STAssertEqualObjects([dateString dateValue], [dateFormatter dateFromString:dateString],
+                             @"Parsed date must be the same as the date formatter one");
+    }
+    
+    STAssertNil([@"0000-00-00" dateValue], @"Invalid dates must be nil");
+    STAssertNil([@"2013-02-29" dateValue], @"Invalid dates must be nil");
+    STAssertNil([@"" dateValue], @"Invalid dates must be nil");
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    for (NSString *dateString in dateStrings)
+    {
+        [dateFormatter dateFromString:dateString];
+    }
+    
+    CFAbsoluteTime dateFormatterTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    for (NSString *dateString in dateStrings)
+    {
+        [dateString dateValue];
+    }
+    
+    CFAbsoluteTime dateValueTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    [self recordResults:@{ @"numberOfDates": @(kNumberOfDates),
+                           @"dateFormatterTime": @(dateFormatterTime),
+                           @"dateValueTime": @(dateValueTime) } ofBenchmark:_cmd];
+    
+    STAssertTrue(dateValueTime < dateFormatterTime, @"dateValue must be faster than NSDateFormatter");
+}
+
+- (void)testLanguageDuplicatesRemovalBenchmark
+{
+    // Similar to a language=all search: every show comes in several languages.
+    static const NSUInteger kNumberOfShows = 300;
+    NSArray *languages = @[@"de", @"en", @"es"];
+    
+    NSMutableString *xmlString = [NSMutableString stringWithString:@"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<Data>"];
+    
+    for (NSUInteger i = 0; i < kNumberOfShows; i++)
+    {
+        for (NSString *language in languages)
+        {
+            [xmlString appendFormat:@"<Series><seriesid>%lu</seriesid><language>%@</language><SeriesName>Show %lu</SeriesName></Series>",
+             (unsigned long)(kNumberOfShows - i), language, (unsigned long)i];
+        }
+    }
+    
+    [xmlString appendString:@"</Data>"];
+    
+    NSData *data = [xmlString dataUsingEncoding:NSUTF8StringEncoding];
+    
+    LRTVDBParseContext *spanishContext = [[LRTVDBParseContext alloc] initWithLanguage:@"es"
+                                                                      includeSpecials:NO
+                                                                lazyEpisodeTextFields:NO];
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSArray *shows = [[LRTVDBShowParser parserWithContext:spanishContext] parseBasicShowInfoFromData:data];
+    
+    [self recordResults:@{ @"numberOfResults": @(kNumberOfShows * [languages count]),
+                           @"parsingTime": @(CFAbsoluteTimeGetCurrent() - startTime) } ofBenchmark:_cmd];
+    
+    STAssertTrue([shows count] == kNumberOfShows, @"There must be one show per show ID");
+    
+    [shows enumerateObjectsUsingBlock:^(LRTVDBShow *show, NSUInteger idx, BOOL *stop) {
+        
+        STAssertEqualObjects(show.showID, ([NSString stringWithFormat:@"%lu", (unsigned long)(kNumberOfShows - idx)]), @"Ranking order must be kept");
+        STAssertEqualObjects(show.language, @"es", @"Show must be in the preferred language");
+        STAssertEqualObjects(show.availableLanguages, languages, @"Every language must be available");
+    }];
+    
+    shows = [LRTVDBShowParser removeLanguageDuplicatesFromShows:shows preferredLanguage:@"fr"];
+    
+    STAssertTrue([shows count] == kNumberOfShows, @"There must be one show per show ID");
+    
+    LRTVDBParseContext *frenchContext = [[LRTVDBParseContext alloc] initWithLanguage:@"fr"
+                                                                     includeSpecials:NO
+                                                               lazyEpisodeTextFields:NO];
+    
+    shows = [[LRTVDBShowParser parserWithContext:frenchContext] parseBasicShowInfoFromData:data];
+    
+    for (LRTVDBShow *show in shows)
+    {
+        STAssertEqualObjects(show.language, @"en", @"Show must fall back to English");
+    }
+}
+
+- (void)testEpisodesMergeBenchmark
+{
+    static const NSUInteger kNumberOfEpisodes = 10000;
+    static const NSUInteger kNumberOfNewEpisodes = 1000;
+    static const NSUInteger kEpisodesPerSeason = 100;
+    
+    NSData *(^episodesData)(NSUInteger, NSUInteger, NSString *) = ^(NSUInteger firstID, NSUInteger count, NSString *titlePrefix) {
+        
+        NSMutableString *xmlString = [NSMutableString stringWithString:@"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<Data>"];
+        
+        // Reverse order, so the merge has to sort the whole batch.
+        for (NSUInteger i = firstID + count; i > firstID; i--)
+        {
+            NSUInteger index = i - 1;
+            
+            [xmlString appendFormat:@"<Episode><id>%lu</id><EpisodeName>%@ %lu</EpisodeName><SeasonNumber>%lu</SeasonNumber><EpisodeNumber>%lu</EpisodeNumber><FirstAired>%04d-%02d-%02d</FirstAired></Episode>",
+             (unsigned long)(index + 1), titlePrefix, (unsigned long)index, (unsigned long)(index / kEpisodesPerSeason + 1),
+             (unsigned long)(index % kEpisodesPerSeason + 1), (int)(1950 + index / 365), (int)(1 + index % 12), (int)(1 + index % 28)];
+        }
+        
+        [xmlString appendString:@"</Data>"];
+        
+        return [xmlString dataUsingEncoding:NSUTF8StringEncoding];
+    };
+    
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    NSArray *episodes = [parser episodesFromData:episodesData(0, kNumberOfEpisodes, @"Episode")];
+    NSArray *updatedEpisodes = [parser episodesFromData:episodesData(0, kNumberOfEpisodes + kNumberOfNewEpisodes, @"Updated episode")];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    [show addEpisodes:episodes];
+    
+    CFAbsoluteTime insertionTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    LRTVDBEpisode *firstEpisode = show.episodes[0];
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    [show addEpisodes:updatedEpisodes];
+    
+    CFAbsoluteTime mergeTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    [self recordResults:@{ @"numberOfEpisodes": @(kNumberOfEpisodes),
+                           @"insertionTime": @(insertionTime),
+                           @"numberOfMergedEpisodes": @([updatedEpisodes count]),
+                           @"mergeTime": @(mergeTime) } ofBenchmark:_cmd];
+    
+    STAssertTrue([show.episodes count] == kNumberOfEpisodes + kNumberOfNewEpisodes, @"Every episode must be merged once");
+    STAssertTrue(show.episodes[0] == firstEpisode, @"Existing episodes must be updated in place");
+    STAssertEqualObjects(firstEpisode.title, @"Updated episode 0", @"Existing episodes must be updated");
+    
+    [show.episodes enumerateObjectsUsingBlock:^(LRTVDBEpisode *episode, NSUInteger idx, BOOL *stop) {
+        
+        STAssertEqualObjects(episode.episodeID, ([NSString stringWithFormat:@"%lu", (unsigned long)(idx + 1)]), @"Episodes must be sorted");
+    }];
+    
+    // Merging the same batch again must not change anything.
+    [show addEpisodes:updatedEpisodes];
+    
+    STAssertTrue([show.episodes count] == kNumberOfEpisodes + kNumberOfNewEpisodes, @"Every episode must be merged once");
+    STAssertTrue(show.episodes[0] == firstEpisode, @"Existing episodes must be updated in place");
+}
+
+- (void)testStoreOpeningBenchmark
+{
+    static const NSUInteger kNumberOfShows = 1000;
+    static const NSUInteger kEpisodesPerShow = 50;
+    
+    NSMutableString *episodesXMLString = [NSMutableString string];
+    
+    for (NSUInteger i = 0; i < kEpisodesPerShow; i++)
+    {
+        [episodesXMLString appendFormat:@"<Episode><id>%lu</id><EpisodeName>Episode %lu</EpisodeName><Overview>Overview of the episode %lu</Overview><SeasonNumber>%lu</SeasonNumber><EpisodeNumber>%lu</EpisodeNumber><FirstAired>2012-%02d-%02d</FirstAired></Episode>",
+         (unsigned long)(i + 1), (unsigned long)i, (unsigned long)i, (unsigned long)(i / 10 + 1), (unsigned long)(i % 10 + 1), (int)(1 + i % 12), (int)(1 + i % 28)];
+    }
+    
+    NSData *episodesData = [self episodesDataWithXMLString:episodesXMLString];
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    NSMutableArray *shows = [NSMutableArray arrayWithCapacity:kNumberOfShows];
+    
+    for (NSUInteger i = 0; i < kNumberOfShows; i++)
+    {
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = [NSString stringWithFormat:@"%lu", (unsigned long)(i + 1)];
+        show.name = [NSString stringWithFormat:@"Show %lu", (unsigned long)i];
+        [show addEpisodes:[parser episodesFromData:episodesData]];
+        [shows addObject:show];
+    }
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    NSData *persistenceFile = [manager persistenceFileForShows:shows error:&error];
+    [manager saveShowsInPersistenceStorage:shows error:&error];
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSArray *eagerShows = [manager showsFromData:persistenceFile error:&error];
+    
+    CFAbsoluteTime eagerTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSArray *lazyShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    CFAbsoluteTime lazyTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    [self recordResults:@{ @"numberOfShows": @(kNumberOfShows),
+                           @"episodesPerShow": @(kEpisodesPerShow),
+                           @"eagerTime": @(eagerTime),
+                           @"lazyTime": @(lazyTime) } ofBenchmark:_cmd];
+    
+    STAssertEqualObjects(lazyShows, eagerShows, @"Shows must be the same and in the same order");
+    STAssertTrue([lazyShows[0] isRelationshipsFault], @"Relationships must not be decoded when opening the store");
+    STAssertTrue([[lazyShows[0] episodes] count] == kEpisodesPerShow, @"Relationships must be decoded on first access");
+    STAssertFalse([lazyShows[0] isRelationshipsFault], @"Relationships must be decoded on first access");
+    STAssertTrue([lazyShows[1] isRelationshipsFault], @"Only the accessed show must be decoded");
+    
+    [manager saveShowsInPersistenceStorage:lazyShows error:&error];
+    
+    STAssertTrue(manager.numberOfWrittenSegments == 0, @"Decoding relationships doesn't make them dirty");
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+}
+
+- (void)testBinaryCodecBenchmark
+{
+    static const NSUInteger kNumberOfShows = 200;
+    static const NSUInteger kEpisodesPerShow = 100;
+    
+    NSMutableString *episodesXMLString = [NSMutableString string];
+    
+    for (NSUInteger i = 0; i < kEpisodesPerShow; i++)
+    {
+        [episodesXMLString appendFormat:@"<Episode><id>%lu</id><EpisodeName>Episode %lu</EpisodeName><Overview>Overview of the episode %lu</Overview><Director>|Director %lu|</Director><GuestStars>|Guest Star|Other Guest Star|</GuestStars><SeasonNumber>%lu</SeasonNumber><EpisodeNumber>%lu</EpisodeNumber><FirstAired>2012-%02d-%02d</FirstAired><Rating>7.5</Rating><RatingCount>%lu</RatingCount><Language>en</Language><seriesid>1</seriesid></Episode>",
+         (unsigned long)(i + 1), (unsigned long)i, (unsigned long)i, (unsigned long)(i % 5), (unsigned long)(i / 10 + 1), (unsigned long)(i % 10 + 1), (int)(1 + i % 12), (int)(1 + i % 28), (unsigned long)i];
+    }
+    
+    NSData *episodesData = [self episodesDataWithXMLString:episodesXMLString];
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    NSMutableArray *shows = [NSMutableArray arrayWithCapacity:kNumberOfShows];
+    
+    for (NSUInteger i = 0; i < kNumberOfShows; i++)
+    {
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = [NSString stringWithFormat:@"%lu", (unsigned long)(i + 1)];
+        show.name = [NSString stringWithFormat:@"Show %lu", (unsigned long)i];
+        [show addEpisodes:[parser episodesFromData:episodesData]];
+        [shows addObject:show];
+    }
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSData *plistData = [manager persistenceFileForShows:shows error:&error];
+    
+    CFAbsoluteTime plistEncodingTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSData *binaryData = [LRTVDBBinaryEncoder encodedDataWithRootObjects:shows];
+    
+    CFAbsoluteTime binaryEncodingTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSArray *plistShows = [manager showsFromData:plistData error:&error];
+    
+    CFAbsoluteTime plistDecodingTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSArray *binaryShows = [LRTVDBBinaryDecoder decodedRootObjectsOfClass:[LRTVDBShow class] data:binaryData error:&error];
+    
+    CFAbsoluteTime binaryDecodingTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    [self recordResults:@{ @"numberOfShows": @(kNumberOfShows),
+                           @"episodesPerShow": @(kEpisodesPerShow),
+                           @"plistLength": @([plistData length]),
+                           @"plistEncodingTime": @(plistEncodingTime),
+                           @"plistDecodingTime": @(plistDecodingTime),
+                           @"binaryLength": @([binaryData length]),
+                           @"binaryEncodingTime": @(binaryEncodingTime),
+                           @"binaryDecodingTime": @(binaryDecodingTime) } ofBenchmark:_cmd];
+    
+    STAssertEqualObjects(binaryShows, plistShows, @"Shows must be the same and in the same order");
+    STAssertTrue([[binaryShows[0] episodes] count] == kEpisodesPerShow, @"Every episode must be decoded");
+    STAssertTrue([binaryData length] < [plistData length], @"Binary data must be smaller than the plist");
+}
+
+- (void)testSQLiteQueryBenchmark
+{
+    static const NSUInteger kNumberOfShows = 200;
+    static const NSUInteger kEpisodesPerShow = 100;
+    
+    NSMutableArray *shows = [NSMutableArray arrayWithCapacity:kNumberOfShows];
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    for (NSUInteger i = 0; i < kNumberOfShows; i++)
+    {
+        NSString *showID = [NSString stringWithFormat:@"%lu", (unsigned long)(i + 1)];
+        NSMutableString *episodesXMLString = [NSMutableString string];
+        
+        // One episode a week, the last one airing within a week.
+        for (NSUInteger j = 0; j < kEpisodesPerShow; j++)
+        {
+            NSInteger days = (NSInteger)(j * 7) - (NSInteger)((kEpisodesPerShow - 1) * 7) + (NSInteger)(i % 7);
+            
+            [episodesXMLString appendFormat:@"<Episode><id>%lu</id><EpisodeName>Episode %lu</EpisodeName><Overview>Overview of the episode %lu</Overview><SeasonNumber>%lu</SeasonNumber><EpisodeNumber>%lu</EpisodeNumber><FirstAired>%@</FirstAired><seriesid>%@</seriesid></Episode>",
+             (unsigned long)(j + 1), (unsigned long)j, (unsigned long)j, (unsigned long)(j / 10 + 1), (unsigned long)(j % 10 + 1), [self ISODateStringWithDaysFromToday:days], showID];
+        }
+        
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = showID;
+        show.name = [NSString stringWithFormat:@"Show %lu", (unsigned long)i];
+        [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:episodesXMLString]]];
+        
+        // Every show but the odd ones is up to date.
+        if (i % 2 == 0) [show setSeen:YES forEpisodesInRange:NSMakeRange(0, [show.episodes count])];
+        
+        [shows addObject:show];
+    }
+    
+    LRTVDBPersistenceManager *plistManager = [LRTVDBPersistenceManager manager];
+    LRTVDBSQLitePersistenceManager *sqliteManager = [LRTVDBSQLitePersistenceManager manager];
+    NSError *error = nil;
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    [plistManager saveShowsInPersistenceStorage:shows error:&error];
+    
+    CFAbsoluteTime plistSaveTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    [sqliteManager saveShowsInPersistenceStorage:shows error:&error];
+    
+    CFAbsoluteTime sqliteSaveTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    NSDate *fromDate = [NSDate date];
+    NSDate *toDate = [NSDate dateWithTimeIntervalSinceNow:6 * 24 * 60 * 60];
+    LRTVDBDayNumber fromDayNumber = [fromDate lr_dayNumber];
+    LRTVDBDayNumber toDayNumber = [toDate lr_dayNumber];
+    
+    // Episodes airing this week
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSMutableArray *plistEpisodes = [NSMutableArray array];
+    
+    for (LRTVDBShow *show in [plistManager showsFromPersistenceStorageWithError:&error])
+    {
+        for (LRTVDBEpisode *episode in show.episodes)
+        {
+            LRTVDBDayNumber dayNumber = [episode.airedDate lr_dayNumber];
+            
+            if (episode.airedDate && dayNumber >= fromDayNumber && dayNumber <= toDayNumber) [plistEpisodes addObject:episode];
+        }
+    }
+    
+    CFAbsoluteTime plistWeekTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSArray *rows = [sqliteManager episodeRowsAiredFromDate:fromDate toDate:toDate error:&error];
+    
+    CFAbsoluteTime sqliteWeekTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    // Shows with unseen episodes
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSMutableArray *plistUnseenShows = [NSMutableArray array];
+    
+    for (LRTVDBShow *show in [plistManager showsFromPersistenceStorageWithError:&error])
+    {
+        for (LRTVDBEpisode *episode in show.episodes)
+        {
+            if (![episode isSpecial] && [episode hasAlreadyAired] && ![episode hasBeenSeen])
+            {
+                [plistUnseenShows addObject:show];
+                break;
+            }
+        }
+    }
+    
+    CFAbsoluteTime plistUnseenTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    startTime = CFAbsoluteTimeGetCurrent();
+    
+    NSArray *sqliteUnseenShows = [sqliteManager showsWithUnseenEpisodesWithError:&error];
+    
+    CFAbsoluteTime sqliteUnseenTime = CFAbsoluteTimeGetCurrent() - startTime;
+    
+    [self recordResults:@{ @"numberOfShows": @(kNumberOfShows),
+                           @"episodesPerShow": @(kEpisodesPerShow),
+                           @"plistSaveTime": @(plistSaveTime),
+                           @"sqliteSaveTime": @(sqliteSaveTime),
+                           @"plistWeekTime": @(plistWeekTime),
+                           @"sqliteWeekTime": @(sqliteWeekTime),
+                           @"plistUnseenTime": @(plistUnseenTime),
+                           @"sqliteUnseenTime": @(sqliteUnseenTime) } ofBenchmark:_cmd];
+    
+    STAssertEquals([rows count], [plistEpisodes count], @"Both backends must find the same episodes");
+    STAssertEqualObjects(sqliteUnseenShows, plistUnseenShows, @"Both backends must find the same shows");
+    
+    [plistManager saveShowsInPersistenceStorage:@[] error:&error];
+    [sqliteManager saveShowsInPersistenceStorage:@[] error:&error];
+}
+
+- (void)testCompressedStoreBenchmark
+{
+    static const NSUInteger kNumberOfShows = 200;
+    static const NSUInteger kEpisodesPerShow = 100;
+    
+    NSMutableString *episodesXMLString = [NSMutableString string];
+    
+    for (NSUInteger i = 0; i < kEpisodesPerShow; i++)
+    {
+        [episodesXMLString appendFormat:@"<Episode><id>%lu</id><EpisodeName>Episode %lu</EpisodeName><Overview>After the events of the previous episode, the family of the %lu friends has to face the consequences of their decisions while the town is in danger.</Overview>"
+         @"<SeasonNumber>%lu</SeasonNumber><EpisodeNumber>%lu</EpisodeNumber><FirstAired>2012-%02d-%02d</FirstAired><filename>episodes/1/%lu.jpg</filename><seriesid>1</seriesid></Episode>",
+         (unsigned long)(i + 1), (unsigned long)i, (unsigned long)i, (unsigned long)(i / 10 + 1), (unsigned long)(i % 10 + 1), (int)(1 + i % 12), (int)(1 + i % 28), (unsigned long)(i + 1)];
+    }
+    
+    NSData *episodesData = [self episodesDataWithXMLString:episodesXMLString];
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    NSMutableArray *shows = [NSMutableArray arrayWithCapacity:kNumberOfShows];
+    
+    for (NSUInteger i = 0; i < kNumberOfShows; i++)
+    {
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = [NSString stringWithFormat:@"%lu", (unsigned long)(i + 1)];
+        show.name = [NSString stringWithFormat:@"Show %lu", (unsigned long)i];
+        show.posterURL = [NSURL URLWithString:[NSString stringWithFormat:@"http://www.thetvdb.com/banners/posters/%lu-1.jpg", (unsigned long)(i + 1)]];
+        [show addEpisodes:[parser episodesFromData:episodesData]];
+        [shows addObject:show];
+    }
+    
+    NSString *storePath = [[NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) lr_firstObject]
+                           stringByAppendingPathComponent:@"LRTVDBShowsStore"];
+    
+    NSMutableDictionary *results = [NSMutableDictionary dictionary];
+    
+    for (NSNumber *compressionEnabled in @[@NO, @YES])
+    {
+        LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+        manager.compressionEnabled = [compressionEnabled boolValue];
+        NSError *error = nil;
+        
+        // Every show is written again once the store is emptied.
+        [manager saveShowsInPersistenceStorage:@[] error:&error];
+        
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        
+        [manager saveShowsInPersistenceStorage:shows error:&error];
+        
+        CFAbsoluteTime saveTime = CFAbsoluteTimeGetCurrent() - startTime;
+        
+        unsigned long long storeSize = 0;
+        
+        for (NSString *fileName in [[NSFileManager defaultManager] contentsOfDirectoryAtPath:storePath error:NULL])
+        {
+            storeSize += [[[NSFileManager defaultManager] attributesOfItemAtPath:[storePath stringByAppendingPathComponent:fileName] error:NULL] fileSize];
+        }
+        
+        startTime = CFAbsoluteTimeGetCurrent();
+        
+        NSArray *persistedShows = [manager showsFromPersistenceStorageWithError:&error];
+        
+        CFAbsoluteTime loadTime = CFAbsoluteTimeGetCurrent() - startTime;
+        
+        startTime = CFAbsoluteTimeGetCurrent();
+        
+        for (LRTVDBShow *show in persistedShows)
+        {
+            [show.episodes count];
+        }
+        
+        CFAbsoluteTime faultTime = CFAbsoluteTimeGetCurrent() - startTime;
+        
+        results[[compressionEnabled boolValue] ? @"compressed" : @"uncompressed"] = @{ @"storeSize": @(storeSize),
+                                                                                     @"saveTime": @(saveTime),
+                                                                                     @"loadTime": @(loadTime),
+                                                                                     @"faultTime": @(faultTime) };
+        
+        STAssertNil(error, @"Shows must be saved and read");
+        STAssertEqualObjects(persistedShows, shows, @"Shows must be the same and in the same order");
+        STAssertEqualObjects([persistedShows[0] posterURL], [shows[0] posterURL], @"Image URLs must be restored");
+        STAssertEqualObjects([[persistedShows[0] episodes][0] overview], [[shows[0] episodes][0] overview], @"Episodes must be restored");
+        
+        [manager saveShowsInPersistenceStorage:@[] error:&error];
+    }
+    
+    [self recordResults:results ofBenchmark:_cmd];
+}
+
+- (void)testBulkImportBenchmark
+{
+    static const NSUInteger kNumberOfShows = 200;
+    static const NSUInteger kEpisodesPerShow = 100;
+    
+    NSURL *dumpURL = [self dumpURLWithNumberOfShows:kNumberOfShows episodesPerShow:kEpisodesPerShow];
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+    
+    LRTVDBBulkImporter *importer = [[LRTVDBBulkImporter alloc] initWithPersistenceManager:manager];
+    
+    LRTVDBBulkImportProgress *progress = [importer importShowsAtURL:dumpURL progressBlock:nil error:&error];
+    
+    [self recordResults:@{ @"numberOfShows": @(kNumberOfShows),
+                           @"episodesPerShow": @(kEpisodesPerShow),
+                           @"elapsedTime": @(progress.elapsedTime),
+                           @"showsPerSecond": @(progress.showsPerSecond),
+                           @"bytesPerSecond": @(progress.bytesPerSecond) } ofBenchmark:_cmd];
+    
+    STAssertNil(error, @"Dump must be imported");
+    STAssertTrue(progress.numberOfImportedShows == kNumberOfShows, @"Every show must be imported");
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+    [[NSFileManager defaultManager] removeItemAtURL:dumpURL error:NULL];
+}
+
+- (void)testSnapshotReadContentionBenchmark
+{
+    static const NSUInteger kNumberOfReaders = 8;
+    static const NSUInteger kReadsPerReader = 50000;
+    static const NSUInteger kNumberOfBatches = 50;
+    static const NSUInteger kEpisodesPerBatch = 20;
+    
+    NSString *(^episodesXMLString)(NSUInteger, NSUInteger) = ^(NSUInteger firstID, NSUInteger count) {
+        
+        NSMutableString *xmlString = [NSMutableString string];
+        
+        for (NSUInteger i = firstID; i < firstID + count; i++)
+        {
+            [xmlString appendFormat:@"<Episode><id>%lu</id><EpisodeName>Episode %lu</EpisodeName><SeasonNumber>%lu</SeasonNumber><EpisodeNumber>%lu</EpisodeNumber></Episode>",
+             (unsigned long)(i + 1), (unsigned long)i, (unsigned long)(i / 100 + 1), (unsigned long)(i % 100 + 1)];
+        }
+        
+        return xmlString;
+    };
+    
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    NSMutableArray *batches = [NSMutableArray arrayWithCapacity:kNumberOfBatches];
+    
+    for (NSUInteger i = 0; i < kNumberOfBatches; i++)
+    {
+        [batches addObject:[parser episodesFromData:[self episodesDataWithXMLString:episodesXMLString(1000 + i * kEpisodesPerBatch, kEpisodesPerBatch)]]];
+    }
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:episodesXMLString(0, 1000)]]];
+    
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    
+    __block int32_t inconsistentReads = 0;
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    // One writer...
+    dispatch_group_async(group, queue, ^{
+        
+        for (NSArray *batch in batches)
+        {
+            [show addEpisodes:batch];
+        }
+    });
+    
+    // ... alongside many readers.
+    for (NSUInteger reader = 0; reader < kNumberOfReaders; reader++)
+    {
+        dispatch_group_async(group, queue, ^{
+            
+            NSUInteger previousCount = 0;
+            
+            for (NSUInteger i = 0; i < kReadsPerReader; i++)
+            {
+                NSUInteger count = [show.episodes count];
+                
+                // Episodes are only added, readers must never see them going back.
+                if (count < previousCount || [[show episodesForSeason:@1] count] != 100)
+                {
+                    OSAtomicIncrement32(&inconsistentReads);
+                }
+                
+                previousCount = count;
+            }
+        });
+    }
+    
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    [self recordResults:@{ @"numberOfReaders": @(kNumberOfReaders),
+                           @"readsPerReader": @(kReadsPerReader),
+                           @"numberOfMerges": @(kNumberOfBatches),
+                           @"time": @(CFAbsoluteTimeGetCurrent() - startTime) } ofBenchmark:_cmd];
+    
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(group);
+#endif
+    
+    STAssertTrue(inconsistentReads == 0, @"Readers must always see a whole snapshot");
+    STAssertTrue([show.episodes count] == 1000 + kNumberOfBatches * kEpisodesPerBatch, @"Every batch must be merged");
+}
+
+- (void)testShowsSortingBenchmark
+{
+    static const NSUInteger kNumberOfShows = 5000;
+    
+    NSMutableArray *shows = [NSMutableArray arrayWithCapacity:kNumberOfShows];
+    
+    for (NSUInteger i = 0; i < kNumberOfShows; i++)
+    {
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.name = [NSString stringWithFormat:@"Show %lu", (unsigned long)(i * 7919 % kNumberOfShows)];
+        show.rating = @((i * 31 % 100) / 10.0);
+        show.ratingCount = @(i % 50);
+        [shows addObject:show];
+    }
+    
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    
+    [shows sortUsingComparator:LRTVDBShowComparator];
+    
+    [self recordResults:@{ @"numberOfShows": @(kNumberOfShows),
+                           @"sortingTime": @(CFAbsoluteTimeGetCurrent() - startTime) } ofBenchmark:_cmd];
+    
+    for (NSUInteger i = 1; i < kNumberOfShows; i++)
+    {
+        STAssertTrue(LRTVDBShowComparator(shows[i - 1], shows[i]) != NSOrderedDescending, @"Shows must be sorted");
+    }
+}
+
+#pragma mark - Private
+
+- (void)recordResults:(NSDictionary *)results ofBenchmark:(SEL)benchmark
+{
+    NSString *resultsPath = [NSTemporaryDirectory() stringByAppendingPathComponent:kBenchmarksResultsFileName];
+    
+    NSMutableDictionary *allResults = [NSMutableDictionary dictionaryWithContentsOfFile:resultsPath] ?: [NSMutableDictionary dictionary];
+    allResults[NSStringFromSelector(benchmark)] = results;
+    
+    STAssertTrue([allResults writeToFile:resultsPath atomically:YES], @"Benchmark results must be written");
+}
+
+@end
@@ -41,6 +41,7 @@
 - (void)testShowsWithIDsFullInformation;
 - (void)testShowsWithIDsCheckRelationships;
 - (void)testShowsWithIDsCheckSpecialEpisodes;
+- (void)testShowsWithIDsLazyEpisodeTextFields;
 - (void)testShowsWithIDsCheckRelationshipsProperties;
 - (void)testShowsWithIDsCorrectLanguage;
 - (void)testShowsWithIDsShowWeakReference;
@@ -76,5 +77,43 @@
 
 /** Persistence */
 - (void)testShowsPersistence;
+- (void)testIncrementalPersistence;
+- (void)testAsynchronousShowsLoading;
+- (void)testJournalReplay;
+- (void)testJournalTornRecords;
+- (void)testJournalGroupCommit;
+- (void)testBackgroundPersistence;
+- (void)testSQLitePersistence;
+- (void)testBinaryCodecRoundTrip;
+- (void)testCompressedPersistence;
+- (void)testRelationshipsEviction;
+- (void)testEpisodesSummaryPersistence;
+- (void)testBulkImport;
+
+/** Parse context */
+- (void)testParseContextIncludeSpecials;
+- (void)testLanguageDuplicatesRemoval;
+
+/** String interning */
+- (void)testStringInterning;
+
+/** Model merges */
+- (void)testEpisodesMergeChangeSet;
+- (void)testEpisodeIndexIncrementalUpdate;
+- (void)testSeasonStats;
+- (void)testArtworkIndex;
+- (void)testShowUpdateFingerprints;
+- (void)testEpisodesMerge;
+
+/** Seen state */
+- (void)testSeenStateCounters;
+
+/** Day numbers */
+- (void)testDaysToAir;
+- (void)testEpisodesInformationConcurrentReads;
+- (void)testDateParsing;
+
+/** Sorting */
+- (void)testShowsSortKey;
 
 @end
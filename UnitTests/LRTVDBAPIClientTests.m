@@ -21,12 +21,31 @@
 // THE SOFTWARE.
 
 #import "LRTVDBAPIClientTests.h"
+#import "SenTestCase+LRTVDBFixtures.h"
 #import "LRTVDBAPIClient.h"
+#import "LRTVDBAPIClient+Private.h"
 #import "LRTVDBShow.h"
 #import "LRTVDBEpisode.h"
 #import "LRTVDBImage.h"
 #import "LRTVDBActor.h"
 #import "LRTVDBPersistenceManager.h"
+#import "LRTVDBPersistenceManager+Private.h"
+#import "LRTVDBPersistenceJournal.h"
+#import "LRTVDBSQLitePersistenceManager.h"
+#import "LRTVDBRelationshipsCache.h"
+#import "LRTVDBBulkImporter.h"
+#import "NSString+LRTVDBAdditions.h"
+#import "NSArray+LRTVDBAdditions.h"
+#import "NSDate+LRTVDBAdditions.h"
+#import "LRTVDBStringInterner.h"
+#import "LRTVDBShowParser.h"
+#import "LRTVDBEpisodeParser.h"
+#import "LRTVDBImageParser.h"
+#import "LRTVDBParseContext.h"
+#import "LRTVDBShow+Private.h"
+#import "LRTVDBBinaryCodec.h"
+#import "NSData+LRTVDBAdditions.h"
+#import <libkern/OSAtomic.h>
 
 static void *kObservingEpisodesContext;
 static void *kObservingImagesContext;
@@ -34,6 +53,7 @@ static void *kObservingActorsContext;
 static void *kObservingFanartURLContext;
 static void *kObservingPosterURLContext;
 static void *kObservingLastEpisodeContext;
+static void *kObservingEpisodesChangesContext;
 
 @implementation LRTVDBAPIClientTests
 
@@ -43,6 +63,7 @@ static void *kObservingLastEpisodeContext;
     
     [LRTVDBAPIClient sharedClient].language = nil;
     [LRTVDBAPIClient sharedClient].includeSpecials = NO;
+    [LRTVDBAPIClient sharedClient].lazyEpisodeTextFields = NO;
 }
 
 #pragma mark - Shows With Name
@@ -330,6 +351,43 @@ static void *kObservingLastEpisodeContext;
        }];
 }
 
+- (void)testShowsWithIDsLazyEpisodeTextFields
+{
+    __block NSArray *eagerEpisodes = nil;
+    
+    [self showsWithIDs:@[@"82066"]
+       includeEpisodes:YES
+         includeImages:NO
+         includeActors:NO
+       completionBlock:^(NSArray *shows, NSDictionary *errorsDictionary) {
+           
+           eagerEpisodes = [shows[0] episodes];
+       }];
+    
+    [LRTVDBAPIClient sharedClient].lazyEpisodeTextFields = YES;
+    
+    [self showsWithIDs:@[@"82066"]
+       includeEpisodes:YES
+         includeImages:NO
+         includeActors:NO
+       completionBlock:^(NSArray *shows, NSDictionary *errorsDictionary) {
+           
+           NSArray *lazyEpisodes = [shows[0] episodes];
+           
+           STAssertTrue([lazyEpisodes count] == [eagerEpisodes count], @"Episodes must be the same");
+           
+           [lazyEpisodes enumerateObjectsUsingBlock:^(LRTVDBEpisode *episode, NSUInteger idx, BOOL *stop) {
+               
+               LRTVDBEpisode *eagerEpisode = eagerEpisodes[idx];
+               
+               STAssertEqualObjects(episode.overview, eagerEpisode.overview, @"Overview must be the same");
+               STAssertEqualObjects(episode.directors, eagerEpisode.directors, @"Directors must be the same");
+               STAssertEqualObjects(episode.writers, eagerEpisode.writers, @"Writers must be the same");
+               STAssertEqualObjects(episode.guestStars, eagerEpisode.guestStars, @"Guest stars must be the same");
+           }];
+       }];
+}
+
 - (void)testShowsWithIDsCheckRelationshipsProperties
 {
     [self showsWithIDs:@[@"82066"]
@@ -638,6 +696,7 @@ static BOOL sActorsKVONotified = NO;
 static BOOL sFanartURLKVONotified = NO;
 static BOOL sPosterURLKVONotified = NO;
 static BOOL sLastEpisodeKVONotified = NO;
+static NSMutableArray *sEpisodesChanges = nil;
 
 - (void)testUpdateShowsKVO
 {    
@@ -1115,6 +1174,10 @@ static BOOL sLastEpisodeKVONotified = NO;
     {
         sLastEpisodeKVONotified = YES;
     }
+    else if (context == &kObservingEpisodesChangesContext)
+    {
+        [sEpisodesChanges addObject:change];
+    }
     else
     {
         [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
@@ -1164,4 +1227,1460 @@ static BOOL sLastEpisodeKVONotified = NO;
        }];
 }
 
+- (void)testIncrementalPersistence
+{
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    NSMutableArray *shows = [NSMutableArray array];
+    
+    for (NSUInteger i = 0; i < 3; i++)
+    {
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = [NSString stringWithFormat:@"%lu", (unsigned long)i];
+        show.name = show.showID;
+        [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:
+                                                    @"<Episode><id>1</id><EpisodeName>1x01</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber></Episode>"
+                                                    @"<Episode><id>2</id><EpisodeName>1x02</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber></Episode>"]]];
+        [shows addObject:show];
+    }
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    [manager saveShowsInPersistenceStorage:shows error:&error];
+    
+    STAssertNil(error, @"Shows must be saved");
+    STAssertTrue(manager.numberOfWrittenSegments == 12, @"New shows are written completely");
+    
+    [manager saveShowsInPersistenceStorage:shows error:&error];
+    
+    STAssertTrue(manager.numberOfWrittenSegments == 0, @"Unchanged shows must not be written");
+    
+    [[shows[1] episodes][0] setSeen:YES];
+    [shows removeObjectAtIndex:2];
+    
+    [manager saveShowsInPersistenceStorage:shows error:&error];
+    
+    STAssertTrue(manager.numberOfWrittenSegments == 1, @"Only the episodes of the changed show must be written");
+    
+    NSArray *persistedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertEqualObjects(persistedShows, shows, @"Shows must be the same and in the same order");
+    STAssertTrue([[persistedShows[1] episodes][0] hasBeenSeen], @"Seen status must be persisted");
+    STAssertFalse([[persistedShows[0] episodes][0] hasBeenSeen], @"Seen status must be persisted");
+    STAssertEqualObjects([[persistedShows[1] episodes][0] showID], @"1", @"Episodes must take the ID of their show");
+    
+    [manager saveShowsInPersistenceStorage:persistedShows error:&error];
+    
+    STAssertTrue(manager.numberOfWrittenSegments == 0, @"Loaded shows are not dirty");
+    
+    LRTVDBShow *showWithoutID = [[LRTVDBShow alloc] init];
+    showWithoutID.name = @"No ID";
+    
+    [manager saveShowsInPersistenceStorage:[persistedShows arrayByAddingObject:showWithoutID] error:&error];
+    
+    STAssertNil(error, @"Shows without ID must be skipped");
+    STAssertEqualObjects([manager showsFromPersistenceStorageWithError:&error], shows, @"Shows without ID must not be persisted");
+    
+    // Episodes persisted without show ID take the one of the show owning them.
+    NSMutableDictionary *serializedShow = [[shows[0] serialize] mutableCopy];
+    NSMutableArray *serializedEpisodes = [NSMutableArray array];
+    
+    for (NSDictionary *serializedEpisode in serializedShow[@"kShowEpisodesKey"])
+    {
+        NSMutableDictionary *episodeWithoutShowID = [serializedEpisode mutableCopy];
+        [episodeWithoutShowID removeObjectForKey:@"kEpisodeShowIDKey"];
+        [serializedEpisodes addObject:episodeWithoutShowID];
+    }
+    
+    serializedShow[@"kShowEpisodesKey"] = serializedEpisodes;
+    
+    LRTVDBShow *deserializedShow = [LRTVDBShow deserialize:serializedShow error:&error];
+    
+    STAssertTrue([deserializedShow.episodes count] == 2, @"Episodes without show ID must not be dropped");
+    STAssertEqualObjects([deserializedShow.episodes[0] showID], @"0", @"Episodes must take the ID of their show");
+}
+
+- (void)testAsynchronousShowsLoading
+{
+    static const NSUInteger kNumberOfShows = 100;
+    
+    NSData *episodesData = [self episodesDataWithXMLString:@"<Episode><id>1</id><EpisodeName>1x01</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><seriesid>1</seriesid></Episode>"];
+    
+    NSMutableArray *shows = [NSMutableArray arrayWithCapacity:kNumberOfShows];
+    
+    for (NSUInteger i = 0; i < kNumberOfShows; i++)
+    {
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = [NSString stringWithFormat:@"%lu", (unsigned long)(i + 1)];
+        show.name = show.showID;
+        [show addEpisodes:[[LRTVDBEpisodeParser parser] episodesFromData:episodesData]];
+        [shows addObject:show];
+    }
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    [manager saveShowsInPersistenceStorage:shows error:&error];
+    
+    STAssertEqualObjects([manager showsFromPersistenceStorageWithError:&error], shows, @"Shows must be decoded in the same order");
+    
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    
+    NSMutableArray *batches = [NSMutableArray array];
+    NSMutableArray *progressiveShows = [NSMutableArray array];
+    __block NSArray *_shows = nil;
+    __block BOOL progressOnMainThread = YES;
+    
+    [manager showsFromPersistenceStorageWithProgressBlock:^(NSArray *batch) {
+        
+        progressOnMainThread &= [NSThread isMainThread];
+        
+        [batches addObject:batch];
+        [progressiveShows addObjectsFromArray:batch];
+        
+    } completionBlock:^(NSArray *loadedShows, NSError *loadError) {
+        
+        _shows = loadedShows;
+        
+        dispatch_semaphore_signal(semaphore);
+    }];
+    
+    while (dispatch_semaphore_wait(semaphore, DISPATCH_TIME_NOW))
+    {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                                 beforeDate:[NSDate distantPast]];
+    }
+    
+    STAssertTrue(progressOnMainThread, @"Progress must be delivered on the main thread");
+    STAssertTrue([batches count] > 1, @"Shows must be delivered progressively");
+    STAssertTrue([batches[0] count] < [[batches lastObject] count], @"First batches must be the smallest");
+    STAssertEqualObjects(progressiveShows, shows, @"Batches must be delivered in order");
+    STAssertEqualObjects(_shows, shows, @"Every show must be delivered on completion");
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+}
+
+- (void)testJournalReplay
+{
+    NSData *episodesData = [self episodesDataWithXMLString:@"<Episode><id>1</id><EpisodeName>1x01</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><seriesid>1</seriesid></Episode>"
+                                                           @"<Episode><id>2</id><EpisodeName>1x02</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber><seriesid>1</seriesid></Episode>"];
+    
+    NSMutableArray *shows = [NSMutableArray array];
+    
+    for (NSString *showID in @[@"1", @"2", @"3"])
+    {
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = showID;
+        show.name = showID;
+        [show addEpisodes:[[LRTVDBEpisodeParser parser] episodesFromData:episodesData]];
+        [shows addObject:show];
+    }
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    [manager saveShowsInPersistenceStorage:@[shows[0], shows[1]] error:&error];
+    
+    LRTVDBShow *firstShow = shows[0];
+    
+    for (LRTVDBEpisode *episode in firstShow.episodes)
+    {
+        episode.seen = YES;
+        [manager journalSeenStatusOfEpisodes:@[episode]];
+    }
+    
+    [firstShow.episodes[1] setSeen:NO];
+    [manager journalSeenStatusOfEpisodes:@[firstShow.episodes[1]]];
+    
+    [manager journalAddedShow:shows[2]];
+    [manager journalRemovedShow:shows[1]];
+    [manager synchronizeJournal];
+    
+    STAssertEquals([[manager.journal records] count], (NSUInteger)5, @"Every record must be in the journal");
+    
+    NSArray *replayedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertEqualObjects([replayedShows valueForKey:@"showID"], (@[@"1", @"3"]), @"Added and removed shows must be replayed");
+    
+    LRTVDBShow *replayedShow = replayedShows[0];
+    
+    STAssertTrue([replayedShow.episodes[0] hasBeenSeen], @"Seen changes must be replayed");
+    STAssertFalse([replayedShow.episodes[1] hasBeenSeen], @"Seen changes must be replayed in order");
+    STAssertEquals([[replayedShows[1] episodes] count], (NSUInteger)2, @"Added shows must be complete");
+    
+    [manager saveShowsInPersistenceStorage:replayedShows error:&error];
+    
+    STAssertEquals([[manager.journal records] count], (NSUInteger)0, @"Saving must compact the journal");
+    
+    replayedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertEqualObjects([replayedShows valueForKey:@"showID"], (@[@"1", @"3"]), @"Compacted shows must be persisted");
+    STAssertTrue([[replayedShows[0] episodes][0] hasBeenSeen], @"Compacted seen changes must be persisted");
+    
+    // Shows added while saves are being written
+    static const NSUInteger kNumberOfAddedShows = 20;
+    
+    NSMutableArray *addedShows = [NSMutableArray arrayWithCapacity:kNumberOfAddedShows];
+    
+    for (NSUInteger i = 0; i < kNumberOfAddedShows; i++)
+    {
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = [NSString stringWithFormat:@"%lu", (unsigned long)(i + 100)];
+        show.name = show.showID;
+        [show addEpisodes:[[LRTVDBEpisodeParser parser] episodesFromData:episodesData]];
+        [addedShows addObject:show];
+    }
+    
+    NSArray *savedShows = replayedShows;
+    
+    dispatch_apply(2, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t idx) {
+        
+        if (idx == 0)
+        {
+            for (LRTVDBShow *show in addedShows) [manager journalAddedShow:show];
+        }
+        else
+        {
+            for (NSUInteger i = 0; i < 5; i++) [manager saveShowsInPersistenceStorage:savedShows error:NULL];
+        }
+    });
+    
+    replayedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertEquals([replayedShows count], (NSUInteger)(2 + kNumberOfAddedShows), @"Shows added while saving must be kept");
+    
+    for (LRTVDBShow *show in replayedShows)
+    {
+        STAssertEquals([show.episodes count], (NSUInteger)2, @"Shows added while saving must be complete");
+    }
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+}
+
+- (void)testJournalTornRecords
+{
+    NSString *directoryPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"LRTVDBJournalTests"];
+    
+    [[NSFileManager defaultManager] removeItemAtPath:directoryPath error:NULL];
+    
+    LRTVDBPersistenceJournal *journal = [[LRTVDBPersistenceJournal alloc] initWithDirectoryPath:directoryPath];
+    
+    [journal appendRecord:[LRTVDBJournalRecord recordWithType:LRTVDBJournalRecordTypeEpisodeSeen showID:@"1" episodeID:@"1" segmentFileNames:nil]];
+    [journal synchronize];
+    
+    // Header of a record whose payload was never written.
+    uint32_t tornHeader[2] = { CFSwapInt32HostToLittle(64), 0 };
+    NSString *journalFileName = [[[NSFileManager defaultManager] contentsOfDirectoryAtPath:directoryPath error:NULL] lastObject];
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingAtPath:[directoryPath stringByAppendingPathComponent:journalFileName]];
+    [fileHandle seekToEndOfFile];
+    [fileHandle writeData:[NSData dataWithBytes:tornHeader length:sizeof(tornHeader)]];
+    [fileHandle closeFile];
+    
+    [journal appendRecord:[LRTVDBJournalRecord recordWithType:LRTVDBJournalRecordTypeEpisodeSeen showID:@"1" episodeID:@"2" segmentFileNames:nil]];
+    
+    NSArray *records = [journal records];
+    
+    STAssertEqualObjects([records valueForKey:@"episodeID"], (@[@"1", @"2"]), @"Records appended after a torn one must be read");
+    
+    [[NSFileManager defaultManager] removeItemAtPath:directoryPath error:NULL];
+}
+
+- (void)testJournalGroupCommit
+{
+    static const NSUInteger kNumberOfRecords = 200;
+    
+    NSString *directoryPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"LRTVDBJournalTests"];
+    
+    [[NSFileManager defaultManager] removeItemAtPath:directoryPath error:NULL];
+    
+    LRTVDBPersistenceJournal *journal = [[LRTVDBPersistenceJournal alloc] initWithDirectoryPath:directoryPath];
+    
+    // The first record starts a flush, the following ones are appended from
+    // several threads while it's syncing.
+    dispatch_apply(kNumberOfRecords, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t idx) {
+        
+        NSString *episodeID = [NSString stringWithFormat:@"%lu", (unsigned long)idx];
+        
+        [journal appendRecord:[LRTVDBJournalRecord recordWithType:LRTVDBJournalRecordTypeEpisodeSeen showID:@"1" episodeID:episodeID segmentFileNames:nil]];
+    });
+    
+    [journal synchronize];
+    
+    STAssertEquals([[journal records] count], kNumberOfRecords, @"Every record must be in the journal");
+    STAssertTrue(journal.numberOfSyncs < kNumberOfRecords, @"Records appended while a flush is syncing must be synced together");
+    
+    [[NSFileManager defaultManager] removeItemAtPath:directoryPath error:NULL];
+}
+
+- (void)testBackgroundPersistence
+{
+    static const NSUInteger kNumberOfSaveRequests = 20;
+    
+    NSData *episodesData = [self episodesDataWithXMLString:@"<Episode><id>1</id><EpisodeName>1x01</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><seriesid>1</seriesid></Episode>"];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    show.showID = @"1";
+    show.name = @"Show";
+    [show addEpisodes:[[LRTVDBEpisodeParser parser] episodesFromData:episodesData]];
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    NSUInteger numberOfBackgroundWrites = manager.numberOfBackgroundWrites;
+    
+    for (NSUInteger i = 0; i < kNumberOfSaveRequests; i++)
+    {
+        [manager saveShowsInBackground:@[show]];
+    }
+    
+    // Changes made before the save is written are written with it.
+    [show.episodes[0] setSeen:YES];
+    
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    
+    __block BOOL completionOnMainThread = NO;
+    __block NSError *flushError = nil;
+    
+    [manager flushPendingSavesWithCompletionBlock:^(NSError *completionError) {
+        
+        completionOnMainThread = [NSThread isMainThread];
+        flushError = completionError;
+        
+        dispatch_semaphore_signal(semaphore);
+    }];
+    
+    while (dispatch_semaphore_wait(semaphore, DISPATCH_TIME_NOW))
+    {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                                 beforeDate:[NSDate distantPast]];
+    }
+    
+    STAssertTrue(completionOnMainThread, @"Flush completion must be called on the main thread");
+    STAssertNil(flushError, @"Background save must succeed");
+    STAssertEquals(manager.numberOfBackgroundWrites - numberOfBackgroundWrites, (NSUInteger)1, @"Save requests must be coalesced");
+    
+    NSArray *persistedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertEqualObjects(persistedShows, @[show], @"Background saves must be persisted");
+    STAssertTrue([[persistedShows[0] episodes][0] hasBeenSeen], @"Pending saves must write the latest changes");
+    
+    // Synchronous saves supersede pending background ones.
+    [manager saveShowsInBackground:@[show]];
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+    
+    STAssertTrue([manager flushPendingSaves:&error], @"Flush must succeed");
+    STAssertEquals(manager.numberOfBackgroundWrites - numberOfBackgroundWrites, (NSUInteger)1, @"Superseded saves must not be written");
+    STAssertEquals([[manager showsFromPersistenceStorageWithError:&error] count], (NSUInteger)0, @"Superseded saves must not be written");
+    
+    // Managers of the same store share their writer, managers of other stores don't.
+    LRTVDBSQLitePersistenceManager *SQLiteManager = [LRTVDBSQLitePersistenceManager manager];
+    NSUInteger numberOfSQLiteBackgroundWrites = SQLiteManager.numberOfBackgroundWrites;
+    
+    [[LRTVDBPersistenceManager manager] saveShowsInBackground:@[show]];
+    
+    STAssertTrue([manager flushPendingSaves:&error], @"Flush must succeed");
+    STAssertEquals(manager.numberOfBackgroundWrites - numberOfBackgroundWrites, (NSUInteger)2, @"Managers of the same store must share their writer");
+    STAssertEquals(SQLiteManager.numberOfBackgroundWrites, numberOfSQLiteBackgroundWrites, @"Managers of other stores must not share it");
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+}
+
+- (void)testSQLitePersistence
+{
+    NSString *episodesXMLFormat = [NSString stringWithFormat:
+                                   @"<Episode><id>1</id><EpisodeName>1x01</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><FirstAired>%@</FirstAired><seriesid>%%@</seriesid></Episode>"
+                                   @"<Episode><id>3</id><EpisodeName>1x03</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>3</EpisodeNumber><seriesid>%%@</seriesid></Episode>"
+                                   @"<Episode><id>2</id><EpisodeName>1x02</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber><FirstAired>%@</FirstAired><seriesid>%%@</seriesid></Episode>"
+                                   @"<Episode><id>4</id><EpisodeName>Special</EpisodeName><SeasonNumber>0</SeasonNumber><EpisodeNumber>1</EpisodeNumber><FirstAired>%@</FirstAired><seriesid>%%@</seriesid></Episode>",
+                                   [self ISODateStringWithDaysFromToday:-10], [self ISODateStringWithDaysFromToday:2], [self ISODateStringWithDaysFromToday:-1]];
+    
+    NSMutableArray *shows = [NSMutableArray array];
+    
+    for (NSString *showID in @[@"1", @"2", @"3"])
+    {
+        NSString *episodesXMLString = [NSString stringWithFormat:episodesXMLFormat, showID, showID, showID, showID];
+        
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = showID;
+        show.name = showID;
+        [show addEpisodes:[[LRTVDBEpisodeParser parser] episodesFromData:[self episodesDataWithXMLString:episodesXMLString]]];
+        [shows addObject:show];
+    }
+    
+    LRTVDBSQLitePersistenceManager *manager = [LRTVDBSQLitePersistenceManager manager];
+    NSError *error = nil;
+    
+    [manager saveShowsInPersistenceStorage:shows error:&error];
+    
+    STAssertNil(error, @"Shows must be saved");
+    STAssertEquals(manager.numberOfWrittenSegments, (NSUInteger)12, @"Every section of new shows must be written");
+    
+    NSArray *persistedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertEqualObjects(persistedShows, shows, @"Shows must be retrieved in the same order");
+    STAssertTrue([persistedShows[0] isRelationshipsFault], @"Relationships must be decoded on first access");
+    STAssertEqualObjects([[persistedShows[0] episodes] valueForKey:@"episodeID"], [[shows[0] episodes] valueForKey:@"episodeID"], @"Episodes must be persisted");
+    
+    NSArray *rows = [manager episodeRowsAiredFromDate:[NSDate date] toDate:[NSDate dateWithTimeIntervalSinceNow:6 * 24 * 60 * 60] error:&error];
+    
+    STAssertEqualObjects([rows valueForKey:@"showID"], (@[@"1", @"2", @"3"]), @"Episodes aired this week must be found");
+    STAssertEqualObjects([rows valueForKey:@"title"], (@[@"1x02", @"1x02", @"1x02"]), @"Episodes aired this week must be found");
+    
+    NSArray *seasonEpisodes = [manager episodesOfShowWithID:@"2" seasonNumber:1 error:&error];
+    
+    STAssertEqualObjects([seasonEpisodes valueForKey:@"title"], (@[@"1x01", @"1x02", @"1x03"]), @"Season episodes must be sorted by number");
+    STAssertNil([seasonEpisodes[0] show], @"Query episodes don't belong to any show");
+    
+    STAssertEqualObjects([[manager showsWithUnseenEpisodesWithError:&error] valueForKey:@"showID"], (@[@"1", @"2", @"3"]), @"Shows with unseen aired episodes must be found");
+    
+    LRTVDBShow *firstShow = shows[0];
+    [firstShow.episodes[1] setSeen:YES];
+    [manager journalSeenStatusOfEpisodes:@[firstShow.episodes[1]]];
+    
+    STAssertEqualObjects([[manager showsWithUnseenEpisodesWithError:&error] valueForKey:@"showID"], (@[@"2", @"3"]), @"Seen changes must be seen by later reads");
+    STAssertTrue([[manager episodesOfShowWithID:@"1" seasonNumber:1 error:&error][0] hasBeenSeen], @"Seen changes must be seen by later reads");
+    
+    [manager journalRemovedShow:shows[2]];
+    
+    STAssertEqualObjects([manager showsFromPersistenceStorageWithError:&error], (@[shows[0], shows[1]]), @"Removed shows must be removed right away");
+    
+    [manager saveShowsInPersistenceStorage:@[shows[0], shows[1]] error:&error];
+    
+    STAssertEquals(manager.numberOfWrittenSegments, (NSUInteger)1, @"Only dirty sections must be written");
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+    
+    STAssertEquals([[manager episodeRowsOfShowWithID:@"1" seasonNumber:1 error:&error] count], (NSUInteger)0, @"Episodes of removed shows must be removed");
+}
+
+- (void)testBinaryCodecRoundTrip
+{
+    NSData *episodesData = [self episodesDataWithXMLString:
+                            @"<Episode><id>1</id><EpisodeName>Pilot</EpisodeName><Overview>First &amp; best</Overview><Director>|Director|</Director>"
+                            @"<Writer>|Writer 1|Writer 2|</Writer><FirstAired>1969-07-20</FirstAired><Rating>7.6</Rating><RatingCount>12</RatingCount>"
+                            @"<SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><seriesid>1</seriesid></Episode>"
+                            @"<Episode><id>2</id><EpisodeName>Ñandú</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber><seriesid>1</seriesid></Episode>"];
+    NSData *bannersData = [@"<Banners><Banner><BannerPath>seasons/1-1.jpg</BannerPath><BannerType>season</BannerType><Season>1</Season><Rating>6.5</Rating><RatingCount>3</RatingCount></Banner></Banners>"
+                           dataUsingEncoding:NSUTF8StringEncoding];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    show.showID = @"1";
+    show.name = @"Show";
+    show.airTime = @"9:00 PM";
+    show.genres = @[@"Drama", @"Comedy"];
+    show.runtime = @60;
+    show.infoFingerprint = @(UINT64_MAX);
+    [show addEpisodes:[[LRTVDBEpisodeParser parser] episodesFromData:episodesData]];
+    [show addImages:[[LRTVDBImageParser parser] imagesFromData:bannersData]];
+    [show.episodes[0] setSeen:YES];
+    
+    NSData *data = [LRTVDBBinaryEncoder encodedDataWithRootObjects:@[show]];
+    
+    NSError *error = nil;
+    NSArray *decodedShows = [LRTVDBBinaryDecoder decodedRootObjectsOfClass:[LRTVDBShow class] data:data error:&error];
+    LRTVDBShow *decodedShow = decodedShows[0];
+    
+    STAssertNil(error, @"Data must be decoded");
+    STAssertEqualObjects(decodedShow, show, @"Show must be the same");
+    STAssertEqualObjects(decodedShow.genres, show.genres, @"String lists must be decoded in order");
+    STAssertEqualObjects(decodedShow.runtime, @60, @"Integers must be decoded");
+    STAssertEqualObjects(decodedShow.infoFingerprint, @(UINT64_MAX), @"Unsigned integers must not overflow");
+    STAssertEqualObjects(decodedShow.episodes, show.episodes, @"Episodes must be the same and in the same order");
+    
+    LRTVDBEpisode *episode = decodedShow.episodes[0];
+    
+    STAssertEqualObjects(episode.overview, [show.episodes[0] overview], @"Text fields must be decoded");
+    STAssertEqualObjects(episode.writers, (@[@"Writer 1", @"Writer 2"]), @"String lists must be decoded");
+    STAssertEqualObjects(episode.airedDate, [show.episodes[0] airedDate], @"Dates before 1970 must be decoded");
+    STAssertEqualObjects(episode.rating, @7.6, @"Doubles must be decoded exactly");
+    STAssertTrue([episode hasBeenSeen], @"Seen status must be decoded");
+    STAssertNil([decodedShow.episodes[1] airedDate], @"Missing values must stay nil");
+    STAssertNil([decodedShow.episodes[1] rating], @"Missing values must stay nil");
+    STAssertEqualObjects([decodedShow.episodes[1] title], @"Ñandú", @"Strings must be decoded as UTF-8");
+    STAssertEqualObjects([decodedShow.images[0] seasonNumber], @1, @"Images must be decoded");
+    STAssertEqualObjects([decodedShow.images[0] rating], @6.5, @"Doubles must be decoded exactly");
+    
+    // Previous versions persisted ratings as floats.
+    LRTVDBEpisode *legacyEpisode = [[LRTVDBEpisode alloc] init];
+    [legacyEpisode setValue:@7.6f forKey:@"rating"];
+    
+    STAssertEqualObjects(legacyEpisode.rating, @7.6, @"Float ratings must be read as their decimal value");
+    
+    // Episodes records read as actors: the known tags are read and the rest skipped.
+    NSData *episodesRecordsData = [LRTVDBBinaryEncoder encodedDataWithRootObjects:show.episodes];
+    NSArray *actors = [LRTVDBBinaryDecoder decodedRootObjectsOfClass:[LRTVDBActor class] data:episodesRecordsData error:&error];
+    
+    STAssertTrue([actors count] == 2, @"Unknown fields must be skipped");
+    STAssertEqualObjects([actors[0] actorID], @"1", @"Known fields must be decoded");
+    
+    // Show air time (a string) read as actor sort order (an integer).
+    STAssertNil([LRTVDBBinaryDecoder decodedRootObjectsOfClass:[LRTVDBActor class] data:data error:&error], @"Wrong types must be detected");
+    STAssertEquals([error code], (NSInteger)kBinaryCodecBadTypeError, @"Wrong types must be detected");
+    
+    NSData *truncatedData = [data subdataWithRange:NSMakeRange(0, [data length] - 10)];
+    
+    STAssertNil([LRTVDBBinaryDecoder decodedRootObjectsOfClass:[LRTVDBShow class] data:truncatedData error:&error], @"Truncated data must be detected");
+    STAssertNil([LRTVDBBinaryDecoder decodedRootObjectsOfClass:[LRTVDBShow class] data:[NSData data] error:&error], @"Empty data must be detected");
+    STAssertEquals([error code], (NSInteger)kBinaryCodecBadHeaderError, @"Missing header must be detected");
+}
+
+- (void)testCompressedPersistence
+{
+    NSData *data = [@"kEpisodeOverviewKey: the best episode of the season" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *compressedData = [data lr_compressedData];
+    
+    STAssertTrue([compressedData lr_isCompressedData], @"Compressed data must be detected");
+    STAssertFalse([data lr_isCompressedData], @"Uncompressed data must be detected");
+    STAssertEqualObjects([compressedData lr_decompressedData], data, @"Data must be decompressed");
+    STAssertNil([[compressedData subdataWithRange:NSMakeRange(0, [compressedData length] - 4)] lr_decompressedData], @"Truncated data must be detected");
+    
+    NSMutableData *corruptData = [compressedData mutableCopy];
+    uint32_t corruptLength = UINT32_MAX;
+    [corruptData replaceBytesInRange:NSMakeRange(5, sizeof(corruptLength)) withBytes:&corruptLength];
+    
+    STAssertNil([corruptData lr_decompressedData], @"Lengths no data can be inflated to must be rejected");
+    
+    NSData *bannersData = [@"<Banners><Banner><BannerPath>posters/1-1.jpg</BannerPath><BannerType>poster</BannerType></Banner></Banners>"
+                           dataUsingEncoding:NSUTF8StringEncoding];
+    LRTVDBImage *image = [[LRTVDBImageParser parser] imagesFromData:bannersData][0];
+    
+    STAssertEqualObjects([image.url absoluteString], @"http://www.thetvdb.com/banners/posters/1-1.jpg", @"Image URLs must be absolute");
+    STAssertEqualObjects([image serialize][@"kImageURLKey"], @"posters/1-1.jpg", @"Only the path of the image must be persisted");
+    
+    // Previous versions persisted the whole URL.
+    NSMutableDictionary *legacyImage = [[image serialize] mutableCopy];
+    legacyImage[@"kImageURLKey"] = [image.url absoluteString];
+    
+    NSError *error = nil;
+    
+    STAssertEqualObjects([LRTVDBImage deserialize:legacyImage error:&error], image, @"Absolute image URLs must be read");
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    show.showID = @"1";
+    show.name = @"Show";
+    show.bannerURL = [NSURL URLWithString:@"http://www.thetvdb.com/banners/graphical/1-g.jpg"];
+    [show addEpisodes:[[LRTVDBEpisodeParser parser] episodesFromData:[self episodesDataWithXMLString:
+                                                                      @"<Episode><id>1</id><EpisodeName>Pilot</EpisodeName><Overview>The first episode of the show</Overview><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><seriesid>1</seriesid></Episode>"]]];
+    [show addImages:@[image]];
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    manager.compressionEnabled = YES;
+    
+    [manager saveShowsInPersistenceStorage:@[show] error:&error];
+    
+    STAssertNil(error, @"Shows must be saved");
+    
+    // Compressed and uncompressed segments are read the same way.
+    NSArray *persistedShows = [[LRTVDBPersistenceManager manager] showsFromPersistenceStorageWithError:&error];
+    LRTVDBShow *persistedShow = [persistedShows lr_firstObject];
+    
+    STAssertEqualObjects(persistedShows, @[show], @"Shows must be the same");
+    STAssertEqualObjects(persistedShow.bannerURL, show.bannerURL, @"Image URLs must be restored");
+    STAssertEqualObjects([persistedShow.episodes[0] overview], [show.episodes[0] overview], @"Compressed segments must be decompressed");
+    STAssertEqualObjects([persistedShow.images[0] url], image.url, @"Image URLs must be restored");
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+}
+
+- (void)testRelationshipsEviction
+{
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    NSMutableArray *shows = [NSMutableArray array];
+    
+    for (NSUInteger i = 0; i < 3; i++)
+    {
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = [NSString stringWithFormat:@"%lu", (unsigned long)(i + 1)];
+        show.name = show.showID;
+        [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:
+                                                    @"<Episode><id>1</id><EpisodeName>1x01</EpisodeName><Overview>Overview of the pilot</Overview><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><FirstAired>2010-01-01</FirstAired><seriesid>1</seriesid></Episode>"
+                                                    @"<Episode><id>2</id><EpisodeName>1x02</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber><FirstAired>2010-01-08</FirstAired><seriesid>1</seriesid></Episode>"]]];
+        [shows addObject:show];
+    }
+    
+    [shows[2] setBasicStatus:LRTVDBShowBasicStatusEnded];
+    
+    LRTVDBShow *show = shows[0];
+    LRTVDBEpisode *episode = show.episodes[0];
+    LRTVDBEpisode *lastEpisode = show.lastEpisode;
+    LRTVDBShowStatus status = show.status;
+    NSNumber *daysToNextEpisode = show.daysToNextEpisode;
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    STAssertTrue([manager evictRelationshipsOfShows:shows] == 0, @"Unsaved relationships must not be evicted");
+    
+    [manager saveShowsInPersistenceStorage:shows error:&error];
+    
+    LRTVDBShowMemoryUsage memoryUsage = show.memoryUsage;
+    
+    STAssertTrue(memoryUsage.info > 0 && memoryUsage.episodes > 0, @"Memory usage must be reported");
+    STAssertTrue(memoryUsage.images == 0 && memoryUsage.actors == 0, @"Missing relationships use no memory");
+    
+    LRTVDBRelationshipsCache *cache = [[LRTVDBRelationshipsCache alloc] initWithPersistenceManager:manager];
+    cache.shows = shows;
+    
+    // Every show has just been read, so only ended ones are evicted.
+    STAssertTrue([cache evictColdRelationships] == 1, @"Ended shows must be evicted");
+    STAssertTrue([shows[2] isRelationshipsFault], @"Ended shows must be evicted");
+    
+    [shows[1] episodes];
+    
+    sEpisodesChanges = [NSMutableArray array];
+    
+    [show addObserver:self
+           forKeyPath:LRTVDBShowAttributes.episodes
+              options:0
+              context:&kObservingEpisodesChangesContext];
+    
+    STAssertTrue([cache evictColdRelationships] == 1, @"Shows not read since the last eviction must be evicted");
+    STAssertTrue([show isRelationshipsFault], @"Shows not read since the last eviction must be evicted");
+    STAssertFalse([shows[1] isRelationshipsFault], @"Recently read shows must stay loaded");
+    STAssertTrue(show.memoryUsage.episodes == 0, @"Evicted relationships use no memory");
+    STAssertTrue([sEpisodesChanges count] == 1, @"Evicted episodes must be notified");
+    STAssertEqualObjects(sEpisodesChanges[0][NSKeyValueChangeKindKey], @(NSKeyValueChangeSetting), @"Evicted episodes must be notified as a whole");
+    STAssertEquals(show.status, status, @"Values derived from the episodes must be computed from the summary");
+    STAssertEqualObjects(show.daysToNextEpisode, daysToNextEpisode, @"Values derived from the episodes must be computed from the summary");
+    STAssertTrue([show isRelationshipsFault], @"Derived values must not reload the relationships");
+    
+    episode.seen = YES;
+    
+    STAssertFalse([show isRelationshipsFault], @"Relationships must be reloaded on access");
+    STAssertTrue([sEpisodesChanges count] >= 2, @"Reloaded episodes must be notified");
+    STAssertEqualObjects([sEpisodesChanges lastObject][NSKeyValueChangeKindKey], @(NSKeyValueChangeSetting), @"Reloaded episodes must be notified as a whole");
+    STAssertEqualObjects(show.lastEpisode, lastEpisode, @"Derived episodes must be reloaded");
+    STAssertTrue(show.lastEpisode != lastEpisode, @"Derived episodes must not keep evicted episodes alive");
+    
+    [show removeObserver:self forKeyPath:LRTVDBShowAttributes.episodes];
+    sEpisodesChanges = nil;
+    
+    STAssertTrue([show.episodes count] == 2, @"Every episode must be reloaded");
+    STAssertTrue([show.episodes[0] hasBeenSeen], @"Changes to episodes read before the eviction must reach the reloaded ones");
+    STAssertTrue([show numberOfSeenEpisodes] == 1, @"Seen state must be rebuilt");
+    STAssertEqualObjects([show.episodes[0] overview], @"Overview of the pilot", @"Text fields must be reloaded");
+    STAssertTrue([manager evictRelationshipsOfShows:@[show]] == 0, @"Changed relationships must not be evicted");
+    
+    cache.memoryBudget = 1;
+    
+    STAssertTrue([cache trim] == 1, @"Saved relationships over the budget must be evicted");
+    STAssertFalse([show isRelationshipsFault], @"Changed relationships must not be evicted");
+    
+    [manager saveShowsInPersistenceStorage:shows error:&error];
+    
+    STAssertTrue([cache trim] == 1, @"Saved relationships over the budget must be evicted");
+    STAssertTrue(cache.relationshipsMemorySize == 0, @"Every relationship must be evicted");
+    
+    NSArray *persistedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertEqualObjects(persistedShows, shows, @"Shows must be the same and in the same order");
+    STAssertTrue([[persistedShows[0] episodes][0] hasBeenSeen], @"Forwarded changes must be saved");
+    STAssertTrue([[shows[2] episodes] count] == 2, @"Evicted shows must still be saved");
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+}
+
+- (void)testEpisodesSummaryPersistence
+{
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    // Next episode in 3 days, in 1 day and to be announced.
+    NSArray *daysToNextEpisodes = @[@3, @1, @(NSIntegerMax)];
+    NSMutableArray *shows = [NSMutableArray array];
+    
+    for (NSUInteger i = 0; i < [daysToNextEpisodes count]; i++)
+    {
+        NSInteger days = [daysToNextEpisodes[i] integerValue];
+        NSString *nextEpisodeFirstAired = (days != NSIntegerMax ?
+                                           [NSString stringWithFormat:@"<FirstAired>%@</FirstAired>", [self ISODateStringWithDaysFromToday:days]] : @"");
+        
+        LRTVDBShow *show = [[LRTVDBShow alloc] init];
+        show.showID = [NSString stringWithFormat:@"%lu", (unsigned long)(i + 1)];
+        show.name = show.showID;
+        show.basicStatus = LRTVDBShowBasicStatusContinuing;
+        [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:[NSString stringWithFormat:
+                                                    @"<Episode><id>1</id><EpisodeName>1x01</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><FirstAired>%@</FirstAired></Episode>"
+                                                    @"<Episode><id>2</id><EpisodeName>2x01</EpisodeName><SeasonNumber>2</SeasonNumber><EpisodeNumber>1</EpisodeNumber>%@</Episode>",
+                                                    [self ISODateStringWithDaysFromToday:-7], nextEpisodeFirstAired]]]];
+        [shows addObject:show];
+    }
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    [manager saveShowsInPersistenceStorage:shows error:&error];
+    
+    NSArray *persistedShows = [manager showsFromPersistenceStorageWithError:&error];
+    NSArray *sortedShows = [persistedShows sortedArrayUsingComparator:LRTVDBShowComparator];
+    
+    STAssertEqualObjects([sortedShows valueForKey:@"showID"], (@[@"2", @"1", @"3"]), @"Loaded shows must be sorted by days to next episode");
+    
+    for (LRTVDBShow *persistedShow in sortedShows)
+    {
+        LRTVDBShow *show = shows[[persistedShow.showID integerValue] - 1];
+        
+        STAssertEquals(persistedShow.status, show.status, @"Status must be computed from the persisted summary");
+        STAssertEqualObjects(persistedShow.daysToNextEpisode, show.daysToNextEpisode, @"Days to next episode must be computed from the persisted summary");
+        STAssertEqualObjects(persistedShow.numberOfSeasons, @2, @"Number of seasons must be computed from the persisted summary");
+        STAssertTrue([persistedShow isRelationshipsFault], @"Sorting shows or reading their status must not load the episodes");
+    }
+    
+    LRTVDBShow *persistedShow = sortedShows[0];
+    
+    STAssertEqualObjects(persistedShow.nextEpisode.episodeID, @"2", @"Episodes must be loaded when read");
+    STAssertFalse([persistedShow isRelationshipsFault], @"Episodes must be loaded when read");
+    STAssertEqualObjects(persistedShow.lastEpisode.episodeID, @"1", @"Episodes must be loaded when read");
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+}
+
+/**
+ Writes a TVDB dump: a directory with the zip of every show, as downloaded
+ by the client (series and episodes, banners and actors XML files).
+ */
+- (void)testBulkImport
+{
+    static const NSUInteger kNumberOfShows = 10;
+    
+    NSURL *dumpURL = [self dumpURLWithNumberOfShows:kNumberOfShows episodesPerShow:2];
+    
+    // Not a show zip, so it must be skipped.
+    [[@"Not a zip" dataUsingEncoding:NSUTF8StringEncoding] writeToURL:[dumpURL URLByAppendingPathComponent:@"corrupted.zip"] atomically:YES];
+    
+    LRTVDBPersistenceManager *manager = [LRTVDBPersistenceManager manager];
+    NSError *error = nil;
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+    
+    LRTVDBBulkImporter *importer = [[LRTVDBBulkImporter alloc] initWithPersistenceManager:manager];
+    importer.batchSize = 4;
+    
+    NSMutableArray *progresses = [NSMutableArray array];
+    
+    LRTVDBBulkImportProgress *progress = [importer importShowsAtURL:dumpURL progressBlock:^(LRTVDBBulkImportProgress *batchProgress) {
+        [progresses addObject:batchProgress];
+    } error:&error];
+    
+    STAssertNil(error, @"Dump must be imported");
+    STAssertTrue(progress.totalNumberOfArchives == kNumberOfShows + 1, @"Every zip in the dump must be found");
+    STAssertTrue(progress.numberOfImportedShows == kNumberOfShows, @"Every show must be imported");
+    STAssertTrue(progress.numberOfFailedArchives == 1, @"Zips without a show must be skipped");
+    STAssertTrue(progress.numberOfReadBytes > 0 && progress.showsPerSecond > 0, @"Throughput must be reported");
+    STAssertTrue([progresses count] == 3, @"Progress must be reported after every batch");
+    STAssertTrue([[progresses lastObject] fractionCompleted] == 1, @"Progress must be complete after the last batch");
+    
+    NSArray *importedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertTrue([importedShows count] == kNumberOfShows, @"Imported shows must be persisted");
+    STAssertEqualObjects([importedShows[0] showID], @"1", @"Shows must be imported in order");
+    STAssertEqualObjects([importedShows[0] name], @"Show 1", @"Show info must be imported");
+    STAssertTrue([[importedShows[0] episodes] count] == 2, @"Episodes must be imported");
+    STAssertTrue([[importedShows[0] images] count] == 1, @"Images must be imported");
+    STAssertTrue([[importedShows[0] actors] count] == 1, @"Actors must be imported");
+    STAssertNotNil([importedShows[0] infoFingerprint], @"Fingerprints must be kept for the next update");
+    
+    [manager saveShowsInPersistenceStorage:importedShows error:&error];
+    
+    STAssertTrue(manager.numberOfWrittenSegments == 0, @"Imported shows must not be written again");
+    
+    importedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertTrue([importedShows count] == kNumberOfShows, @"Compacted imported shows must be persisted");
+    STAssertTrue([[importedShows[0] episodes] count] == 2, @"Compacted imported shows must be complete");
+    
+    STAssertNil([importer importShowsAtURL:[dumpURL URLByAppendingPathComponent:@"missing"] progressBlock:nil error:&error], @"Missing dumps must fail");
+    STAssertEquals([error code], (NSInteger)kBulkImportUnreadableSourceError, @"Missing dumps must fail");
+    
+    // Saving the shows retrieved before the import
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+    
+    error = nil;
+    
+    STAssertNotNil([importer importShowsAtURL:dumpURL progressBlock:nil error:&error], @"Dump must be imported");
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    show.showID = @"0";
+    show.name = @"Show 0";
+    
+    [manager saveShowsInPersistenceStorage:@[show] error:&error];
+    
+    importedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertTrue([importedShows count] == kNumberOfShows + 1, @"Saving other shows must not remove the imported ones");
+    STAssertEqualObjects([importedShows[0] showID], @"0", @"Saved shows must come first");
+    STAssertEqualObjects([importedShows[1] showID], @"1", @"Imported shows must be kept after the saved ones, in order");
+    STAssertTrue([[importedShows[1] episodes] count] == 2, @"Kept imported shows must be complete");
+    
+    // Saved again before being retrieved
+    error = nil;
+    
+    STAssertNotNil([importer importShowsAtURL:dumpURL progressBlock:nil error:&error], @"Dump must be imported");
+    
+    [manager saveShowsInPersistenceStorage:@[show] error:&error];
+    [manager saveShowsInPersistenceStorage:@[show] error:&error];
+    
+    importedShows = [manager showsFromPersistenceStorageWithError:&error];
+    
+    STAssertTrue([importedShows count] == kNumberOfShows + 1, @"Imported shows must be kept until they're retrieved");
+    STAssertTrue([[importedShows[1] episodes] count] == 2, @"Kept imported shows must be complete");
+    
+    [manager saveShowsInPersistenceStorage:@[show] error:&error];
+    
+    STAssertTrue([[manager showsFromPersistenceStorageWithError:&error] count] == 1, @"Retrieved imported shows must be removed if they're not saved");
+    
+    // Same with the SQLite store
+    LRTVDBSQLitePersistenceManager *SQLiteManager = [LRTVDBSQLitePersistenceManager manager];
+    
+    [SQLiteManager saveShowsInPersistenceStorage:@[] error:&error];
+    
+    STAssertTrue([SQLiteManager journalAddedShows:@[show] error:&error], @"Shows must be added");
+    
+    [SQLiteManager saveShowsInPersistenceStorage:@[] error:&error];
+    [SQLiteManager saveShowsInPersistenceStorage:@[] error:&error];
+    
+    STAssertTrue([[SQLiteManager showsFromPersistenceStorageWithError:&error] count] == 1, @"Imported shows must be kept until they're retrieved");
+    
+    [SQLiteManager saveShowsInPersistenceStorage:@[] error:&error];
+    
+    STAssertTrue([[SQLiteManager showsFromPersistenceStorageWithError:&error] count] == 0, @"Retrieved imported shows must be removed if they're not saved");
+    
+    [manager saveShowsInPersistenceStorage:@[] error:&error];
+    [[NSFileManager defaultManager] removeItemAtURL:dumpURL error:NULL];
+}
+
+#pragma mark - Parse context
+
+- (void)testParseContextIncludeSpecials
+{
+    NSString *xmlString = @"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<Data>"
+                          @"<Episode><id>1</id><EpisodeName>Special</EpisodeName><SeasonNumber>0</SeasonNumber><EpisodeNumber>1</EpisodeNumber><seriesid>1</seriesid></Episode>"
+                          @"<Episode><id>2</id><EpisodeName>Pilot</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><seriesid>1</seriesid></Episode>"
+                          @"</Data>";
+    
+    NSData *data = [xmlString dataUsingEncoding:NSUTF8StringEncoding];
+    
+    LRTVDBParseContext *specialsContext = [[LRTVDBParseContext alloc] initWithLanguage:@"en"
+                                                                       includeSpecials:YES
+                                                                 lazyEpisodeTextFields:NO];
+    
+    // Parsers must only depend on their context, not on the shared client.
+    BOOL includeSpecials = [LRTVDBAPIClient sharedClient].includeSpecials;
+    [LRTVDBAPIClient sharedClient].includeSpecials = NO;
+    
+    NSUInteger numberOfEpisodesWithSpecials = [[[LRTVDBEpisodeParser parserWithContext:specialsContext] episodesFromData:data] count];
+    NSUInteger numberOfEpisodesWithoutSpecials = [[[LRTVDBEpisodeParser parser] episodesFromData:data] count];
+    
+    // Restored before asserting, so that a failure doesn't leak into other tests.
+    [LRTVDBAPIClient sharedClient].includeSpecials = includeSpecials;
+    
+    STAssertTrue(numberOfEpisodesWithSpecials == 2, @"Specials must be included");
+    STAssertTrue(numberOfEpisodesWithoutSpecials == 1, @"Specials must not be included");
+}
+
+- (void)testLanguageDuplicatesRemoval
+{
+    // Similar to a language=all search: every show comes in several languages.
+    static const NSUInteger kNumberOfShows = 3;
+    NSArray *languages = @[@"de", @"en", @"es"];
+    
+    NSMutableString *xmlString = [NSMutableString stringWithString:@"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<Data>"];
+    
+    for (NSUInteger i = 0; i < kNumberOfShows; i++)
+    {
+        for (NSString *language in languages)
+        {
+            [xmlString appendFormat:@"<Series><seriesid>%lu</seriesid><language>%@</language><SeriesName>Show %lu</SeriesName></Series>",
+             (unsigned long)(kNumberOfShows - i), language, (unsigned long)i];
+        }
+    }
+    
+    [xmlString appendString:@"</Data>"];
+    
+    NSData *data = [xmlString dataUsingEncoding:NSUTF8StringEncoding];
+    
+    LRTVDBParseContext *spanishContext = [[LRTVDBParseContext alloc] initWithLanguage:@"es"
+                                                                      includeSpecials:NO
+                                                                lazyEpisodeTextFields:NO];
+    
+    NSArray *shows = [[LRTVDBShowParser parserWithContext:spanishContext] parseBasicShowInfoFromData:data];
+    
+    STAssertTrue([shows count] == kNumberOfShows, @"There must be one show per show ID");
+    STAssertEqualObjects([shows valueForKey:@"showID"], (@[@"3", @"2", @"1"]), @"Ranking order must be kept");
+    
+    for (LRTVDBShow *show in shows)
+    {
+        STAssertEqualObjects(show.language, @"es", @"Show must be in the preferred language");
+        STAssertEqualObjects(show.availableLanguages, languages, @"Every language must be available");
+    }
+    
+    shows = [LRTVDBShowParser removeLanguageDuplicatesFromShows:shows preferredLanguage:@"fr"];
+    
+    STAssertTrue([shows count] == kNumberOfShows, @"There must be one show per show ID");
+    
+    LRTVDBParseContext *frenchContext = [[LRTVDBParseContext alloc] initWithLanguage:@"fr"
+                                                                     includeSpecials:NO
+                                                               lazyEpisodeTextFields:NO];
+    
+    shows = [[LRTVDBShowParser parserWithContext:frenchContext] parseBasicShowInfoFromData:data];
+    
+    for (LRTVDBShow *show in shows)
+    {
+        STAssertEqualObjects(show.language, @"en", @"Show must fall back to English");
+    }
+}
+
+#pragma mark - String interning
+
+- (void)testStringInterning
+{
+    LRTVDBStringInterner *interner = [[LRTVDBStringInterner alloc] init];
+    
+    NSString *firstString = [NSString stringWithFormat:@"%@ %@", @"Vince", @"Gilligan"];
+    NSString *secondString = [NSString stringWithFormat:@"%@ %@", @"Vince", @"Gilligan"];
+    
+    STAssertTrue(firstString != secondString, @"Strings must be different instances");
+    
+    NSString *firstInternedString = [interner internString:firstString];
+    NSString *secondInternedString = [interner internString:secondString];
+    
+    STAssertEqualObjects(firstInternedString, firstString, @"Interned string must be equal to the original one");
+    STAssertTrue(firstInternedString == secondInternedString, @"Interned strings must be the same instance");
+    STAssertNil([interner internString:nil], @"Interning nil must return nil");
+    
+    NSArray *internedStrings = [interner internStringsInArray:@[[secondString mutableCopy], @"Bryan Cranston"]];
+    
+    STAssertTrue(internedStrings[0] == firstInternedString, @"Interned strings must be the same instance");
+    
+    STAssertTrue(interner.numberOfStrings == 2, @"There must be two unique strings");
+    STAssertTrue(interner.numberOfLookups == 4, @"There must be four lookups");
+    STAssertTrue(interner.numberOfHits == 2, @"There must be two hits");
+    STAssertTrue(interner.bytesSaved > 0, @"Some bytes must have been saved");
+    
+    [interner removeAllStrings];
+    
+    STAssertTrue(interner.numberOfStrings == 0, @"Interner must be empty");
+    
+    interner.maximumNumberOfStrings = 2;
+    
+    [interner internString:@"Walter"];
+    [interner internString:@"Jesse"];
+    [interner internString:@"Skyler"];
+    
+    STAssertTrue(interner.numberOfStrings == 1, @"Interner must be purged once full");
+}
+
+#pragma mark - Model merges
+
+- (void)testEpisodesMergeChangeSet
+{
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    NSArray *episodes = [parser episodesFromData:[self episodesDataWithXMLString:
+                                                  @"<Episode><id>1</id><EpisodeName>One</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber></Episode>"
+                                                  @"<Episode><id>3</id><EpisodeName>Three</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>3</EpisodeNumber></Episode>"]];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    [show addEpisodes:episodes];
+    
+    sEpisodesChanges = [NSMutableArray array];
+    
+    [show addObserver:self
+           forKeyPath:LRTVDBShowAttributes.episodes
+              options:0
+              context:&kObservingEpisodesChangesContext];
+    
+    // One new episode in the middle and one updated episode.
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:
+                                                @"<Episode><id>3</id><EpisodeName>Three (updated)</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>3</EpisodeNumber></Episode>"
+                                                @"<Episode><id>2</id><EpisodeName>Two</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber></Episode>"
+                                                @"<Episode><id>1</id><EpisodeName>One</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber></Episode>"]]];
+    
+    STAssertTrue([sEpisodesChanges count] == 2, @"There must be one insertion and one replacement");
+    STAssertEqualObjects(sEpisodesChanges[0][NSKeyValueChangeKindKey], @(NSKeyValueChangeInsertion), @"Insertions come first");
+    STAssertEqualObjects(sEpisodesChanges[0][NSKeyValueChangeIndexesKey], [NSIndexSet indexSetWithIndex:1], @"Wrong inserted index");
+    STAssertEqualObjects(sEpisodesChanges[1][NSKeyValueChangeKindKey], @(NSKeyValueChangeReplacement), @"Updates come last");
+    STAssertEqualObjects(sEpisodesChanges[1][NSKeyValueChangeIndexesKey], [NSIndexSet indexSetWithIndex:2], @"Wrong updated index");
+    STAssertTrue(show.episodes[2] == episodes[1], @"Updated episodes must keep their identity");
+    
+    // Nothing changes, nothing is notified.
+    [sEpisodesChanges removeAllObjects];
+    
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:
+                                                @"<Episode><id>2</id><EpisodeName>Two</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber></Episode>"]]];
+    
+    STAssertTrue([sEpisodesChanges count] == 0, @"Unchanged episodes must not be notified");
+    
+    // An episode that moves can't be described with indexes.
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:
+                                                @"<Episode><id>1</id><EpisodeName>One</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>4</EpisodeNumber></Episode>"]]];
+    
+    STAssertTrue([sEpisodesChanges count] == 1, @"There must be one single change");
+    STAssertEqualObjects(sEpisodesChanges[0][NSKeyValueChangeKindKey], @(NSKeyValueChangeSetting), @"Moves must reload everything");
+    STAssertEqualObjects([show.episodes valueForKey:@"episodeID"], (@[@"2", @"3", @"1"]), @"Episodes must be sorted");
+    
+    [show removeObserver:self forKeyPath:LRTVDBShowAttributes.episodes];
+    
+    sEpisodesChanges = nil;
+}
+
+- (void)testEpisodeIndexIncrementalUpdate
+{
+    static const NSInteger kNumberOfEpisodes = 400;
+    static const NSInteger kEpisodesPerSeason = 20;
+    
+    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
+    [dateFormatter setDateFormat:@"yyyy-MM-dd"];
+    
+    // Episodes around today, some of them without aired date.
+    NSString *(^episodeXML)(NSInteger, NSInteger) = ^(NSInteger index, NSInteger daysOffset) {
+        
+        NSDate *airedDate = [NSDate dateWithTimeIntervalSinceNow:daysOffset * 24 * 60 * 60];
+        NSString *airedDateString = index % 7 == 0 ? @"" : [dateFormatter stringFromDate:airedDate];
+        
+        return [NSString stringWithFormat:@"<Episode><id>%ld</id><EpisodeName>%ld</EpisodeName><SeasonNumber>%ld</SeasonNumber><EpisodeNumber>%ld</EpisodeNumber><FirstAired>%@</FirstAired></Episode>",
+                (long)index + 1, (long)daysOffset, (long)(index / kEpisodesPerSeason), (long)(index % kEpisodesPerSeason + 1), airedDateString];
+    };
+    
+    NSMutableString *firstBatch = [NSMutableString string];
+    NSMutableString *secondBatch = [NSMutableString string];
+    
+    for (NSInteger i = 0; i < kNumberOfEpisodes; i++)
+    {
+        // Every other episode comes in the second batch, a few of them are updated there.
+        if (i % 2 == 0) [firstBatch appendString:episodeXML(i, i - kNumberOfEpisodes / 2)];
+        if (i % 2 == 1 || i % 10 == 0) [secondBatch appendString:episodeXML(i, (i * 37) % kNumberOfEpisodes - kNumberOfEpisodes / 2)];
+    }
+    
+    LRTVDBParseContext *context = [[LRTVDBParseContext alloc] initWithLanguage:nil
+                                                               includeSpecials:YES
+                                                         lazyEpisodeTextFields:NO];
+    
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parserWithContext:context];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:firstBatch]]];
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:secondBatch]]];
+    
+    NSArray *episodes = show.episodes;
+    
+    STAssertTrue([episodes count] == kNumberOfEpisodes, @"Every episode must be merged once");
+    
+    // Brute force results
+    NSDate *today = [[NSDate date] dateByIgnoringTime];
+    NSUInteger lastEpisodeIndex = NSNotFound;
+    NSUInteger numberOfAiredEpisodes = 0;
+    
+    for (NSUInteger i = 0; i < [episodes count]; i++)
+    {
+        NSDate *airedDate = [episodes[i] airedDate];
+        
+        if (airedDate && [airedDate compare:today] == NSOrderedAscending) lastEpisodeIndex = i;
+        if (airedDate && [airedDate compare:today] != NSOrderedDescending && ![episodes[i] isSpecial]) numberOfAiredEpisodes++;
+    }
+    
+    LRTVDBEpisode *lastEpisode = lastEpisodeIndex != NSNotFound ? episodes[lastEpisodeIndex] : nil;
+    LRTVDBEpisode *nextEpisode = lastEpisodeIndex == NSNotFound ? [show episodesForSeason:@1][0] :
+                                 lastEpisodeIndex + 1 < [episodes count] ? episodes[lastEpisodeIndex + 1] : nil;
+    
+    // The episode airing today doesn't count as behind.
+    if ([nextEpisode.airedDate isEqualToDate:today]) numberOfAiredEpisodes--;
+    
+    STAssertTrue(show.lastEpisode == lastEpisode, @"Wrong last episode");
+    STAssertTrue(show.nextEpisode == nextEpisode, @"Wrong next episode");
+    STAssertEqualObjects(show.numberOfEpisodesBehind, @(numberOfAiredEpisodes), @"Wrong number of episodes behind");
+    
+    for (NSInteger season = 0; season < kNumberOfEpisodes / kEpisodesPerSeason; season++)
+    {
+        NSArray *seasonEpisodes = [episodes filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"seasonNumber == %ld", (long)season]];
+        
+        STAssertEqualObjects([show episodesForSeason:@(season)], seasonEpisodes, @"Wrong season episodes");
+    }
+    
+    STAssertEqualObjects(show.specials, [show episodesForSeason:@0], @"Specials are season 0 episodes");
+    STAssertEqualObjects([show episodesForSeason:@(kNumberOfEpisodes)], @[], @"Unknown seasons have no episodes");
+}
+
+- (void)testSeasonStats
+{
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:
+                                                @"<Episode><id>1</id><EpisodeName>1x01</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><Rating>8.0</Rating></Episode>"
+                                                @"<Episode><id>2</id><EpisodeName>1x02</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber><Rating>9.0</Rating></Episode>"
+                                                @"<Episode><id>3</id><EpisodeName>1x03</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>3</EpisodeNumber></Episode>"
+                                                @"<Episode><id>4</id><EpisodeName>2x01</EpisodeName><SeasonNumber>2</SeasonNumber><EpisodeNumber>1</EpisodeNumber></Episode>"]]];
+    
+    LRTVDBEpisode *unratedEpisode = [show episodesForSeason:@1][2];
+    
+    STAssertNil(unratedEpisode.rating, @"Unrated episodes must have no rating");
+    STAssertEqualObjects(unratedEpisode.seasonNumber, @1, @"Season number must be kept");
+    STAssertEqualObjects(unratedEpisode.episodeNumber, @3, @"Episode number must be kept");
+    
+    STAssertEqualsWithAccuracy([[show averageRatingForSeason:@1] doubleValue], 8.5, 0.001, @"Unrated episodes don't count");
+    STAssertNil([show averageRatingForSeason:@2], @"Season 2 has no ratings");
+    STAssertNil([show averageRatingForSeason:@3], @"Season 3 doesn't exist");
+    
+    [show setSeen:YES forEpisodesInRange:NSMakeRange(1, 3)];
+    
+    STAssertTrue([show numberOfSeenEpisodesForSeason:@1] == 2, @"Two episodes of season 1 have been seen");
+    STAssertTrue([show numberOfSeenEpisodesForSeason:@2] == 1, @"One episode of season 2 has been seen");
+    STAssertTrue([show numberOfSeenEpisodesForSeason:@3] == 0, @"Season 3 doesn't exist");
+}
+
+- (void)testArtworkIndex
+{
+    NSData *(^bannersData)(NSString *) = ^NSData *(NSString *bannersXMLString) {
+        return [[NSString stringWithFormat:@"<Banners>%@</Banners>", bannersXMLString] dataUsingEncoding:NSUTF8StringEncoding];
+    };
+    
+    LRTVDBImageParser *parser = [LRTVDBImageParser parser];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    [show addImages:[parser imagesFromData:bannersData(
+                                                       @"<Banner><BannerPath>posters/1.jpg</BannerPath><BannerType>poster</BannerType><Rating>7.0</Rating><RatingCount>10</RatingCount></Banner>"
+                                                       @"<Banner><BannerPath>posters/2.jpg</BannerPath><BannerType>poster</BannerType><Rating>9.0</Rating><RatingCount>5</RatingCount></Banner>"
+                                                       @"<Banner><BannerPath>seasons/1-1.jpg</BannerPath><BannerType>season</BannerType><Season>1</Season><Rating>6.0</Rating><RatingCount>3</RatingCount></Banner>"
+                                                       @"<Banner><BannerPath>seasons/1-2.jpg</BannerPath><BannerType>season</BannerType><Season>2</Season><Rating>8.0</Rating><RatingCount>3</RatingCount></Banner>")]];
+    
+    STAssertTrue([show.posterImages count] == 2, @"Two posters");
+    STAssertTrue([show.seasonImages count] == 2, @"Two season images");
+    STAssertTrue([show.fanartImages count] == 0, @"No fanart");
+    STAssertNil([show bestImageOfType:LRTVDBImageTypeFanart], @"No fanart");
+    
+    STAssertEqualsWithAccuracy([[show bestImageOfType:LRTVDBImageTypePoster].rating doubleValue], 9.0, 0.001, @"Best rated poster first");
+    STAssertEqualObjects([show bestImageForSeason:@2].seasonNumber, @2, @"Season images are grouped by season");
+    STAssertNil([show bestImageForSeason:@3], @"Season 3 has no images");
+    
+    // Incremental update
+    [show addImages:[parser imagesFromData:bannersData(
+                                                       @"<Banner><BannerPath>posters/3.jpg</BannerPath><BannerType>poster</BannerType><Rating>10.0</Rating><RatingCount>1</RatingCount></Banner>"
+                                                       @"<Banner><BannerPath>fanart/1.jpg</BannerPath><BannerType>fanart</BannerType><Rating>5.0</Rating><RatingCount>1</RatingCount></Banner>")]];
+    
+    NSArray *bestPosters = [show bestImagesOfType:LRTVDBImageTypePoster count:2];
+    
+    STAssertTrue([show.posterImages count] == 3, @"Three posters");
+    STAssertTrue([bestPosters count] == 2, @"Only the two best posters");
+    STAssertEqualsWithAccuracy([[bestPosters[0] rating] doubleValue], 10.0, 0.001, @"New best poster first");
+    STAssertEqualsWithAccuracy([[bestPosters[1] rating] doubleValue], 9.0, 0.001, @"Previous best poster second");
+    STAssertTrue([show.fanartImages count] == 1, @"New fanart must be indexed");
+    STAssertTrue([[show bestImagesOfType:LRTVDBImageTypeBanner count:3] count] == 0, @"No banners");
+}
+
+- (void)testShowUpdateFingerprints
+{
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    show.showID = @"1";
+    show.name = @"Name";
+    show.infoFingerprint = @1;
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:
+                                                @"<Episode><id>1</id><EpisodeName>1x01</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber></Episode>"]]];
+    
+    LRTVDBShow *updatedShow = [[LRTVDBShow alloc] init];
+    updatedShow.showID = @"1";
+    updatedShow.name = @"New name";
+    updatedShow.infoFingerprint = @1;
+    updatedShow.actorsFingerprint = @2;
+    
+    NSUInteger numberOfSkippedSections = [show updateWithShow:updatedShow
+                                               updateEpisodes:YES
+                                                 updateImages:NO
+                                                 updateActors:YES
+                                               replaceArtwork:NO];
+    
+    STAssertTrue(numberOfSkippedSections == 1, @"Only the show info must be skipped");
+    STAssertEqualObjects(show.name, @"Name", @"Unchanged show info must not be reassigned");
+    STAssertTrue([show.episodes count] == 1, @"Unchanged episodes must be kept");
+    STAssertEqualObjects(show.actorsFingerprint, @2, @"Updated sections must keep their new fingerprint");
+    
+    updatedShow.infoFingerprint = @3;
+    
+    numberOfSkippedSections = [show updateWithShow:updatedShow
+                                    updateEpisodes:NO
+                                      updateImages:NO
+                                      updateActors:YES
+                                    replaceArtwork:NO];
+    
+    STAssertTrue(numberOfSkippedSections == 1, @"Only the actors must be skipped");
+    STAssertEqualObjects(show.name, @"New name", @"Changed show info must be updated");
+    
+    NSError *error = nil;
+    LRTVDBShow *deserializedShow = [LRTVDBShow deserialize:[show serialize] error:&error];
+    
+    STAssertNil(error, @"Fingerprints must be deserialized without errors");
+    
+    STAssertEqualObjects(deserializedShow.infoFingerprint, @3, @"Fingerprints must be persisted");
+    STAssertEqualObjects(deserializedShow.actorsFingerprint, @2, @"Fingerprints must be persisted");
+    STAssertNil(deserializedShow.imagesFingerprint, @"Unknown fingerprints must stay unknown");
+    
+    // Show info fetched to replace the artwork must never be skipped as
+    // unchanged if the current artwork wasn't taken from it.
+    LRTVDBParseContext *context = [[LRTVDBParseContext alloc] initWithLanguage:nil
+                                                               includeSpecials:NO
+                                                         lazyEpisodeTextFields:NO];
+    
+    STAssertFalse([LRTVDBFingerprint(1, context, YES, YES) isEqual:LRTVDBFingerprint(1, context, YES, NO)], @"Replacing the artwork must change the fingerprint");
+    STAssertEqualObjects(LRTVDBFingerprint(1, context, YES, YES), LRTVDBFingerprint(1, context, YES, YES), @"Fingerprints must be stable");
+}
+
+- (void)testEpisodesMerge
+{
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:
+                                                @"<Episode><id>3</id><EpisodeName>Episode 3</EpisodeName><SeasonNumber>2</SeasonNumber><EpisodeNumber>1</EpisodeNumber></Episode>"
+                                                @"<Episode><id>1</id><EpisodeName>Episode 1</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber></Episode>"]]];
+    
+    LRTVDBEpisode *firstEpisode = show.episodes[0];
+    
+    STAssertEqualObjects([show.episodes valueForKey:@"episodeID"], (@[@"1", @"3"]), @"Episodes must be sorted");
+    
+    // Reverse order, so the merge has to sort the whole batch.
+    NSArray *updatedEpisodes = [parser episodesFromData:[self episodesDataWithXMLString:
+                                                         @"<Episode><id>4</id><EpisodeName>Updated episode 4</EpisodeName><SeasonNumber>2</SeasonNumber><EpisodeNumber>2</EpisodeNumber></Episode>"
+                                                         @"<Episode><id>3</id><EpisodeName>Updated episode 3</EpisodeName><SeasonNumber>2</SeasonNumber><EpisodeNumber>1</EpisodeNumber></Episode>"
+                                                         @"<Episode><id>2</id><EpisodeName>Updated episode 2</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber></Episode>"
+                                                         @"<Episode><id>1</id><EpisodeName>Updated episode 1</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber></Episode>"]];
+    
+    [show addEpisodes:updatedEpisodes];
+    
+    STAssertTrue([show.episodes count] == 4, @"Every episode must be merged once");
+    STAssertTrue(show.episodes[0] == firstEpisode, @"Existing episodes must be updated in place");
+    STAssertEqualObjects(firstEpisode.title, @"Updated episode 1", @"Existing episodes must be updated");
+    STAssertEqualObjects([show.episodes valueForKey:@"episodeID"], (@[@"1", @"2", @"3", @"4"]), @"Episodes must be sorted");
+    
+    // Merging the same batch again must not change anything.
+    [show addEpisodes:updatedEpisodes];
+    
+    STAssertTrue([show.episodes count] == 4, @"Every episode must be merged once");
+    STAssertTrue(show.episodes[0] == firstEpisode, @"Existing episodes must be updated in place");
+}
+
+#pragma mark - Seen state
+
+- (void)testSeenStateCounters
+{
+    static const NSUInteger kNumberOfSeasons = 20;
+    static const NSUInteger kEpisodesPerSeason = 25;
+    
+    NSMutableString *episodesXMLString = [NSMutableString string];
+    
+    // Every episode has already aired, specials included.
+    for (NSUInteger i = 0; i < (kNumberOfSeasons + 1) * kEpisodesPerSeason; i++)
+    {
+        [episodesXMLString appendFormat:@"<Episode><id>%lu</id><EpisodeName>%lu</EpisodeName><SeasonNumber>%lu</SeasonNumber><EpisodeNumber>%lu</EpisodeNumber><FirstAired>2000-01-01</FirstAired></Episode>",
+         (unsigned long)i + 1, (unsigned long)i, (unsigned long)(i / kEpisodesPerSeason), (unsigned long)(i % kEpisodesPerSeason + 1)];
+    }
+    
+    LRTVDBParseContext *context = [[LRTVDBParseContext alloc] initWithLanguage:nil
+                                                               includeSpecials:YES
+                                                         lazyEpisodeTextFields:NO];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    [show addEpisodes:[[LRTVDBEpisodeParser parserWithContext:context] episodesFromData:[self episodesDataWithXMLString:episodesXMLString]]];
+    
+    NSUInteger numberOfRegularEpisodes = kNumberOfSeasons * kEpisodesPerSeason;
+    
+    STAssertFalse([show isActive], @"No episode has been seen yet");
+    STAssertEqualObjects(show.numberOfEpisodesBehind, @(numberOfRegularEpisodes), @"Every regular episode is behind");
+    STAssertEqualObjects(show.activeEpisode, [show episodesForSeason:@1][0], @"Active episode must be the first regular one");
+    
+    [show setSeen:YES forEpisodesInRange:NSMakeRange(0, [show.episodes count])];
+    
+    STAssertTrue([show isActive], @"Show must be active");
+    STAssertEqualObjects(show.numberOfEpisodesBehind, @0, @"No episode is behind");
+    STAssertTrue([show hasBeenFinished], @"Show must be finished");
+    
+    // Specials don't count
+    [show setSeen:NO forEpisodesInRange:NSMakeRange(0, kEpisodesPerSeason)];
+    
+    STAssertEqualObjects(show.numberOfEpisodesBehind, @0, @"Specials don't count as behind");
+    
+    LRTVDBEpisode *episode = [show episodesForSeason:@10][5];
+    episode.seen = NO;
+    
+    STAssertEqualObjects(show.numberOfEpisodesBehind, @1, @"There must be one episode behind");
+    STAssertEqualObjects(show.activeEpisode, episode, @"Active episode must be the unseen one");
+    
+    episode.seen = NO;
+    
+    STAssertEqualObjects(show.numberOfEpisodesBehind, @1, @"Marking twice must not change the counters");
+    
+    [show setSeen:NO forEpisodesInRange:NSMakeRange(0, [show.episodes count] * 2)];
+    
+    STAssertFalse([show isActive], @"No episode has been seen");
+    STAssertEqualObjects(show.numberOfEpisodesBehind, @(numberOfRegularEpisodes), @"Every regular episode is behind");
+}
+
+#pragma mark - Day numbers
+
+- (void)testDaysToAir
+{
+    LRTVDBDayNumber todayDayNumber = LRTVDBTodayDayNumber();
+    
+    STAssertEquals(todayDayNumber, [[NSDate date] lr_dayNumber], @"Cached day number must be today's one");
+    STAssertEquals(LRTVDBTodayDayNumber(), todayDayNumber, @"Day number must not change within the same day");
+    
+    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
+    dateFormatter.dateFormat = @"yyyy-MM-dd";
+    
+    NSString *todayString = [dateFormatter stringFromDate:[NSDate lr_dateWithDayNumber:todayDayNumber]];
+    NSString *tomorrowString = [dateFormatter stringFromDate:[NSDate lr_dateWithDayNumber:todayDayNumber + 1]];
+    
+    NSArray *episodes = [[LRTVDBEpisodeParser parser] episodesFromData:[self episodesDataWithXMLString:[NSString stringWithFormat:
+                         @"<Episode><id>1</id><EpisodeName>Today</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>1</EpisodeNumber><FirstAired>%@</FirstAired></Episode>"
+                         @"<Episode><id>2</id><EpisodeName>Tomorrow</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>2</EpisodeNumber><FirstAired>%@</FirstAired></Episode>"
+                         @"<Episode><id>3</id><EpisodeName>TBA</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>3</EpisodeNumber></Episode>",
+                         todayString, tomorrowString]]];
+    
+    STAssertTrue([episodes count] == 3, @"There must be 3 episodes");
+    STAssertTrue([episodes[0] hasAlreadyAired], @"Episodes airing today have already aired");
+    STAssertFalse([episodes[1] hasAlreadyAired], @"Episodes airing tomorrow haven't aired yet");
+    STAssertFalse([episodes[2] hasAlreadyAired], @"Episodes without aired date haven't aired yet");
+}
+
+- (void)testEpisodesInformationConcurrentReads
+{
+    static const NSUInteger kNumberOfReaders = 4;
+    static const NSUInteger kReadsPerReader = 20000;
+    static const NSUInteger kNumberOfBatches = 20;
+    
+    NSString *(^episodeXMLString)(NSUInteger, NSInteger) = ^(NSUInteger number, NSInteger days) {
+        
+        return [NSString stringWithFormat:@"<Episode><id>%lu</id><EpisodeName>%lu</EpisodeName><SeasonNumber>1</SeasonNumber><EpisodeNumber>%lu</EpisodeNumber><FirstAired>%@</FirstAired></Episode>",
+                (unsigned long)number, (unsigned long)number, (unsigned long)number, [self ISODateStringWithDaysFromToday:days]];
+    };
+    
+    LRTVDBEpisodeParser *parser = [LRTVDBEpisodeParser parser];
+    
+    LRTVDBShow *show = [[LRTVDBShow alloc] init];
+    show.basicStatus = LRTVDBShowBasicStatusContinuing;
+    [show addEpisodes:[parser episodesFromData:[self episodesDataWithXMLString:[episodeXMLString(1, -7) stringByAppendingString:episodeXMLString(2, 7)]]]];
+    
+    NSMutableArray *batches = [NSMutableArray arrayWithCapacity:kNumberOfBatches];
+    
+    for (NSUInteger i = 0; i < kNumberOfBatches; i++)
+    {
+        [batches addObject:[parser episodesFromData:[self episodesDataWithXMLString:episodeXMLString(i + 3, i + 14)]]];
+    }
+    
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    
+    __block int32_t inconsistentReads = 0;
+    
+    dispatch_group_async(group, queue, ^{
+        
+        for (NSArray *batch in batches)
+        {
+            [show addEpisodes:batch];
+        }
+    });
+    
+    // Derived values are published as a whole, readers only ever see complete ones.
+    for (NSUInteger reader = 0; reader < kNumberOfReaders; reader++)
+    {
+        dispatch_group_async(group, queue, ^{
+            
+            for (NSUInteger i = 0; i < kReadsPerReader; i++)
+            {
+                if (![show.lastEpisode.episodeID isEqualToString:@"1"] ||
+                    ![show.nextEpisode.episodeID isEqualToString:@"2"] ||
+                    ![show.daysToNextEpisode isEqualToNumber:@7] ||
+                    show.status != LRTVDBShowStatusUpcoming)
+                {
+                    OSAtomicIncrement32(&inconsistentReads);
+                }
+            }
+        });
+    }
+    
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(group);
+#endif
+    
+    STAssertTrue([show.episodes count] == kNumberOfBatches + 2, @"Every episode must have been added");
+    STAssertTrue(inconsistentReads == 0, @"Readers must never see inconsistent episodes information");
+}
+
+- (void)testDateParsing
+{
+    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
+    [dateFormatter setDateFormat:@"yyyy-MM-dd"];
+    
+    for (NSString *dateString in @[@"1950-01-01", @"1999-12-31", @"2012-02-29", @"2013-10-27", @"2029-06-15"])
+    {
+        STAssertEqualObjects([dateString dateValue], [dateFormatter dateFromString:dateString],
+                             @"Parsed date must be the same as the date formatter one");
+    }
+    
+    STAssertNil([@"0000-00-00" dateValue], @"Invalid dates must be nil");
+    STAssertNil([@"2013-02-29" dateValue], @"Invalid dates must be nil");
+    STAssertNil([@"" dateValue], @"Invalid dates must be nil");
+}
+
+#pragma mark - Sorting
+
+- (void)testShowsSortKey
+{
+    LRTVDBShow *(^show)(NSString *, NSNumber *, NSNumber *) = ^(NSString *name, NSNumber *rating, NSNumber *ratingCount) {
+        
+        LRTVDBShow *newShow = [[LRTVDBShow alloc] init];
+        newShow.name = name;
+        newShow.rating = rating;
+        newShow.ratingCount = ratingCount;
+        return newShow;
+    };
+    
+    // Ratings that only differ after packing the sort key must still be sorted.
+    NSArray *expectedShows = @[show(@"Zoo", @9.0, @1),
+                               show(@"Zed", @8.701, @0),
+                               show(@"Alias", @8.7, @100),
+                               show(@"Éxtasis", @8.7, @10),
+                               show(@"lost", @8.7, @10),
+                               show(@"Fringe", nil, nil),
+                               show(nil, nil, nil)];
+    
+    NSArray *shows = [[[expectedShows reverseObjectEnumerator] allObjects] sortedArrayUsingComparator:LRTVDBShowComparator];
+    
+    STAssertEqualObjects([shows valueForKey:@"name"], [expectedShows valueForKey:@"name"], @"Shows must be sorted");
+    
+    // The sort key must be refreshed when its inputs change.
+    LRTVDBShow *lastShow = [shows lastObject];
+    lastShow.rating = @10;
+    
+    shows = [shows sortedArrayUsingComparator:LRTVDBShowComparator];
+    
+    STAssertTrue(shows[0] == lastShow, @"Sort key must be refreshed");
+    
+    // Sort keys are refreshed and read from any thread.
+    for (LRTVDBShow *sortedShow in shows)
+    {
+        sortedShow.ratingCount = sortedShow.ratingCount;
+    }
+    
+    NSArray *reversedShows = [[shows reverseObjectEnumerator] allObjects];
+    NSArray *sortedNames = [shows valueForKey:@"name"];
+    __block int32_t missortedArrays = 0;
+    
+    dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        
+        NSArray *sortedShows = [reversedShows sortedArrayUsingComparator:LRTVDBShowComparator];
+        
+        if (![[sortedShows valueForKey:@"name"] isEqualToArray:sortedNames])
+        {
+            OSAtomicIncrement32(&missortedArrays);
+        }
+    });
+    
+    STAssertTrue(missortedArrays == 0, @"Sort keys refreshed concurrently must be consistent");
+}
+
 @end
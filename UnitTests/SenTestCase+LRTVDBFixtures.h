@@ -0,0 +1,48 @@
+// SenTestCase+LRTVDBFixtures.h
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <SenTestingKit/SenTestingKit.h>
+
+/**
+ Fixtures shared by the unit tests and the benchmarks.
+ */
+@interface SenTestCase (LRTVDBFixtures)
+
+/**
+ @return The day the provided number of days from today, formatted as in
+ TheTVDB XML files (yyyy-MM-dd).
+ */
+- (NSString *)ISODateStringWithDaysFromToday:(NSInteger)days;
+
+/**
+ @return Data of an episodes XML file with the provided Episode elements.
+ */
+- (NSData *)episodesDataWithXMLString:(NSString *)episodesXMLString;
+
+/**
+ Writes a dump of show zips, like the ones downloaded from TheTVDB, to a
+ temporary directory. Shows are numbered from 1.
+ @return URL of the dump directory.
+ */
+- (NSURL *)dumpURLWithNumberOfShows:(NSUInteger)numberOfShows episodesPerShow:(NSUInteger)episodesPerShow;
+
+@end
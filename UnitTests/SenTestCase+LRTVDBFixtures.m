@@ -0,0 +1,84 @@
+// SenTestCase+LRTVDBFixtures.m
+//
+// Copyright (c) 2013 Luis Recuenco
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "SenTestCase+LRTVDBFixtures.h"
+#import "ZZArchiveEntry.h"
+#import "ZZMutableArchive.h"
+
+@implementation SenTestCase (LRTVDBFixtures)
+
+- (NSString *)ISODateStringWithDaysFromToday:(NSInteger)days
+{
+    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
+    dateFormatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    dateFormatter.dateFormat = @"yyyy-MM-dd";
+    
+    return [dateFormatter stringFromDate:[NSDate dateWithTimeIntervalSinceNow:days * 24 * 60 * 60]];
+}
+
+- (NSData *)episodesDataWithXMLString:(NSString *)episodesXMLString
+{
+    return [[NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<Data>%@</Data>", episodesXMLString]
+            dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (NSURL *)dumpURLWithNumberOfShows:(NSUInteger)numberOfShows episodesPerShow:(NSUInteger)episodesPerShow
+{
+    NSURL *dumpURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"LRTVDBDump"] isDirectory:YES];
+    
+    [[NSFileManager defaultManager] removeItemAtURL:dumpURL error:NULL];
+    [[NSFileManager defaultManager] createDirectoryAtURL:dumpURL withIntermediateDirectories:YES attributes:nil error:NULL];
+    
+    for (NSUInteger i = 0; i < numberOfShows; i++)
+    {
+        NSString *showID = [NSString stringWithFormat:@"%lu", (unsigned long)(i + 1)];
+        NSMutableString *infoXMLString = [NSMutableString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<Data>"
+                                          @"<Series><id>%@</id><SeriesName>Show %@</SeriesName><Language>en</Language><Status>Continuing</Status></Series>", showID, showID];
+        
+        for (NSUInteger j = 0; j < episodesPerShow; j++)
+        {
+            [infoXMLString appendFormat:@"<Episode><id>%@%04lu</id><EpisodeName>Episode %lu</EpisodeName><Overview>Overview of the episode %lu</Overview>"
+             @"<SeasonNumber>%lu</SeasonNumber><EpisodeNumber>%lu</EpisodeNumber><FirstAired>2012-%02d-%02d</FirstAired><seriesid>%@</seriesid></Episode>",
+             showID, (unsigned long)j, (unsigned long)j, (unsigned long)j, (unsigned long)(j / 10 + 1), (unsigned long)(j % 10 + 1), (int)(1 + j % 12), (int)(1 + j % 28), showID];
+        }
+        
+        [infoXMLString appendString:@"</Data>"];
+        
+        NSData *infoData = [infoXMLString dataUsingEncoding:NSUTF8StringEncoding];
+        NSData *bannersData = [[NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<Banners>"
+                                @"<Banner><id>1</id><BannerPath>fanart/original/%@-1.jpg</BannerPath><BannerType>fanart</BannerType></Banner></Banners>", showID]
+                               dataUsingEncoding:NSUTF8StringEncoding];
+        NSData *actorsData = [@"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<Actors>"
+                              @"<Actor><id>1</id><Name>Actor</Name><Role>Role</Role><SortOrder>0</SortOrder></Actor></Actors>"
+                              dataUsingEncoding:NSUTF8StringEncoding];
+        
+        ZZMutableArchive *archive = [ZZMutableArchive archiveWithContentsOfURL:[dumpURL URLByAppendingPathComponent:[showID stringByAppendingPathExtension:@"zip"]]];
+        
+        [archive updateEntries:@[[ZZArchiveEntry archiveEntryWithFileName:@"en.xml" compress:YES dataBlock:^{ return infoData; }],
+                                 [ZZArchiveEntry archiveEntryWithFileName:@"banners.xml" compress:YES dataBlock:^{ return bannersData; }],
+                                 [ZZArchiveEntry archiveEntryWithFileName:@"actors.xml" compress:YES dataBlock:^{ return actorsData; }]]];
+    }
+    
+    return dumpURL;
+}
+
+@end